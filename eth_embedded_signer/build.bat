@@ -12,8 +12,43 @@ if %ERRORLEVEL% NEQ 0 (
 REM Create build directory
 if not exist build mkdir build
 
+REM Generate the ABI selector table
+if not exist build\generated mkdir build\generated
+gcc -o build\gen_abi_selectors.exe tools\gen_abi_selectors.c src\keccak.c src\cpu.c -Iinclude -std=c11 -Wall -Wextra
+if %ERRORLEVEL% NEQ 0 (
+    echo Build failed!
+    exit /b 1
+)
+build\gen_abi_selectors.exe tools\abi_selectors.txt build\generated\abi_selectors.h
+if %ERRORLEVEL% NEQ 0 (
+    echo Build failed!
+    exit /b 1
+)
+
+REM Build profile: server or embedded, as ETH_PROFILE in CMakeLists.txt (delete build after changing)
+if not defined PROFILE set PROFILE=server
+if /i "%PROFILE%"=="embedded" (
+    if not defined EC_GEN_TABLE_BITS set EC_GEN_TABLE_BITS=2
+    set PROFILE_FLAGS=-DETH_EC_LIMB64=0 -DETH_CPU_DISPATCH=0 -DETH_RFC6979_LANES=1 -DETH_SIGN_BATCH_CHUNK=4
+) else (
+    set PROFILE_FLAGS=
+)
+
+REM Generate the secp256k1 generator table (window bits: 2, 4, 6 or 8)
+if not defined EC_GEN_TABLE_BITS set EC_GEN_TABLE_BITS=8
+gcc -o build\gen_ec_table.exe tools\gen_ec_table.c src\ec.c src\cpu.c -Iinclude -std=c11 -Wall -Wextra -pthread -DETH_EC_GEN_TABLE_RUNTIME -DETH_EC_GEN_TABLE_BITS=%EC_GEN_TABLE_BITS% %PROFILE_FLAGS%
+if %ERRORLEVEL% NEQ 0 (
+    echo Build failed!
+    exit /b 1
+)
+build\gen_ec_table.exe %EC_GEN_TABLE_BITS% build\generated\ec_gen_table.h
+if %ERRORLEVEL% NEQ 0 (
+    echo Build failed!
+    exit /b 1
+)
+
 REM Compile the project
-gcc -o build\eth_signer.exe src\main.c src\crypto.c src\rlp.c src\transaction.c -Iinclude -std=c11 -Wall -Wextra
+gcc -o build\eth_signer.exe src\main.c src\crypto.c src\rlp.c src\transaction.c src\mpmc_queue.c src\pipeline.c src\sign_queue.c src\nonce_manager.c src\file_map.c src\tx_file.c src\batch_sign.c src\hex.c src\arena.c src\tx_json.c src\rpc_batch.c src\u256.c src\tx_batch.c src\keccak.c src\abi.c src\policy.c src\tx_root.c src\eip712.c src\personal_sign.c src\sha512.c src\ec.c src\hd.c src\pubkey.c src\verify.c src\sha256.c src\rfc6979.c src\cpu.c -Iinclude -Ibuild\generated -std=c11 -Wall -Wextra -pthread -DETH_EC_GEN_TABLE_BITS=%EC_GEN_TABLE_BITS% %PROFILE_FLAGS%
 
 if %ERRORLEVEL% NEQ 0 (
     echo Build failed!
@@ -0,0 +1,319 @@
+#ifndef ETH_EMBEDDED_ABI_H
+#define ETH_EMBEDDED_ABI_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "u256.h"
+#include "arena.h"
+
+/*
+ * Solidity ABI calldata encoder.
+ *
+ * Calldata is written straight into an arena: eth_abi_encode_begin reserves
+ * the selector and one 32-byte head word per argument, static arguments fill
+ * their head word in place and dynamic ones (bytes, string, uint256[]) store
+ * an offset in their head word and append their contents behind the head.
+ * The result is one contiguous run of arena memory that can be used as
+ * tx->data as is. Nested dynamic types (bytes[], tuples) are not supported.
+ *
+ * Selectors of common signatures (ETH_ABI_SELECTOR_TRANSFER, ...) are
+ * generated at build time from tools/abi_selectors.txt into
+ * abi_selectors.h; eth_abi_selector only hashes signatures not in that list.
+ */
+
+/* Argument types for batch encoding */
+typedef enum {
+    ETH_ABI_ADDRESS = 0,    /* uint8_t[20] */
+    ETH_ABI_UINT256 = 1,    /* eth_u256_t */
+    ETH_ABI_UINT64 = 2,     /* uint64_t, encoded as uint256 */
+    ETH_ABI_BOOL = 3,       /* uint8_t, 0 or 1 */
+    ETH_ABI_BYTES32 = 4,    /* uint8_t[32] */
+    ETH_ABI_BYTES = 5       /* eth_abi_bytes_t, dynamic bytes or string */
+} eth_abi_type_t;
+
+/* Dynamic byte string */
+typedef struct {
+    const uint8_t *data;    /* Contents */
+    size_t length;          /* Length in bytes */
+} eth_abi_bytes_t;
+
+/* One argument of a batch: its type and a column of values, one per call */
+typedef struct {
+    eth_abi_type_t type;    /* Argument type */
+    const void *values;     /* Array of the type's C representation (see eth_abi_type_t) */
+} eth_abi_column_t;
+
+/* Encoder for one call */
+typedef struct {
+    eth_arena_t *arena;     /* Arena the calldata is written into */
+    uint8_t *data;          /* Start of the calldata (selector) */
+    size_t arg_count;       /* Head words reserved */
+    size_t next_arg;        /* Next head word to fill */
+    size_t length;          /* Calldata length so far */
+    size_t arena_mark;      /* Arena position before begin, for rollback */
+} eth_abi_encoder_t;
+
+/**
+ * @brief Get the 4-byte selector of a function signature
+ *
+ * Signatures from the generated table are looked up, others are hashed.
+ *
+ * @param signature Canonical signature, e.g. "transfer(address,uint256)"
+ * @param length Length of signature
+ * @param selector Output selector (first four hash bytes, big endian)
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_selector(const char *signature, size_t length, uint32_t *selector);
+
+/**
+ * @brief Find the signature of a selector in the generated table
+ *
+ * @param selector Selector
+ * @return Signature, or NULL if the selector is not in the table
+ */
+const char *eth_abi_selector_signature(uint32_t selector);
+
+/**
+ * @brief Start encoding a call: reserves the selector and the head
+ *
+ * @param encoder Pointer to encoder
+ * @param arena Arena to write into (nothing else may allocate from it until end)
+ * @param selector Function selector
+ * @param arg_count Number of top-level arguments
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_encode_begin(eth_abi_encoder_t *encoder, eth_arena_t *arena, uint32_t selector, size_t arg_count);
+
+/**
+ * @brief Append an address argument
+ *
+ * @param encoder Pointer to encoder
+ * @param address 20-byte address
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_address(eth_abi_encoder_t *encoder, const uint8_t address[20]);
+
+/**
+ * @brief Append a uint256 argument
+ *
+ * @param encoder Pointer to encoder
+ * @param value Value
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_uint(eth_abi_encoder_t *encoder, const eth_u256_t *value);
+
+/**
+ * @brief Append a uintN argument given as a 64-bit integer
+ *
+ * @param encoder Pointer to encoder
+ * @param value Value
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_u64(eth_abi_encoder_t *encoder, uint64_t value);
+
+/**
+ * @brief Append a bool argument
+ *
+ * @param encoder Pointer to encoder
+ * @param value Zero for false, anything else for true
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_bool(eth_abi_encoder_t *encoder, int value);
+
+/**
+ * @brief Append a bytes32 argument
+ *
+ * @param encoder Pointer to encoder
+ * @param value 32 bytes
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_bytes32(eth_abi_encoder_t *encoder, const uint8_t value[32]);
+
+/**
+ * @brief Append a dynamic bytes (or string) argument
+ *
+ * @param encoder Pointer to encoder
+ * @param data Contents
+ * @param length Length of contents
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_bytes(eth_abi_encoder_t *encoder, const uint8_t *data, size_t length);
+
+/**
+ * @brief Append a uint256[] argument
+ *
+ * @param encoder Pointer to encoder
+ * @param values Elements
+ * @param count Number of elements
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_put_uint_array(eth_abi_encoder_t *encoder, const eth_u256_t *values, size_t count);
+
+/**
+ * @brief Finish the call (every argument must have been written)
+ *
+ * On error the arena is rolled back to where begin found it.
+ *
+ * @param encoder Pointer to encoder
+ * @param data Output pointer to the calldata in the arena
+ * @param length Output calldata length
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_encode_end(eth_abi_encoder_t *encoder, uint8_t **data, size_t *length);
+
+/**
+ * @brief Encode several calls to the same function, back to back in the arena
+ *
+ * Argument i of call n is element n of columns[i].values. Calls whose
+ * arguments are all static are laid out with one allocation and one clear
+ * for the whole batch.
+ *
+ * @param arena Arena to write into (rolled back on error)
+ * @param selector Function selector
+ * @param columns Argument columns
+ * @param arg_count Number of arguments
+ * @param call_count Number of calls
+ * @param calldata Output calldata pointer per call
+ * @param lengths Output calldata length per call
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_encode_batch(eth_arena_t *arena, uint32_t selector, const eth_abi_column_t *columns,
+                         size_t arg_count, size_t call_count, uint8_t **calldata, size_t *lengths);
+
+/*
+ * Calldata decoding.
+ *
+ * The decoder does not copy: addresses, byte strings and arrays come back
+ * as pointers into the calldata. Every access is bounds checked, addresses
+ * must have zero upper bytes and bools must be 0 or 1, so malformed calldata
+ * is rejected rather than read leniently.
+ */
+
+/* Returned by eth_abi_decode_token_call for calldata that is not a known token call */
+#define ETH_ABI_NOT_TOKEN_CALL 1
+
+/* Decoded view of a call */
+typedef struct {
+    const uint8_t *calldata;    /* Whole calldata */
+    size_t length;              /* Calldata length */
+    uint32_t selector;          /* Function selector */
+    const uint8_t *args;        /* Arguments (calldata + 4) */
+    size_t args_length;         /* Length of the arguments */
+} eth_abi_call_t;
+
+/* Token operations recognised by the fast path */
+typedef enum {
+    ETH_ABI_TOKEN_TRANSFER = 0,             /* transfer(to, amount) */
+    ETH_ABI_TOKEN_TRANSFER_FROM = 1,        /* transferFrom(from, to, amount or token id) */
+    ETH_ABI_TOKEN_APPROVE = 2,              /* approve(spender, amount or token id) */
+    ETH_ABI_TOKEN_INCREASE_ALLOWANCE = 3,   /* increaseAllowance(spender, amount) */
+    ETH_ABI_TOKEN_DECREASE_ALLOWANCE = 4,   /* decreaseAllowance(spender, amount) */
+    ETH_ABI_TOKEN_SAFE_TRANSFER_FROM = 5,   /* safeTransferFrom(from, to, token id[, data]) */
+    ETH_ABI_TOKEN_SET_APPROVAL_FOR_ALL = 6  /* setApprovalForAll(operator, approved) */
+} eth_abi_token_op_t;
+
+/* Arguments of a recognised token call (pointers into the calldata) */
+typedef struct {
+    eth_abi_token_op_t op;      /* Operation */
+    uint32_t selector;          /* Function selector */
+    const uint8_t *from;        /* Owner for transferFrom/safeTransferFrom, NULL otherwise */
+    const uint8_t *to;          /* Recipient, spender or operator (20 bytes) */
+    eth_u256_t amount;          /* Amount or token id (1/0 for setApprovalForAll) */
+    eth_abi_bytes_t data;       /* safeTransferFrom data (empty otherwise) */
+} eth_abi_token_call_t;
+
+/**
+ * @brief Split calldata into selector and arguments
+ *
+ * @param call Output view
+ * @param calldata Calldata (must outlive the view)
+ * @param length Calldata length (at least 4)
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_decode(eth_abi_call_t *call, const uint8_t *calldata, size_t length);
+
+/**
+ * @brief Get a head word
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @return Pointer to the 32-byte word, or NULL if it is out of bounds
+ */
+const uint8_t *eth_abi_word(const eth_abi_call_t *call, size_t index);
+
+/**
+ * @brief Get an address argument
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @param address Output pointer to the 20 address bytes in the calldata
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_get_address(const eth_abi_call_t *call, size_t index, const uint8_t **address);
+
+/**
+ * @brief Get a uint256 argument
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @param value Output value
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_get_uint(const eth_abi_call_t *call, size_t index, eth_u256_t *value);
+
+/**
+ * @brief Get a uintN argument that must fit in 64 bits
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @param value Output value
+ * @return 0 on success, non-zero on error (including values above 2^64 - 1)
+ */
+int eth_abi_get_u64(const eth_abi_call_t *call, size_t index, uint64_t *value);
+
+/**
+ * @brief Get a bool argument
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @param value Output value (0 or 1)
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_get_bool(const eth_abi_call_t *call, size_t index, int *value);
+
+/**
+ * @brief Get a dynamic bytes (or string) argument
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @param bytes Output view of the contents in the calldata
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_get_bytes(const eth_abi_call_t *call, size_t index, eth_abi_bytes_t *bytes);
+
+/**
+ * @brief Get a dynamic array of static 32-byte elements (uint256[], address[], ...)
+ *
+ * @param call Decoded call
+ * @param index Argument index
+ * @param elements Output pointer to the first element word in the calldata
+ * @param count Output element count
+ * @return 0 on success, non-zero on error
+ */
+int eth_abi_get_array(const eth_abi_call_t *call, size_t index, const uint8_t **elements, size_t *count);
+
+/**
+ * @brief Recognise and decode an ERC-20/ERC-721 token call
+ *
+ * Matches the selector against the generated constants and checks the exact
+ * encoded length, so the common calls decode without touching the generic
+ * path. Trailing bytes after the arguments are rejected.
+ *
+ * @param calldata Calldata
+ * @param length Calldata length
+ * @param call Output token call
+ * @return 0 for a token call, ETH_ABI_NOT_TOKEN_CALL for anything else, negative for malformed token calls
+ */
+int eth_abi_decode_token_call(const uint8_t *calldata, size_t length, eth_abi_token_call_t *call);
+
+#endif /* ETH_EMBEDDED_ABI_H */
@@ -0,0 +1,67 @@
+#ifndef ETH_EMBEDDED_ARENA_H
+#define ETH_EMBEDDED_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Bump allocator over a caller-supplied buffer. Allocations are never freed
+ * one by one; the whole arena is reset at once (e.g. per batch).
+ */
+
+/* Arena context */
+typedef struct {
+    uint8_t *buffer;      /* Backing memory */
+    size_t size;          /* Size of backing memory */
+    size_t used;          /* Bytes handed out so far */
+} eth_arena_t;
+
+/**
+ * @brief Initialise an arena over a buffer
+ *
+ * @param arena Pointer to arena
+ * @param buffer Backing memory
+ * @param size Size of backing memory
+ * @return 0 on success, non-zero on error
+ */
+int eth_arena_init(eth_arena_t *arena, void *buffer, size_t size);
+
+/**
+ * @brief Allocate from the arena
+ *
+ * @param arena Pointer to arena
+ * @param size Number of bytes
+ * @param align Alignment (power of two, 1 for byte data)
+ * @return Pointer to the allocation, NULL if the arena is exhausted
+ */
+void *eth_arena_alloc(eth_arena_t *arena, size_t size, size_t align);
+
+/**
+ * @brief Get the free space at the top of the arena without allocating it
+ *
+ * For writers that only know their size once they are done: write into the
+ * returned space, then claim what was used with eth_arena_advance.
+ *
+ * @param arena Pointer to arena
+ * @param available Output number of free bytes
+ * @return Pointer to the free space
+ */
+uint8_t *eth_arena_top(eth_arena_t *arena, size_t *available);
+
+/**
+ * @brief Claim bytes written at the top of the arena
+ *
+ * @param arena Pointer to arena
+ * @param length Number of bytes to claim
+ * @return 0 on success, non-zero if length exceeds the free space
+ */
+int eth_arena_advance(eth_arena_t *arena, size_t length);
+
+/**
+ * @brief Release every allocation at once
+ *
+ * @param arena Pointer to arena
+ */
+void eth_arena_reset(eth_arena_t *arena);
+
+#endif /* ETH_EMBEDDED_ARENA_H */
@@ -0,0 +1,68 @@
+#ifndef ETH_EMBEDDED_BATCH_SIGN_H
+#define ETH_EMBEDDED_BATCH_SIGN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+#include "policy.h"
+
+/*
+ * Bulk offline signing: map a batch file of unsigned transactions (tx_file.h),
+ * sign them on the pipeline and write the raw signed transactions
+ * in input order. A transaction that fails to sign still produces an (empty)
+ * output record so records stay aligned with the input. In the JSON-RPC
+ * format a failed transaction is left out instead, and request ids are the
+ * input record indexes.
+ *
+ * Nothing is printed: failed transactions are reported through the optional
+ * on_failure callback and the stats, and the return value tells an
+ * unreadable input file from a malformed record.
+ */
+
+/* Returned by eth_batch_sign_file when the input is not a readable batch file */
+#define ETH_BATCH_UNREADABLE -4
+
+/* Returned by eth_batch_sign_file when a malformed record stopped the batch (see malformed_index) */
+#define ETH_BATCH_MALFORMED  -6
+
+/* Called for each transaction that could not be signed, in input order, from one thread at a time */
+typedef void (*eth_batch_failure_fn)(uint64_t index, int status, eth_policy_result_t reason, void *context);
+
+/* Output formats */
+typedef enum {
+    ETH_BATCH_OUTPUT_BINARY = 0,  /* u32 little-endian length, then the raw transaction */
+    ETH_BATCH_OUTPUT_HEX = 1,     /* One 0x-prefixed hex line per transaction */
+    ETH_BATCH_OUTPUT_RPC = 2      /* One JSON-RPC eth_sendRawTransaction batch per line */
+} eth_batch_output_t;
+
+/* Batch signing options */
+typedef struct {
+    const char *input_path;                /* Unsigned transaction file */
+    const char *output_path;               /* Output file ("-" for stdout) */
+    const eth_private_key_t *private_key;  /* Key to sign with */
+    unsigned threads;                      /* Signing threads (0 means 1) */
+    eth_batch_output_t format;             /* Output format */
+    unsigned rpc_batch_size;               /* Requests per JSON-RPC batch (0 means 1000) */
+    const eth_policy_t *policy;            /* Only sign what this policy allows (optional) */
+    eth_batch_failure_fn on_failure;       /* Told about each failed transaction (optional) */
+    void *failure_context;                 /* Passed to on_failure */
+} eth_batch_sign_options_t;
+
+/* Batch signing results */
+typedef struct {
+    uint64_t signed_count;                 /* Transactions signed and written */
+    uint64_t failed_count;                 /* Transactions that could not be signed */
+    uint64_t denied_count;                 /* Of those, transactions the policy denied */
+    uint64_t malformed_index;              /* Record that stopped the batch with ETH_BATCH_MALFORMED */
+} eth_batch_sign_stats_t;
+
+/**
+ * @brief Sign every transaction in a file
+ *
+ * @param options Batch signing options
+ * @param stats Output counters (optional)
+ * @return 0 if every transaction was signed, non-zero on error or if any failed
+ */
+int eth_batch_sign_file(const eth_batch_sign_options_t *options, eth_batch_sign_stats_t *stats);
+
+#endif /* ETH_EMBEDDED_BATCH_SIGN_H */
@@ -0,0 +1,81 @@
+#ifndef ETH_EMBEDDED_CPU_H
+#define ETH_EMBEDDED_CPU_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * CPU feature probing for kernel dispatch.
+ *
+ * Modules with several kernels (hex.h, sha256.h, keccak.h, and field
+ * arithmetic in ec.h) each keep a table of function pointers and pick an
+ * entry from eth_cpu_features() on first use, so one binary runs the fastest
+ * kernels each host supports. Features are read with CPUID once per process;
+ * the AVX states also have to be enabled by the OS (XGETBV).
+ *
+ * The ETH_SIGNER_CPU environment variable narrows the features the kernels
+ * may use, e.g. to compare backends on one machine:
+ *   scalar              portable code only, as on a 32-bit target
+ *   baseline            no instruction set extensions (64-bit limbs stay)
+ *   avx2                AVX2 and what it implies (SSSE3, SSE4.1)
+ *   sse4.1,sha          any comma-separated list of feature names
+ *   native (or unset)   everything the CPU supports
+ * Names are ssse3, sse4.1, avx2, bmi2, sha and avx512; every list keeps
+ * mul64. Features the CPU lacks are never enabled, and unknown names are
+ * ignored.
+ *
+ * Builds with ETH_CPU_DISPATCH set to 0 keep one portable kernel per module
+ * and call it directly: no instruction set extensions, no function pointers,
+ * and a call graph that static stack analysis can follow. ETH_SIGNER_CPU
+ * then has no effect on the kernels.
+ */
+
+#ifndef ETH_CPU_DISPATCH
+#define ETH_CPU_DISPATCH 1
+#endif
+
+/* Feature bits */
+#define ETH_CPU_SSSE3   (1u << 0)
+#define ETH_CPU_SSE41   (1u << 1)
+#define ETH_CPU_AVX2    (1u << 2)
+#define ETH_CPU_BMI2    (1u << 3)    /* BMI1 and BMI2 (andn, rorx) */
+#define ETH_CPU_SHA     (1u << 4)    /* SHA-NI */
+#define ETH_CPU_AVX512  (1u << 5)    /* AVX-512 F and VL */
+#define ETH_CPU_MUL64   (1u << 6)    /* 64x64->128 multiply (any 64-bit target) */
+
+/* Environment variable that narrows the features */
+#define ETH_CPU_ENV "ETH_SIGNER_CPU"
+
+/**
+ * @brief Features the CPU and OS support, ignoring ETH_SIGNER_CPU
+ *
+ * @return Feature bits
+ */
+uint32_t eth_cpu_detected(void);
+
+/**
+ * @brief Features kernels may use (detected, narrowed by ETH_SIGNER_CPU)
+ *
+ * @return Feature bits
+ */
+uint32_t eth_cpu_features(void);
+
+/**
+ * @brief Write feature names as a space-separated list
+ *
+ * @param features Feature bits
+ * @param output Output string (always terminated)
+ * @param size Size of output
+ * @return 0 on success, non-zero if the output was truncated
+ */
+int eth_cpu_describe(uint32_t features, char *output, size_t size);
+
+/**
+ * @brief Probe the CPU and read ETH_SIGNER_CPU now rather than on first use
+ *
+ * Call before starting threads if the environment may change later; kernel
+ * tables are then resolved from this result on first use.
+ */
+void eth_cpu_init(void);
+
+#endif /* ETH_EMBEDDED_CPU_H */
@@ -48,6 +48,34 @@ int eth_keccak256(const eth_byte_t *input, size_t input_len, eth_hash_t *output)
  */
 int eth_sign(const eth_hash_t *msg_hash, const eth_private_key_t *private_key, eth_signature_t *signature);
 
+/**
+ * @brief Sign a message hash and report the recovery ID
+ *
+ * Nonces are deterministic (RFC 6979) and s is always in the low half of
+ * the group order (EIP-2).
+ *
+ * @param msg_hash Hash of the message to sign (32 bytes)
+ * @param private_key Private key to sign with (32 bytes)
+ * @param signature Output signature (64 bytes: r and s concatenated)
+ * @param recovery_id Output recovery ID (0 or 1; 2 or 3 in the negligible case r overflowed) (optional)
+ * @return 0 on success, non-zero on error
+ */
+int eth_sign_recoverable(const eth_hash_t *msg_hash, const eth_private_key_t *private_key,
+                         eth_signature_t *signature, uint8_t *recovery_id);
+
+/**
+ * @brief Sign many message hashes, deriving their nonces side by side
+ * 
+ * @param msg_hashes Hashes to sign
+ * @param private_keys Private key for each hash
+ * @param count Number of hashes
+ * @param signatures Output signatures
+ * @param recovery_ids Output recovery IDs (optional)
+ * @return 0 on success, non-zero on error
+ */
+int eth_sign_batch(const eth_hash_t *msg_hashes, const eth_private_key_t *private_keys, size_t count,
+                   eth_signature_t *signatures, uint8_t *recovery_ids);
+
 /**
  * @brief Recover public key from signature and message hash
  * 
@@ -60,6 +88,15 @@ int eth_sign(const eth_hash_t *msg_hash, const eth_private_key_t *private_key, e
 int eth_recover_public_key(const eth_signature_t *signature, const eth_hash_t *msg_hash, 
                           uint8_t recovery_id, eth_public_key_t *public_key);
 
+/**
+ * @brief Compute the public key of a private key
+ * 
+ * @param private_key Private key (32 bytes, must be in [1, n - 1])
+ * @param public_key Output public key (64 bytes: x and y coordinates concatenated)
+ * @return 0 on success, non-zero on error
+ */
+int eth_private_key_to_public_key(const eth_private_key_t *private_key, eth_public_key_t *public_key);
+
 /**
  * @brief Derive Ethereum address from public key
  * 
@@ -0,0 +1,401 @@
+#ifndef ETH_EMBEDDED_EC_H
+#define ETH_EMBEDDED_EC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+
+/*
+ * secp256k1 arithmetic: field elements mod p, scalars mod n, and points in
+ * affine (eth_ge_t) and Jacobian (eth_gej_t) coordinates.
+ *
+ * Values are kept as eight 32-bit limbs, least significant first, and are
+ * always fully reduced, so equality is limb equality. 32-bit limbs need
+ * only a 32x32->64 multiply, which every target we build for has; on 64-bit
+ * hosts eth_fe_mul and eth_fe_sqr switch at runtime to kernels on 64-bit
+ * limbs (see cpu.h).
+ *
+ * Functions ending in _var take time that depends on their inputs and must
+ * only see public data (public keys, public tweaks). The others do not
+ * branch on or index memory by secret values.
+ */
+
+/* Field element mod p = 2^256 - 2^32 - 977 */
+typedef struct {
+    uint32_t n[8];
+} eth_fe_t;
+
+/* Scalar mod the group order n */
+typedef struct {
+    uint32_t n[8];
+} eth_scalar_t;
+
+/* Point in affine coordinates */
+typedef struct {
+    eth_fe_t x;
+    eth_fe_t y;
+    int infinity;        /* Non-zero for the point at infinity */
+} eth_ge_t;
+
+/* Point in Jacobian coordinates: (x / z^2, y / z^3) */
+typedef struct {
+    eth_fe_t x;
+    eth_fe_t y;
+    eth_fe_t z;
+    int infinity;        /* Non-zero for the point at infinity */
+} eth_gej_t;
+
+/* Affine point as stored in tables (never infinity) */
+typedef struct {
+    eth_fe_t x;
+    eth_fe_t y;
+} eth_ge_storage_t;
+
+/*
+ * Fixed-base table of a point P with b-bit windows: window w holds
+ * j * 2^(b * w) * P for j = 1..2^b - 1, so k * P is the sum of one entry per
+ * b-bit digit of k, with no doublings at all.
+ */
+#define ETH_EC_TABLE_WINDOWS_FOR(bits) ((256 + (bits) - 1) / (bits))
+#define ETH_EC_TABLE_ENTRIES_FOR(bits) ((1 << (bits)) - 1)
+#define ETH_EC_TABLE_SIZE_FOR(bits)    (ETH_EC_TABLE_WINDOWS_FOR(bits) * ETH_EC_TABLE_ENTRIES_FOR(bits))
+
+/* Tables built at run time (per-key verification tables) use 4-bit windows */
+#define ETH_EC_TABLE_BITS    4
+#define ETH_EC_TABLE_WINDOWS ETH_EC_TABLE_WINDOWS_FOR(ETH_EC_TABLE_BITS)
+#define ETH_EC_TABLE_ENTRIES ETH_EC_TABLE_ENTRIES_FOR(ETH_EC_TABLE_BITS)
+#define ETH_EC_TABLE_SIZE    ETH_EC_TABLE_SIZE_FOR(ETH_EC_TABLE_BITS)   /* Entries per table (60 KB) */
+
+/*
+ * The generator's table is generated at build time (tools/gen_ec_table.c)
+ * and linked into .rodata, so no process builds it and every process shares
+ * the same pages. Its window width is a build option: 2 bits (24 KB), 4 bits
+ * (60 KB), 6 bits (169 KB) or 8 bits (510 KB). Wider windows mean fewer
+ * point additions per k * G but more entries to scan in constant time.
+ */
+#ifndef ETH_EC_GEN_TABLE_BITS
+#define ETH_EC_GEN_TABLE_BITS 4
+#endif
+
+/*
+ * Field multiplication on 64-bit limbs (64x64->128 products) where the
+ * compiler has them; 0 keeps the portable 32-bit limbs, which is what a
+ * 32-bit target runs anyway
+ */
+#ifndef ETH_EC_LIMB64
+#define ETH_EC_LIMB64 1
+#endif
+
+/* Field */
+
+/**
+ * @brief Set a field element from 32 big-endian bytes
+ *
+ * @param r Output element
+ * @param bytes Big-endian bytes
+ * @return 0 on success, non-zero if the value is not below p
+ */
+int eth_fe_set_bytes(eth_fe_t *r, const uint8_t bytes[32]);
+
+/**
+ * @brief Write a field element as 32 big-endian bytes
+ *
+ * @param bytes Output bytes
+ * @param a Element
+ */
+void eth_fe_get_bytes(uint8_t bytes[32], const eth_fe_t *a);
+
+/**
+ * @brief Set a field element from a small integer
+ *
+ * @param r Output element
+ * @param value Integer
+ */
+void eth_fe_set_u32(eth_fe_t *r, uint32_t value);
+
+/**
+ * @brief Test for zero
+ *
+ * @param a Element
+ * @return Non-zero if a is zero
+ */
+int eth_fe_is_zero(const eth_fe_t *a);
+
+/**
+ * @brief Test the low bit (the parity used by compressed keys)
+ *
+ * @param a Element
+ * @return 1 if a is odd, 0 if even
+ */
+int eth_fe_is_odd(const eth_fe_t *a);
+
+/**
+ * @brief Test for equality
+ *
+ * @param a First element
+ * @param b Second element
+ * @return Non-zero if a equals b
+ */
+int eth_fe_equal(const eth_fe_t *a, const eth_fe_t *b);
+
+/**
+ * @brief r = a + b
+ */
+void eth_fe_add(eth_fe_t *r, const eth_fe_t *a, const eth_fe_t *b);
+
+/**
+ * @brief r = a - b
+ */
+void eth_fe_sub(eth_fe_t *r, const eth_fe_t *a, const eth_fe_t *b);
+
+/**
+ * @brief r = -a
+ */
+void eth_fe_neg(eth_fe_t *r, const eth_fe_t *a);
+
+/**
+ * @brief r = a * b (r may alias a or b)
+ */
+void eth_fe_mul(eth_fe_t *r, const eth_fe_t *a, const eth_fe_t *b);
+
+/**
+ * @brief r = a^2 (r may alias a)
+ */
+void eth_fe_sqr(eth_fe_t *r, const eth_fe_t *a);
+
+/**
+ * @brief Name of the multiply/square kernels selected for this CPU ("int128" or "portable")
+ *
+ * @return Kernel name
+ */
+const char *eth_fe_backend(void);
+
+/**
+ * @brief r = 1 / a (r = 0 for a = 0)
+ */
+void eth_fe_inv(eth_fe_t *r, const eth_fe_t *a);
+
+/**
+ * @brief r = a^((p + 1) / 4), a square root of a if there is one
+ *
+ * @param r Output element (the root, or garbage if there is none)
+ * @param a Element
+ * @return 0 if a is a square, non-zero otherwise
+ */
+int eth_fe_sqrt(eth_fe_t *r, const eth_fe_t *a);
+
+/**
+ * @brief Invert many elements with a single inversion
+ *
+ * @param r Output elements (must not overlap a)
+ * @param a Elements to invert (all non-zero)
+ * @param count Number of elements
+ */
+void eth_fe_inv_all_var(eth_fe_t *r, const eth_fe_t *a, size_t count);
+
+/* Scalars */
+
+/**
+ * @brief Set a scalar from 32 big-endian bytes, reducing mod n
+ *
+ * @param r Output scalar
+ * @param bytes Big-endian bytes
+ * @return Non-zero if the value was not below n (and was reduced)
+ */
+int eth_scalar_set_bytes(eth_scalar_t *r, const uint8_t bytes[32]);
+
+/**
+ * @brief Write a scalar as 32 big-endian bytes
+ *
+ * @param bytes Output bytes
+ * @param a Scalar
+ */
+void eth_scalar_get_bytes(uint8_t bytes[32], const eth_scalar_t *a);
+
+/**
+ * @brief Test for zero
+ *
+ * @param a Scalar
+ * @return Non-zero if a is zero
+ */
+int eth_scalar_is_zero(const eth_scalar_t *a);
+
+/**
+ * @brief Test whether a scalar is above (n - 1) / 2
+ *
+ * @param a Scalar
+ * @return 1 if a is in the high half, 0 otherwise
+ */
+int eth_scalar_is_high(const eth_scalar_t *a);
+
+/**
+ * @brief r = a + b mod n
+ */
+void eth_scalar_add(eth_scalar_t *r, const eth_scalar_t *a, const eth_scalar_t *b);
+
+/**
+ * @brief r = -a mod n (r may alias a)
+ */
+void eth_scalar_negate(eth_scalar_t *r, const eth_scalar_t *a);
+
+/**
+ * @brief r = a * b mod n (r may alias a or b)
+ */
+void eth_scalar_mul(eth_scalar_t *r, const eth_scalar_t *a, const eth_scalar_t *b);
+
+/**
+ * @brief r = 1 / a mod n (r = 0 for a = 0)
+ */
+void eth_scalar_inv(eth_scalar_t *r, const eth_scalar_t *a);
+
+/**
+ * @brief Invert many scalars with a single inversion, in constant time
+ *
+ * @param r Output scalars (must not overlap a)
+ * @param a Scalars to invert (all non-zero)
+ * @param count Number of scalars
+ */
+void eth_scalar_inv_all(eth_scalar_t *r, const eth_scalar_t *a, size_t count);
+
+/* Points */
+
+/**
+ * @brief Set an affine point from a 64-byte public key (x || y)
+ *
+ * @param r Output point
+ * @param public_key Public key
+ * @return 0 on success, non-zero if the key is not a point on the curve
+ */
+int eth_ge_set_public_key(eth_ge_t *r, const eth_public_key_t *public_key);
+
+/**
+ * @brief Write an affine point as a 64-byte public key (x || y)
+ *
+ * @param public_key Output public key
+ * @param a Point (not infinity)
+ */
+void eth_ge_get_public_key(eth_public_key_t *public_key, const eth_ge_t *a);
+
+/**
+ * @brief r = G, the generator
+ *
+ * @param r Output point
+ */
+void eth_ge_set_generator(eth_ge_t *r);
+
+/**
+ * @brief Set an affine point from x and the parity of y
+ *
+ * @param r Output point
+ * @param x x coordinate
+ * @param odd Non-zero for the point with odd y
+ * @return 0 on success, non-zero if no point has this x
+ */
+int eth_ge_set_xo(eth_ge_t *r, const eth_fe_t *x, int odd);
+
+/**
+ * @brief Test whether an affine point lies on the curve
+ *
+ * @param a Point
+ * @return Non-zero if y^2 = x^3 + 7 (infinity is not valid)
+ */
+int eth_ge_is_valid(const eth_ge_t *a);
+
+/**
+ * @brief Convert affine to Jacobian
+ */
+void eth_gej_set_ge(eth_gej_t *r, const eth_ge_t *a);
+
+/**
+ * @brief Convert Jacobian to affine (one inversion)
+ */
+void eth_ge_set_gej(eth_ge_t *r, const eth_gej_t *a);
+
+/**
+ * @brief Convert many Jacobian points to affine with a single inversion
+ *
+ * @param r Output points (must not overlap a)
+ * @param a Points to convert
+ * @param count Number of points
+ */
+void eth_ge_set_all_gej_var(eth_ge_t *r, const eth_gej_t *a, size_t count);
+
+/**
+ * @brief r = 2a (r may alias a)
+ */
+void eth_gej_double(eth_gej_t *r, const eth_gej_t *a);
+
+/**
+ * @brief r = a + b for a Jacobian a and an affine b (r may alias a)
+ */
+void eth_gej_add_ge_var(eth_gej_t *r, const eth_gej_t *a, const eth_ge_t *b);
+
+/**
+ * @brief Test whether the affine x of a Jacobian point, reduced mod n, equals r (the ECDSA check)
+ *
+ * @param a Point
+ * @param r Scalar
+ * @return Non-zero if a is finite and x mod n == r
+ */
+int eth_gej_x_mod_n_equals_var(const eth_gej_t *a, const eth_scalar_t *r);
+
+/**
+ * @brief Build the fixed-base table of a point (ETH_EC_TABLE_BITS-bit windows)
+ *
+ * @param table Output table (ETH_EC_TABLE_SIZE entries)
+ * @param point Point (not infinity)
+ */
+void eth_ec_table_build(eth_ge_storage_t *table, const eth_ge_t *point);
+
+/**
+ * @brief Build the fixed-base table of a point with any window width
+ *
+ * @param table Output table (ETH_EC_TABLE_SIZE_FOR(bits) entries)
+ * @param point Point (not infinity)
+ * @param bits Window width, 1 to 8
+ */
+void eth_ec_table_build_bits(eth_ge_storage_t *table, const eth_ge_t *point, unsigned bits);
+
+/**
+ * @brief r += k * P for the point P of a fixed-base table (ETH_EC_TABLE_BITS-bit windows)
+ *
+ * @param r Accumulator
+ * @param table Table of P
+ * @param k Scalar (public)
+ */
+void eth_ec_table_mul_add_var(eth_gej_t *r, const eth_ge_storage_t *table, const eth_scalar_t *k);
+
+/**
+ * @brief r += k * G for a public k
+ *
+ * @param r Accumulator
+ * @param k Scalar (public)
+ */
+void eth_ec_mul_gen_add_var(eth_gej_t *r, const eth_scalar_t *k);
+
+/**
+ * @brief r = k * G, in constant time
+ *
+ * @param r Output point
+ * @param k Scalar (secret)
+ */
+void eth_ec_mul_gen(eth_gej_t *r, const eth_scalar_t *k);
+
+/**
+ * @brief r = k * G for a public k
+ *
+ * @param r Output point
+ * @param k Scalar (public)
+ */
+void eth_ec_mul_gen_var(eth_gej_t *r, const eth_scalar_t *k);
+
+/**
+ * @brief r = k * a for any point, with 4-bit windows
+ *
+ * @param r Output point
+ * @param a Point
+ * @param k Scalar (public)
+ */
+void eth_ec_mul_var(eth_gej_t *r, const eth_ge_t *a, const eth_scalar_t *k);
+
+#endif /* ETH_EMBEDDED_EC_H */
@@ -0,0 +1,186 @@
+#ifndef ETH_EMBEDDED_EIP712_H
+#define ETH_EMBEDDED_EIP712_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+#include "u256.h"
+
+/*
+ * EIP-712 typed data hashing and signing.
+ *
+ * A schema is given in encodeType form, one or more struct definitions back
+ * to back (whitespace between them and around names is ignored):
+ *
+ *   Mail(Person from,Person to,string contents)
+ *   Person(string name,address wallet)
+ *
+ * Loading it compiles every struct once: field types are resolved to kinds
+ * and struct references, and each struct's typeHash is computed and kept.
+ * Domains keep their separator. Hashing an instance then only streams its
+ * fields through Keccak, 32 bytes at a time, without building encodeData.
+ *
+ * Field types: uint8..uint256, int8..int256, address, bool, bytes1..bytes32,
+ * bytes, string, struct names, and one level of array (T[] or T[n]) of any
+ * of these.
+ */
+
+/* Field kinds */
+typedef enum {
+    ETH_EIP712_UINT = 0,          /* uintN: number */
+    ETH_EIP712_INT = 1,           /* intN: number, two's complement over 256 bits */
+    ETH_EIP712_ADDRESS = 2,       /* address: data, 20 bytes */
+    ETH_EIP712_BOOL = 3,          /* bool: number, 0 or 1 */
+    ETH_EIP712_FIXED_BYTES = 4,   /* bytesN: data, N bytes */
+    ETH_EIP712_BYTES = 5,         /* bytes: data */
+    ETH_EIP712_STRING = 6,        /* string: data (UTF-8) */
+    ETH_EIP712_STRUCT = 7         /* struct: items, one per field */
+} eth_eip712_kind_t;
+
+/* Field array forms */
+#define ETH_EIP712_SCALAR         0   /* Not an array */
+#define ETH_EIP712_DYNAMIC_ARRAY  1   /* T[] */
+#define ETH_EIP712_FIXED_ARRAY    2   /* T[n] */
+
+struct eth_eip712_type;
+
+/* Compiled field */
+typedef struct {
+    const char *name;                          /* Field name (not NUL terminated) */
+    size_t name_length;                        /* Length of name */
+    const char *type_name;                     /* Type as written, e.g. "Person[]" (not NUL terminated) */
+    size_t type_name_length;                   /* Length of type_name */
+    eth_eip712_kind_t kind;                    /* Kind of the field or of its elements */
+    unsigned size;                             /* Bits of uintN/intN, bytes of bytesN */
+    unsigned array;                            /* ETH_EIP712_SCALAR, ..._DYNAMIC_ARRAY, ..._FIXED_ARRAY */
+    size_t array_length;                       /* Element count of a fixed array */
+    const struct eth_eip712_type *struct_type; /* Struct of ETH_EIP712_STRUCT fields */
+} eth_eip712_field_t;
+
+/* Compiled struct type */
+typedef struct eth_eip712_type {
+    const char *name;                          /* Struct name (not NUL terminated) */
+    size_t name_length;                        /* Length of name */
+    const eth_eip712_field_t *fields;          /* Fields in declaration order */
+    size_t field_count;                        /* Number of fields */
+    eth_hash_t type_hash;                      /* keccak256(encodeType) */
+} eth_eip712_type_t;
+
+/* Compiled schema */
+typedef struct {
+    char *text;                                /* Copy of the schema text the names point into */
+    eth_eip712_type_t *types;                  /* Struct types, sorted by name */
+    size_t type_count;                         /* Number of struct types */
+    eth_eip712_field_t *fields;                /* Fields of all types */
+    size_t error_offset;                       /* Offset in the text of the last load error */
+} eth_eip712_schema_t;
+
+/*
+ * Value of a field, array element or struct. Which members are used depends
+ * on the kind (see eth_eip712_kind_t); an array uses items/count for its
+ * elements, each one a value of the element kind.
+ */
+typedef struct eth_eip712_value {
+    eth_u256_t number;                         /* uintN, intN, bool */
+    const uint8_t *data;                       /* address, bytesN, bytes, string */
+    size_t length;                             /* Length of data */
+    const struct eth_eip712_value *items;      /* Struct fields or array elements */
+    size_t count;                              /* Number of items */
+} eth_eip712_value_t;
+
+/* Signing domain */
+typedef struct {
+    eth_hash_t separator;                      /* hashStruct(EIP712Domain instance) */
+} eth_eip712_domain_t;
+
+/**
+ * @brief Compile a schema
+ *
+ * @param schema Pointer to schema (release with eth_eip712_schema_free)
+ * @param text Struct definitions in encodeType form
+ * @param length Length of text
+ * @return 0 on success, non-zero on error (see error_offset)
+ */
+int eth_eip712_schema_load(eth_eip712_schema_t *schema, const char *text, size_t length);
+
+/**
+ * @brief Release a schema
+ *
+ * @param schema Pointer to schema
+ */
+void eth_eip712_schema_free(eth_eip712_schema_t *schema);
+
+/**
+ * @brief Find a struct type by name
+ *
+ * @param schema Compiled schema
+ * @param name Struct name (NUL terminated)
+ * @return Type, or NULL if the schema has no such struct
+ */
+const eth_eip712_type_t *eth_eip712_find_type(const eth_eip712_schema_t *schema, const char *name);
+
+/**
+ * @brief Set up the standard domain from the fields that are given
+ *
+ * EIP712Domain gets a field for every argument that is set (non-NULL, or a
+ * non-zero chain id), in the order of the standard.
+ *
+ * @param domain Pointer to domain
+ * @param name Domain name (optional)
+ * @param version Domain version (optional)
+ * @param chain_id Chain id (0 leaves it out)
+ * @param verifying_contract 20-byte contract address (optional)
+ * @param salt 32-byte salt (optional)
+ * @return 0 on success, non-zero on error
+ */
+int eth_eip712_domain_init(eth_eip712_domain_t *domain, const char *name, const char *version,
+                           uint64_t chain_id, const uint8_t *verifying_contract, const uint8_t *salt);
+
+/**
+ * @brief Set up a domain from an EIP712Domain struct of a schema
+ *
+ * @param domain Pointer to domain
+ * @param type Compiled EIP712Domain type
+ * @param value Domain instance
+ * @return 0 on success, non-zero on error
+ */
+int eth_eip712_domain_init_struct(eth_eip712_domain_t *domain, const eth_eip712_type_t *type,
+                                  const eth_eip712_value_t *value);
+
+/**
+ * @brief hashStruct of an instance
+ *
+ * @param type Compiled struct type
+ * @param value Instance (items holds one value per field)
+ * @param hash Output hash
+ * @return 0 on success, non-zero on error (including values that do not fit their type)
+ */
+int eth_eip712_hash_struct(const eth_eip712_type_t *type, const eth_eip712_value_t *value, eth_hash_t *hash);
+
+/**
+ * @brief Digest to sign: keccak256(0x19 0x01 || domain separator || hashStruct(message))
+ *
+ * @param domain Signing domain
+ * @param type Compiled message type
+ * @param message Message instance
+ * @param digest Output digest
+ * @return 0 on success, non-zero on error
+ */
+int eth_eip712_hash(const eth_eip712_domain_t *domain, const eth_eip712_type_t *type,
+                    const eth_eip712_value_t *message, eth_hash_t *digest);
+
+/**
+ * @brief Sign typed data (the digest of eth_eip712_hash, signed with eth_sign)
+ *
+ * @param domain Signing domain
+ * @param type Compiled message type
+ * @param message Message instance
+ * @param private_key Private key to sign with
+ * @param signature Output signature
+ * @return 0 on success, non-zero on error
+ */
+int eth_eip712_sign(const eth_eip712_domain_t *domain, const eth_eip712_type_t *type,
+                    const eth_eip712_value_t *message, const eth_private_key_t *private_key,
+                    eth_signature_t *signature);
+
+#endif /* ETH_EMBEDDED_EIP712_H */
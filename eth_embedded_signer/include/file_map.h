@@ -0,0 +1,48 @@
+#ifndef ETH_EMBEDDED_FILE_MAP_H
+#define ETH_EMBEDDED_FILE_MAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Access pattern hints */
+#define ETH_FILE_MAP_SEQUENTIAL 0x01  /* Read front to back once (aggressive readahead) */
+#define ETH_FILE_MAP_NO_READ    0x02  /* Fail instead of reading a file that cannot be mapped into the heap */
+
+/* Read-only view of a whole file */
+typedef struct {
+    const uint8_t *data;  /* File contents (NULL for an empty file) */
+    size_t size;          /* File size in bytes */
+    int mapped;           /* 1 if data is a memory mapping, 0 if it was read into the heap */
+} eth_file_map_t;
+
+/**
+ * @brief Size of a file, for readers that need it before the contents
+ *
+ * @param path Path of the file
+ * @param size Output size in bytes
+ * @return 0 on success, non-zero on error (including pipes, devices and
+ *         other files whose size is unknown)
+ */
+int eth_file_size(const char *path, uint64_t *size);
+
+/**
+ * @brief Map a file read-only (falls back to reading it where mmap is unavailable)
+ *
+ * Only regular files are mapped; pipes, devices and files whose size is
+ * unknown (such as most of /proc) are an error rather than an empty map.
+ *
+ * @param map Pointer to file map
+ * @param path Path of the file
+ * @param flags Access pattern hints (ETH_FILE_MAP_*)
+ * @return 0 on success, non-zero on error
+ */
+int eth_file_map_open(eth_file_map_t *map, const char *path, int flags);
+
+/**
+ * @brief Unmap a file
+ *
+ * @param map Pointer to file map
+ */
+void eth_file_map_close(eth_file_map_t *map);
+
+#endif /* ETH_EMBEDDED_FILE_MAP_H */
@@ -0,0 +1,167 @@
+#ifndef ETH_EMBEDDED_HD_H
+#define ETH_EMBEDDED_HD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+#include "ec.h"
+#include "sha512.h"
+
+/*
+ * BIP-32 hierarchical deterministic keys, with BIP-44 paths such as
+ * m/44'/60'/0'/0/i.
+ *
+ * Deposit addresses are the non-hardened children of one account node,
+ * often millions of them. eth_hd_parent_t holds everything those children
+ * share (the HMAC keyed with the parent chain code, the compressed parent
+ * key and the parent point), so each child costs two SHA-512 blocks, one
+ * fixed-base multiply and one point addition. Consecutive children are
+ * converted to affine together, sharing a single field inversion per batch.
+ */
+
+/* Indexes at or above this are hardened (written i' in paths) */
+#define ETH_HD_HARDENED 0x80000000u
+
+/* Deepest path handled */
+#define ETH_HD_MAX_DEPTH 16
+
+/* Soft result: some indexes in a range have no valid child; their outputs are zeroed */
+#define ETH_HD_SKIPPED 1
+
+/* Extended key */
+typedef struct {
+    uint8_t chain_code[32];
+    eth_private_key_t private_key;   /* Only meaningful when has_private */
+    eth_public_key_t public_key;
+    uint8_t compressed[33];          /* serP(K): hashed into every non-hardened child */
+    int has_private;
+    uint8_t depth;
+    uint32_t child_number;
+} eth_hd_node_t;
+
+/* Extended keys along the most recently derived path */
+typedef struct {
+    eth_hd_node_t nodes[ETH_HD_MAX_DEPTH + 1];   /* nodes[0] is the root */
+    uint32_t path[ETH_HD_MAX_DEPTH];             /* Index leading to each level */
+    size_t depth;                                /* Levels currently cached */
+} eth_hd_cache_t;
+
+/* Shared state for deriving many non-hardened children of one node */
+typedef struct {
+    eth_hmac_sha512_ctx_t hmac;      /* Keyed with the parent chain code */
+    uint8_t compressed[33];          /* serP(K_par) */
+    eth_ge_t point;                  /* K_par */
+} eth_hd_parent_t;
+
+/**
+ * @brief Master node from a seed
+ *
+ * @param node Output node
+ * @param seed Seed bytes (16 to 64 bytes)
+ * @param length Seed length
+ * @return 0 on success, non-zero on error
+ */
+int eth_hd_node_from_seed(eth_hd_node_t *node, const uint8_t *seed, size_t length);
+
+/**
+ * @brief Public-only node from a public key and chain code (an account xpub)
+ *
+ * @param node Output node
+ * @param public_key Public key
+ * @param chain_code Chain code (32 bytes)
+ * @return 0 on success, non-zero on error
+ */
+int eth_hd_node_from_public(eth_hd_node_t *node, const eth_public_key_t *public_key,
+                            const uint8_t chain_code[32]);
+
+/**
+ * @brief Derive one child (CKDpriv when the parent has a private key, CKDpub otherwise)
+ *
+ * @param parent Parent node
+ * @param index Child index (hardened indexes need a private parent)
+ * @param child Output node (may not alias parent)
+ * @return 0 on success, non-zero on error (including the rare invalid child)
+ */
+int eth_hd_node_derive(const eth_hd_node_t *parent, uint32_t index, eth_hd_node_t *child);
+
+/**
+ * @brief Drop the private key of a node
+ *
+ * @param node Pointer to node
+ */
+void eth_hd_node_neuter(eth_hd_node_t *node);
+
+/**
+ * @brief Parse a path such as m/44'/60'/0'/0 (' or h marks hardened)
+ *
+ * @param text Path text
+ * @param path Output indexes
+ * @param max Capacity of path
+ * @param depth Output number of indexes
+ * @return 0 on success, non-zero on error
+ */
+int eth_hd_parse_path(const char *text, uint32_t *path, size_t max, size_t *depth);
+
+/**
+ * @brief Start a cache at a root node
+ *
+ * @param cache Pointer to cache
+ * @param root Root node
+ */
+void eth_hd_cache_init(eth_hd_cache_t *cache, const eth_hd_node_t *root);
+
+/**
+ * @brief Derive a path, reusing the levels it shares with the previous one
+ *
+ * @param cache Pointer to cache
+ * @param path Indexes from the root
+ * @param depth Number of indexes
+ * @param node Output: the node at the end of the path (owned by the cache)
+ * @return 0 on success, non-zero on error
+ */
+int eth_hd_cache_derive(eth_hd_cache_t *cache, const uint32_t *path, size_t depth, const eth_hd_node_t **node);
+
+/**
+ * @brief Parse and derive a path through the cache
+ *
+ * @param cache Pointer to cache
+ * @param text Path text
+ * @param node Output: the node at the end of the path (owned by the cache)
+ * @return 0 on success, non-zero on error
+ */
+int eth_hd_cache_derive_path(eth_hd_cache_t *cache, const char *text, const eth_hd_node_t **node);
+
+/**
+ * @brief Wipe a cache (private keys included)
+ *
+ * @param cache Pointer to cache
+ */
+void eth_hd_cache_wipe(eth_hd_cache_t *cache);
+
+/**
+ * @brief Prepare a node for bulk non-hardened derivation
+ *
+ * @param parent Output parent state
+ * @param node Parent node (only its public half is used)
+ * @return 0 on success, non-zero on error
+ */
+int eth_hd_parent_init(eth_hd_parent_t *parent, const eth_hd_node_t *node);
+
+/**
+ * @brief Public keys and/or addresses of the children [start, end)
+ *
+ * Output i belongs to child start + i. Work is handed out to the threads
+ * in batches of consecutive indexes.
+ *
+ * @param parent Parent state
+ * @param start First index
+ * @param end One past the last index (at most ETH_HD_HARDENED)
+ * @param threads Threads to use (0 means 1)
+ * @param public_keys Output public keys (optional)
+ * @param addresses Output addresses (optional)
+ * @return 0 on success, ETH_HD_SKIPPED if some children were invalid, negative on error
+ */
+int eth_hd_derive_range(const eth_hd_parent_t *parent, uint32_t start, uint32_t end, unsigned threads,
+                        eth_public_key_t *public_keys, eth_address_t *addresses);
+
+#endif /* ETH_EMBEDDED_HD_H */
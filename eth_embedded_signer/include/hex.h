@@ -0,0 +1,47 @@
+#ifndef ETH_EMBEDDED_HEX_H
+#define ETH_EMBEDDED_HEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Hex encoding and decoding for raw transactions, keys and hashes.
+ *
+ * On x86 the SSSE3/AVX2 kernels are picked at runtime from what the CPU
+ * supports, with a table-driven scalar fallback everywhere else.
+ */
+
+/**
+ * @brief Encode bytes as lowercase hex (no 0x prefix, no terminator)
+ *
+ * @param data Input bytes
+ * @param length Number of input bytes
+ * @param output Output characters (2 * length)
+ * @param output_size Size of output buffer
+ * @return 0 on success, non-zero on error
+ */
+int eth_hex_encode(const uint8_t *data, size_t length, char *output, size_t output_size);
+
+/**
+ * @brief Decode hex to bytes
+ *
+ * Accepts an optional 0x/0X prefix and either letter case. The number of
+ * digits has to be even and every character has to be a hex digit.
+ *
+ * @param input Input characters
+ * @param input_len Number of input characters
+ * @param output Output bytes
+ * @param output_size Size of output buffer
+ * @param output_len Pointer to variable to store the number of decoded bytes
+ * @return 0 on success, non-zero on error (invalid digit, odd length, buffer too small)
+ */
+int eth_hex_decode(const char *input, size_t input_len, uint8_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief Name of the kernel selected for this CPU ("avx2", "ssse3" or "scalar")
+ *
+ * @return Kernel name
+ */
+const char *eth_hex_backend(void);
+
+#endif /* ETH_EMBEDDED_HEX_H */
@@ -0,0 +1,55 @@
+#ifndef ETH_EMBEDDED_KECCAK_H
+#define ETH_EMBEDDED_KECCAK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Keccak-256 as used by Ethereum (original Keccak padding 0x01, not the
+ * SHA-3 0x06). Portable 64-bit implementation with an incremental API, so
+ * input can be absorbed in pieces without building one contiguous buffer.
+ * On x86 with BMI2 the same permutation is compiled with andn/rorx and
+ * picked at runtime (see cpu.h).
+ */
+
+/* Rate of Keccak-256 in bytes */
+#define ETH_KECCAK256_RATE 136
+
+/* Incremental hashing context */
+typedef struct {
+    uint64_t state[25];     /* Keccak-f[1600] state */
+    size_t offset;          /* Bytes absorbed into the current block */
+} eth_keccak_ctx_t;
+
+/**
+ * @brief Start a Keccak-256 computation
+ *
+ * @param ctx Pointer to context
+ */
+void eth_keccak256_init(eth_keccak_ctx_t *ctx);
+
+/**
+ * @brief Absorb more input
+ *
+ * @param ctx Pointer to context
+ * @param input Input data
+ * @param length Length of input data
+ */
+void eth_keccak256_update(eth_keccak_ctx_t *ctx, const uint8_t *input, size_t length);
+
+/**
+ * @brief Finish and write the 32-byte digest (the context must be re-initialised to reuse it)
+ *
+ * @param ctx Pointer to context
+ * @param output Output digest
+ */
+void eth_keccak256_final(eth_keccak_ctx_t *ctx, uint8_t output[32]);
+
+/**
+ * @brief Name of the permutation kernel selected for this CPU ("bmi2" or "scalar")
+ *
+ * @return Kernel name
+ */
+const char *eth_keccak_backend(void);
+
+#endif /* ETH_EMBEDDED_KECCAK_H */
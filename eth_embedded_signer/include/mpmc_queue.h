@@ -0,0 +1,106 @@
+#ifndef ETH_EMBEDDED_MPMC_QUEUE_H
+#define ETH_EMBEDDED_MPMC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/*
+ * Bounded lock-free multi-producer/multi-consumer queue of pointers.
+ * Each cell carries a sequence number so producers and consumers only
+ * contend on their own position counter (D. Vyukov's bounded queue).
+ *
+ * Consumers that find the queue empty for longer than a short spin park on
+ * a condition variable (eth_mpmc_queue_pop_wait) and every push wakes one
+ * of them, so idle workers sleep until there is work instead of polling.
+ */
+
+/* Backoff calls that spin or yield before a waiter sleeps or parks */
+#define ETH_MPMC_SPIN_LIMIT 1024
+
+/* Queue cell */
+typedef struct {
+    atomic_size_t sequence;   /* Turn counter for this cell */
+    void *item;               /* Stored pointer */
+} eth_mpmc_cell_t;
+
+/* Queue context */
+typedef struct {
+    eth_mpmc_cell_t *cells;   /* Ring of cells (capacity is a power of two) */
+    size_t mask;              /* capacity - 1 */
+    _Alignas(64) atomic_size_t enqueue_pos;  /* Next position to write (own cache line) */
+    _Alignas(64) atomic_size_t dequeue_pos;  /* Next position to read (own cache line) */
+    _Alignas(64) atomic_uint epoch;          /* Bumped by every push, so parked consumers see new work */
+    atomic_uint parked;                      /* Consumers about to park or parked */
+    pthread_mutex_t park_lock;
+    pthread_cond_t park_wake;
+} eth_mpmc_queue_t;
+
+/**
+ * @brief Initialise a queue
+ *
+ * @param queue Pointer to queue context
+ * @param capacity Number of cells, rounded up to a power of two
+ * @return 0 on success, non-zero on error
+ */
+int eth_mpmc_queue_init(eth_mpmc_queue_t *queue, size_t capacity);
+
+/**
+ * @brief Release the memory held by a queue
+ *
+ * @param queue Pointer to queue context
+ */
+void eth_mpmc_queue_free(eth_mpmc_queue_t *queue);
+
+/**
+ * @brief Push an item without blocking
+ *
+ * @param queue Pointer to queue context
+ * @param item Pointer to store (may not be NULL)
+ * @return 0 on success, non-zero if the queue is full
+ */
+int eth_mpmc_queue_push(eth_mpmc_queue_t *queue, void *item);
+
+/**
+ * @brief Pop an item without blocking
+ *
+ * @param queue Pointer to queue context
+ * @param item Output for the popped pointer
+ * @return 0 on success, non-zero if the queue is empty
+ */
+int eth_mpmc_queue_pop(eth_mpmc_queue_t *queue, void **item);
+
+/**
+ * @brief Pop an item, parking the calling thread while the queue stays empty
+ *
+ * @param queue Pointer to queue context
+ * @param stop Flag that ends the wait once set (optional; set it, then call eth_mpmc_queue_wake_all)
+ * @param item Output for the popped pointer
+ * @return 0 on success, non-zero if stop was set and the queue is empty
+ */
+int eth_mpmc_queue_pop_wait(eth_mpmc_queue_t *queue, const atomic_int *stop, void **item);
+
+/**
+ * @brief Wake every consumer parked in eth_mpmc_queue_pop_wait (e.g. to stop them)
+ *
+ * @param queue Pointer to queue context
+ */
+void eth_mpmc_queue_wake_all(eth_mpmc_queue_t *queue);
+
+/**
+ * @brief Get the queue capacity
+ *
+ * @param queue Pointer to queue context
+ * @return Number of cells
+ */
+size_t eth_mpmc_queue_capacity(const eth_mpmc_queue_t *queue);
+
+/**
+ * @brief Back off while waiting on a queue (spin, then yield, then sleep)
+ *
+ * @param spins Caller-held counter, start at 0 for every new wait
+ */
+void eth_mpmc_backoff(unsigned *spins);
+
+#endif /* ETH_EMBEDDED_MPMC_QUEUE_H */
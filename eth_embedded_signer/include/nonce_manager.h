@@ -0,0 +1,148 @@
+#ifndef ETH_EMBEDDED_NONCE_MANAGER_H
+#define ETH_EMBEDDED_NONCE_MANAGER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "crypto.h"
+
+/*
+ * Lock-free per-address nonce allocator.
+ *
+ * Open-addressing hash map from sender address to an atomic nonce counter.
+ * Threads signing for the same account reserve nonces with a single atomic
+ * operation instead of a global mutex. Nonces whose broadcast failed are
+ * released into a small per-address gap list and handed out again (lowest
+ * first) before any fresh nonce, so the account does not stall on a hole.
+ *
+ * If the gap list is full when a nonce is released, the address is marked
+ * for resync: the nonce would otherwise be lost and leave a permanent hole,
+ * so reservations for it fail until eth_nonce_set reloads the account state.
+ */
+
+/* Number of released nonces each address can hold for reuse */
+#define ETH_NONCE_GAP_SLOTS 8
+
+/* Per-address entry */
+typedef struct {
+    atomic_uint state;                              /* Empty, being inserted, or ready */
+    atomic_uint resync;                             /* Set when a released nonce did not fit */
+    atomic_flag ticket_lock;                        /* Held while a ticket is taken with a nonce */
+    eth_address_t address;                          /* Sender address (key) */
+    atomic_uint_fast64_t next;                      /* Next fresh nonce */
+    atomic_uint_fast64_t committed;                 /* Highest committed nonce + 1 */
+    atomic_uint_fast64_t gaps[ETH_NONCE_GAP_SLOTS]; /* Released nonces + 1 (0 = free slot) */
+} eth_nonce_entry_t;
+
+/* Nonce manager context */
+typedef struct {
+    eth_nonce_entry_t *entries;   /* Table (capacity is a power of two) */
+    size_t mask;                  /* capacity - 1 */
+} eth_nonce_manager_t;
+
+/**
+ * @brief Initialise a nonce manager
+ *
+ * The table does not grow, size it for the number of sender addresses.
+ *
+ * @param manager Pointer to nonce manager
+ * @param capacity Maximum number of addresses (rounded up to a power of two)
+ * @return 0 on success, non-zero on error
+ */
+int eth_nonce_manager_init(eth_nonce_manager_t *manager, size_t capacity);
+
+/**
+ * @brief Release the memory held by a nonce manager
+ *
+ * @param manager Pointer to nonce manager
+ */
+void eth_nonce_manager_free(eth_nonce_manager_t *manager);
+
+/**
+ * @brief Set the next nonce of an address (e.g. from eth_getTransactionCount)
+ *
+ * Clears any released nonces and the resync mark. Not meant to race with
+ * reserve for the same address.
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @param next_nonce Next nonce to hand out
+ * @return 0 on success, non-zero on error
+ */
+int eth_nonce_set(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t next_nonce);
+
+/**
+ * @brief Reserve a nonce for an address
+ *
+ * Returns the lowest released nonce if there is one, otherwise the next fresh one.
+ * Unknown addresses start at nonce 0.
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @param nonce Output nonce
+ * @return 0 on success, non-zero on error (e.g. table full, or the address needs a resync)
+ */
+int eth_nonce_reserve(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t *nonce);
+
+/**
+ * @brief Reserve a nonce and take the next value of a shared counter in one step
+ *
+ * Callers reserving for the same address are ordered by a per-address flag
+ * (other addresses never wait on it), so the tickets one address gets rise
+ * with its fresh nonces. The pipeline passes its sequence counter, which
+ * makes nonce order match emit order without a lock around every submit.
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @param counter Counter to take the ticket from (fetch-and-increment)
+ * @param nonce Output nonce
+ * @param ticket Output counter value
+ * @return 0 on success, non-zero on error (no ticket is taken)
+ */
+int eth_nonce_reserve_ticket(eth_nonce_manager_t *manager, const eth_address_t *address,
+                             atomic_uint_fast64_t *counter, uint64_t *nonce, uint64_t *ticket);
+
+/**
+ * @brief Mark a reserved nonce as used (its transaction was broadcast)
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @param nonce Nonce that was used
+ * @return 0 on success, non-zero on error
+ */
+int eth_nonce_commit(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t nonce);
+
+/**
+ * @brief Give back a reserved nonce whose transaction was never broadcast
+ *
+ * Fails once ETH_NONCE_GAP_SLOTS released nonces are waiting for reuse. The
+ * address is then marked for resync (see eth_nonce_needs_resync) and its
+ * reservations fail until eth_nonce_set is called for it.
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @param nonce Nonce to release
+ * @return 0 on success, non-zero on error (e.g. gap list full)
+ */
+int eth_nonce_release(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t nonce);
+
+/**
+ * @brief Get the highest committed nonce + 1 for an address
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @param committed Output watermark (0 if nothing was committed)
+ * @return 0 on success, non-zero if the address is unknown
+ */
+int eth_nonce_committed(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t *committed);
+
+/**
+ * @brief Check whether an address lost a released nonce and must be resynced
+ *
+ * @param manager Pointer to nonce manager
+ * @param address Sender address
+ * @return 1 if eth_nonce_set has to be called for the address, 0 otherwise
+ */
+int eth_nonce_needs_resync(eth_nonce_manager_t *manager, const eth_address_t *address);
+
+#endif /* ETH_EMBEDDED_NONCE_MANAGER_H */
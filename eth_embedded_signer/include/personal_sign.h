@@ -0,0 +1,112 @@
+#ifndef ETH_EMBEDDED_PERSONAL_SIGN_H
+#define ETH_EMBEDDED_PERSONAL_SIGN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "crypto.h"
+#include "keccak.h"
+
+/*
+ * EIP-191 personal_sign: the signed hash is
+ *
+ *   keccak256("\x19Ethereum Signed Message:\n" || decimal length || message)
+ *
+ * The length comes first, so it has to be known before the message is read.
+ * Given that, the message is absorbed piece by piece and never held in
+ * memory as a whole: files are mapped and hashed in place, streams go
+ * through one fixed-size buffer.
+ */
+
+/* Bytes read at a time by eth_personal_sign_stream */
+#define ETH_PERSONAL_CHUNK_SIZE 4096
+
+/* Incremental personal_sign hash */
+typedef struct {
+    eth_keccak_ctx_t keccak;   /* Hash of the prefix and the message so far */
+    uint64_t remaining;        /* Message bytes still expected */
+} eth_personal_ctx_t;
+
+/**
+ * @brief Start hashing a message of known length (absorbs the prefix)
+ *
+ * @param ctx Pointer to context
+ * @param length Total message length
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_init(eth_personal_ctx_t *ctx, uint64_t length);
+
+/**
+ * @brief Absorb the next part of the message
+ *
+ * @param ctx Pointer to context
+ * @param data Message bytes
+ * @param length Number of bytes (may not run past the length given to init)
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_update(eth_personal_ctx_t *ctx, const uint8_t *data, size_t length);
+
+/**
+ * @brief Finish the hash (the whole message must have been absorbed)
+ *
+ * @param ctx Pointer to context
+ * @param hash Output hash
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_final(eth_personal_ctx_t *ctx, eth_hash_t *hash);
+
+/**
+ * @brief personal_sign hash of a message in memory
+ *
+ * @param message Message
+ * @param length Message length
+ * @param hash Output hash
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_hash(const uint8_t *message, size_t length, eth_hash_t *hash);
+
+/**
+ * @brief personal_sign a message in memory
+ *
+ * @param message Message
+ * @param length Message length
+ * @param private_key Private key to sign with
+ * @param signature Output signature
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_sign(const uint8_t *message, size_t length, const eth_private_key_t *private_key,
+                      eth_signature_t *signature);
+
+/**
+ * @brief personal_sign the next 'length' bytes of a stream
+ *
+ * Reads through a buffer of ETH_PERSONAL_CHUNK_SIZE bytes.
+ *
+ * @param stream Open stream positioned at the message
+ * @param length Message length (fails if the stream ends earlier)
+ * @param private_key Private key to sign with
+ * @param hash Output hash (optional)
+ * @param signature Output signature
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_sign_stream(FILE *stream, uint64_t length, const eth_private_key_t *private_key,
+                             eth_hash_t *hash, eth_signature_t *signature);
+
+/**
+ * @brief personal_sign the contents of a file
+ *
+ * The file is mapped with sequential readahead and hashed in place; where it
+ * cannot be mapped it is streamed instead. The prefix needs the length up
+ * front, so only regular files are signed: pipes, devices and /proc files
+ * are an error (use eth_personal_sign_stream with a known length).
+ *
+ * @param path Path of the file
+ * @param private_key Private key to sign with
+ * @param hash Output hash (optional)
+ * @param signature Output signature
+ * @return 0 on success, non-zero on error
+ */
+int eth_personal_sign_file(const char *path, const eth_private_key_t *private_key,
+                           eth_hash_t *hash, eth_signature_t *signature);
+
+#endif /* ETH_EMBEDDED_PERSONAL_SIGN_H */
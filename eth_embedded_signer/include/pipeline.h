@@ -0,0 +1,130 @@
+#ifndef ETH_EMBEDDED_PIPELINE_H
+#define ETH_EMBEDDED_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "crypto.h"
+#include "transaction.h"
+#include "mpmc_queue.h"
+#include "nonce_manager.h"
+#include "policy.h"
+
+/*
+ * Multi-stage signing pipeline.
+ *
+ *   submit -> [encode + sighash] -> [ECDSA sign] -> [encode signed + emit]
+ *
+ * Each stage runs its own pool of threads and the stages are connected by
+ * bounded lock-free queues. Jobs are emitted in submission order, so
+ * transactions from the same sender always come out in the order they went in.
+ *
+ * Jobs that carry a nonce manager get their nonce reserved at submit, so
+ * nonce order matches emit order. A job that fails inside the pipeline has its
+ * nonce released again before it is emitted. If the manager has no room left
+ * for it, nonce_status is set and the manager marks the sender for resync:
+ * its submits fail until eth_nonce_set is called, instead of signing past a
+ * nonce gap.
+ *
+ * Jobs that carry a policy are checked in the first stage and fail with
+ * ETH_POLICY_DENIED before any signing work is done.
+ */
+
+/* Signing job (owned by the caller until it has been emitted) */
+typedef struct {
+    eth_transaction_t *tx;                /* Transaction to sign (r, s, v get filled in) */
+    const eth_private_key_t *private_key; /* Key to sign with */
+    uint8_t *output;                      /* Buffer for the signed encoding */
+    size_t output_size;                   /* Size of output buffer */
+    size_t output_len;                    /* Length of signed encoding (set by the last stage) */
+    int status;                           /* 0 on success, error code of the failing stage otherwise */
+    void *user_data;                      /* Caller context, untouched by the pipeline */
+    eth_nonce_manager_t *nonces;          /* Optional: assign tx->nonce from this manager at submit */
+    const eth_address_t *sender;          /* Sender address for the nonce manager */
+    const eth_policy_t *policy;           /* Optional: only sign what this policy allows */
+    eth_policy_result_t policy_result;    /* Why the policy denied the job (set by the first stage) */
+    int nonce_status;                     /* Non-zero if a failed job's nonce could not be given back */
+
+    /* Internal state carried between stages */
+    eth_hash_t sighash;                   /* Signing hash from the first stage */
+    uint64_t sequence;                    /* Submission order */
+    uint8_t nonce_reserved;               /* tx->nonce came from the nonce manager */
+} eth_pipeline_job_t;
+
+/* Called once per job, in submission order, from one thread at a time */
+typedef void (*eth_pipeline_emit_fn)(eth_pipeline_job_t *job, void *context);
+
+/* Pipeline configuration */
+typedef struct {
+    size_t max_in_flight;      /* Jobs in flight before submit blocks (rounded up to a power of two) */
+    unsigned encode_threads;   /* Threads for encode + sighash */
+    unsigned sign_threads;     /* Threads for ECDSA signing (the expensive stage) */
+    unsigned emit_threads;     /* Threads for signed encoding */
+    eth_pipeline_emit_fn emit; /* Completion callback (optional) */
+    void *emit_context;        /* Passed to emit */
+} eth_pipeline_config_t;
+
+/* Pipeline context */
+typedef struct {
+    eth_pipeline_config_t config;
+    eth_mpmc_queue_t hash_queue;          /* Submitted jobs waiting for encode + sighash */
+    eth_mpmc_queue_t sign_queue;          /* Hashed jobs waiting for a signature */
+    eth_mpmc_queue_t emit_queue;          /* Signed jobs waiting for encoding and emission */
+    _Atomic(eth_pipeline_job_t *) *reorder; /* Finished jobs waiting for their turn, indexed by sequence */
+    size_t window;                        /* Max jobs in flight (power of two) */
+    pthread_t *threads;                   /* All stage threads */
+    unsigned thread_count;                /* Number of started threads */
+    _Alignas(64) atomic_uint_fast64_t submitted; /* Next sequence number to hand out */
+    _Alignas(64) atomic_uint_fast64_t emitted;   /* Next sequence number to emit */
+    _Alignas(64) atomic_uint emit_epoch;  /* Bumped whenever 'emitted' moves, so parked waiters see it */
+    atomic_uint emit_waiters;             /* Submitters and drainers about to park or parked */
+    pthread_mutex_t emit_lock;
+    pthread_cond_t emit_wake;
+    atomic_flag draining;                 /* Held by the thread currently emitting */
+    atomic_int stopping;                  /* Set when the threads should exit */
+} eth_pipeline_t;
+
+/**
+ * @brief Fill in a default configuration (one thread per stage)
+ *
+ * @param config Pointer to configuration
+ */
+void eth_pipeline_config_default(eth_pipeline_config_t *config);
+
+/**
+ * @brief Initialise a pipeline and start its threads
+ *
+ * @param pipeline Pointer to pipeline context
+ * @param config Pipeline configuration
+ * @return 0 on success, non-zero on error
+ */
+int eth_pipeline_init(eth_pipeline_t *pipeline, const eth_pipeline_config_t *config);
+
+/**
+ * @brief Submit a job, blocking while the pipeline is full (backpressure)
+ *
+ * Safe to call from several threads. The job must stay valid until emitted.
+ *
+ * @param pipeline Pointer to pipeline context
+ * @param job Job to sign
+ * @return 0 on success, non-zero on error
+ */
+int eth_pipeline_submit(eth_pipeline_t *pipeline, eth_pipeline_job_t *job);
+
+/**
+ * @brief Wait until every submitted job has been emitted
+ *
+ * @param pipeline Pointer to pipeline context
+ * @return 0 on success, non-zero on error
+ */
+int eth_pipeline_drain(eth_pipeline_t *pipeline);
+
+/**
+ * @brief Drain the pipeline, stop its threads and release its memory
+ *
+ * @param pipeline Pointer to pipeline context
+ */
+void eth_pipeline_destroy(eth_pipeline_t *pipeline);
+
+#endif /* ETH_EMBEDDED_PIPELINE_H */
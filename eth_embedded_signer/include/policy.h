@@ -0,0 +1,157 @@
+#ifndef ETH_EMBEDDED_POLICY_H
+#define ETH_EMBEDDED_POLICY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+#include "u256.h"
+#include "transaction.h"
+
+/*
+ * Pre-sign policy: a rule file compiled into lookup tables that every
+ * transaction is checked against before it is signed.
+ *
+ * Rule file, one rule per line, '#' starts a comment:
+ *
+ *   allow 0x<address>        destination that may be paid or called
+ *   allow any                any destination
+ *   allow create             contract creation
+ *   chain <id> [value <wei>] [gas <limit>] [fee <wei>]
+ *                            chain that may be signed for, with optional caps on
+ *                            value, gas limit and max fee (gas price) per gas
+ *   selector <0x12345678|signature> [max_amount <n>] [recipient_allowlisted]
+ *                            function that may be called; for token calls
+ *                            (see eth_abi_decode_token_call) the amount and the
+ *                            recipient can be limited too
+ *   selector any             any function
+ *
+ * Numbers are decimal or 0x hex. Anything not allowed is denied: a chain
+ * without a chain line, a destination not on the allowlist, calldata whose
+ * selector is not listed. Allowlisted addresses go into an open-addressing
+ * hash table and selectors and chains into sorted arrays, so a check costs
+ * the same with ten or a hundred thousand allowlisted addresses.
+ */
+
+/* Returned by eth_policy_check and eth_tx_sign_checked for a denied transaction */
+#define ETH_POLICY_DENIED 1
+
+/* Why a transaction was denied */
+typedef enum {
+    ETH_POLICY_OK = 0,                /* Allowed */
+    ETH_POLICY_UNKNOWN_CHAIN = 1,     /* No chain rule for tx->chain_id */
+    ETH_POLICY_DESTINATION = 2,       /* Destination not allowlisted */
+    ETH_POLICY_CREATE = 3,            /* Contract creation not allowed */
+    ETH_POLICY_VALUE = 4,             /* Value above the chain cap */
+    ETH_POLICY_GAS = 5,               /* Gas limit above the chain cap */
+    ETH_POLICY_FEE = 6,               /* Max fee (gas price) above the chain cap */
+    ETH_POLICY_SELECTOR = 7,          /* Selector not allowed */
+    ETH_POLICY_CALLDATA = 8,          /* Calldata the selector rule cannot inspect */
+    ETH_POLICY_TOKEN_AMOUNT = 9,      /* Token amount above the selector cap */
+    ETH_POLICY_TOKEN_RECIPIENT = 10   /* Token recipient not allowlisted */
+} eth_policy_result_t;
+
+/* Policy flags */
+#define ETH_POLICY_ANY_DESTINATION  0x1   /* allow any */
+#define ETH_POLICY_ALLOW_CREATE     0x2   /* allow create */
+#define ETH_POLICY_ANY_SELECTOR     0x4   /* selector any */
+
+/* Selector rule flags */
+#define ETH_POLICY_MAX_AMOUNT             0x1   /* Token amount is capped */
+#define ETH_POLICY_RECIPIENT_ALLOWLISTED  0x2   /* Token recipient must be allowlisted */
+
+/* Limits for one chain (all ones = no limit) */
+typedef struct {
+    uint64_t chain_id;        /* Chain id */
+    uint64_t max_gas;         /* Gas limit cap */
+    eth_u256_t max_value;     /* Value cap in wei */
+    eth_u256_t max_fee;       /* Max fee / gas price cap in wei per gas */
+} eth_policy_chain_t;
+
+/* Rule for one selector */
+typedef struct {
+    uint32_t selector;        /* Function selector */
+    unsigned flags;           /* ETH_POLICY_MAX_AMOUNT, ETH_POLICY_RECIPIENT_ALLOWLISTED */
+    eth_u256_t max_amount;    /* Token amount cap */
+} eth_policy_selector_t;
+
+/* Compiled policy */
+typedef struct {
+    unsigned flags;                    /* ETH_POLICY_ANY_DESTINATION, ... */
+    uint8_t (*addresses)[20];          /* Allowlisted addresses */
+    size_t address_count;              /* Number of allowlisted addresses */
+    size_t address_capacity;           /* Allocated address entries */
+    uint32_t *slots;                   /* Hash table: index + 1 into addresses, 0 = empty */
+    size_t slot_mask;                  /* Table size - 1 (power of two) */
+    eth_policy_selector_t *selectors;  /* Selector rules, sorted by selector */
+    size_t selector_count;             /* Number of selector rules */
+    eth_policy_chain_t *chains;        /* Chain rules, sorted by chain id */
+    size_t chain_count;                /* Number of chain rules */
+    unsigned error_line;               /* Line of the last load error */
+} eth_policy_t;
+
+/**
+ * @brief Compile a policy from rule text
+ *
+ * @param policy Pointer to policy (release with eth_policy_free)
+ * @param text Rule text
+ * @param length Length of text
+ * @return 0 on success, non-zero on error (see error_line)
+ */
+int eth_policy_load(eth_policy_t *policy, const char *text, size_t length);
+
+/**
+ * @brief Compile a policy from a rule file
+ *
+ * @param policy Pointer to policy (release with eth_policy_free)
+ * @param path Path of the rule file
+ * @return 0 on success, non-zero on error (see error_line)
+ */
+int eth_policy_load_file(eth_policy_t *policy, const char *path);
+
+/**
+ * @brief Release a policy
+ *
+ * @param policy Pointer to policy
+ */
+void eth_policy_free(eth_policy_t *policy);
+
+/**
+ * @brief Check whether an address is allowlisted
+ *
+ * @param policy Compiled policy
+ * @param address 20-byte address
+ * @return 1 if allowlisted, 0 otherwise
+ */
+int eth_policy_allows_address(const eth_policy_t *policy, const uint8_t address[20]);
+
+/**
+ * @brief Check a transaction against a policy
+ *
+ * @param policy Compiled policy
+ * @param tx Transaction to check
+ * @param result Output reason (optional)
+ * @return 0 if allowed, ETH_POLICY_DENIED if denied, negative on error
+ */
+int eth_policy_check(const eth_policy_t *policy, const eth_transaction_t *tx, eth_policy_result_t *result);
+
+/**
+ * @brief Sign a transaction only if the policy allows it
+ *
+ * @param tx Pointer to transaction structure
+ * @param private_key Private key to sign with
+ * @param policy Compiled policy
+ * @param result Output reason (optional)
+ * @return 0 on success, ETH_POLICY_DENIED if denied, negative on error
+ */
+int eth_tx_sign_checked(eth_transaction_t *tx, const eth_private_key_t *private_key,
+                        const eth_policy_t *policy, eth_policy_result_t *result);
+
+/**
+ * @brief Short description of a policy result
+ *
+ * @param result Policy result
+ * @return Static string
+ */
+const char *eth_policy_result_string(eth_policy_result_t result);
+
+#endif /* ETH_EMBEDDED_POLICY_H */
@@ -0,0 +1,67 @@
+#ifndef ETH_EMBEDDED_PUBKEY_H
+#define ETH_EMBEDDED_PUBKEY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+
+/*
+ * Compressed (SEC1, 33-byte) public keys: a 0x02/0x03 prefix giving the
+ * parity of y, then x. Half the size of eth_public_key_t, at the price of a
+ * field square root to get y back.
+ *
+ * The square root is one fixed exponentiation (about 266 field operations)
+ * per key and cannot be shared between keys the way inversions can, so
+ * large batches are spread over threads instead. Decompression is also the
+ * validation: x is rejected when x^3 + 7 has no root.
+ */
+
+/* Size of a compressed public key */
+#define ETH_PUBLIC_KEY_COMPRESSED_SIZE 33
+
+/* Soft result of a batch: some entries were invalid (their outputs are zeroed) */
+#define ETH_PUBLIC_KEY_INVALID_ENTRIES 1
+
+/**
+ * @brief Compress a public key
+ *
+ * @param public_key Public key (x || y)
+ * @param compressed Output (33 bytes)
+ * @return 0 on success, non-zero on error
+ */
+int eth_public_key_compress(const eth_public_key_t *public_key, uint8_t compressed[ETH_PUBLIC_KEY_COMPRESSED_SIZE]);
+
+/**
+ * @brief Decompress and validate a public key
+ *
+ * @param compressed Compressed key (33 bytes)
+ * @param public_key Output public key (x || y)
+ * @return 0 on success, non-zero if the key is malformed or not on the curve
+ */
+int eth_public_key_decompress(const uint8_t compressed[ETH_PUBLIC_KEY_COMPRESSED_SIZE],
+                              eth_public_key_t *public_key);
+
+/**
+ * @brief Compress many public keys
+ *
+ * @param public_keys Public keys
+ * @param count Number of keys
+ * @param compressed Output: count * 33 bytes, back to back
+ * @return 0 on success, non-zero on error
+ */
+int eth_public_key_compress_batch(const eth_public_key_t *public_keys, size_t count, uint8_t *compressed);
+
+/**
+ * @brief Decompress and validate many public keys
+ *
+ * @param compressed Compressed keys: count * 33 bytes, back to back
+ * @param count Number of keys
+ * @param threads Threads to use (0 means 1)
+ * @param public_keys Output public keys (invalid entries are zeroed)
+ * @param valid Output: 1 or 0 per key (optional)
+ * @return 0 if all keys are valid, ETH_PUBLIC_KEY_INVALID_ENTRIES if some are not, negative on error
+ */
+int eth_public_key_decompress_batch(const uint8_t *compressed, size_t count, unsigned threads,
+                                    eth_public_key_t *public_keys, uint8_t *valid);
+
+#endif /* ETH_EMBEDDED_PUBKEY_H */
@@ -0,0 +1,42 @@
+#ifndef ETH_EMBEDDED_RFC6979_H
+#define ETH_EMBEDDED_RFC6979_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+
+/*
+ * Deterministic ECDSA nonces (RFC 6979, HMAC-SHA256) for secp256k1.
+ *
+ * A nonce takes 16 SHA-256 compressions: the HMAC key pads are compressed
+ * once per HMAC key and reused for every MAC under that key, and the pads of
+ * the initial all-zero key are shared by the whole batch. The batch form runs
+ * up to ETH_SHA256_LANES derivations in lockstep, so every compression step
+ * is one eth_sha256_compress_multi call across the group. Builds with
+ * ETH_RFC6979_LANES set to 1 (the embedded profile) have no lanes to fill:
+ * the batch form derives one nonce after the other with eth_rfc6979_nonce.
+ */
+
+/**
+ * @brief Derive the signing nonce for one key and message hash
+ *
+ * @param private_key Private key (must be in [1, n - 1])
+ * @param hash Message hash
+ * @param nonce Output nonce (32 bytes, in [1, n - 1])
+ * @return 0 on success, non-zero on error
+ */
+int eth_rfc6979_nonce(const eth_private_key_t *private_key, const eth_hash_t *hash, uint8_t nonce[32]);
+
+/**
+ * @brief Derive the signing nonces for many (key, hash) pairs
+ *
+ * @param private_keys Private keys, one per pair
+ * @param hashes Message hashes, one per pair
+ * @param count Number of pairs
+ * @param nonces Output: count * 32 bytes, back to back
+ * @return 0 on success, non-zero on error (nothing is derived if any key is invalid)
+ */
+int eth_rfc6979_nonce_batch(const eth_private_key_t *private_keys, const eth_hash_t *hashes, size_t count,
+                            uint8_t *nonces);
+
+#endif /* ETH_EMBEDDED_RFC6979_H */
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "u256.h"
 
 /* RLP encoding types */
 typedef enum {
@@ -45,6 +46,31 @@ int rlp_begin_list(rlp_encoder_t *encoder, size_t *marker);
  */
 int rlp_end_list(rlp_encoder_t *encoder, size_t marker);
 
+/**
+ * @brief Write a list header for a payload of known length
+ * 
+ * Alternative to begin/end when the payload length is known up front: the
+ * items follow the header directly and nothing has to be moved afterwards.
+ * 
+ * @param encoder Pointer to encoder context
+ * @param payload_length Total encoded length of the list items
+ * @return 0 on success, non-zero on error
+ */
+int rlp_encode_list_header(rlp_encoder_t *encoder, size_t payload_length);
+
+/**
+ * @brief Write a string header for a byte array of known length
+ * 
+ * The bytes themselves are left to the caller (e.g. hashed in place instead
+ * of copied). Not for a single byte below 0x80, which is encoded without a
+ * header; rlp_bytes_length tells the two cases apart.
+ * 
+ * @param encoder Pointer to encoder context
+ * @param length Length of the byte array
+ * @return 0 on success, non-zero on error
+ */
+int rlp_encode_string_header(rlp_encoder_t *encoder, size_t length);
+
 /**
  * @brief Encode a single byte
  * 
@@ -73,6 +99,58 @@ int rlp_encode_bytes(rlp_encoder_t *encoder, const uint8_t *data, size_t length)
  */
 int rlp_encode_uint(rlp_encoder_t *encoder, uint64_t value);
 
+/**
+ * @brief Encode a 256-bit unsigned integer (minimal big endian, zero as 0x80)
+ * 
+ * @param encoder Pointer to encoder context
+ * @param value Integer to encode
+ * @return 0 on success, non-zero on error
+ */
+int rlp_encode_u256(rlp_encoder_t *encoder, const eth_u256_t *value);
+
+/**
+ * @brief Append data that is already RLP encoded (e.g. the items of a list)
+ * 
+ * @param encoder Pointer to encoder context
+ * @param data Pointer to encoded data
+ * @param length Length of encoded data
+ * @return 0 on success, non-zero on error
+ */
+int rlp_encode_raw(rlp_encoder_t *encoder, const uint8_t *data, size_t length);
+
+/**
+ * @brief Encoded size of an unsigned integer (as rlp_encode_uint writes it)
+ * 
+ * @param value Integer
+ * @return Size in bytes
+ */
+size_t rlp_uint_length(uint64_t value);
+
+/**
+ * @brief Encoded size of a 256-bit unsigned integer (as rlp_encode_u256 writes it)
+ * 
+ * @param value Integer
+ * @return Size in bytes
+ */
+size_t rlp_u256_length(const eth_u256_t *value);
+
+/**
+ * @brief Encoded size of a byte array (as rlp_encode_bytes writes it)
+ * 
+ * @param data Pointer to data
+ * @param length Length of data
+ * @return Size in bytes
+ */
+size_t rlp_bytes_length(const uint8_t *data, size_t length);
+
+/**
+ * @brief Size of the header of a list with the given payload length
+ * 
+ * @param payload_length Total encoded length of the list items
+ * @return Size in bytes
+ */
+size_t rlp_list_header_length(size_t payload_length);
+
 /**
  * @brief Get the current length of encoded data
  * 
@@ -0,0 +1,122 @@
+#ifndef ETH_EMBEDDED_RPC_BATCH_H
+#define ETH_EMBEDDED_RPC_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(_WIN32)
+/* Same layout as the POSIX structure */
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+#else
+#include <sys/uio.h>
+#endif
+
+/*
+ * Builder for batched JSON-RPC eth_sendRawTransaction requests:
+ *
+ *   [{"jsonrpc":"2.0","id":7,"method":"eth_sendRawTransaction","params":["0x02f8..."]},...]
+ *
+ * Requests are written in place into caller memory, either one buffer or a
+ * set of iovec segments that can go straight to writev. The raw transaction
+ * is hex-encoded directly into the output, and ids come from a decimal
+ * counter that is incremented in place instead of being formatted per call.
+ */
+
+/* Returned by eth_rpc_batch_add when the request does not fit in the remaining space */
+#define ETH_RPC_BATCH_FULL 1
+
+/* Largest id text (UINT64_MAX has 20 digits) */
+#define ETH_RPC_BATCH_ID_DIGITS 20
+
+/* Batch builder context */
+typedef struct {
+    struct iovec *segments;                /* Output segments (iov_len is the capacity until finish) */
+    size_t segment_count;                  /* Number of segments */
+    size_t segment;                        /* Segment being written */
+    size_t length;                         /* Bytes used in the current segment */
+    struct iovec single;                   /* Backing segment for eth_rpc_batch_init */
+    size_t capacity;                       /* Capacity of the current segment */
+    size_t count;                          /* Requests written */
+    size_t total_length;                   /* Bytes written over all segments */
+    char id[ETH_RPC_BATCH_ID_DIGITS];      /* Next id, right-aligned decimal digits */
+    size_t id_len;                         /* Number of digits in use */
+} eth_rpc_batch_t;
+
+/**
+ * @brief Start a batch in a single buffer
+ *
+ * @param batch Pointer to batch context
+ * @param buffer Output buffer
+ * @param size Size of output buffer (at least 2 bytes)
+ * @param first_id Id of the first request
+ * @return 0 on success, non-zero on error
+ */
+int eth_rpc_batch_init(eth_rpc_batch_t *batch, char *buffer, size_t size, uint64_t first_id);
+
+/**
+ * @brief Start a batch spread over several segments
+ *
+ * iov_base/iov_len give each segment's memory and capacity. A request is never
+ * split between segments. eth_rpc_batch_finish rewrites iov_len to the bytes used.
+ *
+ * @param batch Pointer to batch context
+ * @param segments Output segments (must stay valid until finish)
+ * @param segment_count Number of segments
+ * @param first_id Id of the first request
+ * @return 0 on success, non-zero on error
+ */
+int eth_rpc_batch_init_segments(eth_rpc_batch_t *batch, struct iovec *segments, size_t segment_count, uint64_t first_id);
+
+/**
+ * @brief Append an eth_sendRawTransaction request
+ *
+ * @param batch Pointer to batch context
+ * @param raw Signed raw transaction (eth_tx_encode_signed output)
+ * @param raw_len Length of the raw transaction
+ * @return 0 on success, ETH_RPC_BATCH_FULL if it does not fit (finish and start
+ *         a new batch), negative on error (including a request too large for any segment)
+ */
+int eth_rpc_batch_add(eth_rpc_batch_t *batch, const uint8_t *raw, size_t raw_len);
+
+/**
+ * @brief Use up the next id without writing a request
+ *
+ * Keeps ids equal to input positions when a transaction is dropped.
+ *
+ * @param batch Pointer to batch context
+ */
+void eth_rpc_batch_skip(eth_rpc_batch_t *batch);
+
+/**
+ * @brief Get the id the next request will carry
+ *
+ * @param batch Pointer to batch context
+ * @return Next id
+ */
+uint64_t eth_rpc_batch_next_id(const eth_rpc_batch_t *batch);
+
+/**
+ * @brief Close the JSON array
+ *
+ * An empty batch comes out as "[]", which nodes reject; check the count first.
+ *
+ * @param batch Pointer to batch context
+ * @param segments_used Output number of segments holding data (optional)
+ * @param total_length Output total length in bytes (optional)
+ * @return 0 on success, non-zero on error
+ */
+int eth_rpc_batch_finish(eth_rpc_batch_t *batch, size_t *segments_used, size_t *total_length);
+
+/**
+ * @brief Size of one request for a raw transaction, separator included
+ *
+ * @param raw_len Length of the raw transaction
+ * @param id Request id
+ * @return Number of bytes
+ */
+size_t eth_rpc_request_size(size_t raw_len, uint64_t id);
+
+#endif /* ETH_EMBEDDED_RPC_BATCH_H */
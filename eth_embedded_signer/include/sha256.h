@@ -0,0 +1,123 @@
+#ifndef ETH_EMBEDDED_SHA256_H
+#define ETH_EMBEDDED_SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * SHA-256 and HMAC-SHA256 (RFC 6979 nonces, see rfc6979.h).
+ *
+ * Single messages go through the SHA-NI kernel when the CPU has it and a
+ * portable kernel otherwise. eth_sha256_compress_multi compresses one block
+ * into each of several independent states: with AVX2 eight states are
+ * processed side by side in the lanes of one register set, which is what
+ * makes many short HMACs (a batch of nonces) cheap.
+ */
+
+/* SHA-256 block size in bytes */
+#define ETH_SHA256_BLOCK_SIZE 64
+
+/* States eth_sha256_compress_multi processes side by side */
+#define ETH_SHA256_LANES 8
+
+/* SHA-256 context */
+typedef struct {
+    uint32_t state[8];                        /* Chaining value */
+    uint64_t length;                          /* Bytes absorbed so far */
+    uint8_t buffer[ETH_SHA256_BLOCK_SIZE];    /* Partial block */
+} eth_sha256_ctx_t;
+
+/* HMAC-SHA256 context */
+typedef struct {
+    eth_sha256_ctx_t inner;                   /* After the key ^ ipad block */
+    eth_sha256_ctx_t outer;                   /* After the key ^ opad block */
+} eth_hmac_sha256_ctx_t;
+
+/**
+ * @brief Initialise a SHA-256 context
+ *
+ * @param ctx Pointer to context
+ */
+void eth_sha256_init(eth_sha256_ctx_t *ctx);
+
+/**
+ * @brief Absorb data
+ *
+ * @param ctx Pointer to context
+ * @param data Input
+ * @param length Input length
+ */
+void eth_sha256_update(eth_sha256_ctx_t *ctx, const uint8_t *data, size_t length);
+
+/**
+ * @brief Finish and write the digest
+ *
+ * @param ctx Pointer to context
+ * @param output Output digest (32 bytes)
+ */
+void eth_sha256_final(eth_sha256_ctx_t *ctx, uint8_t output[32]);
+
+/**
+ * @brief One-shot SHA-256
+ *
+ * @param data Input
+ * @param length Input length
+ * @param output Output digest (32 bytes)
+ */
+void eth_sha256(const uint8_t *data, size_t length, uint8_t output[32]);
+
+/**
+ * @brief Compress one block into each of several independent states
+ *
+ * @param states Chaining values, updated in place
+ * @param blocks One 64-byte block per state
+ * @param count Number of states
+ */
+void eth_sha256_compress_multi(uint32_t (*states)[8], const uint8_t *const *blocks, size_t count);
+
+/**
+ * @brief Key an HMAC-SHA256 context
+ *
+ * @param ctx Pointer to context
+ * @param key Key
+ * @param length Key length
+ */
+void eth_hmac_sha256_init(eth_hmac_sha256_ctx_t *ctx, const uint8_t *key, size_t length);
+
+/**
+ * @brief Absorb message data
+ *
+ * @param ctx Pointer to context
+ * @param data Input
+ * @param length Input length
+ */
+void eth_hmac_sha256_update(eth_hmac_sha256_ctx_t *ctx, const uint8_t *data, size_t length);
+
+/**
+ * @brief Finish and write the MAC
+ *
+ * @param ctx Pointer to context
+ * @param output Output MAC (32 bytes)
+ */
+void eth_hmac_sha256_final(eth_hmac_sha256_ctx_t *ctx, uint8_t output[32]);
+
+/**
+ * @brief One-shot HMAC-SHA256
+ *
+ * @param key Key
+ * @param key_length Key length
+ * @param data Message
+ * @param length Message length
+ * @param output Output MAC (32 bytes)
+ */
+void eth_hmac_sha256(const uint8_t *key, size_t key_length, const uint8_t *data, size_t length,
+                     uint8_t output[32]);
+
+/**
+ * @brief Name of the kernels selected for this CPU ("sha-ni", "avx2" or "scalar")
+ *
+ * @return Kernel name
+ */
+const char *eth_sha256_backend(void);
+
+#endif /* ETH_EMBEDDED_SHA256_H */
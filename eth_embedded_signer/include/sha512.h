@@ -0,0 +1,93 @@
+#ifndef ETH_EMBEDDED_SHA512_H
+#define ETH_EMBEDDED_SHA512_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * SHA-512 and HMAC-SHA512 (BIP-32 key derivation).
+ *
+ * An HMAC context keyed once can be copied and reused for any number of
+ * messages: the key blocks are compressed at init, so each message costs
+ * only its own blocks.
+ */
+
+/* SHA-512 block size in bytes */
+#define ETH_SHA512_BLOCK_SIZE 128
+
+/* SHA-512 context */
+typedef struct {
+    uint64_t state[8];                        /* Chaining value */
+    uint64_t length;                          /* Bytes absorbed so far */
+    uint8_t buffer[ETH_SHA512_BLOCK_SIZE];    /* Partial block */
+} eth_sha512_ctx_t;
+
+/* HMAC-SHA512 context */
+typedef struct {
+    eth_sha512_ctx_t inner;                   /* After the key ^ ipad block */
+    eth_sha512_ctx_t outer;                   /* After the key ^ opad block */
+} eth_hmac_sha512_ctx_t;
+
+/**
+ * @brief Initialise a SHA-512 context
+ *
+ * @param ctx Pointer to context
+ */
+void eth_sha512_init(eth_sha512_ctx_t *ctx);
+
+/**
+ * @brief Absorb data
+ *
+ * @param ctx Pointer to context
+ * @param data Input
+ * @param length Input length
+ */
+void eth_sha512_update(eth_sha512_ctx_t *ctx, const uint8_t *data, size_t length);
+
+/**
+ * @brief Finish and write the digest
+ *
+ * @param ctx Pointer to context
+ * @param output Output digest (64 bytes)
+ */
+void eth_sha512_final(eth_sha512_ctx_t *ctx, uint8_t output[64]);
+
+/**
+ * @brief Key an HMAC-SHA512 context
+ *
+ * @param ctx Pointer to context
+ * @param key Key
+ * @param length Key length
+ */
+void eth_hmac_sha512_init(eth_hmac_sha512_ctx_t *ctx, const uint8_t *key, size_t length);
+
+/**
+ * @brief Absorb message data
+ *
+ * @param ctx Pointer to context
+ * @param data Input
+ * @param length Input length
+ */
+void eth_hmac_sha512_update(eth_hmac_sha512_ctx_t *ctx, const uint8_t *data, size_t length);
+
+/**
+ * @brief Finish and write the MAC
+ *
+ * @param ctx Pointer to context
+ * @param output Output MAC (64 bytes)
+ */
+void eth_hmac_sha512_final(eth_hmac_sha512_ctx_t *ctx, uint8_t output[64]);
+
+/**
+ * @brief One-shot HMAC-SHA512
+ *
+ * @param key Key
+ * @param key_length Key length
+ * @param data Message
+ * @param length Message length
+ * @param output Output MAC (64 bytes)
+ */
+void eth_hmac_sha512(const uint8_t *key, size_t key_length, const uint8_t *data, size_t length,
+                     uint8_t output[64]);
+
+#endif /* ETH_EMBEDDED_SHA512_H */
@@ -0,0 +1,119 @@
+#ifndef ETH_EMBEDDED_SIGN_QUEUE_H
+#define ETH_EMBEDDED_SIGN_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "crypto.h"
+#include "transaction.h"
+#include "mpmc_queue.h"
+#include "nonce_manager.h"
+#include "policy.h"
+
+/*
+ * Asynchronous signing for event loops.
+ *
+ * eth_sign_queue_submit never blocks: it hands the job to a worker pool and
+ * returns. Finished jobs collect on a completion queue that the loop drains in
+ * batches with eth_sign_queue_poll. The descriptor from eth_sign_queue_fd
+ * becomes readable when completions are waiting (an eventfd on Linux).
+ *
+ * Jobs that carry a nonce manager get their nonce reserved at submit and
+ * released again if signing fails. A completion with nonce_status set means
+ * the manager had no room for the released nonce and marked the sender for
+ * resync: its submits fail until eth_nonce_set is called.
+ *
+ * Jobs that carry a policy are signed with eth_tx_sign_checked. A denied job
+ * completes with status ETH_POLICY_DENIED and the reason in policy_result.
+ */
+
+/* Returned by eth_sign_queue_submit when every slot is in use */
+#define ETH_SIGN_QUEUE_FULL 1
+
+/* Signing job (owned by the caller until its completion has been polled) */
+typedef struct {
+    eth_transaction_t *tx;                /* Transaction to sign (r, s, v get filled in) */
+    const eth_private_key_t *private_key; /* Key to sign with */
+    uint8_t *output;                      /* Buffer for the signed encoding (optional) */
+    size_t output_size;                   /* Size of output buffer */
+    eth_nonce_manager_t *nonces;          /* Optional: assign tx->nonce from this manager at submit */
+    const eth_address_t *sender;          /* Sender address for the nonce manager */
+    const eth_policy_t *policy;           /* Optional: only sign what this policy allows */
+} eth_sign_job_t;
+
+/* Completion entry */
+typedef struct {
+    eth_sign_job_t *job;                  /* Job that finished */
+    void *user_data;                      /* Value passed to submit */
+    size_t output_len;                    /* Length of the signed encoding */
+    int status;                           /* 0 on success, non-zero on error */
+    eth_policy_result_t policy_result;    /* Why the policy denied the job (ETH_POLICY_OK otherwise) */
+    int nonce_status;                     /* Non-zero if a failed job's nonce could not be given back */
+} eth_sign_completion_t;
+
+/* Sign queue context */
+typedef struct {
+    eth_sign_completion_t *slots;         /* One slot per in-flight job */
+    eth_mpmc_queue_t free_slots;          /* Slots available to submit */
+    eth_mpmc_queue_t submit_queue;        /* Slots waiting for a worker */
+    eth_mpmc_queue_t completion_queue;    /* Slots waiting to be polled */
+    pthread_t *threads;                   /* Worker pool */
+    unsigned thread_count;                /* Number of started workers */
+    int event_fd;                         /* Readable when completions are waiting (-1 if unsupported) */
+    int event_write_fd;                   /* Write side (same as event_fd for an eventfd) */
+    atomic_int wake_armed;                /* Set when the loop wants a wakeup for the next completion */
+    atomic_int stopping;                  /* Set when the workers should exit */
+} eth_sign_queue_t;
+
+/**
+ * @brief Initialise a sign queue and start its workers
+ *
+ * @param queue Pointer to sign queue context
+ * @param threads Number of worker threads (0 means 1)
+ * @param depth Maximum number of jobs in flight (rounded up to a power of two)
+ * @return 0 on success, non-zero on error
+ */
+int eth_sign_queue_init(eth_sign_queue_t *queue, unsigned threads, size_t depth);
+
+/**
+ * @brief Submit a job without blocking
+ *
+ * @param queue Pointer to sign queue context
+ * @param job Job to sign (must stay valid until its completion is polled)
+ * @param user_data Value handed back in the completion
+ * @return 0 on success, ETH_SIGN_QUEUE_FULL if no slot is free (poll and retry), negative on error
+ */
+int eth_sign_queue_submit(eth_sign_queue_t *queue, eth_sign_job_t *job, void *user_data);
+
+/**
+ * @brief Collect finished jobs without blocking
+ *
+ * The wakeup descriptor is only re-armed by polling, so keep calling until
+ * fewer than max completions come back before waiting on it again.
+ *
+ * @param queue Pointer to sign queue context
+ * @param completions Output array
+ * @param max Capacity of the output array
+ * @return Number of completions written, negative on error
+ */
+int eth_sign_queue_poll(eth_sign_queue_t *queue, eth_sign_completion_t *completions, size_t max);
+
+/**
+ * @brief Get the descriptor to watch for completions (epoll/poll/select)
+ *
+ * @param queue Pointer to sign queue context
+ * @return File descriptor, or -1 if the platform has no wakeup descriptor
+ */
+int eth_sign_queue_fd(const eth_sign_queue_t *queue);
+
+/**
+ * @brief Stop the workers and release the queue
+ *
+ * Jobs that were submitted but not yet polled are finished first.
+ *
+ * @param queue Pointer to sign queue context
+ */
+void eth_sign_queue_destroy(eth_sign_queue_t *queue);
+
+#endif /* ETH_EMBEDDED_SIGN_QUEUE_H */
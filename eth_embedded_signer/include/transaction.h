@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "crypto.h"
+#include "u256.h"
 
 // Transaction types (legacy, EIP-2930, EIP-1559)
 typedef enum {
@@ -12,6 +13,22 @@ typedef enum {
     ETH_EIP1559_TX = 2     // EIP-1559 (priority fee)
 } eth_tx_type_t;
 
+// What changed since the cache was last brought up to date
+#define ETH_TX_DIRTY_FEES  0x1    // Fee fields: the cached encoding gets patched
+#define ETH_TX_DIRTY_BODY  0x2    // Anything else: full re-encode
+#define ETH_TX_DIRTY_NONCE 0x4    // Nonce: patched like the fees
+
+// Optional memo of a transaction's unsigned encoding and signing hash
+typedef struct {
+    uint8_t *encoding;            // Buffer for the unsigned encoding (caller supplied)
+    size_t encoding_size;         // Size of the buffer
+    size_t encoding_len;          // Length of the cached encoding
+    size_t fee_offset;            // Where the fee fields start in the encoding
+    size_t fee_len;               // Encoded length of the fee fields
+    eth_hash_t sighash;           // Cached signing hash
+    unsigned dirty;               // ETH_TX_DIRTY_* bits, 0 when encoding and sighash are current
+} eth_tx_cache_t;
+
 // Ethereum transaction aka tx struct
 typedef struct {
     eth_tx_type_t tx_type;        // What kind of tx is this? 
@@ -20,29 +37,32 @@ typedef struct {
     uint64_t nonce;               // Sender's nonce
     uint8_t to[20];               // Who's getting it (empty for contract creation)
     uint8_t to_len;               // How long 'to' is (0 = contract creation) - length basically
-    uint8_t value[32];            // Amount in wei or whatever denomination
-    uint8_t value_len;            // How many bytes in value
+    eth_u256_t value;             // Amount in wei
     uint8_t *data;                // Calldata or contract code
     size_t data_len;              // Length of data
     uint64_t chain_id;            // Chain ID
 
     // Only for legacy and EIP-2930
-    uint8_t gas_price[32];        // Gas price in wei
-    uint8_t gas_price_len;        // How many bytes in gas price
+    eth_u256_t gas_price;         // Gas price in wei
 
     // for EIP-1559
-    uint8_t max_priority_fee[32]; // Max tip per gas (wei)
-    uint8_t max_priority_fee_len; // How many bytes in tip
-    uint8_t max_fee[32];          // Max fee per gas (wei)
-    uint8_t max_fee_len;          // How many bytes in max fee
+    eth_u256_t max_priority_fee;  // Max tip per gas (wei)
+    eth_u256_t max_fee;           // Max fee per gas (wei)
+
+    // for EIP-2930 and EIP-1559
+    uint8_t *access_list;         // RLP-encoded access list entries (the list payload, no list header)
+    size_t access_list_len;       // Length of access list payload (0 = empty access list)
 
     // All tx types
     uint64_t gas_limit;           // Max gas for this tx
 
     // Signature
-    uint8_t v;                    // Recovery ID + chain ID
+    uint64_t v;                   // Recovery ID, or 35/36 + chain ID * 2 for legacy (EIP-155)
     uint8_t r[32];                // Sig R
     uint8_t s[32];                // Sig S
+
+    // Optional, see eth_tx_attach_cache
+    eth_tx_cache_t *cache;        // Memoized encoding and sighash (NULL = none)
 } eth_transaction_t;
 
 /**
@@ -54,6 +74,127 @@ typedef struct {
  */
 int eth_tx_init(eth_transaction_t *tx, eth_tx_type_t tx_type);
 
+/**
+ * @brief Attach a cache that memoizes the unsigned encoding and signing hash
+ * 
+ * While a cache is attached, change fields only through the eth_tx_set_*
+ * functions (or call eth_tx_invalidate after writing them directly) so the
+ * cache knows what to redo. eth_tx_refresh_cache (and eth_tx_sign, which
+ * calls it) then brings the cache up to date: unchanged transactions hash
+ * without re-encoding, and nonce or fee changes patch the cached encoding in
+ * place. eth_tx_encode, eth_tx_hash and eth_tx_encode_signed only read the
+ * cache, and encode from the fields while it is stale.
+ * 
+ * The cache has a single owner: the thread that owns the transaction. Only
+ * that thread may set fields, refresh or sign; other threads may call the
+ * const functions once it has finished, never at the same time. A cache is
+ * never shared between transactions.
+ * 
+ * @param tx Pointer to transaction structure
+ * @param cache Cache to attach (NULL detaches)
+ * @param buffer Buffer for the cached encoding (encodings that do not fit are not cached)
+ * @param buffer_size Size of buffer
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_attach_cache(eth_transaction_t *tx, eth_tx_cache_t *cache, uint8_t *buffer, size_t buffer_size);
+
+/**
+ * @brief Bring an attached cache up to date (does nothing without a cache)
+ * 
+ * @param tx Pointer to transaction structure
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_refresh_cache(eth_transaction_t *tx);
+
+/**
+ * @brief Mark the whole cached state stale (after writing fields directly)
+ * 
+ * @param tx Pointer to transaction structure
+ */
+void eth_tx_invalidate(eth_transaction_t *tx);
+
+/**
+ * @brief Set the nonce
+ * 
+ * @param tx Pointer to transaction structure
+ * @param nonce Sender nonce
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_nonce(eth_transaction_t *tx, uint64_t nonce);
+
+/**
+ * @brief Set the chain id
+ * 
+ * @param tx Pointer to transaction structure
+ * @param chain_id Chain id
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_chain_id(eth_transaction_t *tx, uint64_t chain_id);
+
+/**
+ * @brief Set the gas limit
+ * 
+ * @param tx Pointer to transaction structure
+ * @param gas_limit Max gas for this tx
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_gas_limit(eth_transaction_t *tx, uint64_t gas_limit);
+
+/**
+ * @brief Set the recipient
+ * 
+ * @param tx Pointer to transaction structure
+ * @param to Recipient address, NULL for contract creation
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_to(eth_transaction_t *tx, const uint8_t to[20]);
+
+/**
+ * @brief Set the value
+ * 
+ * @param tx Pointer to transaction structure
+ * @param value Amount in wei
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_value(eth_transaction_t *tx, const eth_u256_t *value);
+
+/**
+ * @brief Set the calldata (the pointer is kept, not the bytes)
+ * 
+ * @param tx Pointer to transaction structure
+ * @param data Calldata
+ * @param data_len Length of calldata
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_data(eth_transaction_t *tx, uint8_t *data, size_t data_len);
+
+/**
+ * @brief Set the gas price (legacy and EIP-2930)
+ * 
+ * @param tx Pointer to transaction structure
+ * @param gas_price Gas price in wei
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_gas_price(eth_transaction_t *tx, const eth_u256_t *gas_price);
+
+/**
+ * @brief Set the max fee per gas (EIP-1559)
+ * 
+ * @param tx Pointer to transaction structure
+ * @param max_fee Max fee per gas in wei
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_max_fee(eth_transaction_t *tx, const eth_u256_t *max_fee);
+
+/**
+ * @brief Set the max priority fee per gas (EIP-1559)
+ * 
+ * @param tx Pointer to transaction structure
+ * @param max_priority_fee Max tip per gas in wei
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_set_max_priority_fee(eth_transaction_t *tx, const eth_u256_t *max_priority_fee);
+
 /**
  * @brief RLP encode a transaction (unsigned)
  * 
@@ -83,6 +224,18 @@ int eth_tx_hash(const eth_transaction_t *tx, eth_hash_t *hash);
  */
 int eth_tx_sign(eth_transaction_t *tx, const eth_private_key_t *private_key);
 
+/**
+ * @brief Sign a precomputed signing hash and store the signature in the transaction
+ * 
+ * Lets callers that already ran eth_tx_hash (e.g. a pipeline stage) skip re-encoding.
+ * 
+ * @param tx Pointer to transaction structure
+ * @param hash Signing hash of the transaction (from eth_tx_hash)
+ * @param private_key Private key to sign with
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_sign_hash(eth_transaction_t *tx, const eth_hash_t *hash, const eth_private_key_t *private_key);
+
 /**
  * @brief RLP encode a signed transaction
  * 
@@ -94,4 +247,41 @@ int eth_tx_sign(eth_transaction_t *tx, const eth_private_key_t *private_key);
  */
 int eth_tx_encode_signed(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size, size_t *output_size);
 
+/**
+ * @brief Re-sign a transaction with new fees (replace-by-fee)
+ * 
+ * Sets the fees, signs and writes the signed encoding. With a cache attached
+ * (see eth_tx_attach_cache) the previous encoding is reused: only the fee
+ * fields and the list header are rewritten before re-hashing, and the signed
+ * encoding is built from the cached body.
+ * 
+ * @param tx Pointer to transaction structure (fees and signature are updated)
+ * @param new_tip New max priority fee per gas (EIP-1559 only, ignored otherwise)
+ * @param new_max_fee New max fee per gas (EIP-1559) or gas price
+ * @param private_key Private key to sign with
+ * @param buffer Output buffer for the signed transaction
+ * @param buffer_size Size of output buffer
+ * @param output_size Pointer to variable to store size of signed transaction
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_rebump(eth_transaction_t *tx, const eth_u256_t *new_tip, const eth_u256_t *new_max_fee,
+                  const eth_private_key_t *private_key, uint8_t *buffer, size_t buffer_size, size_t *output_size);
+
+/**
+ * @brief Re-sign a set of transactions with new fees, back to back into one buffer
+ * 
+ * @param txs Transactions (same key, fees and signatures are updated)
+ * @param count Number of transactions
+ * @param new_tip New max priority fee per gas (EIP-1559 only, ignored otherwise)
+ * @param new_max_fee New max fee per gas (EIP-1559) or gas price
+ * @param private_key Private key to sign with
+ * @param buffer Output buffer for the signed transactions
+ * @param buffer_size Size of output buffer
+ * @param offsets Output offsets, count + 1 entries: txs[i] spans [offsets[i], offsets[i + 1])
+ * @return 0 on success, non-zero on error (offsets are valid up to the failed transaction)
+ */
+int eth_tx_rebump_batch(eth_transaction_t *txs, size_t count, const eth_u256_t *new_tip,
+                        const eth_u256_t *new_max_fee, const eth_private_key_t *private_key,
+                        uint8_t *buffer, size_t buffer_size, size_t *offsets);
+
 #endif /* ETH_EMBEDDED_TRANSACTION_H */ 
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef ETH_EMBEDDED_TX_BATCH_H
+#define ETH_EMBEDDED_TX_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+#include "u256.h"
+#include "transaction.h"
+
+/*
+ * Structure-of-arrays batch of unsigned transactions.
+ *
+ * Each field lives in its own contiguous column and all calldata shares one
+ * heap, so a pass over the batch only pulls in the columns it reads. There
+ * is a single fee cap column (gas price for legacy and EIP-2930, max fee
+ * for EIP-1559) instead of a buffer per fee field.
+ *
+ * Batch encode and hash work on the columns directly: the encoded length of
+ * every field is known up front, so each transaction is written front to
+ * back with its list header first and nothing is moved afterwards. The
+ * output is identical to eth_tx_encode. Access lists are not stored.
+ */
+
+/* Transaction batch */
+typedef struct {
+    size_t count;              /* Transactions in the batch */
+    size_t capacity;           /* Allocated rows */
+    uint8_t *tx_type;          /* eth_tx_type_t per row */
+    uint64_t *chain_id;        /* Chain id */
+    uint64_t *nonce;           /* Sender nonce */
+    uint64_t *gas_limit;       /* Gas limit */
+    uint8_t (*to)[20];         /* Recipient */
+    uint8_t *to_len;           /* 20, or 0 for contract creation */
+    eth_u256_t *value;         /* Value in wei */
+    eth_u256_t *fee_cap;       /* Gas price (legacy, EIP-2930) or max fee (EIP-1559) */
+    eth_u256_t *priority_fee;  /* Max priority fee (EIP-1559) */
+    uint64_t *data_offset;     /* Calldata offset into the heap */
+    uint32_t *data_len;        /* Calldata length */
+    uint8_t *heap;             /* Shared calldata heap */
+    size_t heap_size;          /* Bytes used in heap */
+    size_t heap_capacity;      /* Bytes allocated for heap */
+} eth_tx_batch_t;
+
+/**
+ * @brief Initialise an empty batch
+ *
+ * @param batch Pointer to batch
+ * @param capacity Rows to allocate up front (grows as needed)
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_batch_init(eth_tx_batch_t *batch, size_t capacity);
+
+/**
+ * @brief Release a batch
+ *
+ * @param batch Pointer to batch
+ */
+void eth_tx_batch_free(eth_tx_batch_t *batch);
+
+/**
+ * @brief Remove every transaction, keeping the memory
+ *
+ * @param batch Pointer to batch
+ */
+void eth_tx_batch_clear(eth_tx_batch_t *batch);
+
+/**
+ * @brief Append a transaction (calldata is copied into the heap)
+ *
+ * @param batch Pointer to batch
+ * @param tx Transaction to append (no access list)
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_batch_add(eth_tx_batch_t *batch, const eth_transaction_t *tx);
+
+/**
+ * @brief Load one row as an eth_transaction_t
+ *
+ * tx->data points into the heap and stays valid until the batch is changed.
+ *
+ * @param batch Pointer to batch
+ * @param index Row index
+ * @param tx Output transaction
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_batch_get(const eth_tx_batch_t *batch, size_t index, eth_transaction_t *tx);
+
+/**
+ * @brief Total size of the unsigned encodings of a range of rows
+ *
+ * @param batch Pointer to batch
+ * @param first First row
+ * @param count Number of rows
+ * @return Size in bytes (0 for an invalid range)
+ */
+size_t eth_tx_batch_encoded_size(const eth_tx_batch_t *batch, size_t first, size_t count);
+
+/**
+ * @brief RLP encode a range of rows (unsigned) back to back
+ *
+ * @param batch Pointer to batch
+ * @param first First row
+ * @param count Number of rows
+ * @param buffer Output buffer
+ * @param buffer_size Size of output buffer
+ * @param offsets Output offsets, count + 1 entries: row first + i spans [offsets[i], offsets[i + 1])
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_batch_encode(const eth_tx_batch_t *batch, size_t first, size_t count,
+                        uint8_t *buffer, size_t buffer_size, size_t *offsets);
+
+/**
+ * @brief Compute the signing hash of a range of rows
+ *
+ * @param batch Pointer to batch
+ * @param first First row
+ * @param count Number of rows
+ * @param hashes Output hashes, one per row
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_batch_hash(const eth_tx_batch_t *batch, size_t first, size_t count, eth_hash_t *hashes);
+
+#endif /* ETH_EMBEDDED_TX_BATCH_H */
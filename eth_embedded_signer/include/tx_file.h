@@ -0,0 +1,143 @@
+#ifndef ETH_EMBEDDED_TX_FILE_H
+#define ETH_EMBEDDED_TX_FILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "transaction.h"
+#include "file_map.h"
+
+/*
+ * Memory-mappable batch file of unsigned transactions.
+ *
+ * A fixed header, then one fixed-size record per transaction, then a heap that
+ * holds every transaction's calldata. Records are found by index, so a batch
+ * can be split across threads without parsing it first, and calldata is
+ * handed out as a pointer into the mapping. All integers are little-endian.
+ *
+ * Header (64 bytes):
+ *   offset  size  field
+ *        0     4  magic "ETXB"
+ *        4     2  version (1)
+ *        6     2  header size (64)
+ *        8     2  record size (200)
+ *       10     6  reserved (0)
+ *       16     8  record count
+ *       24     8  offset of the first record
+ *       32     8  offset of the calldata heap
+ *       40     8  size of the calldata heap
+ *       48    16  reserved (0)
+ *
+ * Record (200 bytes):
+ *        0     1  tx_type
+ *        1     1  to_len (0 or 20)
+ *        2     1  value_len
+ *        3     1  gas_price_len
+ *        4     1  max_priority_fee_len
+ *        5     1  max_fee_len
+ *        6     2  reserved (0)
+ *        8     8  chain_id
+ *       16     8  nonce
+ *       24     8  gas_limit
+ *       32     8  calldata offset (into the heap)
+ *       40     4  calldata length
+ *       44     4  reserved (0)
+ *       48    20  to
+ *       68     4  reserved (0)
+ *       72    32  value (big-endian, value_len bytes used)
+ *      104    32  gas_price
+ *      136    32  max_priority_fee
+ *      168    32  max_fee
+ */
+
+#define ETH_TX_FILE_VERSION      1
+#define ETH_TX_FILE_HEADER_SIZE  64
+#define ETH_TX_FILE_RECORD_SIZE  200
+
+/* Batch file reader */
+typedef struct {
+    eth_file_map_t map;      /* Mapping (unused when opened over a buffer) */
+    const uint8_t *records;  /* First record */
+    const uint8_t *heap;     /* Calldata heap */
+    uint64_t count;          /* Number of records */
+    uint64_t heap_size;      /* Size of the calldata heap */
+} eth_tx_file_t;
+
+/* Batch file writer */
+typedef struct {
+    FILE *file;              /* Output file (records are written straight through) */
+    uint8_t *heap;           /* Calldata heap, appended on finish */
+    size_t heap_size;        /* Bytes used in heap */
+    size_t heap_capacity;    /* Bytes allocated for heap */
+    uint64_t count;          /* Records written */
+    int error;               /* Sticky I/O error */
+} eth_tx_file_writer_t;
+
+/**
+ * @brief Map a batch file and validate its header
+ *
+ * @param reader Pointer to reader
+ * @param path Path of the batch file
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_file_open(eth_tx_file_t *reader, const char *path);
+
+/**
+ * @brief Open a batch file that is already in memory
+ *
+ * @param reader Pointer to reader
+ * @param data File contents (must outlive the reader)
+ * @param size Size of the contents
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_file_open_buffer(eth_tx_file_t *reader, const uint8_t *data, size_t size);
+
+/**
+ * @brief Load the transaction at an index
+ *
+ * tx->data points into the mapping: it stays valid until the reader is
+ * closed and must not be written through. Safe to call from several threads.
+ *
+ * @param reader Pointer to reader
+ * @param index Record index
+ * @param tx Output transaction
+ * @return 0 on success, non-zero on error (bad index or malformed record)
+ */
+int eth_tx_file_get(const eth_tx_file_t *reader, uint64_t index, eth_transaction_t *tx);
+
+/**
+ * @brief Unmap a batch file
+ *
+ * @param reader Pointer to reader
+ */
+void eth_tx_file_close(eth_tx_file_t *reader);
+
+/**
+ * @brief Create a batch file
+ *
+ * @param writer Pointer to writer
+ * @param path Path of the batch file
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_file_writer_open(eth_tx_file_writer_t *writer, const char *path);
+
+/**
+ * @brief Append a transaction
+ *
+ * Transactions with a non-empty access list are rejected (not in version 1).
+ *
+ * @param writer Pointer to writer
+ * @param tx Transaction to append
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_file_writer_add(eth_tx_file_writer_t *writer, const eth_transaction_t *tx);
+
+/**
+ * @brief Write the calldata heap and header, then close the file
+ *
+ * @param writer Pointer to writer
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_file_writer_finish(eth_tx_file_writer_t *writer);
+
+#endif /* ETH_EMBEDDED_TX_FILE_H */
@@ -0,0 +1,76 @@
+#ifndef ETH_EMBEDDED_TX_JSON_H
+#define ETH_EMBEDDED_TX_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "transaction.h"
+#include "arena.h"
+
+/*
+ * Reader for unsigned transactions in eth_sendTransaction JSON form:
+ *
+ *   {"type":"0x2","chainId":"0x1","nonce":"0x7","to":"0x...","value":"0xde0b6b3a7640000",
+ *    "gas":"0x5208","maxFeePerGas":"0x...","maxPriorityFeePerGas":"0x...","data":"0x...",
+ *    "accessList":[{"address":"0x...","storageKeys":["0x..."]}]}
+ *
+ * One pass over the input, no heap allocation: quantities are decoded straight
+ * into the transaction (eth_u256_t for value and fees), calldata
+ * and the RLP-encoded access list go into a caller-supplied arena. Objects may
+ * follow each other separated by whitespace, so newline-delimited streams read
+ * one transaction per call.
+ *
+ * Quantities are 0x-prefixed hex strings or plain JSON integers. "input" is
+ * accepted for "data" and "gasLimit" for "gas". "from" is checked to be an
+ * address but otherwise ignored, unknown keys are skipped. Without "type" the
+ * type follows from the fields present (maxFeePerGas: EIP-1559, accessList:
+ * EIP-2930, otherwise legacy), and fields that do not belong to the type are
+ * rejected.
+ */
+
+/* Returned by eth_tx_json_next when the input is exhausted */
+#define ETH_TX_JSON_END 1
+
+/* Streaming reader context */
+typedef struct {
+    const char *input;      /* Input text */
+    size_t size;            /* Size of input */
+    size_t offset;          /* Read position */
+    eth_arena_t *arena;     /* Receives calldata and access lists */
+    size_t error_offset;    /* Input offset of the last error */
+} eth_tx_json_reader_t;
+
+/**
+ * @brief Initialise a reader over a buffer of JSON objects
+ *
+ * @param reader Pointer to reader
+ * @param input Input text (e.g. a mapped file, must outlive the transactions read)
+ * @param size Size of input
+ * @param arena Arena for calldata and access lists
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_json_reader_init(eth_tx_json_reader_t *reader, const char *input, size_t size, eth_arena_t *arena);
+
+/**
+ * @brief Read the next transaction
+ *
+ * tx->data and tx->access_list point into the arena. After an error the reader
+ * skips to the next line, so one bad line does not end a newline-delimited stream.
+ *
+ * @param reader Pointer to reader
+ * @param tx Output transaction
+ * @return 0 on success, ETH_TX_JSON_END at end of input, negative on error (see error_offset)
+ */
+int eth_tx_json_next(eth_tx_json_reader_t *reader, eth_transaction_t *tx);
+
+/**
+ * @brief Parse a single JSON transaction object
+ *
+ * @param json Input text
+ * @param length Length of input
+ * @param tx Output transaction
+ * @param arena Arena for calldata and access lists
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_json_parse(const char *json, size_t length, eth_transaction_t *tx, eth_arena_t *arena);
+
+#endif /* ETH_EMBEDDED_TX_JSON_H */
@@ -0,0 +1,46 @@
+#ifndef ETH_EMBEDDED_TX_ROOT_H
+#define ETH_EMBEDDED_TX_ROOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "arena.h"
+
+/*
+ * Transactions root: the root hash of the ordered Merkle-Patricia trie a
+ * block header commits to, with RLP(index) as key and the raw signed
+ * transaction (as eth_tx_encode_signed writes it) as value.
+ *
+ * The trie is never stored. Keys sort in a known order (1..127, 0, 128, ...)
+ * so every subtree is a contiguous run of transactions, and nodes are hashed
+ * bottom up as the runs are split. With more than one thread the top of the
+ * trie is split into subtrees that are hashed in parallel and the nodes above
+ * them are hashed afterwards. Node buffers come from a caller-supplied arena
+ * (see eth_tx_root_arena_size); nothing is allocated per node.
+ */
+
+/**
+ * @brief Arena space eth_tx_root needs
+ *
+ * @param count Number of transactions
+ * @param threads Number of threads (0 means 1)
+ * @return Size in bytes
+ */
+size_t eth_tx_root_arena_size(size_t count, unsigned threads);
+
+/**
+ * @brief Compute the transactions root of a list of signed transactions
+ *
+ * The arena is returned to its previous state before returning.
+ *
+ * @param raw_txs Raw signed transactions, in block order
+ * @param lengths Length of each raw transaction
+ * @param count Number of transactions (0 gives the empty trie root)
+ * @param arena Scratch arena with at least eth_tx_root_arena_size bytes free
+ * @param threads Number of threads to hash with, including the caller (0 means 1)
+ * @param root Output 32-byte root hash
+ * @return 0 on success, non-zero on error
+ */
+int eth_tx_root(const uint8_t *const *raw_txs, const size_t *lengths, size_t count,
+                eth_arena_t *arena, unsigned threads, uint8_t root[32]);
+
+#endif /* ETH_EMBEDDED_TX_ROOT_H */
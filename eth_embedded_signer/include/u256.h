@@ -0,0 +1,93 @@
+#ifndef ETH_EMBEDDED_U256_H
+#define ETH_EMBEDDED_U256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 256-bit unsigned integer for transaction quantities (value, gas price, fees).
+ *
+ * Stored as four 64-bit limbs, least significant first, so there is no
+ * separate length to keep in sync: the minimal big-endian length is derived
+ * when the value is encoded.
+ */
+
+/* 256-bit unsigned integer */
+typedef struct {
+    uint64_t limb[4];     /* limb[0] holds the least significant 64 bits */
+} eth_u256_t;
+
+/**
+ * @brief Set from a 64-bit integer
+ *
+ * @param value Pointer to value
+ * @param source Integer to set
+ */
+void eth_u256_set_u64(eth_u256_t *value, uint64_t source);
+
+/**
+ * @brief Set from decimal digits
+ *
+ * @param value Pointer to value
+ * @param digits Decimal digits (no sign, no separators)
+ * @param length Number of digits
+ * @return 0 on success, non-zero on error (invalid digit, empty, or larger than 2^256 - 1)
+ */
+int eth_u256_set_dec(eth_u256_t *value, const char *digits, size_t length);
+
+/**
+ * @brief Set from hex digits
+ *
+ * Accepts an optional 0x/0X prefix, either letter case and leading zeros.
+ *
+ * @param value Pointer to value
+ * @param digits Hex digits
+ * @param length Number of characters
+ * @return 0 on success, non-zero on error (invalid digit, empty, or more than 256 bits)
+ */
+int eth_u256_set_hex(eth_u256_t *value, const char *digits, size_t length);
+
+/**
+ * @brief Set from big-endian bytes
+ *
+ * @param value Pointer to value
+ * @param bytes Big-endian bytes
+ * @param length Number of bytes (at most 32)
+ * @return 0 on success, non-zero on error
+ */
+int eth_u256_set_bytes(eth_u256_t *value, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Write as 32 big-endian bytes
+ *
+ * @param value Pointer to value
+ * @param output Output bytes (32)
+ */
+void eth_u256_to_bytes(const eth_u256_t *value, uint8_t output[32]);
+
+/**
+ * @brief Number of bytes in the minimal big-endian form (0 for zero)
+ *
+ * @param value Pointer to value
+ * @return Byte length
+ */
+size_t eth_u256_byte_length(const eth_u256_t *value);
+
+/**
+ * @brief Check for zero
+ *
+ * @param value Pointer to value
+ * @return 1 if zero, 0 otherwise
+ */
+int eth_u256_is_zero(const eth_u256_t *value);
+
+/**
+ * @brief Compare two values
+ *
+ * @param a First value
+ * @param b Second value
+ * @return -1 if a < b, 0 if equal, 1 if a > b
+ */
+int eth_u256_cmp(const eth_u256_t *a, const eth_u256_t *b);
+
+#endif /* ETH_EMBEDDED_U256_H */
@@ -0,0 +1,85 @@
+#ifndef ETH_EMBEDDED_VERIFY_H
+#define ETH_EMBEDDED_VERIFY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crypto.h"
+#include "arena.h"
+#include "ec.h"
+
+/*
+ * ECDSA verification of r || s signatures against a known public key.
+ *
+ * Verification computes u1 * G + u2 * Q. G has a fixed-base table, so u1 * G
+ * is 64 table lookups and mixed additions; a generic Q costs a full windowed
+ * multiply (256 doublings) on top. An eth_verifier_set_t holds the same
+ * table for each of a fixed set of signer keys, so u2 * Q becomes lookups
+ * too and a verification is one scalar inversion plus about 128 additions.
+ *
+ * Tables are 60 KB per key and live back to back in one caller-supplied
+ * arena, each aligned to a cache line (see eth_verifier_set_arena_size).
+ * Building one costs about as much as seven generic verifications, so sets
+ * pay off for keys that sign many messages.
+ */
+
+/* Soft result: the signature is well formed but does not match */
+#define ETH_VERIFY_MISMATCH 1
+
+/* Precomputed tables for a fixed set of signer keys */
+typedef struct {
+    eth_ge_storage_t *tables;    /* capacity tables of ETH_EC_TABLE_SIZE entries */
+    size_t count;                /* Keys added so far */
+    size_t capacity;             /* Keys the arena space was reserved for */
+} eth_verifier_set_t;
+
+/**
+ * @brief Verify a signature against a public key
+ *
+ * @param hash Message hash
+ * @param signature Signature (r || s; s may be high)
+ * @param public_key Public key
+ * @return 0 if the signature is valid, ETH_VERIFY_MISMATCH if not, negative on error
+ */
+int eth_verify(const eth_hash_t *hash, const eth_signature_t *signature, const eth_public_key_t *public_key);
+
+/**
+ * @brief Arena space a verifier set needs
+ *
+ * @param capacity Number of keys
+ * @return Size in bytes
+ */
+size_t eth_verifier_set_arena_size(size_t capacity);
+
+/**
+ * @brief Initialise an empty verifier set
+ *
+ * @param set Pointer to set
+ * @param arena Arena with at least eth_verifier_set_arena_size(capacity) bytes free
+ * @param capacity Number of keys the set can hold
+ * @return 0 on success, non-zero on error
+ */
+int eth_verifier_set_init(eth_verifier_set_t *set, eth_arena_t *arena, size_t capacity);
+
+/**
+ * @brief Add a key and build its table
+ *
+ * @param set Pointer to set
+ * @param public_key Public key
+ * @param key_index Output index of the key in the set (optional)
+ * @return 0 on success, non-zero if the set is full or the key is not on the curve
+ */
+int eth_verifier_set_add(eth_verifier_set_t *set, const eth_public_key_t *public_key, size_t *key_index);
+
+/**
+ * @brief Verify a signature against a key of the set
+ *
+ * @param set Pointer to set
+ * @param key_index Index returned by eth_verifier_set_add
+ * @param hash Message hash
+ * @param signature Signature (r || s; s may be high)
+ * @return 0 if the signature is valid, ETH_VERIFY_MISMATCH if not, negative on error
+ */
+int eth_verify_known(const eth_verifier_set_t *set, size_t key_index, const eth_hash_t *hash,
+                     const eth_signature_t *signature);
+
+#endif /* ETH_EMBEDDED_VERIFY_H */
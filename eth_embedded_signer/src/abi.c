@@ -0,0 +1,596 @@
+#include <string.h>
+#include "../include/abi.h"
+#include "../include/crypto.h"
+#include "abi_selectors.h"
+
+/* Error codes */
+#define ABI_ERROR_NONE          0
+#define ABI_ERROR_INVALID      -1
+#define ABI_ERROR_NO_SPACE     -2
+#define ABI_ERROR_ARGUMENTS    -3
+
+/* ABI word size */
+#define ABI_WORD 32
+
+/* Generated selector table */
+typedef struct {
+    uint32_t selector;
+    const char *signature;
+} abi_selector_entry_t;
+
+#define ABI_SELECTOR_ENTRY(selector, signature) { selector, signature },
+static const abi_selector_entry_t abi_selector_table[ETH_ABI_SELECTOR_COUNT] = {
+    ETH_ABI_SELECTOR_ENTRIES(ABI_SELECTOR_ENTRY)
+};
+#undef ABI_SELECTOR_ENTRY
+
+static const unsigned char abi_signature_order[ETH_ABI_SELECTOR_COUNT] = {
+    ETH_ABI_SIGNATURE_ORDER
+};
+
+/* Compare a table signature with a (not terminated) candidate */
+static int abi_signature_compare(const char *entry, const char *signature, size_t length) {
+    int result = strncmp(entry, signature, length);
+    if (result == 0 && entry[length] != '\0') {
+        result = 1;
+    }
+    return result;
+}
+
+int eth_abi_selector(const char *signature, size_t length, uint32_t *selector) {
+    if (!signature || length == 0 || !selector) {
+        return ABI_ERROR_INVALID;
+    }
+
+    /* Binary search over the table in signature order */
+    size_t low = 0;
+    size_t high = ETH_ABI_SELECTOR_COUNT;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        const abi_selector_entry_t *entry = &abi_selector_table[abi_signature_order[mid]];
+        int result = abi_signature_compare(entry->signature, signature, length);
+        if (result == 0) {
+            *selector = entry->selector;
+            return ABI_ERROR_NONE;
+        }
+        if (result < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    /* Not a known signature: hash it */
+    eth_hash_t hash;
+    int result = eth_keccak256((const uint8_t *)signature, length, &hash);
+    if (result != 0) {
+        return result;
+    }
+    *selector = ((uint32_t)hash.data[0] << 24) | ((uint32_t)hash.data[1] << 16) |
+                ((uint32_t)hash.data[2] << 8) | hash.data[3];
+
+    return ABI_ERROR_NONE;
+}
+
+const char *eth_abi_selector_signature(uint32_t selector) {
+    size_t low = 0;
+    size_t high = ETH_ABI_SELECTOR_COUNT;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (abi_selector_table[mid].selector == selector) {
+            return abi_selector_table[mid].signature;
+        }
+        if (abi_selector_table[mid].selector < selector) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+/* Write the selector big endian */
+static void abi_write_selector(uint8_t *out, uint32_t selector) {
+    out[0] = (uint8_t)(selector >> 24);
+    out[1] = (uint8_t)(selector >> 16);
+    out[2] = (uint8_t)(selector >> 8);
+    out[3] = (uint8_t)selector;
+}
+
+/* Word writers: the word is already zeroed, only the value bytes are written */
+static void abi_write_u64(uint8_t *word, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        word[ABI_WORD - 1 - i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/* Write one static argument taken from a batch column */
+static void abi_write_column(uint8_t *word, const eth_abi_column_t *column, size_t index) {
+    switch (column->type) {
+    case ETH_ABI_ADDRESS:
+        memcpy(word + 12, ((const uint8_t (*)[20])column->values)[index], 20);
+        break;
+    case ETH_ABI_UINT256:
+        eth_u256_to_bytes(&((const eth_u256_t *)column->values)[index], word);
+        break;
+    case ETH_ABI_UINT64:
+        abi_write_u64(word, ((const uint64_t *)column->values)[index]);
+        break;
+    case ETH_ABI_BOOL:
+        word[ABI_WORD - 1] = ((const uint8_t *)column->values)[index] != 0;
+        break;
+    case ETH_ABI_BYTES32:
+        memcpy(word, ((const uint8_t (*)[32])column->values)[index], 32);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Drop everything written since begin */
+static int abi_fail(eth_abi_encoder_t *encoder, int error) {
+    if (encoder->data) {
+        encoder->arena->used = encoder->arena_mark;
+        encoder->data = NULL;
+    }
+    return error;
+}
+
+/* Next head word, or NULL once all arguments are written */
+static uint8_t *abi_next_word(eth_abi_encoder_t *encoder) {
+    if (!encoder || !encoder->data || encoder->next_arg == encoder->arg_count) {
+        return NULL;
+    }
+    return encoder->data + 4 + ABI_WORD * encoder->next_arg++;
+}
+
+/* Append size bytes of tail, which must follow the calldata directly */
+static uint8_t *abi_append(eth_abi_encoder_t *encoder, size_t size) {
+    uint8_t *tail = eth_arena_alloc(encoder->arena, size, 1);
+    if (!tail || tail != encoder->data + encoder->length) {
+        return NULL;
+    }
+    encoder->length += size;
+    return tail;
+}
+
+int eth_abi_encode_begin(eth_abi_encoder_t *encoder, eth_arena_t *arena, uint32_t selector, size_t arg_count) {
+    if (!encoder || !arena || arg_count > (SIZE_MAX - 4) / ABI_WORD) {
+        return ABI_ERROR_INVALID;
+    }
+
+    size_t length = 4 + ABI_WORD * arg_count;
+    size_t mark = arena->used;
+    uint8_t *data = eth_arena_alloc(arena, length, 1);
+    if (!data) {
+        return ABI_ERROR_NO_SPACE;
+    }
+
+    abi_write_selector(data, selector);
+    memset(data + 4, 0, length - 4);
+
+    encoder->arena = arena;
+    encoder->data = data;
+    encoder->arg_count = arg_count;
+    encoder->next_arg = 0;
+    encoder->length = length;
+    encoder->arena_mark = mark;
+
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_address(eth_abi_encoder_t *encoder, const uint8_t address[20]) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word || !address) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    memcpy(word + 12, address, 20);
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_uint(eth_abi_encoder_t *encoder, const eth_u256_t *value) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word || !value) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    eth_u256_to_bytes(value, word);
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_u64(eth_abi_encoder_t *encoder, uint64_t value) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    abi_write_u64(word, value);
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_bool(eth_abi_encoder_t *encoder, int value) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    word[ABI_WORD - 1] = value != 0;
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_bytes32(eth_abi_encoder_t *encoder, const uint8_t value[32]) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word || !value) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    memcpy(word, value, 32);
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_bytes(eth_abi_encoder_t *encoder, const uint8_t *data, size_t length) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word || (!data && length > 0) || length > SIZE_MAX - 2 * ABI_WORD) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    /* Offset from the start of the arguments, then length word and padded contents */
+    abi_write_u64(word, encoder->length - 4);
+
+    size_t padded = (length + ABI_WORD - 1) & ~(size_t)(ABI_WORD - 1);
+    uint8_t *tail = abi_append(encoder, ABI_WORD + padded);
+    if (!tail) {
+        return abi_fail(encoder, ABI_ERROR_NO_SPACE);
+    }
+
+    memset(tail, 0, ABI_WORD);
+    abi_write_u64(tail, length);
+    if (length > 0) {
+        memcpy(tail + ABI_WORD, data, length);
+    }
+    memset(tail + ABI_WORD + length, 0, padded - length);
+
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_put_uint_array(eth_abi_encoder_t *encoder, const eth_u256_t *values, size_t count) {
+    uint8_t *word = abi_next_word(encoder);
+    if (!word || (!values && count > 0) || count > SIZE_MAX / ABI_WORD - 1) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_ARGUMENTS) : ABI_ERROR_INVALID;
+    }
+
+    abi_write_u64(word, encoder->length - 4);
+
+    uint8_t *tail = abi_append(encoder, ABI_WORD * (count + 1));
+    if (!tail) {
+        return abi_fail(encoder, ABI_ERROR_NO_SPACE);
+    }
+
+    memset(tail, 0, ABI_WORD);
+    abi_write_u64(tail, count);
+    for (size_t i = 0; i < count; i++) {
+        eth_u256_to_bytes(&values[i], tail + ABI_WORD * (i + 1));
+    }
+
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_encode_end(eth_abi_encoder_t *encoder, uint8_t **data, size_t *length) {
+    if (!encoder || !encoder->data || !data || !length) {
+        return encoder ? abi_fail(encoder, ABI_ERROR_INVALID) : ABI_ERROR_INVALID;
+    }
+    if (encoder->next_arg != encoder->arg_count) {
+        return abi_fail(encoder, ABI_ERROR_ARGUMENTS);
+    }
+
+    *data = encoder->data;
+    *length = encoder->length;
+    encoder->data = NULL;
+
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_encode_batch(eth_arena_t *arena, uint32_t selector, const eth_abi_column_t *columns,
+                         size_t arg_count, size_t call_count, uint8_t **calldata, size_t *lengths) {
+    if (!arena || (!columns && arg_count > 0) || (call_count > 0 && (!calldata || !lengths)) ||
+        arg_count > (SIZE_MAX - 4) / ABI_WORD) {
+        return ABI_ERROR_INVALID;
+    }
+
+    int all_static = 1;
+    for (size_t i = 0; i < arg_count; i++) {
+        if (columns[i].type > ETH_ABI_BYTES || (!columns[i].values && call_count > 0)) {
+            return ABI_ERROR_INVALID;
+        }
+        if (columns[i].type == ETH_ABI_BYTES) {
+            all_static = 0;
+        }
+    }
+
+    size_t call_size = 4 + ABI_WORD * arg_count;
+
+    if (all_static) {
+        /* Fixed layout: one allocation and one clear for every call */
+        if (call_count > SIZE_MAX / call_size) {
+            return ABI_ERROR_INVALID;
+        }
+        uint8_t *block = eth_arena_alloc(arena, call_size * call_count, 1);
+        if (!block && call_count > 0) {
+            return ABI_ERROR_NO_SPACE;
+        }
+        if (call_count > 0) {
+            memset(block, 0, call_size * call_count);
+        }
+
+        for (size_t n = 0; n < call_count; n++) {
+            uint8_t *call = block + call_size * n;
+            abi_write_selector(call, selector);
+            for (size_t i = 0; i < arg_count; i++) {
+                abi_write_column(call + 4 + ABI_WORD * i, &columns[i], n);
+            }
+            calldata[n] = call;
+            lengths[n] = call_size;
+        }
+
+        return ABI_ERROR_NONE;
+    }
+
+    size_t mark = arena->used;
+
+    for (size_t n = 0; n < call_count; n++) {
+        eth_abi_encoder_t encoder;
+        int result = eth_abi_encode_begin(&encoder, arena, selector, arg_count);
+
+        for (size_t i = 0; i < arg_count && result == 0; i++) {
+            if (columns[i].type == ETH_ABI_BYTES) {
+                const eth_abi_bytes_t *bytes = &((const eth_abi_bytes_t *)columns[i].values)[n];
+                result = eth_abi_put_bytes(&encoder, bytes->data, bytes->length);
+            } else {
+                abi_write_column(abi_next_word(&encoder), &columns[i], n);
+            }
+        }
+        if (result == 0) {
+            result = eth_abi_encode_end(&encoder, &calldata[n], &lengths[n]);
+        }
+
+        if (result != 0) {
+            arena->used = mark;
+            return result;
+        }
+    }
+
+    return ABI_ERROR_NONE;
+}
+
+/* Address in a word: the upper 12 bytes must be zero */
+static const uint8_t *abi_word_address(const uint8_t *word) {
+    uint8_t high = 0;
+    for (int i = 0; i < 12; i++) {
+        high |= word[i];
+    }
+    return high ? NULL : word + 12;
+}
+
+/* Word as a 64-bit integer: the upper 24 bytes must be zero */
+static int abi_word_u64(const uint8_t *word, uint64_t *value) {
+    uint8_t high = 0;
+    uint64_t low = 0;
+
+    for (int i = 0; i < 24; i++) {
+        high |= word[i];
+    }
+    for (int i = 24; i < ABI_WORD; i++) {
+        low = (low << 8) | word[i];
+    }
+    if (high) {
+        return ABI_ERROR_INVALID;
+    }
+
+    *value = low;
+    return ABI_ERROR_NONE;
+}
+
+/* Word as a size (offsets and lengths) */
+static int abi_word_size(const uint8_t *word, size_t *value) {
+    uint64_t low;
+    if (abi_word_u64(word, &low) != 0 || low > SIZE_MAX) {
+        return ABI_ERROR_INVALID;
+    }
+
+    *value = (size_t)low;
+    return ABI_ERROR_NONE;
+}
+
+/* Follow the offset in head word index to a length word and the data after it */
+static int abi_dynamic(const eth_abi_call_t *call, size_t index, size_t element_size,
+                       const uint8_t **data, size_t *count) {
+    const uint8_t *word = eth_abi_word(call, index);
+    size_t offset, length;
+
+    if (!word || abi_word_size(word, &offset) != 0) {
+        return ABI_ERROR_INVALID;
+    }
+    if (offset > call->args_length || call->args_length - offset < ABI_WORD) {
+        return ABI_ERROR_INVALID;
+    }
+    if (abi_word_size(call->args + offset, &length) != 0) {
+        return ABI_ERROR_INVALID;
+    }
+    if (length > (call->args_length - offset - ABI_WORD) / element_size) {
+        return ABI_ERROR_INVALID;
+    }
+
+    *data = call->args + offset + ABI_WORD;
+    *count = length;
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_decode(eth_abi_call_t *call, const uint8_t *calldata, size_t length) {
+    if (!call || !calldata || length < 4) {
+        return ABI_ERROR_INVALID;
+    }
+
+    call->calldata = calldata;
+    call->length = length;
+    call->selector = ((uint32_t)calldata[0] << 24) | ((uint32_t)calldata[1] << 16) |
+                     ((uint32_t)calldata[2] << 8) | calldata[3];
+    call->args = calldata + 4;
+    call->args_length = length - 4;
+
+    return ABI_ERROR_NONE;
+}
+
+const uint8_t *eth_abi_word(const eth_abi_call_t *call, size_t index) {
+    if (!call || index >= call->args_length / ABI_WORD) {
+        return NULL;
+    }
+    return call->args + ABI_WORD * index;
+}
+
+int eth_abi_get_address(const eth_abi_call_t *call, size_t index, const uint8_t **address) {
+    const uint8_t *word = eth_abi_word(call, index);
+    if (!word || !address || !(*address = abi_word_address(word))) {
+        return ABI_ERROR_INVALID;
+    }
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_get_uint(const eth_abi_call_t *call, size_t index, eth_u256_t *value) {
+    const uint8_t *word = eth_abi_word(call, index);
+    if (!word || !value) {
+        return ABI_ERROR_INVALID;
+    }
+    return eth_u256_set_bytes(value, word, ABI_WORD);
+}
+
+int eth_abi_get_u64(const eth_abi_call_t *call, size_t index, uint64_t *value) {
+    const uint8_t *word = eth_abi_word(call, index);
+    if (!word || !value) {
+        return ABI_ERROR_INVALID;
+    }
+
+    return abi_word_u64(word, value);
+}
+
+int eth_abi_get_bool(const eth_abi_call_t *call, size_t index, int *value) {
+    uint64_t word;
+    if (!value || eth_abi_get_u64(call, index, &word) != 0 || word > 1) {
+        return ABI_ERROR_INVALID;
+    }
+    *value = (int)word;
+    return ABI_ERROR_NONE;
+}
+
+int eth_abi_get_bytes(const eth_abi_call_t *call, size_t index, eth_abi_bytes_t *bytes) {
+    if (!bytes) {
+        return ABI_ERROR_INVALID;
+    }
+    return abi_dynamic(call, index, 1, &bytes->data, &bytes->length);
+}
+
+int eth_abi_get_array(const eth_abi_call_t *call, size_t index, const uint8_t **elements, size_t *count) {
+    if (!elements || !count) {
+        return ABI_ERROR_INVALID;
+    }
+    return abi_dynamic(call, index, ABI_WORD, elements, count);
+}
+
+int eth_abi_decode_token_call(const uint8_t *calldata, size_t length, eth_abi_token_call_t *call) {
+    if (!calldata || !call) {
+        return ABI_ERROR_INVALID;
+    }
+    if (length < 4) {
+        return ETH_ABI_NOT_TOKEN_CALL;
+    }
+
+    const uint8_t *args = calldata + 4;
+    uint32_t selector = ((uint32_t)calldata[0] << 24) | ((uint32_t)calldata[1] << 16) |
+                        ((uint32_t)calldata[2] << 8) | calldata[3];
+    size_t words;
+    int has_from = 0;
+
+    /* Selector decides the layout; every fixed layout has an exact length */
+    switch (selector) {
+    case ETH_ABI_SELECTOR_TRANSFER:
+        call->op = ETH_ABI_TOKEN_TRANSFER;
+        words = 2;
+        break;
+    case ETH_ABI_SELECTOR_APPROVE:
+        call->op = ETH_ABI_TOKEN_APPROVE;
+        words = 2;
+        break;
+    case ETH_ABI_SELECTOR_INCREASE_ALLOWANCE:
+        call->op = ETH_ABI_TOKEN_INCREASE_ALLOWANCE;
+        words = 2;
+        break;
+    case ETH_ABI_SELECTOR_DECREASE_ALLOWANCE:
+        call->op = ETH_ABI_TOKEN_DECREASE_ALLOWANCE;
+        words = 2;
+        break;
+    case ETH_ABI_SELECTOR_SET_APPROVAL_FOR_ALL:
+        call->op = ETH_ABI_TOKEN_SET_APPROVAL_FOR_ALL;
+        words = 2;
+        break;
+    case ETH_ABI_SELECTOR_TRANSFER_FROM:
+        call->op = ETH_ABI_TOKEN_TRANSFER_FROM;
+        words = 3;
+        has_from = 1;
+        break;
+    case ETH_ABI_SELECTOR_SAFE_TRANSFER_FROM:
+    case ETH_ABI_SELECTOR_SAFE_TRANSFER_FROM_DATA:
+        call->op = ETH_ABI_TOKEN_SAFE_TRANSFER_FROM;
+        words = selector == ETH_ABI_SELECTOR_SAFE_TRANSFER_FROM ? 3 : 4;
+        has_from = 1;
+        break;
+    default:
+        return ETH_ABI_NOT_TOKEN_CALL;
+    }
+
+    call->selector = selector;
+    call->data.data = NULL;
+    call->data.length = 0;
+
+    if (words == 4) {
+        /* Canonical encoding only: data right after the head, padded to a word */
+        size_t offset, data_length;
+        if (length < 4 + 5 * ABI_WORD ||
+            abi_word_size(args + 3 * ABI_WORD, &offset) != 0 || offset != 4 * ABI_WORD ||
+            abi_word_size(args + 4 * ABI_WORD, &data_length) != 0 ||
+            data_length > length - (4 + 5 * ABI_WORD) ||
+            length - (4 + 5 * ABI_WORD) != ((data_length + ABI_WORD - 1) & ~(size_t)(ABI_WORD - 1))) {
+            return ABI_ERROR_INVALID;
+        }
+        call->data.data = args + 5 * ABI_WORD;
+        call->data.length = data_length;
+    } else if (length != 4 + ABI_WORD * words) {
+        return ABI_ERROR_INVALID;
+    }
+
+    /* from, to, amount occupy the first words in that order */
+    const uint8_t *word = args;
+    call->from = NULL;
+    if (has_from) {
+        call->from = abi_word_address(word);
+        if (!call->from) {
+            return ABI_ERROR_INVALID;
+        }
+        word += ABI_WORD;
+    }
+
+    call->to = abi_word_address(word);
+    if (!call->to) {
+        return ABI_ERROR_INVALID;
+    }
+    word += ABI_WORD;
+
+    eth_u256_set_bytes(&call->amount, word, ABI_WORD);
+    if (call->op == ETH_ABI_TOKEN_SET_APPROVAL_FOR_ALL &&
+        (call->amount.limb[3] | call->amount.limb[2] | call->amount.limb[1] | (call->amount.limb[0] >> 1))) {
+        return ABI_ERROR_INVALID;
+    }
+
+    return ABI_ERROR_NONE;
+}
@@ -0,0 +1,60 @@
+#include "../include/arena.h"
+
+/* Error codes */
+#define ARENA_ERROR_NONE      0
+#define ARENA_ERROR_INVALID  -1
+#define ARENA_ERROR_FULL     -2
+
+int eth_arena_init(eth_arena_t *arena, void *buffer, size_t size) {
+    if (!arena || (!buffer && size > 0)) {
+        return ARENA_ERROR_INVALID;
+    }
+
+    arena->buffer = buffer;
+    arena->size = size;
+    arena->used = 0;
+
+    return ARENA_ERROR_NONE;
+}
+
+void *eth_arena_alloc(eth_arena_t *arena, size_t size, size_t align) {
+    if (!arena || align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    /* Align the actual address, not just the offset */
+    uintptr_t base = (uintptr_t)arena->buffer;
+    uintptr_t start = (base + arena->used + (align - 1)) & ~(uintptr_t)(align - 1);
+    size_t offset = (size_t)(start - base);
+
+    if (offset > arena->size || size > arena->size - offset) {
+        return NULL;
+    }
+
+    arena->used = offset + size;
+    return arena->buffer + offset;
+}
+
+uint8_t *eth_arena_top(eth_arena_t *arena, size_t *available) {
+    if (!arena || !available) {
+        return NULL;
+    }
+
+    *available = arena->size - arena->used;
+    return arena->buffer + arena->used;
+}
+
+int eth_arena_advance(eth_arena_t *arena, size_t length) {
+    if (!arena || length > arena->size - arena->used) {
+        return ARENA_ERROR_FULL;
+    }
+
+    arena->used += length;
+    return ARENA_ERROR_NONE;
+}
+
+void eth_arena_reset(eth_arena_t *arena) {
+    if (arena) {
+        arena->used = 0;
+    }
+}
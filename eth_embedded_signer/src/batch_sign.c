@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/batch_sign.h"
+#include "../include/tx_file.h"
+#include "../include/pipeline.h"
+#include "../include/mpmc_queue.h"
+#include "../include/hex.h"
+#include "../include/rpc_batch.h"
+
+/* Error codes */
+#define BATCH_ERROR_NONE       0
+#define BATCH_ERROR_INVALID   -1
+#define BATCH_ERROR_IO        -2
+#define BATCH_ERROR_NOMEM     -3
+#define BATCH_ERROR_INPUT     ETH_BATCH_UNREADABLE
+#define BATCH_ERROR_FAILED    -5
+#define BATCH_ERROR_MALFORMED ETH_BATCH_MALFORMED
+
+/* Transactions in flight through the pipeline */
+#define BATCH_WINDOW          1024
+
+/* Size of the output write buffer */
+#define BATCH_WRITE_BUFFER    (4u << 20)
+
+/* Requests per JSON-RPC batch when not configured */
+#define BATCH_RPC_DEFAULT     1000
+
+/* Start a new JSON-RPC batch at the end of the write buffer only if this much is left */
+#define BATCH_RPC_MIN_SPACE   (64u << 10)
+
+/* Room for the signed encoding on top of the calldata (header, fields, signature) */
+#define BATCH_ENCODING_SLACK  512
+
+/* One in-flight transaction */
+typedef struct {
+    eth_transaction_t tx;
+    eth_pipeline_job_t job;
+    uint8_t *output;
+    size_t output_size;
+} batch_slot_t;
+
+/* Output side, only touched from the (serialised) emit callback */
+typedef struct {
+    FILE *file;
+    uint8_t *buffer;
+    size_t length;
+    eth_batch_output_t format;
+    eth_rpc_batch_t rpc;          /* JSON-RPC batch being built in the write buffer */
+    int rpc_open;                 /* Set while rpc is in use */
+    unsigned rpc_batch_size;      /* Requests per JSON-RPC batch */
+    uint64_t rpc_next_id;         /* Id of the next request (= input index) */
+    eth_mpmc_queue_t *free_slots;
+    eth_batch_sign_stats_t stats;
+    eth_batch_failure_fn on_failure;
+    void *failure_context;
+    int io_error;
+} batch_writer_t;
+
+/* Write out the buffered records */
+static void batch_flush(batch_writer_t *writer) {
+    if (writer->length > 0 && !writer->io_error) {
+        if (fwrite(writer->buffer, 1, writer->length, writer->file) != writer->length) {
+            writer->io_error = 1;
+        }
+    }
+    writer->length = 0;
+}
+
+/* Reserve space in the write buffer, flushing first if needed */
+static uint8_t *batch_reserve(batch_writer_t *writer, size_t length) {
+    if (writer->length + length > BATCH_WRITE_BUFFER) {
+        batch_flush(writer);
+    }
+    if (length > BATCH_WRITE_BUFFER) {
+        return NULL;
+    }
+
+    uint8_t *p = writer->buffer + writer->length;
+    writer->length += length;
+    return p;
+}
+
+/* Close the open JSON-RPC batch and claim its bytes in the write buffer */
+static void batch_rpc_close(batch_writer_t *writer) {
+    if (!writer->rpc_open) {
+        return;
+    }
+
+    writer->rpc_open = 0;
+    writer->rpc_next_id = eth_rpc_batch_next_id(&writer->rpc);
+
+    /* A batch of failed transactions only moved the ids on */
+    if (writer->rpc.count == 0) {
+        return;
+    }
+
+    size_t length = 0;
+    eth_rpc_batch_finish(&writer->rpc, NULL, &length);
+    writer->length += length;
+    writer->buffer[writer->length++] = '\n';
+}
+
+/* Start a JSON-RPC batch at the end of the write buffer (one byte kept for the newline) */
+static void batch_rpc_open(batch_writer_t *writer) {
+    if (BATCH_WRITE_BUFFER - writer->length < BATCH_RPC_MIN_SPACE) {
+        batch_flush(writer);
+    }
+
+    eth_rpc_batch_init(&writer->rpc, (char *)writer->buffer + writer->length,
+                       BATCH_WRITE_BUFFER - writer->length - 1, writer->rpc_next_id);
+    writer->rpc_open = 1;
+}
+
+/* Add one transaction to the JSON-RPC output, built in place in the write buffer */
+static void batch_write_rpc(batch_writer_t *writer, const uint8_t *data, size_t length) {
+    if (!writer->rpc_open) {
+        batch_rpc_open(writer);
+    }
+
+    if (length == 0) {
+        eth_rpc_batch_skip(&writer->rpc);
+    } else {
+        int result = eth_rpc_batch_add(&writer->rpc, data, length);
+        if (result == ETH_RPC_BATCH_FULL) {
+            /* Out of buffer: ship what we have and retry in an empty one */
+            batch_rpc_close(writer);
+            batch_flush(writer);
+            batch_rpc_open(writer);
+            result = eth_rpc_batch_add(&writer->rpc, data, length);
+        }
+        if (result != 0) {
+            writer->io_error = 1;
+            return;
+        }
+    }
+
+    if (writer->rpc.count == writer->rpc_batch_size) {
+        batch_rpc_close(writer);
+    }
+}
+
+/* Append one record in the configured format */
+static void batch_write_record(batch_writer_t *writer, const uint8_t *data, size_t length) {
+    if (writer->format == ETH_BATCH_OUTPUT_RPC) {
+        batch_write_rpc(writer, data, length);
+    } else if (writer->format == ETH_BATCH_OUTPUT_HEX) {
+        /* "0x" + hex + newline (an empty line for a failed transaction) */
+        uint8_t *p = batch_reserve(writer, length ? length * 2 + 3 : 1);
+        if (!p) {
+            writer->io_error = 1;
+            return;
+        }
+        if (length) {
+            *p++ = '0';
+            *p++ = 'x';
+            eth_hex_encode(data, length, (char *)p, length * 2);
+            p += length * 2;
+        }
+        *p = '\n';
+    } else {
+        uint8_t *p = batch_reserve(writer, length + 4);
+        if (!p) {
+            writer->io_error = 1;
+            return;
+        }
+        p[0] = (uint8_t)length;
+        p[1] = (uint8_t)(length >> 8);
+        p[2] = (uint8_t)(length >> 16);
+        p[3] = (uint8_t)(length >> 24);
+        memcpy(p + 4, data, length);
+    }
+}
+
+/* Pipeline emit callback: write the record and recycle the slot */
+static void batch_emit(eth_pipeline_job_t *job, void *context) {
+    batch_writer_t *writer = context;
+    batch_slot_t *slot = job->user_data;
+
+    if (job->status == 0) {
+        batch_write_record(writer, job->output, job->output_len);
+        writer->stats.signed_count++;
+    } else {
+        /* Sequence numbers are input indexes: records are submitted in file order */
+        batch_write_record(writer, NULL, 0);
+        writer->stats.failed_count++;
+        if (job->status == ETH_POLICY_DENIED) {
+            writer->stats.denied_count++;
+        }
+        if (writer->on_failure) {
+            writer->on_failure(job->sequence, job->status, job->policy_result, writer->failure_context);
+        }
+    }
+
+    unsigned spins = 0;
+    while (eth_mpmc_queue_push(writer->free_slots, slot) != 0) {
+        eth_mpmc_backoff(&spins);
+    }
+}
+
+/* Make sure a slot's output buffer can hold the signed encoding of tx */
+static int batch_slot_fit(batch_slot_t *slot, size_t data_len) {
+    size_t needed = data_len + BATCH_ENCODING_SLACK;
+
+    if (slot->output_size >= needed) {
+        return BATCH_ERROR_NONE;
+    }
+
+    uint8_t *output = realloc(slot->output, needed);
+    if (!output) {
+        return BATCH_ERROR_NOMEM;
+    }
+    slot->output = output;
+    slot->output_size = needed;
+
+    return BATCH_ERROR_NONE;
+}
+
+int eth_batch_sign_file(const eth_batch_sign_options_t *options, eth_batch_sign_stats_t *stats) {
+    if (!options || !options->input_path || !options->output_path || !options->private_key) {
+        return BATCH_ERROR_INVALID;
+    }
+
+    int result = BATCH_ERROR_NONE;
+    eth_tx_file_t input;
+    batch_writer_t writer;
+    eth_mpmc_queue_t free_slots;
+    batch_slot_t *slots = NULL;
+    int to_stdout = strcmp(options->output_path, "-") == 0;
+
+    memset(&writer, 0, sizeof(writer));
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+
+    if (eth_tx_file_open(&input, options->input_path) != 0) {
+        return BATCH_ERROR_INPUT;
+    }
+
+    writer.file = to_stdout ? stdout : fopen(options->output_path, "wb");
+    writer.buffer = malloc(BATCH_WRITE_BUFFER);
+    writer.format = options->format;
+    writer.rpc_batch_size = options->rpc_batch_size ? options->rpc_batch_size : BATCH_RPC_DEFAULT;
+    writer.free_slots = &free_slots;
+    writer.on_failure = options->on_failure;
+    writer.failure_context = options->failure_context;
+    slots = calloc(BATCH_WINDOW, sizeof(batch_slot_t));
+
+    if (!writer.file || !writer.buffer || !slots || eth_mpmc_queue_init(&free_slots, BATCH_WINDOW) != 0) {
+        if (writer.file && !to_stdout) fclose(writer.file);
+        free(writer.buffer);
+        free(slots);
+        eth_tx_file_close(&input);
+        return writer.file ? BATCH_ERROR_NOMEM : BATCH_ERROR_IO;
+    }
+
+    for (size_t i = 0; i < BATCH_WINDOW; i++) {
+        eth_mpmc_queue_push(&free_slots, &slots[i]);
+    }
+
+    /* ECDSA gets the requested threads, the cheap stages a quarter of that */
+    unsigned threads = options->threads ? options->threads : 1;
+    eth_pipeline_config_t config;
+    eth_pipeline_config_default(&config);
+    config.max_in_flight = BATCH_WINDOW;
+    config.sign_threads = threads;
+    config.encode_threads = (threads + 3) / 4;
+    config.emit_threads = (threads + 3) / 4;
+    config.emit = batch_emit;
+    config.emit_context = &writer;
+
+    eth_pipeline_t pipeline;
+    if (eth_pipeline_init(&pipeline, &config) != 0) {
+        result = BATCH_ERROR_NOMEM;
+        goto cleanup;
+    }
+
+    /* Feed records in file order, reusing slots as they are emitted */
+    for (uint64_t index = 0; index < input.count; index++) {
+        void *item;
+        unsigned spins = 0;
+        while (eth_mpmc_queue_pop(&free_slots, &item) != 0) {
+            eth_mpmc_backoff(&spins);
+        }
+        batch_slot_t *slot = item;
+
+        if (eth_tx_file_get(&input, index, &slot->tx) != 0) {
+            /* A malformed record stops the batch */
+            writer.stats.malformed_index = index;
+            result = BATCH_ERROR_MALFORMED;
+            break;
+        }
+
+        if (batch_slot_fit(slot, slot->tx.data_len) != 0) {
+            result = BATCH_ERROR_NOMEM;
+            break;
+        }
+
+        memset(&slot->job, 0, sizeof(slot->job));
+        slot->job.tx = &slot->tx;
+        slot->job.private_key = options->private_key;
+        slot->job.policy = options->policy;
+        slot->job.output = slot->output;
+        slot->job.output_size = slot->output_size;
+        slot->job.user_data = slot;
+
+        if (eth_pipeline_submit(&pipeline, &slot->job) != 0) {
+            result = BATCH_ERROR_FAILED;
+            break;
+        }
+    }
+
+    eth_pipeline_destroy(&pipeline);
+    batch_rpc_close(&writer);
+    batch_flush(&writer);
+
+    if (writer.io_error || fflush(writer.file) != 0) {
+        result = BATCH_ERROR_IO;
+    }
+    if (result == BATCH_ERROR_NONE && writer.stats.failed_count > 0) {
+        result = BATCH_ERROR_FAILED;
+    }
+
+cleanup:
+    if (stats) {
+        *stats = writer.stats;
+    }
+    if (!to_stdout && fclose(writer.file) != 0 && result == BATCH_ERROR_NONE) {
+        result = BATCH_ERROR_IO;
+    }
+    for (size_t i = 0; i < BATCH_WINDOW; i++) {
+        free(slots[i].output);
+    }
+    free(slots);
+    free(writer.buffer);
+    eth_mpmc_queue_free(&free_slots);
+    eth_tx_file_close(&input);
+
+    return result;
+}
@@ -0,0 +1,179 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "../include/cpu.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define CPU_HAVE_X86 1
+#endif
+
+/* Error codes */
+#define CPU_ERROR_NONE       0
+#define CPU_ERROR_TRUNCATED -1
+
+/* Marks a cached feature word as probed (never a feature) */
+#define CPU_PROBED (1u << 31)
+
+/* Feature names, with the features each one implies */
+typedef struct {
+    const char *name;
+    uint32_t features;
+} cpu_feature_name_t;
+
+static const cpu_feature_name_t cpu_names[] = {
+    { "baseline", 0 },
+    { "ssse3", ETH_CPU_SSSE3 },
+    { "sse4.1", ETH_CPU_SSE41 | ETH_CPU_SSSE3 },
+    { "avx2", ETH_CPU_AVX2 | ETH_CPU_SSE41 | ETH_CPU_SSSE3 },
+    { "bmi2", ETH_CPU_BMI2 },
+    { "sha", ETH_CPU_SHA | ETH_CPU_SSE41 | ETH_CPU_SSSE3 },
+    { "avx512", ETH_CPU_AVX512 | ETH_CPU_AVX2 | ETH_CPU_SSE41 | ETH_CPU_SSSE3 },
+    { "mul64", ETH_CPU_MUL64 },
+};
+
+#define CPU_NAME_COUNT (sizeof(cpu_names) / sizeof(cpu_names[0]))
+
+#if defined(CPU_HAVE_X86)
+
+/* XCR0: which register states the OS saves on context switches */
+static uint64_t cpu_xgetbv(void) {
+    uint32_t low, high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return ((uint64_t)high << 32) | low;
+}
+
+static uint32_t cpu_probe_x86(void) {
+    unsigned eax, ebx, ecx, edx;
+    uint32_t features = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    if (ecx & (1u << 9)) {
+        features |= ETH_CPU_SSSE3;
+    }
+    if (ecx & (1u << 19)) {
+        features |= ETH_CPU_SSE41;
+    }
+
+    /* AVX needs OSXSAVE and the XMM/YMM states enabled; AVX-512 also the opmask/ZMM states */
+    int os_avx = 0, os_avx512 = 0;
+    if ((ecx & (1u << 27)) && (ecx & (1u << 28))) {
+        uint64_t xcr0 = cpu_xgetbv();
+        os_avx = (xcr0 & 0x06) == 0x06;
+        os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+    }
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        if (os_avx && (ebx & (1u << 5))) {
+            features |= ETH_CPU_AVX2;
+        }
+        if ((ebx & (1u << 3)) && (ebx & (1u << 8))) {
+            features |= ETH_CPU_BMI2;
+        }
+        if ((ebx & (1u << 29)) && (features & ETH_CPU_SSE41)) {
+            features |= ETH_CPU_SHA;
+        }
+        if (os_avx512 && (ebx & (1u << 16)) && (ebx & (1u << 31))) {
+            features |= ETH_CPU_AVX512;
+        }
+    }
+
+    return features;
+}
+
+#endif /* CPU_HAVE_X86 */
+
+static uint32_t cpu_probe(void) {
+    uint32_t features = 0;
+
+#if defined(__SIZEOF_INT128__)
+    features |= ETH_CPU_MUL64;
+#endif
+#if defined(CPU_HAVE_X86)
+    features |= cpu_probe_x86();
+#endif
+    return features;
+}
+
+/* Features allowed by ETH_SIGNER_CPU (all of them when it is unset or "native") */
+static uint32_t cpu_override(void) {
+    const char *value = getenv(ETH_CPU_ENV);
+    if (!value || *value == '\0' || strcmp(value, "native") == 0) {
+        return ~CPU_PROBED;
+    }
+    if (strcmp(value, "scalar") == 0) {
+        return 0;
+    }
+
+    uint32_t allowed = ETH_CPU_MUL64;
+    while (*value) {
+        size_t length = strcspn(value, ",");
+        for (size_t i = 0; i < CPU_NAME_COUNT; i++) {
+            if (strlen(cpu_names[i].name) == length && strncmp(value, cpu_names[i].name, length) == 0) {
+                allowed |= cpu_names[i].features;
+            }
+        }
+        value += length;
+        if (*value == ',') {
+            value++;
+        }
+    }
+    return allowed;
+}
+
+uint32_t eth_cpu_detected(void) {
+    /* Racing first calls all probe the same bits, so relaxed ordering is enough */
+    static _Atomic uint32_t detected = 0;
+    uint32_t features = atomic_load_explicit(&detected, memory_order_relaxed);
+
+    if (!(features & CPU_PROBED)) {
+        features = cpu_probe() | CPU_PROBED;
+        atomic_store_explicit(&detected, features, memory_order_relaxed);
+    }
+    return features & ~CPU_PROBED;
+}
+
+uint32_t eth_cpu_features(void) {
+    static _Atomic uint32_t usable = 0;
+    uint32_t features = atomic_load_explicit(&usable, memory_order_relaxed);
+
+    if (!(features & CPU_PROBED)) {
+        features = (eth_cpu_detected() & cpu_override()) | CPU_PROBED;
+        atomic_store_explicit(&usable, features, memory_order_relaxed);
+    }
+    return features & ~CPU_PROBED;
+}
+
+int eth_cpu_describe(uint32_t features, char *output, size_t size) {
+    static const char *const names[] = { "ssse3", "sse4.1", "avx2", "bmi2", "sha", "avx512", "mul64" };
+    size_t used = 0;
+    int result = CPU_ERROR_NONE;
+
+    if (!output || size == 0) {
+        return CPU_ERROR_TRUNCATED;
+    }
+
+    output[0] = '\0';
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!(features & (1u << i))) {
+            continue;
+        }
+        size_t length = strlen(names[i]) + (used > 0);
+        if (used + length >= size) {
+            result = CPU_ERROR_TRUNCATED;
+            break;
+        }
+        if (used > 0) {
+            output[used++] = ' ';
+        }
+        memcpy(output + used, names[i], strlen(names[i]) + 1);
+        used += strlen(names[i]);
+    }
+    return result;
+}
+
+void eth_cpu_init(void) {
+    eth_cpu_features();
+}
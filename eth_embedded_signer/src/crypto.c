@@ -1,10 +1,14 @@
 #include <string.h>
 #include "../include/crypto.h"
+#include "../include/keccak.h"
+#include "../include/ec.h"
+#include "../include/rfc6979.h"
 
 /*
- * NOTE: This is a stub implementation for demonstration purposes.
- * In a real implementation, you would need to include proper cryptographic libraries
- * such as mbedtls, wolfSSL, or a specialized ECC library for embedded systems.
+ * NOTE: Keccak-256, ECDSA (with RFC 6979 nonces) and public key derivation
+ * are implemented here on top of keccak.c, ec.c and rfc6979.c. None of this
+ * has been audited; a production signer should still be checked against an
+ * established library such as libsecp256k1.
  */
 
 /* Error codes */
@@ -12,10 +16,13 @@
 #define CRYPTO_ERROR_INVALID    -1
 #define CRYPTO_ERROR_UNSUPPORTED -2
 
-/*
- * Keccak-256 hash function stub
- * In a real implementation, this would call a proper Keccak-256 implementation
- */
+/* Signatures whose nonces eth_sign_batch derives together (about 300 bytes of stack each) */
+#ifndef ETH_SIGN_BATCH_CHUNK
+#define ETH_SIGN_BATCH_CHUNK 16
+#endif
+#define CRYPTO_SIGN_CHUNK ETH_SIGN_BATCH_CHUNK
+
+/* Keccak-256 hash function (one-shot wrapper over keccak.h) */
 int eth_keccak256(const eth_byte_t *input, size_t input_len, eth_hash_t *output) {
     if (!input && input_len > 0) {
         return CRYPTO_ERROR_INVALID;
@@ -25,85 +32,194 @@ int eth_keccak256(const eth_byte_t *input, size_t input_len, eth_hash_t *output)
         return CRYPTO_ERROR_INVALID;
     }
     
-    /* 
-     * STUB: In a real implementation, you would compute the actual Keccak-256 hash.
-     * For demonstration, we create a deterministic fake hash based on input data.
-     */
-    memset(output->data, 0, sizeof(output->data));
-    
-    /* Create a fake hash based on input length and first/last bytes */
-    output->data[0] = (input_len >> 24) & 0xFF;
-    output->data[1] = (input_len >> 16) & 0xFF;
-    output->data[2] = (input_len >> 8) & 0xFF;
-    output->data[3] = input_len & 0xFF;
-    
-    /* If there's input data, use it to influence the hash */
+    eth_keccak_ctx_t ctx;
+    eth_keccak256_init(&ctx);
     if (input_len > 0) {
-        output->data[4] = input[0];
-        output->data[5] = input[input_len / 2];
-        output->data[6] = input[input_len - 1];
-        
-        /* XOR the input bytes with the hash bytes */
-        for (size_t i = 0; i < input_len && i < 32; i++) {
-            output->data[i % 32] ^= input[i];
-        }
+        eth_keccak256_update(&ctx, input, input_len);
     }
+    eth_keccak256_final(&ctx, output->data);
     
     return CRYPTO_ERROR_NONE;
 }
 
 /*
- * ECDSA signing function stub
- * In a real implementation, this would perform actual ECDSA signing on the secp256k1 curve
+ * Finish an ECDSA signature from the nonce point R = k * G and 1 / k:
+ * r = R.x mod n, s = (z + r * d) / k, normalised to the low half (EIP-2).
  */
+static int sign_finish(const eth_hash_t *msg_hash, const eth_scalar_t *d, const eth_ge_t *nonce_point,
+                       const eth_scalar_t *nonce_inverse, eth_signature_t *signature, uint8_t *recovery_id) {
+    eth_scalar_t r, z, s;
+    uint8_t x[32];
+
+    eth_fe_get_bytes(x, &nonce_point->x);
+    int overflow = eth_scalar_set_bytes(&r, x);
+
+    eth_scalar_set_bytes(&z, msg_hash->data);
+    eth_scalar_mul(&s, &r, d);
+    eth_scalar_add(&s, &s, &z);
+    eth_scalar_mul(&s, &s, nonce_inverse);
+
+    /* Bit 0: parity of R.y; bit 1: R.x was at least n. Negating s negates R. */
+    uint8_t id = (uint8_t)(eth_fe_is_odd(&nonce_point->y) | (overflow << 1));
+    if (eth_scalar_is_high(&s)) {
+        eth_scalar_negate(&s, &s);
+        id ^= 1;
+    }
+
+    if (eth_scalar_is_zero(&r) || eth_scalar_is_zero(&s)) {
+        return CRYPTO_ERROR_INVALID;
+    }
+
+    eth_scalar_get_bytes(signature->data, &r);
+    eth_scalar_get_bytes(signature->data + 32, &s);
+    if (recovery_id) {
+        *recovery_id = id;
+    }
+    return CRYPTO_ERROR_NONE;
+}
+
+/* ECDSA signing with an RFC 6979 nonce */
 int eth_sign(const eth_hash_t *msg_hash, const eth_private_key_t *private_key, eth_signature_t *signature) {
+    return eth_sign_recoverable(msg_hash, private_key, signature, NULL);
+}
+
+int eth_sign_recoverable(const eth_hash_t *msg_hash, const eth_private_key_t *private_key,
+                         eth_signature_t *signature, uint8_t *recovery_id) {
     if (!msg_hash || !private_key || !signature) {
         return CRYPTO_ERROR_INVALID;
     }
-    
-    /* 
-     * STUB: In a real implementation, you would compute the actual ECDSA signature.
-     * For demonstration, we create a deterministic fake signature.
-     */
-    
-    /* Create fake R value for signature (first 32 bytes) */
-    for (int i = 0; i < 32; i++) {
-        signature->data[i] = private_key->data[i] ^ msg_hash->data[i];
-    }
-    
-    /* Create fake S value for signature (last 32 bytes) */
-    for (int i = 0; i < 32; i++) {
-        signature->data[i + 32] = private_key->data[i] ^ msg_hash->data[31 - i];
+
+    uint8_t nonce[32];
+    int result = eth_rfc6979_nonce(private_key, msg_hash, nonce);
+    if (result != CRYPTO_ERROR_NONE) {
+        return result;
     }
-    
-    return CRYPTO_ERROR_NONE;
+
+    eth_scalar_t d, k;
+    eth_gej_t point;
+    eth_ge_t affine;
+    eth_scalar_set_bytes(&d, private_key->data);
+    eth_scalar_set_bytes(&k, nonce);
+    eth_ec_mul_gen(&point, &k);
+    eth_ge_set_gej(&affine, &point);
+    eth_scalar_inv(&k, &k);
+    result = sign_finish(msg_hash, &d, &affine, &k, signature, recovery_id);
+
+    memset(nonce, 0, sizeof(nonce));
+    memset(&d, 0, sizeof(d));
+    memset(&k, 0, sizeof(k));
+    memset(&point, 0, sizeof(point));
+    memset(&affine, 0, sizeof(affine));
+    return result;
 }
 
+/* Per-chunk state of eth_sign_batch */
+typedef struct {
+    uint8_t nonces[CRYPTO_SIGN_CHUNK][32];
+    eth_scalar_t k[CRYPTO_SIGN_CHUNK];
+    eth_scalar_t k_inverse[CRYPTO_SIGN_CHUNK];
+    eth_gej_t points[CRYPTO_SIGN_CHUNK];
+    eth_ge_t affine[CRYPTO_SIGN_CHUNK];
+} crypto_sign_chunk_t;
+
 /*
- * Public key recovery function stub
- * In a real implementation, this would perform actual ECDSA recovery on the secp256k1 curve
+ * The nonces of a chunk are derived side by side, and the chunk shares one
+ * field inversion (R to affine) and one scalar inversion (1 / k) through
+ * Montgomery's trick. R is never infinity, so the batch conversion's only
+ * branch does not depend on secrets.
  */
+int eth_sign_batch(const eth_hash_t *msg_hashes, const eth_private_key_t *private_keys, size_t count,
+                   eth_signature_t *signatures, uint8_t *recovery_ids) {
+    if ((!msg_hashes || !private_keys || !signatures) && count > 0) {
+        return CRYPTO_ERROR_INVALID;
+    }
+
+    crypto_sign_chunk_t chunk;
+    int result = CRYPTO_ERROR_NONE;
+
+    for (size_t first = 0; first < count && result == CRYPTO_ERROR_NONE; first += CRYPTO_SIGN_CHUNK) {
+        size_t size = count - first < CRYPTO_SIGN_CHUNK ? count - first : CRYPTO_SIGN_CHUNK;
+        result = eth_rfc6979_nonce_batch(private_keys + first, msg_hashes + first, size, chunk.nonces[0]);
+        if (result != CRYPTO_ERROR_NONE) {
+            break;
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            eth_scalar_set_bytes(&chunk.k[i], chunk.nonces[i]);
+            eth_ec_mul_gen(&chunk.points[i], &chunk.k[i]);
+        }
+        eth_ge_set_all_gej_var(chunk.affine, chunk.points, size);
+        eth_scalar_inv_all(chunk.k_inverse, chunk.k, size);
+
+        for (size_t i = 0; i < size && result == CRYPTO_ERROR_NONE; i++) {
+            eth_scalar_t d;
+            eth_scalar_set_bytes(&d, private_keys[first + i].data);
+            result = sign_finish(&msg_hashes[first + i], &d, &chunk.affine[i], &chunk.k_inverse[i],
+                                 &signatures[first + i], recovery_ids ? &recovery_ids[first + i] : NULL);
+            memset(&d, 0, sizeof(d));
+        }
+    }
+
+    memset(&chunk, 0, sizeof(chunk));
+    return result;
+}
+
+/* Public key recovery: Q = (s * R - z * G) / r, with R the point of x = r and the given parity */
 int eth_recover_public_key(const eth_signature_t *signature, const eth_hash_t *msg_hash, 
                           uint8_t recovery_id, eth_public_key_t *public_key) {
     if (!signature || !msg_hash || recovery_id > 1 || !public_key) {
         return CRYPTO_ERROR_INVALID;
     }
     
-    /* 
-     * STUB: In a real implementation, you would recover the public key from the signature.
-     * For demonstration, we create a deterministic fake public key.
-     */
+    eth_scalar_t r, s, z, u1, u2;
+    if (eth_scalar_set_bytes(&r, signature->data) || eth_scalar_is_zero(&r) ||
+        eth_scalar_set_bytes(&s, signature->data + 32) || eth_scalar_is_zero(&s)) {
+        return CRYPTO_ERROR_INVALID;
+    }
+    
+    eth_fe_t x;
+    eth_ge_t point;
+    if (eth_fe_set_bytes(&x, signature->data) != 0 || eth_ge_set_xo(&point, &x, recovery_id & 1) != 0) {
+        return CRYPTO_ERROR_INVALID;
+    }
+    
+    eth_scalar_set_bytes(&z, msg_hash->data);
+    eth_scalar_inv(&r, &r);
+    eth_scalar_mul(&u1, &z, &r);
+    eth_scalar_negate(&u1, &u1);
+    eth_scalar_mul(&u2, &s, &r);
+    
+    eth_gej_t q;
+    eth_ec_mul_var(&q, &point, &u2);
+    eth_ec_mul_gen_add_var(&q, &u1);
+    if (q.infinity) {
+        return CRYPTO_ERROR_INVALID;
+    }
+    
+    eth_ge_set_gej(&point, &q);
+    eth_ge_get_public_key(public_key, &point);
     
-    /* Create fake X coordinate (first 32 bytes) */
-    for (int i = 0; i < 32; i++) {
-        public_key->data[i] = signature->data[i] ^ msg_hash->data[i] ^ recovery_id;
+    return CRYPTO_ERROR_NONE;
+}
+
+/* Public key derivation: k * G on secp256k1 */
+int eth_private_key_to_public_key(const eth_private_key_t *private_key, eth_public_key_t *public_key) {
+    if (!private_key || !public_key) {
+        return CRYPTO_ERROR_INVALID;
     }
     
-    /* Create fake Y coordinate (last 32 bytes) */
-    for (int i = 0; i < 32; i++) {
-        public_key->data[i + 32] = signature->data[i + 32] ^ msg_hash->data[31 - i] ^ recovery_id;
+    eth_scalar_t k;
+    if (eth_scalar_set_bytes(&k, private_key->data) || eth_scalar_is_zero(&k)) {
+        return CRYPTO_ERROR_INVALID;
     }
     
+    eth_gej_t point;
+    eth_ge_t affine;
+    eth_ec_mul_gen(&point, &k);
+    eth_ge_set_gej(&affine, &point);
+    eth_ge_get_public_key(public_key, &affine);
+    
+    memset(&k, 0, sizeof(k));
     return CRYPTO_ERROR_NONE;
 }
 
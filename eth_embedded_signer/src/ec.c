@@ -0,0 +1,1115 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "../include/ec.h"
+#include "../include/cpu.h"
+
+#if ETH_EC_LIMB64 && defined(__SIZEOF_INT128__)
+#define EC_HAVE_INT128 1
+#endif
+
+/* p = 2^256 - 2^32 - 977 */
+static const uint32_t ec_p[8] = {
+    0xFFFFFC2F, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
+};
+
+/* 2^256 - p */
+static const uint32_t ec_p_complement[8] = { 0x000003D1, 0x00000001, 0, 0, 0, 0, 0, 0 };
+
+/* Group order n */
+static const uint32_t ec_n[8] = {
+    0xD0364141, 0xBFD25E8C, 0xAF48A03B, 0xBAAEDCE6, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
+};
+
+/* 2^256 - n */
+static const uint32_t ec_n_complement[8] = { 0x2FC9BEBF, 0x402DA173, 0x50B75FC4, 0x45512319, 0x00000001, 0, 0, 0 };
+
+/* Generator, as an uncompressed public key */
+static const uint8_t ec_generator[64] = {
+    0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62, 0x95, 0xCE, 0x87, 0x0B, 0x07,
+    0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8, 0x17, 0x98,
+    0x48, 0x3A, 0xDA, 0x77, 0x26, 0xA3, 0xC4, 0x65, 0x5D, 0xA4, 0xFB, 0xFC, 0x0E, 0x11, 0x08, 0xA8,
+    0xFD, 0x17, 0xB4, 0x48, 0xA6, 0x85, 0x54, 0x19, 0x9C, 0x47, 0xD0, 0x8F, 0xFB, 0x10, 0xD4, 0xB8
+};
+
+/* (n - 1) / 2: scalars above it are "high" (EIP-2 rejects signatures with a high s) */
+static const uint32_t ec_n_half[8] = {
+    0x681B20A0, 0xDFE92F46, 0x57A4501D, 0x5D576E73, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF
+};
+
+/* n - 2, the exponent of scalar inversion */
+static const uint32_t ec_n_minus_2[8] = {
+    0xD036413F, 0xBFD25E8C, 0xAF48A03B, 0xBAAEDCE6, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
+};
+
+/*
+ * Table of the generator. Normally generated at build time into .rodata;
+ * builds without the generation step (the table generator itself) define
+ * ETH_EC_GEN_TABLE_RUNTIME and build it once per process on first use.
+ */
+#if defined(ETH_EC_GEN_TABLE_RUNTIME)
+#include <pthread.h>
+#define EC_GEN_TABLE_BITS ETH_EC_GEN_TABLE_BITS
+static eth_ge_storage_t ec_gen_table[ETH_EC_TABLE_SIZE_FOR(EC_GEN_TABLE_BITS)];
+static pthread_once_t ec_gen_once = PTHREAD_ONCE_INIT;
+#else
+#include "ec_gen_table.h"
+#if EC_GEN_TABLE_BITS != ETH_EC_GEN_TABLE_BITS
+#error "ec_gen_table.h was generated for another ETH_EC_GEN_TABLE_BITS; regenerate it"
+#endif
+#endif
+
+#define EC_GEN_WINDOWS ETH_EC_TABLE_WINDOWS_FOR(EC_GEN_TABLE_BITS)
+#define EC_GEN_ENTRIES ETH_EC_TABLE_ENTRIES_FOR(EC_GEN_TABLE_BITS)
+
+/* Points normalized together while building a table */
+#define EC_TABLE_BATCH 16
+
+/* Limb helpers */
+
+static uint32_t limbs_add(uint32_t r[8], const uint32_t a[8], const uint32_t b[8]) {
+    uint64_t acc = 0;
+    for (int i = 0; i < 8; i++) {
+        acc += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)acc;
+        acc >>= 32;
+    }
+    return (uint32_t)acc;
+}
+
+static uint32_t limbs_sub(uint32_t r[8], const uint32_t a[8], const uint32_t b[8]) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t diff = (uint64_t)a[i] - b[i] - borrow;
+        r[i] = (uint32_t)diff;
+        borrow = diff >> 63;
+    }
+    return (uint32_t)borrow;
+}
+
+/* r = mask ? a : r */
+static void limbs_cmov(uint32_t r[8], const uint32_t a[8], uint32_t mask) {
+    for (int i = 0; i < 8; i++) {
+        r[i] = (r[i] & ~mask) | (a[i] & mask);
+    }
+}
+
+/*
+ * Reduce r (below 2^256) once more if r >= m, where complement = 2^256 - m:
+ * r >= m exactly when r + complement carries out. 'carry' folds in a 2^256
+ * already carried out of r. Returns non-zero if a reduction happened.
+ */
+static uint32_t limbs_reduce(uint32_t r[8], uint32_t carry, const uint32_t complement[8]) {
+    uint32_t t[8];
+    carry |= limbs_add(t, r, complement);
+    limbs_cmov(r, t, 0 - carry);
+    return carry;
+}
+
+static void limbs_set_bytes(uint32_t r[8], const uint8_t bytes[32]) {
+    for (int i = 0; i < 8; i++) {
+        const uint8_t *word = bytes + 28 - 4 * i;
+        r[i] = ((uint32_t)word[0] << 24) | ((uint32_t)word[1] << 16) | ((uint32_t)word[2] << 8) | word[3];
+    }
+}
+
+static void limbs_get_bytes(uint8_t bytes[32], const uint32_t a[8]) {
+    for (int i = 0; i < 8; i++) {
+        uint8_t *word = bytes + 28 - 4 * i;
+        word[0] = (uint8_t)(a[i] >> 24);
+        word[1] = (uint8_t)(a[i] >> 16);
+        word[2] = (uint8_t)(a[i] >> 8);
+        word[3] = (uint8_t)a[i];
+    }
+}
+
+static int limbs_is_zero(const uint32_t a[8]) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits |= a[i];
+    }
+    return bits == 0;
+}
+
+/* t = a * b, 512 bits */
+static void limbs_mul(uint32_t t[16], const uint32_t a[8], const uint32_t b[8]) {
+    memset(t, 0, 16 * sizeof(uint32_t));
+    for (int i = 0; i < 8; i++) {
+        uint64_t acc = 0;
+        for (int j = 0; j < 8; j++) {
+            acc += (uint64_t)a[i] * b[j] + t[i + j];
+            t[i + j] = (uint32_t)acc;
+            acc >>= 32;
+        }
+        t[i + 8] = (uint32_t)acc;
+    }
+}
+
+/* Field */
+
+int eth_fe_set_bytes(eth_fe_t *r, const uint8_t bytes[32]) {
+    limbs_set_bytes(r->n, bytes);
+    return limbs_reduce(r->n, 0, ec_p_complement) ? -1 : 0;
+}
+
+void eth_fe_get_bytes(uint8_t bytes[32], const eth_fe_t *a) {
+    limbs_get_bytes(bytes, a->n);
+}
+
+void eth_fe_set_u32(eth_fe_t *r, uint32_t value) {
+    memset(r, 0, sizeof(*r));
+    r->n[0] = value;
+}
+
+int eth_fe_is_zero(const eth_fe_t *a) {
+    return limbs_is_zero(a->n);
+}
+
+int eth_fe_is_odd(const eth_fe_t *a) {
+    return (int)(a->n[0] & 1);
+}
+
+int eth_fe_equal(const eth_fe_t *a, const eth_fe_t *b) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits |= a->n[i] ^ b->n[i];
+    }
+    return bits == 0;
+}
+
+void eth_fe_add(eth_fe_t *r, const eth_fe_t *a, const eth_fe_t *b) {
+    uint32_t carry = limbs_add(r->n, a->n, b->n);
+    limbs_reduce(r->n, carry, ec_p_complement);
+}
+
+void eth_fe_sub(eth_fe_t *r, const eth_fe_t *a, const eth_fe_t *b) {
+    uint32_t t[8];
+    uint32_t borrow = limbs_sub(r->n, a->n, b->n);
+
+    /* Went negative: add p back */
+    limbs_add(t, r->n, ec_p);
+    limbs_cmov(r->n, t, 0 - borrow);
+}
+
+void eth_fe_neg(eth_fe_t *r, const eth_fe_t *a) {
+    eth_fe_t zero;
+    eth_fe_set_u32(&zero, 0);
+    eth_fe_sub(r, &zero, a);
+}
+
+/*
+ * Reduce a 512-bit product mod p. Since 2^256 = 2^32 + 977 (mod p), the
+ * high half is folded into the low half as hi * 977 + (hi << 32), which
+ * leaves at most 34 bits above 2^256 to fold the same way once more.
+ */
+static void fe_reduce(uint32_t r[8], const uint32_t t[16]) {
+    uint64_t acc = 0;
+
+    for (int i = 0; i < 8; i++) {
+        acc += (uint64_t)t[i] + (uint64_t)t[8 + i] * 977;
+        if (i > 0) {
+            acc += t[7 + i];
+        }
+        r[i] = (uint32_t)acc;
+        acc >>= 32;
+    }
+    uint64_t top = acc + t[15];
+
+    uint64_t low = top * 977;
+    acc = (uint64_t)r[0] + (uint32_t)low;
+    r[0] = (uint32_t)acc;
+    acc >>= 32;
+    acc += (uint64_t)r[1] + (low >> 32) + (uint32_t)top;
+    r[1] = (uint32_t)acc;
+    acc >>= 32;
+    acc += (uint64_t)r[2] + (top >> 32);
+    r[2] = (uint32_t)acc;
+    acc >>= 32;
+    for (int i = 3; i < 8; i++) {
+        acc += r[i];
+        r[i] = (uint32_t)acc;
+        acc >>= 32;
+    }
+
+    /* A last carry out is worth 2^32 + 977; r is tiny then, so this cannot carry again */
+    uint32_t mask = 0 - (uint32_t)acc;
+    uint32_t fold[8] = { 977 & mask, 1 & mask, 0, 0, 0, 0, 0, 0 };
+    limbs_add(r, r, fold);
+
+    limbs_reduce(r, 0, ec_p_complement);
+}
+
+static void fe_mul_portable(uint32_t r[8], const uint32_t a[8], const uint32_t b[8]) {
+    uint32_t t[16];
+
+    limbs_mul(t, a, b);
+    fe_reduce(r, t);
+}
+
+static void fe_sqr_portable(uint32_t r[8], const uint32_t a[8]) {
+    uint32_t t[16];
+
+    /* Cross products once, doubled, plus the squares on the diagonal */
+    memset(t, 0, sizeof(t));
+    for (int i = 0; i < 7; i++) {
+        uint64_t acc = 0;
+        for (int j = i + 1; j < 8; j++) {
+            acc += (uint64_t)a[i] * a[j] + t[i + j];
+            t[i + j] = (uint32_t)acc;
+            acc >>= 32;
+        }
+        t[i + 8] = (uint32_t)acc;
+    }
+
+    uint32_t high = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t next = t[i] >> 31;
+        t[i] = (t[i] << 1) | high;
+        high = next;
+    }
+
+    uint64_t acc = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t square = (uint64_t)a[i] * a[i];
+        acc += (uint64_t)t[2 * i] + (uint32_t)square;
+        t[2 * i] = (uint32_t)acc;
+        acc >>= 32;
+        acc += (uint64_t)t[2 * i + 1] + (square >> 32);
+        t[2 * i + 1] = (uint32_t)acc;
+        acc >>= 32;
+    }
+
+    fe_reduce(r, t);
+}
+
+#if defined(EC_HAVE_INT128)
+
+/*
+ * 64-bit limb kernels for hosts with a 64x64->128 multiply: a quarter of the
+ * partial products of the 32-bit code. Field elements keep their 32-bit
+ * layout and are repacked on the way in and out.
+ */
+typedef unsigned __int128 ec_u128;
+
+/* 2^256 mod p */
+#define EC_FOLD 0x1000003D1ULL
+
+static inline void fe64_load(uint64_t r[4], const uint32_t a[8]) {
+    for (int i = 0; i < 4; i++) {
+        r[i] = (uint64_t)a[2 * i] | ((uint64_t)a[2 * i + 1] << 32);
+    }
+}
+
+/* Reduce a 512-bit product as fe_reduce does, folding the high half times 2^256 mod p */
+static void fe64_reduce(uint32_t r[8], const uint64_t t[8]) {
+    uint64_t x[4];
+    ec_u128 acc = 0;
+
+    for (int i = 0; i < 4; i++) {
+        acc += (ec_u128)t[i] + (ec_u128)t[4 + i] * EC_FOLD;
+        x[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+
+    /* At most 34 bits above 2^256 */
+    acc = (ec_u128)x[0] + (ec_u128)(uint64_t)acc * EC_FOLD;
+    x[0] = (uint64_t)acc;
+    acc >>= 64;
+    for (int i = 1; i < 4; i++) {
+        acc += x[i];
+        x[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+
+    /* A last carry out leaves x tiny, so folding it cannot carry again */
+    x[0] += EC_FOLD & (0 - (uint64_t)acc);
+
+    /* x >= p exactly when x + (2^256 - p) carries out */
+    uint64_t y[4];
+    acc = 0;
+    for (int i = 0; i < 4; i++) {
+        acc += (ec_u128)x[i] + (i == 0 ? EC_FOLD : 0);
+        y[i] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    uint64_t mask = 0 - (uint64_t)acc;
+    for (int i = 0; i < 4; i++) {
+        uint64_t v = (x[i] & ~mask) | (y[i] & mask);
+        r[2 * i] = (uint32_t)v;
+        r[2 * i + 1] = (uint32_t)(v >> 32);
+    }
+}
+
+static void fe_mul_int128(uint32_t r[8], const uint32_t a[8], const uint32_t b[8]) {
+    uint64_t x[4], y[4], t[8] = { 0 };
+
+    fe64_load(x, a);
+    fe64_load(y, b);
+    for (int i = 0; i < 4; i++) {
+        ec_u128 acc = 0;
+        for (int j = 0; j < 4; j++) {
+            acc += (ec_u128)x[i] * y[j] + t[i + j];
+            t[i + j] = (uint64_t)acc;
+            acc >>= 64;
+        }
+        t[i + 4] = (uint64_t)acc;
+    }
+    fe64_reduce(r, t);
+}
+
+static void fe_sqr_int128(uint32_t r[8], const uint32_t a[8]) {
+    uint64_t x[4], t[8] = { 0 };
+
+    fe64_load(x, a);
+    for (int i = 0; i < 3; i++) {
+        ec_u128 acc = 0;
+        for (int j = i + 1; j < 4; j++) {
+            acc += (ec_u128)x[i] * x[j] + t[i + j];
+            t[i + j] = (uint64_t)acc;
+            acc >>= 64;
+        }
+        t[i + 4] = (uint64_t)acc;
+    }
+
+    uint64_t high = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t next = t[i] >> 63;
+        t[i] = (t[i] << 1) | high;
+        high = next;
+    }
+
+    ec_u128 acc = 0;
+    for (int i = 0; i < 4; i++) {
+        ec_u128 square = (ec_u128)x[i] * x[i];
+        acc += (ec_u128)t[2 * i] + (uint64_t)square;
+        t[2 * i] = (uint64_t)acc;
+        acc >>= 64;
+        acc += (ec_u128)t[2 * i + 1] + (uint64_t)(square >> 64);
+        t[2 * i + 1] = (uint64_t)acc;
+        acc >>= 64;
+    }
+    fe64_reduce(r, t);
+}
+
+#endif /* EC_HAVE_INT128 */
+
+typedef void (*fe_mul_fn)(uint32_t r[8], const uint32_t a[8], const uint32_t b[8]);
+typedef void (*fe_sqr_fn)(uint32_t r[8], const uint32_t a[8]);
+
+/* Selected kernels, resolved on first use */
+typedef struct {
+    fe_mul_fn mul;
+    fe_sqr_fn sqr;
+    const char *name;
+} fe_backend_t;
+
+static const fe_backend_t *fe_select(void) {
+#if defined(EC_HAVE_INT128)
+    static const fe_backend_t int128 = { fe_mul_int128, fe_sqr_int128, "int128" };
+
+#if ETH_CPU_DISPATCH
+    if (eth_cpu_features() & ETH_CPU_MUL64) {
+        return &int128;
+    }
+#else
+    return &int128;
+#endif
+#endif
+    static const fe_backend_t portable = { fe_mul_portable, fe_sqr_portable, "portable" };
+    return &portable;
+}
+
+static const fe_backend_t *fe_backend_get(void) {
+#if !ETH_CPU_DISPATCH
+    return fe_select();
+#else
+    /* Racing first calls all pick the same table, so relaxed ordering is enough */
+    static _Atomic(const fe_backend_t *) backend = NULL;
+    const fe_backend_t *selected = atomic_load_explicit(&backend, memory_order_relaxed);
+
+    if (!selected) {
+        selected = fe_select();
+        atomic_store_explicit(&backend, selected, memory_order_relaxed);
+    }
+    return selected;
+#endif
+}
+
+void eth_fe_mul(eth_fe_t *r, const eth_fe_t *a, const eth_fe_t *b) {
+    fe_backend_get()->mul(r->n, a->n, b->n);
+}
+
+void eth_fe_sqr(eth_fe_t *r, const eth_fe_t *a) {
+    fe_backend_get()->sqr(r->n, a->n);
+}
+
+const char *eth_fe_backend(void) {
+    return fe_backend_get()->name;
+}
+
+/* r = a^(2^count) */
+static void fe_sqr_n(eth_fe_t *r, const eth_fe_t *a, int count) {
+    *r = *a;
+    for (int i = 0; i < count; i++) {
+        eth_fe_sqr(r, r);
+    }
+}
+
+/*
+ * Shared head of the inversion and square root chains: xk = a^(2^k - 1)
+ * for the runs of ones in both exponents (x2, x22, x223).
+ */
+static void fe_pow_runs(const eth_fe_t *a, eth_fe_t *x2, eth_fe_t *x22, eth_fe_t *x223) {
+    eth_fe_t x3, x6, x9, x11, x44, x88, x176, x220;
+
+    eth_fe_sqr(x2, a);
+    eth_fe_mul(x2, x2, a);
+    eth_fe_sqr(&x3, x2);
+    eth_fe_mul(&x3, &x3, a);
+    fe_sqr_n(&x6, &x3, 3);
+    eth_fe_mul(&x6, &x6, &x3);
+    fe_sqr_n(&x9, &x6, 3);
+    eth_fe_mul(&x9, &x9, &x3);
+    fe_sqr_n(&x11, &x9, 2);
+    eth_fe_mul(&x11, &x11, x2);
+    fe_sqr_n(x22, &x11, 11);
+    eth_fe_mul(x22, x22, &x11);
+    fe_sqr_n(&x44, x22, 22);
+    eth_fe_mul(&x44, &x44, x22);
+    fe_sqr_n(&x88, &x44, 44);
+    eth_fe_mul(&x88, &x88, &x44);
+    fe_sqr_n(&x176, &x88, 88);
+    eth_fe_mul(&x176, &x176, &x88);
+    fe_sqr_n(&x220, &x176, 44);
+    eth_fe_mul(&x220, &x220, &x44);
+    fe_sqr_n(x223, &x220, 3);
+    eth_fe_mul(x223, x223, &x3);
+}
+
+/*
+ * r = a^(p - 2). p - 2 has runs of 223, 22, 1, 2 and 1 ones, so the whole
+ * chain is 255 squarings and 15 multiplications.
+ */
+void eth_fe_inv(eth_fe_t *r, const eth_fe_t *a) {
+    eth_fe_t x2, x22, x223, t;
+
+    fe_pow_runs(a, &x2, &x22, &x223);
+    fe_sqr_n(&t, &x223, 23);
+    eth_fe_mul(&t, &t, &x22);
+    fe_sqr_n(&t, &t, 5);
+    eth_fe_mul(&t, &t, a);
+    fe_sqr_n(&t, &t, 3);
+    eth_fe_mul(&t, &t, &x2);
+    fe_sqr_n(&t, &t, 2);
+    eth_fe_mul(r, &t, a);
+}
+
+/*
+ * Since p = 3 (mod 4), a^((p + 1) / 4) is a square root of a whenever one
+ * exists. (p + 1) / 4 has runs of 223, 22 and 2 ones: 253 squarings and
+ * 13 multiplications, then one squaring to check the result.
+ */
+int eth_fe_sqrt(eth_fe_t *r, const eth_fe_t *a) {
+    eth_fe_t x2, x22, x223, t, check;
+
+    fe_pow_runs(a, &x2, &x22, &x223);
+    fe_sqr_n(&t, &x223, 23);
+    eth_fe_mul(&t, &t, &x22);
+    fe_sqr_n(&t, &t, 6);
+    eth_fe_mul(&t, &t, &x2);
+    fe_sqr_n(&t, &t, 2);
+
+    eth_fe_sqr(&check, &t);
+    *r = t;
+    return eth_fe_equal(&check, a) ? 0 : -1;
+}
+
+void eth_fe_inv_all_var(eth_fe_t *r, const eth_fe_t *a, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    /* Prefix products, one inversion, then peel the inputs off one at a time */
+    r[0] = a[0];
+    for (size_t i = 1; i < count; i++) {
+        eth_fe_mul(&r[i], &r[i - 1], &a[i]);
+    }
+
+    eth_fe_t inverse;
+    eth_fe_inv(&inverse, &r[count - 1]);
+    for (size_t i = count - 1; i > 0; i--) {
+        eth_fe_mul(&r[i], &r[i - 1], &inverse);
+        eth_fe_mul(&inverse, &inverse, &a[i]);
+    }
+    r[0] = inverse;
+}
+
+/* Scalars */
+
+int eth_scalar_set_bytes(eth_scalar_t *r, const uint8_t bytes[32]) {
+    limbs_set_bytes(r->n, bytes);
+    return (int)limbs_reduce(r->n, 0, ec_n_complement);
+}
+
+void eth_scalar_get_bytes(uint8_t bytes[32], const eth_scalar_t *a) {
+    limbs_get_bytes(bytes, a->n);
+}
+
+int eth_scalar_is_zero(const eth_scalar_t *a) {
+    return limbs_is_zero(a->n);
+}
+
+int eth_scalar_is_high(const eth_scalar_t *a) {
+    uint32_t t[8];
+    return (int)limbs_sub(t, ec_n_half, a->n);
+}
+
+void eth_scalar_add(eth_scalar_t *r, const eth_scalar_t *a, const eth_scalar_t *b) {
+    uint32_t carry = limbs_add(r->n, a->n, b->n);
+    limbs_reduce(r->n, carry, ec_n_complement);
+}
+
+void eth_scalar_negate(eth_scalar_t *r, const eth_scalar_t *a) {
+    uint32_t t[8];
+    uint32_t nonzero = (uint32_t)!limbs_is_zero(a->n);
+
+    /* n - a, except that -0 is 0 */
+    limbs_sub(t, ec_n, a->n);
+    memset(r->n, 0, sizeof(r->n));
+    limbs_cmov(r->n, t, 0 - nonzero);
+}
+
+/*
+ * One folding step of scalar_reduce: out = lo + hi * c for the length-limb
+ * value in, where lo is its low 8 limbs and c = 2^256 - n. out gets
+ * length - 3 limbs, and at least 9. Called with constant lengths so the
+ * loops can be unrolled.
+ */
+static inline void scalar_fold(uint32_t *out, const uint32_t *in, size_t length) {
+    size_t high = length - 8;
+    uint32_t m[13];
+
+    /* m = hi * c, then lo + m in one carry pass */
+    memset(m, 0, (high + 5) * sizeof(uint32_t));
+    for (size_t i = 0; i < high; i++) {
+        uint64_t acc = 0;
+        for (size_t j = 0; j < 5; j++) {
+            acc += (uint64_t)in[8 + i] * ec_n_complement[j] + m[i + j];
+            m[i + j] = (uint32_t)acc;
+            acc >>= 32;
+        }
+        m[i + 5] = (uint32_t)acc;
+    }
+
+    uint64_t acc = 0;
+    for (size_t j = 0; j < high + 5; j++) {
+        acc += (uint64_t)(j < 8 ? in[j] : 0) + m[j];
+        out[j] = (uint32_t)acc;
+        acc >>= 32;
+    }
+    for (size_t j = high + 5; j < 8; j++) {
+        acc += in[j];
+        out[j] = (uint32_t)acc;
+        acc >>= 32;
+    }
+    if (high + 5 <= 8) {
+        out[8] = (uint32_t)acc;
+    }
+}
+
+/*
+ * Reduce a 512-bit product mod n. 2^256 = c (mod n) with c = 2^256 - n only
+ * 129 bits long, so folding hi * c into lo shrinks the value: 16 limbs to
+ * 13 (385 bits), 13 to 10 (290 bits) and 10 to 9 (257 bits), after which one
+ * conditional subtraction is left. The schedule is fixed, not data dependent.
+ */
+static void scalar_reduce(uint32_t r[8], const uint32_t t[16]) {
+    uint32_t a[13], b[10], c[9];
+
+    scalar_fold(a, t, 16);
+    scalar_fold(b, a, 13);
+    scalar_fold(c, b, 10);
+
+    memcpy(r, c, 8 * sizeof(uint32_t));
+    limbs_reduce(r, c[8], ec_n_complement);
+}
+
+void eth_scalar_mul(eth_scalar_t *r, const eth_scalar_t *a, const eth_scalar_t *b) {
+    uint32_t t[16];
+
+    limbs_mul(t, a->n, b->n);
+    scalar_reduce(r->n, t);
+}
+
+/* a^(n - 2) with 4-bit windows; the exponent is public, so the window lookups are too */
+void eth_scalar_inv(eth_scalar_t *r, const eth_scalar_t *a) {
+    eth_scalar_t powers[16], acc;
+
+    memset(&powers[0], 0, sizeof(powers[0]));
+    powers[0].n[0] = 1;
+    powers[1] = *a;
+    for (int i = 2; i < 16; i++) {
+        eth_scalar_mul(&powers[i], &powers[i - 1], a);
+    }
+
+    acc = powers[0];
+    for (int w = 63; w >= 0; w--) {
+        for (int i = 0; i < 4; i++) {
+            eth_scalar_mul(&acc, &acc, &acc);
+        }
+        eth_scalar_mul(&acc, &acc, &powers[(ec_n_minus_2[w / 8] >> (4 * (w % 8))) & 0x0F]);
+    }
+
+    *r = acc;
+    memset(powers, 0, sizeof(powers));
+}
+
+void eth_scalar_inv_all(eth_scalar_t *r, const eth_scalar_t *a, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    /* Prefix products, one inversion, then peel the inputs off one at a time */
+    r[0] = a[0];
+    for (size_t i = 1; i < count; i++) {
+        eth_scalar_mul(&r[i], &r[i - 1], &a[i]);
+    }
+
+    eth_scalar_t inverse;
+    eth_scalar_inv(&inverse, &r[count - 1]);
+    for (size_t i = count - 1; i > 0; i--) {
+        eth_scalar_mul(&r[i], &r[i - 1], &inverse);
+        eth_scalar_mul(&inverse, &inverse, &a[i]);
+    }
+    r[0] = inverse;
+    memset(&inverse, 0, sizeof(inverse));
+}
+
+/* Points */
+
+int eth_ge_is_valid(const eth_ge_t *a) {
+    if (a->infinity) {
+        return 0;
+    }
+
+    eth_fe_t left, right, seven;
+    eth_fe_sqr(&left, &a->y);
+    eth_fe_sqr(&right, &a->x);
+    eth_fe_mul(&right, &right, &a->x);
+    eth_fe_set_u32(&seven, 7);
+    eth_fe_add(&right, &right, &seven);
+    return eth_fe_equal(&left, &right);
+}
+
+int eth_ge_set_public_key(eth_ge_t *r, const eth_public_key_t *public_key) {
+    r->infinity = 0;
+    if (eth_fe_set_bytes(&r->x, public_key->data) != 0 ||
+        eth_fe_set_bytes(&r->y, public_key->data + 32) != 0) {
+        return -1;
+    }
+    return eth_ge_is_valid(r) ? 0 : -1;
+}
+
+void eth_ge_get_public_key(eth_public_key_t *public_key, const eth_ge_t *a) {
+    eth_fe_get_bytes(public_key->data, &a->x);
+    eth_fe_get_bytes(public_key->data + 32, &a->y);
+}
+
+void eth_ge_set_generator(eth_ge_t *r) {
+    limbs_set_bytes(r->x.n, ec_generator);
+    limbs_set_bytes(r->y.n, ec_generator + 32);
+    r->infinity = 0;
+}
+
+int eth_ge_set_xo(eth_ge_t *r, const eth_fe_t *x, int odd) {
+    eth_fe_t y2, seven;
+
+    /* y^2 = x^3 + 7 */
+    eth_fe_sqr(&y2, x);
+    eth_fe_mul(&y2, &y2, x);
+    eth_fe_set_u32(&seven, 7);
+    eth_fe_add(&y2, &y2, &seven);
+
+    r->x = *x;
+    r->infinity = 0;
+    if (eth_fe_sqrt(&r->y, &y2) != 0) {
+        return -1;
+    }
+    if (eth_fe_is_odd(&r->y) != (odd != 0)) {
+        eth_fe_neg(&r->y, &r->y);
+    }
+    return 0;
+}
+
+void eth_gej_set_ge(eth_gej_t *r, const eth_ge_t *a) {
+    r->x = a->x;
+    r->y = a->y;
+    eth_fe_set_u32(&r->z, 1);
+    r->infinity = a->infinity;
+}
+
+/* Affine from Jacobian, given 1 / z */
+static void ge_set_gej_zinv(eth_ge_t *r, const eth_gej_t *a, const eth_fe_t *zinv) {
+    eth_fe_t zinv2, zinv3;
+
+    eth_fe_sqr(&zinv2, zinv);
+    eth_fe_mul(&zinv3, &zinv2, zinv);
+    eth_fe_mul(&r->x, &a->x, &zinv2);
+    eth_fe_mul(&r->y, &a->y, &zinv3);
+    r->infinity = 0;
+}
+
+void eth_ge_set_gej(eth_ge_t *r, const eth_gej_t *a) {
+    if (a->infinity) {
+        memset(r, 0, sizeof(*r));
+        r->infinity = 1;
+        return;
+    }
+
+    eth_fe_t zinv;
+    eth_fe_inv(&zinv, &a->z);
+    ge_set_gej_zinv(r, a, &zinv);
+}
+
+void eth_ge_set_all_gej_var(eth_ge_t *r, const eth_gej_t *a, size_t count) {
+    /* Running products of the z coordinates, kept in r[i].x until they are needed */
+    size_t last = count;
+    for (size_t i = 0; i < count; i++) {
+        if (a[i].infinity) {
+            memset(&r[i], 0, sizeof(r[i]));
+            r[i].infinity = 1;
+            continue;
+        }
+        if (last == count) {
+            r[i].x = a[i].z;
+        } else {
+            eth_fe_mul(&r[i].x, &r[last].x, &a[i].z);
+        }
+        last = i;
+    }
+    if (last == count) {
+        return;
+    }
+
+    eth_fe_t inverse;
+    eth_fe_inv(&inverse, &r[last].x);
+
+    size_t i = last;
+    for (;;) {
+        size_t previous = i;
+        while (previous > 0 && a[previous - 1].infinity) {
+            previous--;
+        }
+
+        eth_fe_t zinv;
+        if (previous == 0) {
+            ge_set_gej_zinv(&r[i], &a[i], &inverse);
+            break;
+        }
+        eth_fe_mul(&zinv, &inverse, &r[previous - 1].x);
+        eth_fe_mul(&inverse, &inverse, &a[i].z);
+        ge_set_gej_zinv(&r[i], &a[i], &zinv);
+        i = previous - 1;
+    }
+}
+
+void eth_gej_double(eth_gej_t *r, const eth_gej_t *a) {
+    if (a->infinity) {
+        *r = *a;
+        return;
+    }
+
+    /* S = 4xy^2, M = 3x^2, x' = M^2 - 2S, y' = M(S - x') - 8y^4, z' = 2yz */
+    eth_fe_t yy, s, m, t, z;
+
+    eth_fe_mul(&z, &a->y, &a->z);
+    eth_fe_add(&z, &z, &z);
+
+    eth_fe_sqr(&yy, &a->y);
+    eth_fe_mul(&s, &a->x, &yy);
+    eth_fe_add(&s, &s, &s);
+    eth_fe_add(&s, &s, &s);
+
+    eth_fe_sqr(&t, &a->x);
+    eth_fe_add(&m, &t, &t);
+    eth_fe_add(&m, &m, &t);
+
+    eth_fe_sqr(&yy, &yy);
+    eth_fe_add(&yy, &yy, &yy);
+    eth_fe_add(&yy, &yy, &yy);
+    eth_fe_add(&yy, &yy, &yy);
+
+    eth_fe_sqr(&r->x, &m);
+    eth_fe_sub(&r->x, &r->x, &s);
+    eth_fe_sub(&r->x, &r->x, &s);
+
+    eth_fe_sub(&t, &s, &r->x);
+    eth_fe_mul(&t, &t, &m);
+    eth_fe_sub(&r->y, &t, &yy);
+
+    r->z = z;
+    r->infinity = 0;
+}
+
+/*
+ * r = a + b with no special cases: a and b must be finite and distinct
+ * (x coordinates differ), otherwise the result is garbage. Returns h, which
+ * is zero exactly in those excluded cases.
+ */
+static void gej_add_ge_raw(eth_gej_t *r, const eth_gej_t *a, const eth_ge_t *b, eth_fe_t *h_out, eth_fe_t *r_out) {
+    eth_fe_t zz, u2, s2, h, rr, hh, hhh, v, t;
+
+    eth_fe_sqr(&zz, &a->z);
+    eth_fe_mul(&u2, &b->x, &zz);
+    eth_fe_mul(&s2, &b->y, &zz);
+    eth_fe_mul(&s2, &s2, &a->z);
+    eth_fe_sub(&h, &u2, &a->x);
+    eth_fe_sub(&rr, &s2, &a->y);
+
+    eth_fe_sqr(&hh, &h);
+    eth_fe_mul(&hhh, &hh, &h);
+    eth_fe_mul(&v, &a->x, &hh);
+
+    eth_fe_mul(&r->z, &a->z, &h);
+
+    /* x' = r^2 - h^3 - 2v, y' = r(v - x') - y h^3 */
+    eth_fe_mul(&t, &a->y, &hhh);
+    eth_fe_sqr(&r->x, &rr);
+    eth_fe_sub(&r->x, &r->x, &hhh);
+    eth_fe_sub(&r->x, &r->x, &v);
+    eth_fe_sub(&r->x, &r->x, &v);
+    eth_fe_sub(&v, &v, &r->x);
+    eth_fe_mul(&v, &v, &rr);
+    eth_fe_sub(&r->y, &v, &t);
+    r->infinity = 0;
+
+    if (h_out) {
+        *h_out = h;
+        *r_out = rr;
+    }
+}
+
+void eth_gej_add_ge_var(eth_gej_t *r, const eth_gej_t *a, const eth_ge_t *b) {
+    if (b->infinity) {
+        *r = *a;
+        return;
+    }
+    if (a->infinity) {
+        eth_gej_set_ge(r, b);
+        return;
+    }
+
+    eth_gej_t saved = *a;
+    eth_fe_t h, rr;
+    gej_add_ge_raw(r, a, b, &h, &rr);
+    if (eth_fe_is_zero(&h)) {
+        if (eth_fe_is_zero(&rr)) {
+            /* a == b */
+            eth_gej_double(r, &saved);
+        } else {
+            /* a == -b */
+            memset(r, 0, sizeof(*r));
+            r->infinity = 1;
+        }
+    }
+}
+
+int eth_gej_x_mod_n_equals_var(const eth_gej_t *a, const eth_scalar_t *r) {
+    if (a->infinity) {
+        return 0;
+    }
+
+    /* r == (X / Z^2) mod n, checked as r * Z^2 == X without the inversion */
+    eth_fe_t x, zz, t;
+    memcpy(x.n, r->n, sizeof(x.n));
+    eth_fe_sqr(&zz, &a->z);
+    eth_fe_mul(&t, &x, &zz);
+    if (eth_fe_equal(&t, &a->x)) {
+        return 1;
+    }
+
+    /* An affine x in [n, p) also reduces to r */
+    if (limbs_add(x.n, r->n, ec_n) || limbs_reduce(x.n, 0, ec_p_complement)) {
+        return 0;
+    }
+    eth_fe_mul(&t, &x, &zz);
+    return eth_fe_equal(&t, &a->x);
+}
+
+void eth_ec_table_build_bits(eth_ge_storage_t *table, const eth_ge_t *point, unsigned bits) {
+    const int windows = ETH_EC_TABLE_WINDOWS_FOR(bits);
+    const int entries = ETH_EC_TABLE_ENTRIES_FOR(bits);
+    eth_gej_t multiples[EC_TABLE_BATCH];
+    eth_ge_t affine[EC_TABLE_BATCH];
+    eth_ge_t base = *point;
+
+    for (int w = 0; w < windows; w++) {
+        /*
+         * 1..2^bits - 1 times base for the table, and 2^bits times base as the
+         * next window's base, normalized a batch at a time so wide windows
+         * need no more stack than narrow ones
+         */
+        eth_gej_t sum;
+        eth_gej_set_ge(&sum, &base);
+        for (int first = 1; first <= entries + 1; first += EC_TABLE_BATCH) {
+            int size = entries + 2 - first < EC_TABLE_BATCH ? entries + 2 - first : EC_TABLE_BATCH;
+            for (int i = 0; i < size; i++) {
+                multiples[i] = sum;
+                eth_gej_add_ge_var(&sum, &multiples[i], &base);
+            }
+            eth_ge_set_all_gej_var(affine, multiples, (size_t)size);
+            for (int i = 0; i < size; i++) {
+                int j = first + i;
+                if (j <= entries) {
+                    table[w * entries + j - 1].x = affine[i].x;
+                    table[w * entries + j - 1].y = affine[i].y;
+                }
+            }
+            if (first + size > entries + 1) {
+                base = affine[size - 1];
+            }
+        }
+    }
+}
+
+void eth_ec_table_build(eth_ge_storage_t *table, const eth_ge_t *point) {
+    eth_ec_table_build_bits(table, point, ETH_EC_TABLE_BITS);
+}
+
+#if defined(ETH_EC_GEN_TABLE_RUNTIME)
+
+static void ec_gen_build(void) {
+    eth_ge_t base;
+
+    eth_ge_set_generator(&base);
+    eth_ec_table_build_bits(ec_gen_table, &base, EC_GEN_TABLE_BITS);
+}
+
+static const eth_ge_storage_t *ec_gen_table_get(void) {
+    pthread_once(&ec_gen_once, ec_gen_build);
+    return ec_gen_table;
+}
+
+#else
+
+static const eth_ge_storage_t *ec_gen_table_get(void) {
+    return ec_gen_table;
+}
+
+#endif /* ETH_EC_GEN_TABLE_RUNTIME */
+
+/* Digit number w of k in bits-bit windows (digits may straddle two limbs) */
+static uint32_t ec_digit(const eth_scalar_t *k, int w, unsigned bits) {
+    unsigned bit = (unsigned)w * bits;
+    unsigned limb = bit / 32, shift = bit % 32;
+    uint32_t value = k->n[limb] >> shift;
+
+    if (shift + bits > 32 && limb + 1 < 8) {
+        value |= k->n[limb + 1] << (32 - shift);
+    }
+    return value & ((1u << bits) - 1);
+}
+
+void eth_ec_mul_gen(eth_gej_t *r, const eth_scalar_t *k) {
+    const eth_ge_storage_t *table = ec_gen_table_get();
+
+    /*
+     * Every window does the same work: all entries are read, the addition
+     * always runs, and masks pick the result. Partial sums stay below the
+     * entry being added (k < n), so the addition never meets equal or
+     * opposite points.
+     */
+    eth_gej_t acc;
+    uint32_t acc_infinity = 1;
+    memset(&acc, 0, sizeof(acc));
+    eth_fe_set_u32(&acc.z, 1);
+
+    for (int w = 0; w < EC_GEN_WINDOWS; w++) {
+        const eth_ge_storage_t *window = table + w * EC_GEN_ENTRIES;
+        uint32_t digit = ec_digit(k, w, EC_GEN_TABLE_BITS);
+
+        eth_ge_t entry;
+        entry.x = window[0].x;
+        entry.y = window[0].y;
+        entry.infinity = 0;
+        for (uint32_t j = 1; j < EC_GEN_ENTRIES; j++) {
+            uint32_t mask = 0 - ((((digit ^ (j + 1)) - 1) >> 31) & 1);
+            limbs_cmov(entry.x.n, window[j].x.n, mask);
+            limbs_cmov(entry.y.n, window[j].y.n, mask);
+        }
+
+        eth_gej_t sum, lifted;
+        gej_add_ge_raw(&sum, &acc, &entry, NULL, NULL);
+        eth_gej_set_ge(&lifted, &entry);
+
+        uint32_t first = 0 - acc_infinity;
+        limbs_cmov(sum.x.n, lifted.x.n, first);
+        limbs_cmov(sum.y.n, lifted.y.n, first);
+        limbs_cmov(sum.z.n, lifted.z.n, first);
+
+        uint32_t nonzero = 0 - (((digit - 1) >> 31) ^ 1);
+        limbs_cmov(acc.x.n, sum.x.n, nonzero);
+        limbs_cmov(acc.y.n, sum.y.n, nonzero);
+        limbs_cmov(acc.z.n, sum.z.n, nonzero);
+        acc_infinity &= ~nonzero & 1;
+    }
+
+    *r = acc;
+    r->infinity = (int)acc_infinity;
+}
+
+static void ec_table_mul_add_var(eth_gej_t *r, const eth_ge_storage_t *table, const eth_scalar_t *k,
+                                 unsigned bits) {
+    const int windows = ETH_EC_TABLE_WINDOWS_FOR(bits);
+    const int entries = ETH_EC_TABLE_ENTRIES_FOR(bits);
+
+    for (int w = 0; w < windows; w++) {
+        uint32_t digit = ec_digit(k, w, bits);
+        if (digit == 0) {
+            continue;
+        }
+
+        eth_ge_t entry;
+        entry.x = table[w * entries + digit - 1].x;
+        entry.y = table[w * entries + digit - 1].y;
+        entry.infinity = 0;
+        eth_gej_add_ge_var(r, r, &entry);
+    }
+}
+
+void eth_ec_table_mul_add_var(eth_gej_t *r, const eth_ge_storage_t *table, const eth_scalar_t *k) {
+    ec_table_mul_add_var(r, table, k, ETH_EC_TABLE_BITS);
+}
+
+void eth_ec_mul_gen_add_var(eth_gej_t *r, const eth_scalar_t *k) {
+    ec_table_mul_add_var(r, ec_gen_table_get(), k, EC_GEN_TABLE_BITS);
+}
+
+void eth_ec_mul_gen_var(eth_gej_t *r, const eth_scalar_t *k) {
+    memset(r, 0, sizeof(*r));
+    r->infinity = 1;
+    eth_ec_mul_gen_add_var(r, k);
+}
+
+void eth_ec_mul_var(eth_gej_t *r, const eth_ge_t *a, const eth_scalar_t *k) {
+    /* 1a .. 15a in affine, then four doublings and at most one addition per digit */
+    eth_gej_t multiples[ETH_EC_TABLE_ENTRIES];
+    eth_ge_t affine[ETH_EC_TABLE_ENTRIES];
+
+    eth_gej_set_ge(&multiples[0], a);
+    for (int j = 1; j < ETH_EC_TABLE_ENTRIES; j++) {
+        eth_gej_add_ge_var(&multiples[j], &multiples[j - 1], a);
+    }
+    eth_ge_set_all_gej_var(affine, multiples, ETH_EC_TABLE_ENTRIES);
+
+    memset(r, 0, sizeof(*r));
+    r->infinity = 1;
+    for (int w = ETH_EC_TABLE_WINDOWS - 1; w >= 0; w--) {
+        for (int i = 0; i < 4; i++) {
+            eth_gej_double(r, r);
+        }
+        uint32_t digit = ec_digit(k, w, ETH_EC_TABLE_BITS);
+        if (digit != 0) {
+            eth_gej_add_ge_var(r, r, &affine[digit - 1]);
+        }
+    }
+}
@@ -0,0 +1,646 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/eip712.h"
+#include "../include/keccak.h"
+
+/* Error codes */
+#define EIP712_ERROR_NONE          0
+#define EIP712_ERROR_INVALID      -1
+#define EIP712_ERROR_NOMEM        -2
+#define EIP712_ERROR_SYNTAX       -3
+#define EIP712_ERROR_UNKNOWN_TYPE -4
+#define EIP712_ERROR_VALUE        -5
+
+/* Deepest struct nesting hashed, to bound the stack on small targets */
+#define EIP712_MAX_DEPTH 32
+
+static int eip712_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int eip712_is_name_char(char c, int first) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$') {
+        return 1;
+    }
+    return !first && c >= '0' && c <= '9';
+}
+
+static size_t eip712_skip_space(const char *text, size_t length, size_t pos) {
+    while (pos < length && eip712_is_space(text[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+/* Identifier at pos; returns its end, or pos if there is none */
+static size_t eip712_name_end(const char *text, size_t length, size_t pos) {
+    size_t end = pos;
+
+    while (end < length && eip712_is_name_char(text[end], end == pos)) {
+        end++;
+    }
+    return end;
+}
+
+/* Parse a decimal number without leading zeros; returns 0 if the text is not one */
+static int eip712_parse_number(const char *text, size_t length, size_t *value) {
+    if (length == 0 || length > 9 || (text[0] == '0' && length > 1)) {
+        return 0;
+    }
+
+    size_t result = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return 0;
+        }
+        result = result * 10 + (size_t)(text[i] - '0');
+    }
+    *value = result;
+    return 1;
+}
+
+/* Recognise an atomic or dynamic type name; returns 0 for anything else (a struct name) */
+static int eip712_builtin(const char *name, size_t length, eth_eip712_kind_t *kind, unsigned *size) {
+    size_t bits;
+
+    *size = 0;
+    if (length == 7 && memcmp(name, "address", 7) == 0) {
+        *kind = ETH_EIP712_ADDRESS;
+    } else if (length == 4 && memcmp(name, "bool", 4) == 0) {
+        *kind = ETH_EIP712_BOOL;
+    } else if (length == 6 && memcmp(name, "string", 6) == 0) {
+        *kind = ETH_EIP712_STRING;
+    } else if (length == 5 && memcmp(name, "bytes", 5) == 0) {
+        *kind = ETH_EIP712_BYTES;
+    } else if (length > 5 && memcmp(name, "bytes", 5) == 0 &&
+               eip712_parse_number(name + 5, length - 5, &bits) && bits >= 1 && bits <= 32) {
+        *kind = ETH_EIP712_FIXED_BYTES;
+        *size = (unsigned)bits;
+    } else if (length > 4 && memcmp(name, "uint", 4) == 0 &&
+               eip712_parse_number(name + 4, length - 4, &bits) && bits >= 8 && bits <= 256 && bits % 8 == 0) {
+        *kind = ETH_EIP712_UINT;
+        *size = (unsigned)bits;
+    } else if (length > 3 && memcmp(name, "int", 3) == 0 &&
+               eip712_parse_number(name + 3, length - 3, &bits) && bits >= 8 && bits <= 256 && bits % 8 == 0) {
+        *kind = ETH_EIP712_INT;
+        *size = (unsigned)bits;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static int eip712_compare_names(const char *a, size_t a_length, const char *b, size_t b_length) {
+    size_t common = a_length < b_length ? a_length : b_length;
+    int result = memcmp(a, b, common);
+
+    if (result != 0) {
+        return result;
+    }
+    return (a_length > b_length) - (a_length < b_length);
+}
+
+static int eip712_compare_types(const void *a, const void *b) {
+    const eth_eip712_type_t *x = a;
+    const eth_eip712_type_t *y = b;
+    return eip712_compare_names(x->name, x->name_length, y->name, y->name_length);
+}
+
+static const eth_eip712_type_t *eip712_lookup(const eth_eip712_schema_t *schema, const char *name, size_t length) {
+    size_t lo = 0;
+    size_t hi = schema->type_count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const eth_eip712_type_t *type = &schema->types[mid];
+        int order = eip712_compare_names(type->name, type->name_length, name, length);
+        if (order == 0) {
+            return type;
+        }
+        if (order < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Parse one field, "type name", starting at pos. Struct references are
+ * resolved once every definition has been read.
+ */
+static int eip712_parse_field(eth_eip712_schema_t *schema, const char *text, size_t length,
+                              size_t *pos, eth_eip712_field_t *field) {
+    size_t start = *pos;
+    size_t end = eip712_name_end(text, length, start);
+    if (end == start) {
+        schema->error_offset = start;
+        return EIP712_ERROR_SYNTAX;
+    }
+    size_t base_length = end - start;
+
+    field->array = ETH_EIP712_SCALAR;
+    field->array_length = 0;
+    if (end < length && text[end] == '[') {
+        size_t close = end + 1;
+        while (close < length && text[close] != ']') {
+            close++;
+        }
+        if (close == length) {
+            schema->error_offset = end;
+            return EIP712_ERROR_SYNTAX;
+        }
+        if (close == end + 1) {
+            field->array = ETH_EIP712_DYNAMIC_ARRAY;
+        } else if (eip712_parse_number(text + end + 1, close - end - 1, &field->array_length)) {
+            field->array = ETH_EIP712_FIXED_ARRAY;
+        } else {
+            schema->error_offset = end;
+            return EIP712_ERROR_SYNTAX;
+        }
+        end = close + 1;
+        if (end < length && text[end] == '[') {
+            /* Arrays of arrays are not supported */
+            schema->error_offset = end;
+            return EIP712_ERROR_SYNTAX;
+        }
+    }
+
+    field->type_name = text + start;
+    field->type_name_length = end - start;
+    if (!eip712_builtin(text + start, base_length, &field->kind, &field->size)) {
+        field->kind = ETH_EIP712_STRUCT;
+    }
+    field->struct_type = NULL;
+
+    size_t name_start = eip712_skip_space(text, length, end);
+    size_t name_end = eip712_name_end(text, length, name_start);
+    if (name_start == end || name_end == name_start) {
+        schema->error_offset = name_start;
+        return EIP712_ERROR_SYNTAX;
+    }
+    field->name = text + name_start;
+    field->name_length = name_end - name_start;
+
+    *pos = name_end;
+    return EIP712_ERROR_NONE;
+}
+
+static int eip712_parse(eth_eip712_schema_t *schema, const char *text, size_t length) {
+    size_t pos = eip712_skip_space(text, length, 0);
+    size_t field_count = 0;
+
+    while (pos < length) {
+        eth_eip712_type_t *type = &schema->types[schema->type_count];
+        size_t name_end = eip712_name_end(text, length, pos);
+        size_t open = eip712_skip_space(text, length, name_end);
+        if (name_end == pos || open == length || text[open] != '(') {
+            schema->error_offset = pos;
+            return EIP712_ERROR_SYNTAX;
+        }
+
+        eth_eip712_kind_t kind;
+        unsigned size;
+        if (eip712_builtin(text + pos, name_end - pos, &kind, &size)) {
+            /* A struct cannot take the name of a built-in type */
+            schema->error_offset = pos;
+            return EIP712_ERROR_SYNTAX;
+        }
+
+        type->name = text + pos;
+        type->name_length = name_end - pos;
+        type->fields = &schema->fields[field_count];
+        type->field_count = 0;
+        schema->type_count++;
+
+        pos = eip712_skip_space(text, length, open + 1);
+        if (pos < length && text[pos] == ')') {
+            pos++;
+        } else {
+            for (;;) {
+                int result = eip712_parse_field(schema, text, length, &pos, &schema->fields[field_count]);
+                if (result != EIP712_ERROR_NONE) {
+                    return result;
+                }
+                field_count++;
+                type->field_count++;
+
+                pos = eip712_skip_space(text, length, pos);
+                if (pos < length && text[pos] == ',') {
+                    pos = eip712_skip_space(text, length, pos + 1);
+                } else if (pos < length && text[pos] == ')') {
+                    pos++;
+                    break;
+                } else {
+                    schema->error_offset = pos;
+                    return EIP712_ERROR_SYNTAX;
+                }
+            }
+        }
+
+        pos = eip712_skip_space(text, length, pos);
+    }
+
+    if (schema->type_count == 0) {
+        schema->error_offset = 0;
+        return EIP712_ERROR_SYNTAX;
+    }
+    return EIP712_ERROR_NONE;
+}
+
+/* Mark a type and every struct it refers to, directly or not */
+static void eip712_mark(const eth_eip712_schema_t *schema, const eth_eip712_type_t *type, uint8_t *used) {
+    size_t index = (size_t)(type - schema->types);
+
+    if (used[index]) {
+        return;
+    }
+    used[index] = 1;
+    for (size_t i = 0; i < type->field_count; i++) {
+        if (type->fields[i].kind == ETH_EIP712_STRUCT) {
+            eip712_mark(schema, type->fields[i].struct_type, used);
+        }
+    }
+}
+
+/* Stream "Name(type name,...)" into a hash */
+static void eip712_hash_definition(eth_keccak_ctx_t *ctx, const eth_eip712_type_t *type) {
+    eth_keccak256_update(ctx, (const uint8_t *)type->name, type->name_length);
+    eth_keccak256_update(ctx, (const uint8_t *)"(", 1);
+    for (size_t i = 0; i < type->field_count; i++) {
+        const eth_eip712_field_t *field = &type->fields[i];
+        if (i > 0) {
+            eth_keccak256_update(ctx, (const uint8_t *)",", 1);
+        }
+        eth_keccak256_update(ctx, (const uint8_t *)field->type_name, field->type_name_length);
+        eth_keccak256_update(ctx, (const uint8_t *)" ", 1);
+        eth_keccak256_update(ctx, (const uint8_t *)field->name, field->name_length);
+    }
+    eth_keccak256_update(ctx, (const uint8_t *)")", 1);
+}
+
+/* Resolve struct references and compute every typeHash */
+static int eip712_compile(eth_eip712_schema_t *schema) {
+    size_t field_count = 0;
+
+    for (size_t t = 0; t < schema->type_count; t++) {
+        const eth_eip712_type_t *type = &schema->types[t];
+        if (t > 0 && eip712_compare_types(type - 1, type) == 0) {
+            /* Duplicate definition */
+            schema->error_offset = (size_t)(type->name - schema->text);
+            return EIP712_ERROR_SYNTAX;
+        }
+        field_count += type->field_count;
+    }
+
+    for (size_t i = 0; i < field_count; i++) {
+        eth_eip712_field_t *field = &schema->fields[i];
+        if (field->kind != ETH_EIP712_STRUCT) {
+            continue;
+        }
+
+        const char *bracket = memchr(field->type_name, '[', field->type_name_length);
+        size_t base_length = bracket ? (size_t)(bracket - field->type_name) : field->type_name_length;
+        field->struct_type = eip712_lookup(schema, field->type_name, base_length);
+        if (!field->struct_type) {
+            schema->error_offset = (size_t)(field->type_name - schema->text);
+            return EIP712_ERROR_UNKNOWN_TYPE;
+        }
+    }
+
+    uint8_t *used = malloc(schema->type_count);
+    if (!used) {
+        return EIP712_ERROR_NOMEM;
+    }
+
+    /* encodeType: the type itself, then the structs it uses sorted by name */
+    for (size_t t = 0; t < schema->type_count; t++) {
+        eth_eip712_type_t *type = &schema->types[t];
+        eth_keccak_ctx_t ctx;
+
+        memset(used, 0, schema->type_count);
+        eip712_mark(schema, type, used);
+
+        eth_keccak256_init(&ctx);
+        eip712_hash_definition(&ctx, type);
+        for (size_t i = 0; i < schema->type_count; i++) {
+            if (used[i] && i != t) {
+                eip712_hash_definition(&ctx, &schema->types[i]);
+            }
+        }
+        eth_keccak256_final(&ctx, type->type_hash.data);
+    }
+
+    free(used);
+    return EIP712_ERROR_NONE;
+}
+
+int eth_eip712_schema_load(eth_eip712_schema_t *schema, const char *text, size_t length) {
+    if (!schema || (!text && length > 0)) {
+        return EIP712_ERROR_INVALID;
+    }
+
+    memset(schema, 0, sizeof(*schema));
+
+    /* Every type has a '(' and every field but the first of a type follows a ',' */
+    size_t max_types = 0;
+    size_t max_fields = 0;
+    for (size_t i = 0; i < length; i++) {
+        max_types += text[i] == '(';
+        max_fields += text[i] == ',';
+    }
+    max_fields += max_types;
+
+    schema->text = malloc(length + 1);
+    schema->types = calloc(max_types ? max_types : 1, sizeof(eth_eip712_type_t));
+    schema->fields = calloc(max_fields ? max_fields : 1, sizeof(eth_eip712_field_t));
+    if (!schema->text || !schema->types || !schema->fields) {
+        eth_eip712_schema_free(schema);
+        return EIP712_ERROR_NOMEM;
+    }
+    if (length > 0) {
+        memcpy(schema->text, text, length);
+    }
+    schema->text[length] = '\0';
+
+    int result = eip712_parse(schema, schema->text, length);
+    if (result == EIP712_ERROR_NONE) {
+        qsort(schema->types, schema->type_count, sizeof(eth_eip712_type_t), eip712_compare_types);
+        result = eip712_compile(schema);
+    }
+
+    if (result != EIP712_ERROR_NONE) {
+        size_t error_offset = schema->error_offset;
+        eth_eip712_schema_free(schema);
+        schema->error_offset = error_offset;
+    }
+    return result;
+}
+
+void eth_eip712_schema_free(eth_eip712_schema_t *schema) {
+    if (!schema) {
+        return;
+    }
+
+    free(schema->text);
+    free(schema->types);
+    free(schema->fields);
+    memset(schema, 0, sizeof(*schema));
+}
+
+const eth_eip712_type_t *eth_eip712_find_type(const eth_eip712_schema_t *schema, const char *name) {
+    if (!schema || !name) {
+        return NULL;
+    }
+    return eip712_lookup(schema, name, strlen(name));
+}
+
+/* Whether a number fits in 'bits' bits, unsigned or as a sign-extended two's complement value */
+static int eip712_fits(const eth_u256_t *number, unsigned bits, int is_signed) {
+    if (bits == 256) {
+        return 1;
+    }
+
+    /* Bits from 'bits' up (from 'bits - 1' for signed values) must all equal the fill */
+    unsigned from = is_signed ? bits - 1 : bits;
+    uint64_t fill = (is_signed && ((number->limb[from / 64] >> (from % 64)) & 1)) ? ~(uint64_t)0 : 0;
+
+    for (unsigned limb = from / 64; limb < 4; limb++) {
+        uint64_t mask = limb == from / 64 ? ~(uint64_t)0 << (from % 64) : ~(uint64_t)0;
+        if ((number->limb[limb] & mask) != (fill & mask)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int eip712_hash_struct(const eth_eip712_type_t *type, const eth_eip712_value_t *value,
+                              unsigned depth, uint8_t hash[32]);
+
+/* encodeData word of one value of the field's kind */
+static int eip712_encode_word(const eth_eip712_field_t *field, const eth_eip712_value_t *value,
+                              unsigned depth, uint8_t word[32]) {
+    switch (field->kind) {
+    case ETH_EIP712_UINT:
+    case ETH_EIP712_INT:
+        if (!eip712_fits(&value->number, field->size, field->kind == ETH_EIP712_INT)) {
+            return EIP712_ERROR_VALUE;
+        }
+        eth_u256_to_bytes(&value->number, word);
+        return EIP712_ERROR_NONE;
+
+    case ETH_EIP712_BOOL:
+        if (!eip712_fits(&value->number, 1, 0)) {
+            return EIP712_ERROR_VALUE;
+        }
+        eth_u256_to_bytes(&value->number, word);
+        return EIP712_ERROR_NONE;
+
+    case ETH_EIP712_ADDRESS:
+        if (!value->data || value->length != 20) {
+            return EIP712_ERROR_VALUE;
+        }
+        memset(word, 0, 12);
+        memcpy(word + 12, value->data, 20);
+        return EIP712_ERROR_NONE;
+
+    case ETH_EIP712_FIXED_BYTES:
+        if (!value->data || value->length != field->size) {
+            return EIP712_ERROR_VALUE;
+        }
+        memcpy(word, value->data, field->size);
+        memset(word + field->size, 0, 32 - field->size);
+        return EIP712_ERROR_NONE;
+
+    case ETH_EIP712_BYTES:
+    case ETH_EIP712_STRING: {
+        if (!value->data && value->length > 0) {
+            return EIP712_ERROR_VALUE;
+        }
+        eth_keccak_ctx_t ctx;
+        eth_keccak256_init(&ctx);
+        eth_keccak256_update(&ctx, value->data, value->length);
+        eth_keccak256_final(&ctx, word);
+        return EIP712_ERROR_NONE;
+    }
+
+    case ETH_EIP712_STRUCT:
+        return eip712_hash_struct(field->struct_type, value, depth + 1, word);
+    }
+
+    return EIP712_ERROR_INVALID;
+}
+
+/* Stream one field's encodeData word into the struct hash */
+static int eip712_encode_field(eth_keccak_ctx_t *ctx, const eth_eip712_field_t *field,
+                               const eth_eip712_value_t *value, unsigned depth) {
+    uint8_t word[32];
+    int result;
+
+    if (field->array == ETH_EIP712_SCALAR) {
+        result = eip712_encode_word(field, value, depth, word);
+    } else if ((field->array == ETH_EIP712_FIXED_ARRAY && value->count != field->array_length) ||
+               (!value->items && value->count > 0)) {
+        result = EIP712_ERROR_VALUE;
+    } else {
+        /* An array is the hash of its elements' words */
+        eth_keccak_ctx_t elements;
+        eth_keccak256_init(&elements);
+        result = EIP712_ERROR_NONE;
+        for (size_t i = 0; i < value->count && result == EIP712_ERROR_NONE; i++) {
+            result = eip712_encode_word(field, &value->items[i], depth, word);
+            eth_keccak256_update(&elements, word, sizeof(word));
+        }
+        eth_keccak256_final(&elements, word);
+    }
+
+    if (result == EIP712_ERROR_NONE) {
+        eth_keccak256_update(ctx, word, sizeof(word));
+    }
+    return result;
+}
+
+static int eip712_hash_struct(const eth_eip712_type_t *type, const eth_eip712_value_t *value,
+                              unsigned depth, uint8_t hash[32]) {
+    if (depth > EIP712_MAX_DEPTH || value->count != type->field_count ||
+        (!value->items && value->count > 0)) {
+        return EIP712_ERROR_VALUE;
+    }
+
+    eth_keccak_ctx_t ctx;
+    eth_keccak256_init(&ctx);
+    eth_keccak256_update(&ctx, type->type_hash.data, sizeof(type->type_hash.data));
+    for (size_t i = 0; i < type->field_count; i++) {
+        int result = eip712_encode_field(&ctx, &type->fields[i], &value->items[i], depth);
+        if (result != EIP712_ERROR_NONE) {
+            return result;
+        }
+    }
+    eth_keccak256_final(&ctx, hash);
+
+    return EIP712_ERROR_NONE;
+}
+
+int eth_eip712_hash_struct(const eth_eip712_type_t *type, const eth_eip712_value_t *value, eth_hash_t *hash) {
+    if (!type || !value || !hash) {
+        return EIP712_ERROR_INVALID;
+    }
+    return eip712_hash_struct(type, value, 0, hash->data);
+}
+
+/* keccak256 of a string into an encodeData word */
+static void eip712_hash_string(const char *text, uint8_t word[32]) {
+    eth_keccak_ctx_t ctx;
+    eth_keccak256_init(&ctx);
+    eth_keccak256_update(&ctx, (const uint8_t *)text, strlen(text));
+    eth_keccak256_final(&ctx, word);
+}
+
+int eth_eip712_domain_init(eth_eip712_domain_t *domain, const char *name, const char *version,
+                           uint64_t chain_id, const uint8_t *verifying_contract, const uint8_t *salt) {
+    if (!domain) {
+        return EIP712_ERROR_INVALID;
+    }
+
+    /* The type only lists the fields that are present */
+    static const char *const members[5] = {
+        "string name", "string version", "uint256 chainId", "address verifyingContract", "bytes32 salt"
+    };
+    int present[5] = { name != NULL, version != NULL, chain_id != 0, verifying_contract != NULL, salt != NULL };
+
+    eth_keccak_ctx_t type_ctx;
+    int first = 1;
+    eth_keccak256_init(&type_ctx);
+    eth_keccak256_update(&type_ctx, (const uint8_t *)"EIP712Domain(", 13);
+    for (int i = 0; i < 5; i++) {
+        if (!present[i]) {
+            continue;
+        }
+        if (!first) {
+            eth_keccak256_update(&type_ctx, (const uint8_t *)",", 1);
+        }
+        eth_keccak256_update(&type_ctx, (const uint8_t *)members[i], strlen(members[i]));
+        first = 0;
+    }
+    eth_keccak256_update(&type_ctx, (const uint8_t *)")", 1);
+
+    uint8_t word[32];
+    eth_keccak_ctx_t ctx;
+    eth_keccak256_final(&type_ctx, word);
+    eth_keccak256_init(&ctx);
+    eth_keccak256_update(&ctx, word, sizeof(word));
+
+    if (name) {
+        eip712_hash_string(name, word);
+        eth_keccak256_update(&ctx, word, sizeof(word));
+    }
+    if (version) {
+        eip712_hash_string(version, word);
+        eth_keccak256_update(&ctx, word, sizeof(word));
+    }
+    if (chain_id != 0) {
+        eth_u256_t number;
+        eth_u256_set_u64(&number, chain_id);
+        eth_u256_to_bytes(&number, word);
+        eth_keccak256_update(&ctx, word, sizeof(word));
+    }
+    if (verifying_contract) {
+        memset(word, 0, 12);
+        memcpy(word + 12, verifying_contract, 20);
+        eth_keccak256_update(&ctx, word, sizeof(word));
+    }
+    if (salt) {
+        eth_keccak256_update(&ctx, salt, 32);
+    }
+
+    eth_keccak256_final(&ctx, domain->separator.data);
+    return EIP712_ERROR_NONE;
+}
+
+int eth_eip712_domain_init_struct(eth_eip712_domain_t *domain, const eth_eip712_type_t *type,
+                                  const eth_eip712_value_t *value) {
+    if (!domain) {
+        return EIP712_ERROR_INVALID;
+    }
+    return eth_eip712_hash_struct(type, value, &domain->separator);
+}
+
+int eth_eip712_hash(const eth_eip712_domain_t *domain, const eth_eip712_type_t *type,
+                    const eth_eip712_value_t *message, eth_hash_t *digest) {
+    if (!domain || !digest) {
+        return EIP712_ERROR_INVALID;
+    }
+
+    eth_hash_t message_hash;
+    int result = eth_eip712_hash_struct(type, message, &message_hash);
+    if (result != EIP712_ERROR_NONE) {
+        return result;
+    }
+
+    static const uint8_t prefix[2] = { 0x19, 0x01 };
+    eth_keccak_ctx_t ctx;
+    eth_keccak256_init(&ctx);
+    eth_keccak256_update(&ctx, prefix, sizeof(prefix));
+    eth_keccak256_update(&ctx, domain->separator.data, sizeof(domain->separator.data));
+    eth_keccak256_update(&ctx, message_hash.data, sizeof(message_hash.data));
+    eth_keccak256_final(&ctx, digest->data);
+
+    return EIP712_ERROR_NONE;
+}
+
+int eth_eip712_sign(const eth_eip712_domain_t *domain, const eth_eip712_type_t *type,
+                    const eth_eip712_value_t *message, const eth_private_key_t *private_key,
+                    eth_signature_t *signature) {
+    if (!private_key || !signature) {
+        return EIP712_ERROR_INVALID;
+    }
+
+    eth_hash_t digest;
+    int result = eth_eip712_hash(domain, type, message, &digest);
+    if (result != EIP712_ERROR_NONE) {
+        return result;
+    }
+
+    return eth_sign(&digest, private_key, signature);
+}
@@ -0,0 +1,192 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/file_map.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define FILE_MAP_HAVE_MMAP 1
+#endif
+
+/* Error codes */
+#define FILE_MAP_ERROR_NONE     0
+#define FILE_MAP_ERROR_INVALID -1
+#define FILE_MAP_ERROR_IO      -2
+#define FILE_MAP_ERROR_NOMEM   -3
+#define FILE_MAP_ERROR_UNSIZED -4
+
+/* Fallback: read the whole file into the heap */
+static int file_map_read(eth_file_map_t *map, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return FILE_MAP_ERROR_IO;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        fclose(file);
+        return FILE_MAP_ERROR_IO;
+    }
+    long size = ftell(file);
+    if (size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return FILE_MAP_ERROR_IO;
+    }
+
+    uint8_t *data = NULL;
+    if (size > 0) {
+        data = malloc((size_t)size);
+        if (!data) {
+            fclose(file);
+            return FILE_MAP_ERROR_NOMEM;
+        }
+        if (fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            fclose(file);
+            return FILE_MAP_ERROR_IO;
+        }
+    }
+
+    fclose(file);
+    map->data = data;
+    map->size = (size_t)size;
+    map->mapped = 0;
+
+    return FILE_MAP_ERROR_NONE;
+}
+
+#if defined(FILE_MAP_HAVE_MMAP)
+
+/*
+ * Only regular files have a size to trust: pipes, FIFOs and devices report
+ * 0, and so do /proc files that still have contents, so an empty file is
+ * checked by reading from it
+ */
+static int file_map_check_size(int fd, const struct stat *st) {
+    if (!S_ISREG(st->st_mode)) {
+        return FILE_MAP_ERROR_UNSIZED;
+    }
+    if (st->st_size == 0) {
+        uint8_t probe;
+        if (read(fd, &probe, 1) != 0) {
+            return FILE_MAP_ERROR_UNSIZED;
+        }
+    }
+    return FILE_MAP_ERROR_NONE;
+}
+
+#endif /* FILE_MAP_HAVE_MMAP */
+
+int eth_file_size(const char *path, uint64_t *size) {
+    if (!path || !size) {
+        return FILE_MAP_ERROR_INVALID;
+    }
+
+#if defined(FILE_MAP_HAVE_MMAP)
+    /* O_NONBLOCK: opening a FIFO would otherwise wait for a writer before fstat can refuse it */
+    int fd = open(path, O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        return FILE_MAP_ERROR_IO;
+    }
+
+    struct stat st;
+    int result = fstat(fd, &st) == 0 ? file_map_check_size(fd, &st) : FILE_MAP_ERROR_IO;
+    close(fd);
+    if (result == FILE_MAP_ERROR_NONE) {
+        *size = (uint64_t)st.st_size;
+    }
+    return result;
+#else
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return FILE_MAP_ERROR_IO;
+    }
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    fclose(file);
+    if (length < 0) {
+        return FILE_MAP_ERROR_UNSIZED;
+    }
+    *size = (uint64_t)length;
+    return FILE_MAP_ERROR_NONE;
+#endif
+}
+
+int eth_file_map_open(eth_file_map_t *map, const char *path, int flags) {
+    if (!map || !path) {
+        return FILE_MAP_ERROR_INVALID;
+    }
+
+    map->data = NULL;
+    map->size = 0;
+    map->mapped = 0;
+
+#if defined(FILE_MAP_HAVE_MMAP)
+    int fd = open(path, O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        return FILE_MAP_ERROR_IO;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return FILE_MAP_ERROR_IO;
+    }
+
+    int result = file_map_check_size(fd, &st);
+    if (result != FILE_MAP_ERROR_NONE || st.st_size == 0) {
+        /* Not a regular file, or an empty one: nothing to map */
+        close(fd);
+        return result;
+    }
+
+    void *data = MAP_FAILED;
+    if ((uint64_t)st.st_size <= SIZE_MAX) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        /* Not mappable (too big for the address space, or no mmap for this file system): read it instead */
+        return (flags & ETH_FILE_MAP_NO_READ) ? FILE_MAP_ERROR_IO : file_map_read(map, path);
+    }
+
+    if (flags & ETH_FILE_MAP_SEQUENTIAL) {
+        /* Ask for aggressive readahead and early reclaim behind the reader */
+        posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    }
+
+    map->data = data;
+    map->size = (size_t)st.st_size;
+    map->mapped = 1;
+
+    return FILE_MAP_ERROR_NONE;
+#else
+    return (flags & ETH_FILE_MAP_NO_READ) ? FILE_MAP_ERROR_IO : file_map_read(map, path);
+#endif
+}
+
+void eth_file_map_close(eth_file_map_t *map) {
+    if (!map || !map->data) {
+        return;
+    }
+
+#if defined(FILE_MAP_HAVE_MMAP)
+    if (map->mapped) {
+        munmap((void *)map->data, map->size);
+    } else {
+        free((void *)map->data);
+    }
+#else
+    free((void *)map->data);
+#endif
+
+    map->data = NULL;
+    map->size = 0;
+    map->mapped = 0;
+}
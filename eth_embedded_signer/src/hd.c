@@ -0,0 +1,377 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../include/hd.h"
+#include "../include/pubkey.h"
+
+/* Error codes */
+#define HD_ERROR_NONE      0
+#define HD_ERROR_INVALID  -1
+#define HD_ERROR_HARDENED -2   /* Hardened child of a public-only node */
+#define HD_ERROR_CHILD    -3   /* I_L >= n or the child key is zero / infinity (BIP-32: use the next index) */
+#define HD_ERROR_PATH     -4
+
+/* Children per batch: one field inversion each, small enough for the stack */
+#define HD_BATCH 32
+
+/* Publish a point as the node's public key */
+static void hd_set_public(eth_hd_node_t *node, const eth_ge_t *point) {
+    eth_ge_get_public_key(&node->public_key, point);
+    eth_public_key_compress(&node->public_key, node->compressed);
+}
+
+/* Private key bytes, chain code and public key from I = I_L || I_R */
+static int hd_set_private(eth_hd_node_t *node, const eth_scalar_t *k, const uint8_t chain_code[32]) {
+    if (eth_scalar_is_zero(k)) {
+        return HD_ERROR_CHILD;
+    }
+
+    eth_gej_t point;
+    eth_ge_t affine;
+    eth_ec_mul_gen(&point, k);
+    eth_ge_set_gej(&affine, &point);
+
+    eth_scalar_get_bytes(node->private_key.data, k);
+    memcpy(node->chain_code, chain_code, 32);
+    node->has_private = 1;
+    hd_set_public(node, &affine);
+    return HD_ERROR_NONE;
+}
+
+int eth_hd_node_from_seed(eth_hd_node_t *node, const uint8_t *seed, size_t length) {
+    static const uint8_t key[] = "Bitcoin seed";
+
+    if (!node || !seed || length < 16 || length > 64) {
+        return HD_ERROR_INVALID;
+    }
+
+    uint8_t i[64];
+    eth_hmac_sha512(key, sizeof(key) - 1, seed, length, i);
+
+    memset(node, 0, sizeof(*node));
+    eth_scalar_t k;
+    int result = eth_scalar_set_bytes(&k, i) ? HD_ERROR_CHILD : hd_set_private(node, &k, i + 32);
+
+    memset(i, 0, sizeof(i));
+    memset(&k, 0, sizeof(k));
+    return result;
+}
+
+int eth_hd_node_from_public(eth_hd_node_t *node, const eth_public_key_t *public_key,
+                            const uint8_t chain_code[32]) {
+    if (!node || !public_key || !chain_code) {
+        return HD_ERROR_INVALID;
+    }
+
+    eth_ge_t point;
+    if (eth_ge_set_public_key(&point, public_key) != 0) {
+        return HD_ERROR_INVALID;
+    }
+
+    memset(node, 0, sizeof(*node));
+    memcpy(node->chain_code, chain_code, 32);
+    hd_set_public(node, &point);
+    return HD_ERROR_NONE;
+}
+
+int eth_hd_node_derive(const eth_hd_node_t *parent, uint32_t index, eth_hd_node_t *child) {
+    if (!parent || !child || parent == child) {
+        return HD_ERROR_INVALID;
+    }
+    if ((index & ETH_HD_HARDENED) && !parent->has_private) {
+        return HD_ERROR_HARDENED;
+    }
+
+    /* Hardened: 0x00 || k_par || i, otherwise serP(K_par) || i */
+    uint8_t data[37];
+    if (index & ETH_HD_HARDENED) {
+        data[0] = 0x00;
+        memcpy(data + 1, parent->private_key.data, 32);
+    } else {
+        memcpy(data, parent->compressed, 33);
+    }
+    data[33] = (uint8_t)(index >> 24);
+    data[34] = (uint8_t)(index >> 16);
+    data[35] = (uint8_t)(index >> 8);
+    data[36] = (uint8_t)index;
+
+    uint8_t i[64];
+    eth_hmac_sha512(parent->chain_code, 32, data, sizeof(data), i);
+
+    memset(child, 0, sizeof(*child));
+    child->depth = (uint8_t)(parent->depth + 1);
+    child->child_number = index;
+
+    eth_scalar_t tweak;
+    int result = HD_ERROR_NONE;
+    if (eth_scalar_set_bytes(&tweak, i)) {
+        result = HD_ERROR_CHILD;
+    } else if (parent->has_private) {
+        /* k_i = I_L + k_par */
+        eth_scalar_t k;
+        eth_scalar_set_bytes(&k, parent->private_key.data);
+        eth_scalar_add(&k, &k, &tweak);
+        result = hd_set_private(child, &k, i + 32);
+        memset(&k, 0, sizeof(k));
+    } else {
+        /* K_i = I_L * G + K_par */
+        eth_ge_t parent_point, affine;
+        eth_gej_t point;
+        eth_ge_set_public_key(&parent_point, &parent->public_key);
+        eth_ec_mul_gen_var(&point, &tweak);
+        eth_gej_add_ge_var(&point, &point, &parent_point);
+        if (point.infinity) {
+            result = HD_ERROR_CHILD;
+        } else {
+            eth_ge_set_gej(&affine, &point);
+            memcpy(child->chain_code, i + 32, 32);
+            hd_set_public(child, &affine);
+        }
+    }
+
+    memset(data, 0, sizeof(data));
+    memset(i, 0, sizeof(i));
+    memset(&tweak, 0, sizeof(tweak));
+    return result;
+}
+
+void eth_hd_node_neuter(eth_hd_node_t *node) {
+    if (node) {
+        memset(&node->private_key, 0, sizeof(node->private_key));
+        node->has_private = 0;
+    }
+}
+
+int eth_hd_parse_path(const char *text, uint32_t *path, size_t max, size_t *depth) {
+    if (!text || !depth || (!path && max > 0)) {
+        return HD_ERROR_INVALID;
+    }
+    if (text[0] != 'm') {
+        return HD_ERROR_PATH;
+    }
+
+    size_t count = 0;
+    const char *p = text + 1;
+    while (*p == '/') {
+        p++;
+        if (*p < '0' || *p > '9') {
+            return HD_ERROR_PATH;
+        }
+
+        uint32_t index = 0;
+        while (*p >= '0' && *p <= '9') {
+            index = index * 10 + (uint32_t)(*p - '0');
+            if (index >= ETH_HD_HARDENED) {
+                return HD_ERROR_PATH;
+            }
+            p++;
+        }
+        if (*p == '\'' || *p == 'h' || *p == 'H') {
+            index |= ETH_HD_HARDENED;
+            p++;
+        }
+
+        if (count == max) {
+            return HD_ERROR_PATH;
+        }
+        path[count++] = index;
+    }
+    if (*p != '\0') {
+        return HD_ERROR_PATH;
+    }
+
+    *depth = count;
+    return HD_ERROR_NONE;
+}
+
+void eth_hd_cache_init(eth_hd_cache_t *cache, const eth_hd_node_t *root) {
+    memset(cache, 0, sizeof(*cache));
+    cache->nodes[0] = *root;
+}
+
+int eth_hd_cache_derive(eth_hd_cache_t *cache, const uint32_t *path, size_t depth, const eth_hd_node_t **node) {
+    if (!cache || !node || depth > ETH_HD_MAX_DEPTH || (!path && depth > 0)) {
+        return HD_ERROR_INVALID;
+    }
+
+    size_t shared = 0;
+    while (shared < depth && shared < cache->depth && cache->path[shared] == path[shared]) {
+        shared++;
+    }
+
+    /* A prefix of the cached path keeps the deeper levels for later */
+    if (shared < depth) {
+        for (size_t level = shared; level < depth; level++) {
+            int result = eth_hd_node_derive(&cache->nodes[level], path[level], &cache->nodes[level + 1]);
+            if (result != HD_ERROR_NONE) {
+                cache->depth = level;
+                return result;
+            }
+            cache->path[level] = path[level];
+        }
+        cache->depth = depth;
+    }
+
+    *node = &cache->nodes[depth];
+    return HD_ERROR_NONE;
+}
+
+int eth_hd_cache_derive_path(eth_hd_cache_t *cache, const char *text, const eth_hd_node_t **node) {
+    uint32_t path[ETH_HD_MAX_DEPTH];
+    size_t depth;
+
+    int result = eth_hd_parse_path(text, path, ETH_HD_MAX_DEPTH, &depth);
+    if (result != HD_ERROR_NONE) {
+        return result;
+    }
+    return eth_hd_cache_derive(cache, path, depth, node);
+}
+
+void eth_hd_cache_wipe(eth_hd_cache_t *cache) {
+    if (cache) {
+        memset(cache, 0, sizeof(*cache));
+    }
+}
+
+int eth_hd_parent_init(eth_hd_parent_t *parent, const eth_hd_node_t *node) {
+    if (!parent || !node) {
+        return HD_ERROR_INVALID;
+    }
+    if (eth_ge_set_public_key(&parent->point, &node->public_key) != 0) {
+        return HD_ERROR_INVALID;
+    }
+
+    eth_hmac_sha512_init(&parent->hmac, node->chain_code, 32);
+    memcpy(parent->compressed, node->compressed, 33);
+    return HD_ERROR_NONE;
+}
+
+/* Range derivation shared by all workers */
+typedef struct {
+    const eth_hd_parent_t *parent;
+    uint32_t start;
+    uint32_t end;
+    eth_public_key_t *public_keys;
+    eth_address_t *addresses;
+    atomic_uint next_batch;          /* Next batch handed out */
+    atomic_int skipped;              /* Set when some child was invalid */
+} hd_range_ctx_t;
+
+/* Children [first, last) of the range */
+static void hd_range_batch(hd_range_ctx_t *ctx, uint32_t first, uint32_t last) {
+    const eth_hd_parent_t *parent = ctx->parent;
+    eth_gej_t points[HD_BATCH];
+    eth_ge_t affine[HD_BATCH];
+    size_t count = last - first;
+
+    if (count == 0 || count > HD_BATCH) {
+        return;
+    }
+
+    uint8_t data[37];
+    memcpy(data, parent->compressed, 33);
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t index = first + (uint32_t)i;
+        data[33] = (uint8_t)(index >> 24);
+        data[34] = (uint8_t)(index >> 16);
+        data[35] = (uint8_t)(index >> 8);
+        data[36] = (uint8_t)index;
+
+        /* The keyed HMAC state is copied, not rebuilt from the chain code */
+        eth_hmac_sha512_ctx_t hmac = parent->hmac;
+        uint8_t digest[64];
+        eth_hmac_sha512_update(&hmac, data, sizeof(data));
+        eth_hmac_sha512_final(&hmac, digest);
+
+        eth_scalar_t tweak;
+        if (eth_scalar_set_bytes(&tweak, digest)) {
+            memset(&points[i], 0, sizeof(points[i]));
+            points[i].infinity = 1;
+            continue;
+        }
+        eth_ec_mul_gen_var(&points[i], &tweak);
+        eth_gej_add_ge_var(&points[i], &points[i], &parent->point);
+    }
+
+    eth_ge_set_all_gej_var(affine, points, count);
+
+    for (size_t i = 0; i < count; i++) {
+        size_t slot = first - ctx->start + i;
+        eth_public_key_t public_key;
+
+        if (affine[i].infinity) {
+            memset(&public_key, 0, sizeof(public_key));
+            if (ctx->addresses) {
+                memset(&ctx->addresses[slot], 0, sizeof(ctx->addresses[slot]));
+            }
+            atomic_store_explicit(&ctx->skipped, 1, memory_order_relaxed);
+        } else {
+            eth_ge_get_public_key(&public_key, &affine[i]);
+            if (ctx->addresses) {
+                eth_public_key_to_address(&public_key, &ctx->addresses[slot]);
+            }
+        }
+        if (ctx->public_keys) {
+            ctx->public_keys[slot] = public_key;
+        }
+    }
+}
+
+static void hd_range_run(hd_range_ctx_t *ctx) {
+    for (;;) {
+        uint64_t batch = atomic_fetch_add_explicit(&ctx->next_batch, 1, memory_order_relaxed);
+        uint64_t first = ctx->start + batch * HD_BATCH;
+        if (first >= ctx->end) {
+            return;
+        }
+        uint64_t last = first + HD_BATCH < ctx->end ? first + HD_BATCH : ctx->end;
+        hd_range_batch(ctx, (uint32_t)first, (uint32_t)last);
+    }
+}
+
+static void *hd_range_thread(void *arg) {
+    hd_range_run(arg);
+    return NULL;
+}
+
+int eth_hd_derive_range(const eth_hd_parent_t *parent, uint32_t start, uint32_t end, unsigned threads,
+                        eth_public_key_t *public_keys, eth_address_t *addresses) {
+    if (!parent || (!public_keys && !addresses) || start > end || end > ETH_HD_HARDENED) {
+        return HD_ERROR_INVALID;
+    }
+
+    hd_range_ctx_t ctx;
+    ctx.parent = parent;
+    ctx.start = start;
+    ctx.end = end;
+    ctx.public_keys = public_keys;
+    ctx.addresses = addresses;
+    atomic_init(&ctx.next_batch, 0);
+    atomic_init(&ctx.skipped, 0);
+
+    /* No more threads than batches */
+    uint32_t batches = (end - start + HD_BATCH - 1) / HD_BATCH;
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > batches) {
+        threads = batches > 0 ? batches : 1;
+    }
+
+    /* If a thread cannot be started the others take its share */
+    pthread_t *workers = threads > 1 ? malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    unsigned started = 0;
+    while (workers && started < threads - 1 &&
+           pthread_create(&workers[started], NULL, hd_range_thread, &ctx) == 0) {
+        started++;
+    }
+    hd_range_run(&ctx);
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+
+    return atomic_load_explicit(&ctx.skipped, memory_order_relaxed) ? ETH_HD_SKIPPED : HD_ERROR_NONE;
+}
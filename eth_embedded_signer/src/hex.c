@@ -0,0 +1,276 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "../include/hex.h"
+#include "../include/cpu.h"
+
+#if ETH_CPU_DISPATCH && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HEX_HAVE_X86_KERNELS 1
+#endif
+
+/* Error codes */
+#define HEX_ERROR_NONE          0
+#define HEX_ERROR_INVALID      -1
+#define HEX_ERROR_BUFFER_SMALL -2
+#define HEX_ERROR_DIGIT        -3
+#define HEX_ERROR_ODD_LENGTH   -4
+
+/* Kernel signatures: encode length bytes, decode length bytes (2 * length digits) */
+typedef void (*hex_encode_fn)(const uint8_t *data, size_t length, char *output);
+typedef int (*hex_decode_fn)(const char *input, size_t length, uint8_t *output);
+
+static const char hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
+/* Digit value for every character, 0xff for anything that is not a hex digit */
+static const uint8_t hex_values[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/* Scalar kernels */
+
+static void hex_encode_scalar(const uint8_t *data, size_t length, char *output) {
+    for (size_t i = 0; i < length; i++) {
+        output[2 * i] = hex_digits[data[i] >> 4];
+        output[2 * i + 1] = hex_digits[data[i] & 0x0f];
+    }
+}
+
+static int hex_decode_scalar(const char *input, size_t length, uint8_t *output) {
+    uint8_t invalid = 0;
+
+    /* Collect invalid digits in one flag instead of branching per character */
+    for (size_t i = 0; i < length; i++) {
+        uint8_t hi = hex_values[(uint8_t)input[2 * i]];
+        uint8_t lo = hex_values[(uint8_t)input[2 * i + 1]];
+        invalid |= hi | lo;
+        output[i] = (uint8_t)((hi << 4) | (lo & 0x0f));
+    }
+
+    return (invalid & 0xf0) ? HEX_ERROR_DIGIT : HEX_ERROR_NONE;
+}
+
+#if defined(HEX_HAVE_X86_KERNELS)
+
+/*
+ * SIMD kernels. Encoding splits each byte into nibbles and maps them to
+ * characters with a 16-entry shuffle table. Decoding classifies every
+ * character as digit or letter with unsigned range checks, then folds
+ * nibble pairs into bytes with a multiply-add (hi * 16 + lo).
+ */
+
+__attribute__((target("ssse3")))
+static void hex_encode_ssse3(const uint8_t *data, size_t length, char *output) {
+    const __m128i table = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+        __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(in, nibble));
+        _mm_storeu_si128((__m128i *)(output + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(output + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+
+    hex_encode_scalar(data + i, length - i, output + 2 * i);
+}
+
+/* Convert 16 characters to nibble values, clearing *valid lanes that are not hex digits */
+__attribute__((target("ssse3")))
+static __m128i hex_nibbles_ssse3(__m128i chars, __m128i *valid) {
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    *valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_letter));
+
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static int hex_decode_ssse3(const char *input, size_t length, uint8_t *output) {
+    const __m128i weights = _mm_set1_epi16(0x0110); /* bytes 16, 1: hi * 16 + lo */
+    __m128i valid = _mm_set1_epi8(-1);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i a = hex_nibbles_ssse3(_mm_loadu_si128((const __m128i *)(input + 2 * i)), &valid);
+        __m128i b = hex_nibbles_ssse3(_mm_loadu_si128((const __m128i *)(input + 2 * i + 16)), &valid);
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128((__m128i *)(output + i), bytes);
+    }
+
+    if (_mm_movemask_epi8(valid) != 0xffff) {
+        return HEX_ERROR_DIGIT;
+    }
+
+    return hex_decode_scalar(input + 2 * i, length - i, output + i);
+}
+
+__attribute__((target("avx2")))
+static void hex_encode_avx2(const uint8_t *data, size_t length, char *output) {
+    const __m256i table = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                           '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                           '0', '1', '2', '3', '4', '5', '6', '7',
+                                           '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+        __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(in, nibble));
+        /* Interleaving works per 128-bit lane, so put the lanes back in order */
+        __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(output + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *)(output + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+
+    hex_encode_ssse3(data + i, length - i, output + 2 * i);
+}
+
+/* Convert 32 characters to nibble values, clearing *valid lanes that are not hex digits */
+__attribute__((target("avx2")))
+static __m256i hex_nibbles_avx2(__m256i chars, __m256i *valid) {
+    __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+    *valid = _mm256_and_si256(*valid, _mm256_or_si256(is_digit, is_letter));
+
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static int hex_decode_avx2(const char *input, size_t length, uint8_t *output) {
+    const __m256i weights = _mm256_set1_epi16(0x0110); /* bytes 16, 1: hi * 16 + lo */
+    __m256i valid = _mm256_set1_epi8(-1);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i a = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(input + 2 * i)), &valid);
+        __m256i b = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(input + 2 * i + 32)), &valid);
+        __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+        /* Packing works per 128-bit lane, so put the quadwords back in order */
+        _mm256_storeu_si256((__m256i *)(output + i), _mm256_permute4x64_epi64(bytes, 0xd8));
+    }
+
+    if (_mm256_movemask_epi8(valid) != -1) {
+        return HEX_ERROR_DIGIT;
+    }
+
+    return hex_decode_ssse3(input + 2 * i, length - i, output + i);
+}
+
+#endif /* HEX_HAVE_X86_KERNELS */
+
+/* Selected kernels, resolved on first use */
+typedef struct {
+    hex_encode_fn encode;
+    hex_decode_fn decode;
+    const char *name;
+} hex_backend_t;
+
+static const hex_backend_t *hex_select(void) {
+    static const hex_backend_t scalar = { hex_encode_scalar, hex_decode_scalar, "scalar" };
+#if defined(HEX_HAVE_X86_KERNELS)
+    static const hex_backend_t ssse3 = { hex_encode_ssse3, hex_decode_ssse3, "ssse3" };
+    static const hex_backend_t avx2 = { hex_encode_avx2, hex_decode_avx2, "avx2" };
+
+    uint32_t features = eth_cpu_features();
+
+    if (features & ETH_CPU_AVX2) {
+        return &avx2;
+    }
+    if (features & ETH_CPU_SSSE3) {
+        return &ssse3;
+    }
+#endif
+    return &scalar;
+}
+
+static const hex_backend_t *hex_backend_get(void) {
+#if !ETH_CPU_DISPATCH
+    return hex_select();
+#else
+    /* Racing first calls all pick the same table, so relaxed ordering is enough */
+    static _Atomic(const hex_backend_t *) backend = NULL;
+    const hex_backend_t *selected = atomic_load_explicit(&backend, memory_order_relaxed);
+
+    if (!selected) {
+        selected = hex_select();
+        atomic_store_explicit(&backend, selected, memory_order_relaxed);
+    }
+    return selected;
+#endif
+}
+
+/* Public API */
+
+int eth_hex_encode(const uint8_t *data, size_t length, char *output, size_t output_size) {
+    if ((!data && length > 0) || (!output && length > 0)) {
+        return HEX_ERROR_INVALID;
+    }
+    if (length > output_size / 2) {
+        return HEX_ERROR_BUFFER_SMALL;
+    }
+
+    hex_backend_get()->encode(data, length, output);
+
+    return HEX_ERROR_NONE;
+}
+
+int eth_hex_decode(const char *input, size_t input_len, uint8_t *output, size_t output_size, size_t *output_len) {
+    if ((!input && input_len > 0) || !output_len) {
+        return HEX_ERROR_INVALID;
+    }
+
+    /* Optional 0x prefix */
+    if (input_len >= 2 && input[0] == '0' && (input[1] == 'x' || input[1] == 'X')) {
+        input += 2;
+        input_len -= 2;
+    }
+
+    if (input_len % 2 != 0) {
+        return HEX_ERROR_ODD_LENGTH;
+    }
+    if (input_len / 2 > output_size || (!output && input_len > 0)) {
+        return HEX_ERROR_BUFFER_SMALL;
+    }
+
+    int result = hex_backend_get()->decode(input, input_len / 2, output);
+    if (result != HEX_ERROR_NONE) {
+        return result;
+    }
+
+    *output_len = input_len / 2;
+
+    return HEX_ERROR_NONE;
+}
+
+const char *eth_hex_backend(void) {
+    return hex_backend_get()->name;
+}
@@ -0,0 +1,215 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "../include/keccak.h"
+#include "../include/cpu.h"
+
+#if ETH_CPU_DISPATCH && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KECCAK_HAVE_X86_KERNELS 1
+#endif
+
+/* The permutation body is compiled once per kernel, each time with that kernel's instruction set */
+#if defined(__GNUC__)
+#define KECCAK_BODY static inline __attribute__((always_inline))
+#else
+#define KECCAK_BODY static inline
+#endif
+
+/* Round constants for the iota step */
+static const uint64_t keccak_round_constants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+static inline uint64_t keccak_rotl(uint64_t value, unsigned shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+/* Keccak-f[1600] permutation, one round per iteration with theta, rho, pi and chi unrolled */
+KECCAK_BODY void keccak_f1600_body(uint64_t state[25]) {
+    uint64_t b[25], c[5], d[5];
+
+    for (int round = 0; round < 24; round++) {
+        /* Theta */
+        c[0] = state[0] ^ state[5] ^ state[10] ^ state[15] ^ state[20];
+        c[1] = state[1] ^ state[6] ^ state[11] ^ state[16] ^ state[21];
+        c[2] = state[2] ^ state[7] ^ state[12] ^ state[17] ^ state[22];
+        c[3] = state[3] ^ state[8] ^ state[13] ^ state[18] ^ state[23];
+        c[4] = state[4] ^ state[9] ^ state[14] ^ state[19] ^ state[24];
+        d[0] = c[4] ^ keccak_rotl(c[1], 1);
+        d[1] = c[0] ^ keccak_rotl(c[2], 1);
+        d[2] = c[1] ^ keccak_rotl(c[3], 1);
+        d[3] = c[2] ^ keccak_rotl(c[4], 1);
+        d[4] = c[3] ^ keccak_rotl(c[0], 1);
+
+        /* Rho and pi: lane (x, y) moves to (y, 2x + 3y) */
+        b[0] = state[0] ^ d[0];
+        b[10] = keccak_rotl(state[1] ^ d[1], 1);
+        b[20] = keccak_rotl(state[2] ^ d[2], 62);
+        b[5] = keccak_rotl(state[3] ^ d[3], 28);
+        b[15] = keccak_rotl(state[4] ^ d[4], 27);
+        b[16] = keccak_rotl(state[5] ^ d[0], 36);
+        b[1] = keccak_rotl(state[6] ^ d[1], 44);
+        b[11] = keccak_rotl(state[7] ^ d[2], 6);
+        b[21] = keccak_rotl(state[8] ^ d[3], 55);
+        b[6] = keccak_rotl(state[9] ^ d[4], 20);
+        b[7] = keccak_rotl(state[10] ^ d[0], 3);
+        b[17] = keccak_rotl(state[11] ^ d[1], 10);
+        b[2] = keccak_rotl(state[12] ^ d[2], 43);
+        b[12] = keccak_rotl(state[13] ^ d[3], 25);
+        b[22] = keccak_rotl(state[14] ^ d[4], 39);
+        b[23] = keccak_rotl(state[15] ^ d[0], 41);
+        b[8] = keccak_rotl(state[16] ^ d[1], 45);
+        b[18] = keccak_rotl(state[17] ^ d[2], 15);
+        b[3] = keccak_rotl(state[18] ^ d[3], 21);
+        b[13] = keccak_rotl(state[19] ^ d[4], 8);
+        b[14] = keccak_rotl(state[20] ^ d[0], 18);
+        b[24] = keccak_rotl(state[21] ^ d[1], 2);
+        b[9] = keccak_rotl(state[22] ^ d[2], 61);
+        b[19] = keccak_rotl(state[23] ^ d[3], 56);
+        b[4] = keccak_rotl(state[24] ^ d[4], 14);
+
+        /* Chi */
+        state[0] = b[0] ^ (~b[1] & b[2]);
+        state[1] = b[1] ^ (~b[2] & b[3]);
+        state[2] = b[2] ^ (~b[3] & b[4]);
+        state[3] = b[3] ^ (~b[4] & b[0]);
+        state[4] = b[4] ^ (~b[0] & b[1]);
+        state[5] = b[5] ^ (~b[6] & b[7]);
+        state[6] = b[6] ^ (~b[7] & b[8]);
+        state[7] = b[7] ^ (~b[8] & b[9]);
+        state[8] = b[8] ^ (~b[9] & b[5]);
+        state[9] = b[9] ^ (~b[5] & b[6]);
+        state[10] = b[10] ^ (~b[11] & b[12]);
+        state[11] = b[11] ^ (~b[12] & b[13]);
+        state[12] = b[12] ^ (~b[13] & b[14]);
+        state[13] = b[13] ^ (~b[14] & b[10]);
+        state[14] = b[14] ^ (~b[10] & b[11]);
+        state[15] = b[15] ^ (~b[16] & b[17]);
+        state[16] = b[16] ^ (~b[17] & b[18]);
+        state[17] = b[17] ^ (~b[18] & b[19]);
+        state[18] = b[18] ^ (~b[19] & b[15]);
+        state[19] = b[19] ^ (~b[15] & b[16]);
+        state[20] = b[20] ^ (~b[21] & b[22]);
+        state[21] = b[21] ^ (~b[22] & b[23]);
+        state[22] = b[22] ^ (~b[23] & b[24]);
+        state[23] = b[23] ^ (~b[24] & b[20]);
+        state[24] = b[24] ^ (~b[20] & b[21]);
+
+        /* Iota */
+        state[0] ^= keccak_round_constants[round];
+    }
+}
+
+typedef void (*keccak_permute_fn)(uint64_t state[25]);
+
+static void keccak_f1600_scalar(uint64_t state[25]) {
+    keccak_f1600_body(state);
+}
+
+#if defined(KECCAK_HAVE_X86_KERNELS)
+
+/* Same rounds; chi becomes andn and the rotations rorx, which leave the flags alone */
+__attribute__((target("bmi,bmi2")))
+static void keccak_f1600_bmi2(uint64_t state[25]) {
+    keccak_f1600_body(state);
+}
+
+#endif /* KECCAK_HAVE_X86_KERNELS */
+
+/* Selected kernel, resolved on first use */
+typedef struct {
+    keccak_permute_fn permute;
+    const char *name;
+} keccak_backend_t;
+
+static const keccak_backend_t *keccak_select(void) {
+    static const keccak_backend_t scalar = { keccak_f1600_scalar, "scalar" };
+#if defined(KECCAK_HAVE_X86_KERNELS)
+    static const keccak_backend_t bmi2 = { keccak_f1600_bmi2, "bmi2" };
+
+    if (eth_cpu_features() & ETH_CPU_BMI2) {
+        return &bmi2;
+    }
+#endif
+    return &scalar;
+}
+
+static const keccak_backend_t *keccak_backend_get(void) {
+#if !ETH_CPU_DISPATCH
+    return keccak_select();
+#else
+    /* Racing first calls all pick the same table, so relaxed ordering is enough */
+    static _Atomic(const keccak_backend_t *) backend = NULL;
+    const keccak_backend_t *selected = atomic_load_explicit(&backend, memory_order_relaxed);
+
+    if (!selected) {
+        selected = keccak_select();
+        atomic_store_explicit(&backend, selected, memory_order_relaxed);
+    }
+    return selected;
+#endif
+}
+
+/* Little-endian lane load, independent of host byte order */
+static inline uint64_t keccak_load64(const uint8_t *bytes) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void eth_keccak256_init(eth_keccak_ctx_t *ctx) {
+    memset(ctx, 0, sizeof(eth_keccak_ctx_t));
+}
+
+void eth_keccak256_update(eth_keccak_ctx_t *ctx, const uint8_t *input, size_t length) {
+    keccak_permute_fn permute = keccak_backend_get()->permute;
+    size_t offset = ctx->offset;
+
+    /* Finish a partial block byte by byte */
+    while (length > 0 && (offset != 0 || length < ETH_KECCAK256_RATE)) {
+        ctx->state[offset / 8] ^= (uint64_t)*input++ << (8 * (offset % 8));
+        length--;
+        if (++offset == ETH_KECCAK256_RATE) {
+            permute(ctx->state);
+            offset = 0;
+        }
+    }
+
+    /* Whole blocks a lane at a time */
+    while (length >= ETH_KECCAK256_RATE) {
+        for (int i = 0; i < ETH_KECCAK256_RATE / 8; i++) {
+            ctx->state[i] ^= keccak_load64(input + 8 * i);
+        }
+        permute(ctx->state);
+        input += ETH_KECCAK256_RATE;
+        length -= ETH_KECCAK256_RATE;
+    }
+
+    /* Leftover bytes start a new partial block */
+    for (; length > 0; length--, offset++) {
+        ctx->state[offset / 8] ^= (uint64_t)*input++ << (8 * (offset % 8));
+    }
+
+    ctx->offset = offset;
+}
+
+void eth_keccak256_final(eth_keccak_ctx_t *ctx, uint8_t output[32]) {
+    /* Keccak padding: 0x01 after the message, 0x80 in the last byte of the block */
+    ctx->state[ctx->offset / 8] ^= (uint64_t)0x01 << (8 * (ctx->offset % 8));
+    ctx->state[(ETH_KECCAK256_RATE - 1) / 8] ^= (uint64_t)0x80 << (8 * ((ETH_KECCAK256_RATE - 1) % 8));
+    keccak_backend_get()->permute(ctx->state);
+
+    for (int i = 0; i < 32; i++) {
+        output[i] = (uint8_t)(ctx->state[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+const char *eth_keccak_backend(void) {
+    return keccak_backend_get()->name;
+}
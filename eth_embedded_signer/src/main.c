@@ -1,17 +1,51 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include "../include/crypto.h"
 #include "../include/transaction.h"
 #include "../include/rlp.h"
+#include "../include/batch_sign.h"
+#include "../include/hex.h"
+#include "../include/abi.h"
+#include "../include/policy.h"
+#include "../include/tx_root.h"
+#include "../include/file_map.h"
+#include "../include/personal_sign.h"
+#include "../include/hd.h"
+#include "../include/pubkey.h"
+#include "../include/cpu.h"
+#include "../include/keccak.h"
+#include "../include/sha256.h"
+#include "../include/ec.h"
+#include "abi_selectors.h"
 
 /* Print a byte array as hex */
 static void print_hex(const uint8_t *data, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        printf("%02x", data[i]);
+    char text[256];
+    
+    /* Encode in chunks so long calldata doesn't need a big stack buffer */
+    while (length > 0) {
+        size_t chunk = length < sizeof(text) / 2 ? length : sizeof(text) / 2;
+        eth_hex_encode(data, chunk, text, sizeof(text));
+        fwrite(text, 1, chunk * 2, stdout);
+        data += chunk;
+        length -= chunk;
     }
 }
 
+/* Print a quantity as minimal big-endian hex ("00" for zero) */
+static void print_u256(const eth_u256_t *value) {
+    uint8_t bytes[32];
+    size_t length = eth_u256_byte_length(value);
+    
+    eth_u256_to_bytes(value, bytes);
+    if (length == 0) {
+        length = 1;
+    }
+    print_hex(bytes + 32 - length, length);
+}
+
 /* Make a test private key (never use this for real ETH!) */
 static void generate_sample_private_key(eth_private_key_t *private_key) {
     /* This is a fixed test key, super insecure, just for demo */
@@ -32,13 +66,8 @@ static void create_sample_eip1559_transaction(eth_transaction_t *tx) {
     tx->nonce = 42;   /* Just a random nonce */
     
     /* Set gas parameters */
-    uint8_t max_priority_fee[1] = { 0x01 }; /* 1 gwei */
-    tx->max_priority_fee_len = 1;
-    memcpy(tx->max_priority_fee, max_priority_fee, tx->max_priority_fee_len);
-    
-    uint8_t max_fee[1] = { 0x05 }; /* 5 gwei */
-    tx->max_fee_len = 1;
-    memcpy(tx->max_fee, max_fee, tx->max_fee_len);
+    eth_u256_set_u64(&tx->max_priority_fee, 1); /* 1 gwei */
+    eth_u256_set_u64(&tx->max_fee, 5);          /* 5 gwei */
     
     tx->gas_limit = 21000; /* Standard ETH transfer gas */
     
@@ -51,9 +80,7 @@ static void create_sample_eip1559_transaction(eth_transaction_t *tx) {
     memcpy(tx->to, to, tx->to_len);
     
     /* Set transaction value (1 ETH = 10^18 wei) */
-    uint8_t value[4] = { 0x0d, 0xe0, 0xb6, 0xb3 }; /* 0.0001 ETH, just for fun */
-    tx->value_len = 4;
-    memcpy(tx->value, value, tx->value_len);
+    eth_u256_set_hex(&tx->value, "0x0de0b6b3", 10); /* 0.0001 ETH, just for fun */
     
     /* No data for a simple ETH transfer */
     tx->data = NULL;
@@ -67,9 +94,7 @@ static void create_sample_legacy_transaction(eth_transaction_t *tx) {
     tx->nonce = 42;   /* Just a random nonce */
     
     /* Set gas parameters */
-    uint8_t gas_price[1] = { 0x03 }; /* 3 gwei */
-    tx->gas_price_len = 1;
-    memcpy(tx->gas_price, gas_price, tx->gas_price_len);
+    eth_u256_set_u64(&tx->gas_price, 3); /* 3 gwei */
     
     tx->gas_limit = 21000; /* Standard ETH transfer gas */
     
@@ -82,9 +107,7 @@ static void create_sample_legacy_transaction(eth_transaction_t *tx) {
     memcpy(tx->to, to, tx->to_len);
     
     /* Set transaction value (1 ETH = 10^18 wei) */
-    uint8_t value[4] = { 0x0d, 0xe0, 0xb6, 0xb3 }; /* 0.0001 ETH, just for fun */
-    tx->value_len = 4;
-    memcpy(tx->value, value, tx->value_len);
+    eth_u256_set_hex(&tx->value, "0x0de0b6b3", 10); /* 0.0001 ETH, just for fun */
     
     /* No data for a simple ETH transfer */
     tx->data = NULL;
@@ -98,13 +121,8 @@ static void create_sample_contract_interaction(eth_transaction_t *tx) {
     tx->nonce = 42;   /* Just a random nonce */
     
     /* Set gas parameters */
-    uint8_t max_priority_fee[1] = { 0x01 }; /* 1 gwei */
-    tx->max_priority_fee_len = 1;
-    memcpy(tx->max_priority_fee, max_priority_fee, tx->max_priority_fee_len);
-    
-    uint8_t max_fee[1] = { 0x05 }; /* 5 gwei */
-    tx->max_fee_len = 1;
-    memcpy(tx->max_fee, max_fee, tx->max_fee_len);
+    eth_u256_set_u64(&tx->max_priority_fee, 1); /* 1 gwei */
+    eth_u256_set_u64(&tx->max_fee, 5);          /* 5 gwei */
     
     tx->gas_limit = 150000; /* More gas for contract call */
     
@@ -117,24 +135,24 @@ static void create_sample_contract_interaction(eth_transaction_t *tx) {
     memcpy(tx->to, to, tx->to_len);
     
     /* Value: 0 ETH for this tx */
-    uint8_t value[1] = { 0x00 };
-    tx->value_len = 1;
-    memcpy(tx->value, value, tx->value_len);
-    
-    /* Example function call: transfer(address,uint256) with address and value arguments */
-    /* Function signature: transfer(address,uint256) = 0xa9059cbb */
-    /* Address parameter: 0x1234567890abcdef1234567890abcdef12345678 [//TODO: make this a variable] */
-    /* Value parameter: 1000000000000000000 (1 ETH) */
-    static uint8_t data[] = {
-        0xa9, 0x05, 0x9c, 0xbb, /* Function signature */
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* Padding */
-        0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x12, 0x34, 0x56, 0x78, /* Address */
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* Padding */
-        0x0d, 0xe0, 0xb6, 0xb3, 0xa7, 0x64, 0x00, 0x00 /* Value: 1 ETH (0x0de0b6b3a7640000) */
-    };
+    eth_u256_set_u64(&tx->value, 0);
     
-    tx->data = data;
-    tx->data_len = sizeof(data);
+    /* Example function call: transfer(recipient, 1 ETH), encoded into a static arena */
+    static const uint8_t recipient[20] = {
+        0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x12, 0x34,
+        0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x12, 0x34, 0x56, 0x78
+    };
+    static uint8_t calldata[4 + 2 * 32];
+    eth_arena_t arena;
+    eth_abi_encoder_t encoder;
+    eth_u256_t amount;
+    
+    eth_u256_set_u64(&amount, 1000000000000000000ULL); /* 1 ETH in wei */
+    eth_arena_init(&arena, calldata, sizeof(calldata));
+    eth_abi_encode_begin(&encoder, &arena, ETH_ABI_SELECTOR_TRANSFER, 2);
+    eth_abi_put_address(&encoder, recipient);
+    eth_abi_put_uint(&encoder, &amount);
+    eth_abi_encode_end(&encoder, &tx->data, &tx->data_len);
 }
 
 /* Demo function to showcase crypto operations */
@@ -159,9 +177,18 @@ static void demo_crypto_operations(void) {
     print_hex(hash.data, 32);
     printf("\n");
     
+    /* The same message as personal_sign hashes it (EIP-191 prefix) */
+    eth_hash_t personal_hash;
+    eth_personal_hash((const uint8_t *)message, strlen(message), &personal_hash);
+    
+    printf("personal_sign hash: ");
+    print_hex(personal_hash.data, 32);
+    printf("\n");
+    
     /* Sign the hash */
     eth_signature_t signature;
-    result = eth_sign(&hash, &private_key, &signature);
+    uint8_t recovery_id = 0;
+    result = eth_sign_recoverable(&hash, &private_key, &signature, &recovery_id);
     
     printf("Signature R: ");
     print_hex(signature.data, 32);
@@ -173,7 +200,7 @@ static void demo_crypto_operations(void) {
     
     /* Recover public key from signature */
     eth_public_key_t public_key;
-    result = eth_recover_public_key(&signature, &hash, 0, &public_key);
+    result = eth_recover_public_key(&signature, &hash, recovery_id, &public_key);
     
     printf("Public key X: ");
     print_hex(public_key.data, 32);
@@ -208,17 +235,17 @@ static void demo_transaction_signing(void) {
     printf("- Chain ID: %lu\n", tx.chain_id);
     printf("- Nonce: %lu\n", tx.nonce);
     printf("- Max priority fee: 0x");
-    print_hex(tx.max_priority_fee, tx.max_priority_fee_len);
+    print_u256(&tx.max_priority_fee);
     printf("\n");
     printf("- Max fee: 0x");
-    print_hex(tx.max_fee, tx.max_fee_len);
+    print_u256(&tx.max_fee);
     printf("\n");
     printf("- Gas limit: %lu\n", tx.gas_limit);
     printf("- To: 0x");
     print_hex(tx.to, tx.to_len);
     printf("\n");
     printf("- Value: 0x");
-    print_hex(tx.value, tx.value_len);
+    print_u256(&tx.value);
     printf("\n");
     
     /* Create buffer for encoded transaction */
@@ -243,7 +270,7 @@ static void demo_transaction_signing(void) {
     /* Sign the transaction */
     result = eth_tx_sign(&tx, &private_key);
     
-    printf("Signature V: %u\n", tx.v);
+    printf("Signature V: %llu\n", (unsigned long long)tx.v);
     printf("Signature R: 0x");
     print_hex(tx.r, 32);
     printf("\n");
@@ -364,7 +391,488 @@ static void demo_contract_interaction(void) {
     printf("\n");
 }
 
-int main(void) {
+/* Print command line usage */
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s                 run the demo\n", program);
+    fprintf(stderr, "  %s sign-batch --in <txs.bin> --out <raw.bin|-> --key-file <key.hex>\n", program);
+    fprintf(stderr, "             [--threads N] [--policy <rules.txt>] [--hex | --rpc [--rpc-batch N]]\n");
+    fprintf(stderr, "  %s tx-root --in <raw.bin> [--threads N]\n", program);
+    fprintf(stderr, "  %s personal-sign --in <file> --key-file <key.hex>\n", program);
+    fprintf(stderr, "  %s hd-addresses --seed-file <seed.hex> --path <m/44'/60'/0'/0> --count N\n", program);
+    fprintf(stderr, "             [--start N] [--threads N]\n");
+    fprintf(stderr, "  %s decompress-keys --in <keys33.bin> [--out <keys64.bin>] [--threads N]\n", program);
+    fprintf(stderr, "  %s cpu-info           show CPU features and selected kernels (%s overrides)\n", program,
+            ETH_CPU_ENV);
+}
+
+/* Load up to 'capacity' bytes stored as hex (optional 0x, surrounding whitespace) */
+static int load_hex_file(const char *path, uint8_t *output, size_t capacity, size_t *length_out) {
+    char text[260];
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+
+    /* Filling the whole buffer means the file is longer than any key or seed: refuse it rather than cut it short */
+    size_t length = fread(text, 1, sizeof(text), file);
+    fclose(file);
+    if (length == sizeof(text)) {
+        memset(text, 0, sizeof(text));
+        return -1;
+    }
+
+    /* Trim surrounding whitespace */
+    char *start = text;
+    while (length > 0 && (*start == ' ' || *start == '\t' || *start == '\n' || *start == '\r')) {
+        start++;
+        length--;
+    }
+    while (length > 0 && (start[length - 1] == ' ' || start[length - 1] == '\t' ||
+                          start[length - 1] == '\n' || start[length - 1] == '\r')) {
+        length--;
+    }
+
+    int result = eth_hex_decode(start, length, output, capacity, length_out);
+
+    /* Don't leave secrets lying around on the stack */
+    memset(text, 0, sizeof(text));
+
+    return result == 0 ? 0 : -1;
+}
+
+/* Load a private key stored as 64 hex characters */
+static int load_private_key_file(const char *path, eth_private_key_t *private_key) {
+    size_t key_len = 0;
+    int result = load_hex_file(path, private_key->data, sizeof(private_key->data), &key_len);
+
+    return (result == 0 && key_len == sizeof(private_key->data)) ? 0 : -1;
+}
+
+/* Report a transaction sign-batch could not sign */
+static void sign_batch_failure(uint64_t index, int status, eth_policy_result_t reason, void *context) {
+    (void)context;
+
+    if (status == ETH_POLICY_DENIED) {
+        fprintf(stderr, "sign-batch: transaction %llu denied by policy: %s\n",
+                (unsigned long long)index, eth_policy_result_string(reason));
+    } else {
+        fprintf(stderr, "sign-batch: transaction %llu failed (%d)\n", (unsigned long long)index, status);
+    }
+}
+
+/* sign-batch command: sign a file of unsigned transactions in parallel */
+static int command_sign_batch(int argc, char **argv) {
+    eth_batch_sign_options_t options;
+    const char *key_path = NULL;
+    const char *policy_path = NULL;
+    eth_private_key_t private_key;
+    eth_policy_t policy;
+
+    memset(&options, 0, sizeof(options));
+    options.threads = 1;
+    options.format = ETH_BATCH_OUTPUT_BINARY;
+    options.on_failure = sign_batch_failure;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--in") == 0 && i + 1 < argc) {
+            options.input_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (strcmp(argv[i], "--key-file") == 0 && i + 1 < argc) {
+            key_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            long threads = strtol(argv[++i], NULL, 10);
+            if (threads < 1 || threads > 1024) {
+                fprintf(stderr, "sign-batch: --threads must be between 1 and 1024\n");
+                return 2;
+            }
+            options.threads = (unsigned)threads;
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            policy_path = argv[++i];
+        } else if (strcmp(argv[i], "--hex") == 0) {
+            options.format = ETH_BATCH_OUTPUT_HEX;
+        } else if (strcmp(argv[i], "--rpc") == 0) {
+            options.format = ETH_BATCH_OUTPUT_RPC;
+        } else if (strcmp(argv[i], "--rpc-batch") == 0 && i + 1 < argc) {
+            long batch_size = strtol(argv[++i], NULL, 10);
+            if (batch_size < 1 || batch_size > 1000000) {
+                fprintf(stderr, "sign-batch: --rpc-batch must be between 1 and 1000000\n");
+                return 2;
+            }
+            options.rpc_batch_size = (unsigned)batch_size;
+        } else {
+            fprintf(stderr, "sign-batch: unknown or incomplete option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!options.input_path || !options.output_path || !key_path) {
+        fprintf(stderr, "sign-batch: --in, --out and --key-file are required\n");
+        return 2;
+    }
+
+    if (load_private_key_file(key_path, &private_key) != 0) {
+        fprintf(stderr, "sign-batch: could not read a 32-byte hex key from '%s'\n", key_path);
+        return 1;
+    }
+    options.private_key = &private_key;
+
+    if (policy_path) {
+        if (eth_policy_load_file(&policy, policy_path) != 0) {
+            fprintf(stderr, "sign-batch: bad policy file '%s' (line %u)\n", policy_path, policy.error_line);
+            memset(&private_key, 0, sizeof(private_key));
+            return 1;
+        }
+        options.policy = &policy;
+    }
+
+    eth_batch_sign_stats_t stats;
+    int result = eth_batch_sign_file(&options, &stats);
+    memset(&private_key, 0, sizeof(private_key));
+    if (policy_path) {
+        eth_policy_free(&policy);
+    }
+
+    if (result == ETH_BATCH_UNREADABLE) {
+        fprintf(stderr, "sign-batch: '%s' is not a readable batch file\n", options.input_path);
+        return 1;
+    }
+    if (result == ETH_BATCH_MALFORMED) {
+        fprintf(stderr, "sign-batch: malformed record %llu\n", (unsigned long long)stats.malformed_index);
+    }
+
+    fprintf(stderr, "sign-batch: %llu signed, %llu failed (%llu denied by policy)\n",
+            (unsigned long long)stats.signed_count, (unsigned long long)stats.failed_count,
+            (unsigned long long)stats.denied_count);
+
+    return result == 0 ? 0 : 1;
+}
+
+/* tx-root command: transactions root of a sign-batch binary output file */
+static int command_tx_root(int argc, char **argv) {
+    const char *input_path = NULL;
+    unsigned threads = 1;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--in") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            if (value < 1 || value > 1024) {
+                fprintf(stderr, "tx-root: --threads must be between 1 and 1024\n");
+                return 2;
+            }
+            threads = (unsigned)value;
+        } else {
+            fprintf(stderr, "tx-root: unknown or incomplete option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!input_path) {
+        fprintf(stderr, "tx-root: --in is required\n");
+        return 2;
+    }
+
+    eth_file_map_t map;
+    if (eth_file_map_open(&map, input_path, ETH_FILE_MAP_SEQUENTIAL) != 0) {
+        fprintf(stderr, "tx-root: cannot read '%s'\n", input_path);
+        return 1;
+    }
+
+    /* Records are a 4-byte little-endian length followed by the raw transaction */
+    size_t count = 0;
+    for (size_t offset = 0; offset + 4 <= map.size; count++) {
+        offset += 4 + ((size_t)map.data[offset] | ((size_t)map.data[offset + 1] << 8) |
+                       ((size_t)map.data[offset + 2] << 16) | ((size_t)map.data[offset + 3] << 24));
+    }
+
+    const uint8_t **raw_txs = malloc((count + 1) * sizeof(*raw_txs));
+    size_t *lengths = malloc((count + 1) * sizeof(*lengths));
+    size_t arena_size = eth_tx_root_arena_size(count, threads);
+    void *arena_memory = malloc(arena_size);
+    int result = -1;
+
+    if (raw_txs && lengths && arena_memory) {
+        size_t offset = 0;
+        result = 0;
+        for (size_t i = 0; i < count; i++) {
+            lengths[i] = (size_t)map.data[offset] | ((size_t)map.data[offset + 1] << 8) |
+                         ((size_t)map.data[offset + 2] << 16) | ((size_t)map.data[offset + 3] << 24);
+            raw_txs[i] = map.data + offset + 4;
+            offset += 4 + lengths[i];
+            if (offset > map.size) {
+                fprintf(stderr, "tx-root: '%s' ends inside record %zu\n", input_path, i);
+                result = 1;
+                break;
+            }
+        }
+
+        uint8_t root[32];
+        eth_arena_t arena;
+        if (result == 0 && eth_arena_init(&arena, arena_memory, arena_size) == 0 &&
+            eth_tx_root(raw_txs, lengths, count, &arena, threads, root) == 0) {
+            printf("0x");
+            print_hex(root, sizeof(root));
+            printf("\n");
+        } else if (result == 0) {
+            result = -1;
+        }
+    }
+
+    if (result < 0) {
+        fprintf(stderr, "tx-root: failed to compute the root\n");
+    }
+
+    free(arena_memory);
+    free(lengths);
+    free(raw_txs);
+    eth_file_map_close(&map);
+
+    return result == 0 ? 0 : 1;
+}
+
+/* personal-sign command: EIP-191 signature over the contents of a file */
+static int command_personal_sign(int argc, char **argv) {
+    const char *input_path = NULL;
+    const char *key_path = NULL;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--in") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--key-file") == 0 && i + 1 < argc) {
+            key_path = argv[++i];
+        } else {
+            fprintf(stderr, "personal-sign: unknown or incomplete option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!input_path || !key_path) {
+        fprintf(stderr, "personal-sign: --in and --key-file are required\n");
+        return 2;
+    }
+
+    eth_private_key_t private_key;
+    if (load_private_key_file(key_path, &private_key) != 0) {
+        fprintf(stderr, "personal-sign: could not read a 32-byte hex key from '%s'\n", key_path);
+        return 1;
+    }
+
+    eth_hash_t hash;
+    eth_signature_t signature;
+    int result = eth_personal_sign_file(input_path, &private_key, &hash, &signature);
+    memset(&private_key, 0, sizeof(private_key));
+    if (result != 0) {
+        fprintf(stderr, "personal-sign: cannot sign '%s'\n", input_path);
+        return 1;
+    }
+
+    printf("hash: 0x");
+    print_hex(hash.data, sizeof(hash.data));
+    printf("\nsignature: 0x");
+    print_hex(signature.data, sizeof(signature.data));
+    printf("\n");
+
+    return 0;
+}
+
+/* hd-addresses command: addresses of consecutive children of an HD path */
+static int command_hd_addresses(int argc, char **argv) {
+    const char *seed_path = NULL;
+    const char *path = NULL;
+    unsigned long long start = 0;
+    unsigned long long count = 0;
+    unsigned threads = 1;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--seed-file") == 0 && i + 1 < argc) {
+            seed_path = argv[++i];
+        } else if (strcmp(argv[i], "--path") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            start = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            if (value < 1 || value > 1024) {
+                fprintf(stderr, "hd-addresses: --threads must be between 1 and 1024\n");
+                return 2;
+            }
+            threads = (unsigned)value;
+        } else {
+            fprintf(stderr, "hd-addresses: unknown or incomplete option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!seed_path || !path || count == 0) {
+        fprintf(stderr, "hd-addresses: --seed-file, --path and --count are required\n");
+        return 2;
+    }
+    if (start + count > ETH_HD_HARDENED) {
+        fprintf(stderr, "hd-addresses: indexes must stay below 2^31\n");
+        return 2;
+    }
+
+    uint8_t seed[64];
+    size_t seed_length = 0;
+    if (load_hex_file(seed_path, seed, sizeof(seed), &seed_length) != 0) {
+        fprintf(stderr, "hd-addresses: could not read a hex seed from '%s'\n", seed_path);
+        return 1;
+    }
+
+    eth_hd_node_t root;
+    eth_hd_cache_t cache;
+    const eth_hd_node_t *account = NULL;
+    eth_hd_parent_t parent;
+    int result = eth_hd_node_from_seed(&root, seed, seed_length);
+    memset(seed, 0, sizeof(seed));
+    if (result == 0) {
+        eth_hd_cache_init(&cache, &root);
+        result = eth_hd_cache_derive_path(&cache, path, &account);
+        if (result == 0) {
+            result = eth_hd_parent_init(&parent, account);
+        }
+        eth_hd_cache_wipe(&cache);
+    }
+    memset(&root, 0, sizeof(root));
+    if (result != 0) {
+        fprintf(stderr, "hd-addresses: cannot derive '%s' from the seed\n", path);
+        return 1;
+    }
+
+    eth_address_t *addresses = malloc((size_t)count * sizeof(*addresses));
+    if (!addresses) {
+        fprintf(stderr, "hd-addresses: out of memory\n");
+        return 1;
+    }
+
+    result = eth_hd_derive_range(&parent, (uint32_t)start, (uint32_t)(start + count), threads, NULL, addresses);
+    if (result >= 0) {
+        for (unsigned long long i = 0; i < count; i++) {
+            printf("%llu 0x", start + i);
+            print_hex(addresses[i].data, sizeof(addresses[i].data));
+            printf("\n");
+        }
+        if (result == ETH_HD_SKIPPED) {
+            fprintf(stderr, "hd-addresses: some indexes have no valid child (printed as zero)\n");
+        }
+    }
+    free(addresses);
+
+    return result >= 0 ? 0 : 1;
+}
+
+/* decompress-keys command: validate a file of compressed public keys, optionally expanding it */
+static int command_decompress_keys(int argc, char **argv) {
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    unsigned threads = 1;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--in") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            if (value < 1 || value > 1024) {
+                fprintf(stderr, "decompress-keys: --threads must be between 1 and 1024\n");
+                return 2;
+            }
+            threads = (unsigned)value;
+        } else {
+            fprintf(stderr, "decompress-keys: unknown or incomplete option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!input_path) {
+        fprintf(stderr, "decompress-keys: --in is required\n");
+        return 2;
+    }
+
+    eth_file_map_t map;
+    if (eth_file_map_open(&map, input_path, ETH_FILE_MAP_SEQUENTIAL) != 0) {
+        fprintf(stderr, "decompress-keys: cannot read '%s'\n", input_path);
+        return 1;
+    }
+    if (map.size % ETH_PUBLIC_KEY_COMPRESSED_SIZE != 0) {
+        fprintf(stderr, "decompress-keys: '%s' is not a whole number of 33-byte keys\n", input_path);
+        eth_file_map_close(&map);
+        return 1;
+    }
+
+    size_t count = map.size / ETH_PUBLIC_KEY_COMPRESSED_SIZE;
+    eth_public_key_t *public_keys = malloc((count + 1) * sizeof(*public_keys));
+    uint8_t *valid = malloc(count + 1);
+    int result = -1;
+
+    if (public_keys && valid) {
+        result = eth_public_key_decompress_batch(map.data, count, threads, public_keys, valid);
+    }
+    if (result >= 0) {
+        size_t invalid = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!valid[i]) {
+                fprintf(stderr, "decompress-keys: key %zu is not a valid public key\n", i);
+                invalid++;
+            }
+        }
+        fprintf(stderr, "decompress-keys: %zu keys, %zu invalid\n", count, invalid);
+
+        if (output_path) {
+            FILE *out = fopen(output_path, "wb");
+            if (!out || fwrite(public_keys, sizeof(*public_keys), count, out) != count) {
+                fprintf(stderr, "decompress-keys: cannot write '%s'\n", output_path);
+                result = -1;
+            }
+            if (out && fclose(out) != 0) {
+                result = -1;
+            }
+        }
+        if (invalid > 0 && result >= 0) {
+            result = 1;
+        }
+    } else {
+        fprintf(stderr, "decompress-keys: out of memory\n");
+    }
+
+    free(valid);
+    free(public_keys);
+    eth_file_map_close(&map);
+
+    return result == 0 ? 0 : 1;
+}
+
+/* Detected and usable CPU features and the kernel each module selected */
+static int command_cpu_info(int argc, char **argv) {
+    char features[128];
+    const char *override = getenv(ETH_CPU_ENV);
+
+    (void)argv;
+    if (argc > 0) {
+        fprintf(stderr, "cpu-info: takes no options\n");
+        return 2;
+    }
+
+    eth_cpu_describe(eth_cpu_detected(), features, sizeof(features));
+    printf("detected:  %s\n", features[0] ? features : "(none)");
+    eth_cpu_describe(eth_cpu_features(), features, sizeof(features));
+    printf("usable:    %s\n", features[0] ? features : "(none)");
+    printf("override:  %s\n", override && override[0] ? override : "(unset)");
+    printf("keccak:    %s\n", eth_keccak_backend());
+    printf("sha256:    %s\n", eth_sha256_backend());
+    printf("field:     %s\n", eth_fe_backend());
+    printf("hex:       %s\n", eth_hex_backend());
+    return 0;
+}
+
+/* Run all the demos */
+static int run_demo(void) {
     printf("Ethereum Embedded Signer Demo\n");
     printf("=============================\n");
     
@@ -377,4 +885,34 @@ int main(void) {
     printf("\nDemo completed successfully!\n");
     
     return 0;
-} 
\ No newline at end of file
+}
+
+int main(int argc, char **argv) {
+    eth_cpu_init();
+
+    if (argc < 2) {
+        return run_demo();
+    }
+
+    if (strcmp(argv[1], "sign-batch") == 0) {
+        return command_sign_batch(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "tx-root") == 0) {
+        return command_tx_root(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "personal-sign") == 0) {
+        return command_personal_sign(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "hd-addresses") == 0) {
+        return command_hd_addresses(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "decompress-keys") == 0) {
+        return command_decompress_keys(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "cpu-info") == 0) {
+        return command_cpu_info(argc - 2, argv + 2);
+    }
+
+    print_usage(argv[0]);
+    return 2;
+}
\ No newline at end of file
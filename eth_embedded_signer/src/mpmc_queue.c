@@ -0,0 +1,231 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include "../include/mpmc_queue.h"
+
+/* Error codes */
+#define QUEUE_ERROR_NONE      0
+#define QUEUE_ERROR_INVALID  -1
+#define QUEUE_ERROR_NOMEM    -2
+#define QUEUE_ERROR_FULL     -3
+#define QUEUE_ERROR_EMPTY    -4
+#define QUEUE_ERROR_STOPPED  -5
+
+/* Round up to the next power of two (minimum 2) */
+static size_t round_up_pow2(size_t value) {
+    size_t result = 2;
+
+    while (result < value) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+int eth_mpmc_queue_init(eth_mpmc_queue_t *queue, size_t capacity) {
+    if (!queue || capacity == 0 || capacity > (SIZE_MAX >> 2)) {
+        return QUEUE_ERROR_INVALID;
+    }
+
+    capacity = round_up_pow2(capacity);
+
+    queue->cells = malloc(capacity * sizeof(eth_mpmc_cell_t));
+    if (!queue->cells) {
+        return QUEUE_ERROR_NOMEM;
+    }
+
+    /* Cell i is free for the producer whose position is i */
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&queue->cells[i].sequence, i);
+        queue->cells[i].item = NULL;
+    }
+
+    if (pthread_mutex_init(&queue->park_lock, NULL) != 0) {
+        free(queue->cells);
+        queue->cells = NULL;
+        return QUEUE_ERROR_NOMEM;
+    }
+    if (pthread_cond_init(&queue->park_wake, NULL) != 0) {
+        pthread_mutex_destroy(&queue->park_lock);
+        free(queue->cells);
+        queue->cells = NULL;
+        return QUEUE_ERROR_NOMEM;
+    }
+
+    queue->mask = capacity - 1;
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    atomic_init(&queue->epoch, 0);
+    atomic_init(&queue->parked, 0);
+
+    return QUEUE_ERROR_NONE;
+}
+
+void eth_mpmc_queue_free(eth_mpmc_queue_t *queue) {
+    if (!queue) {
+        return;
+    }
+
+    if (queue->cells) {
+        pthread_cond_destroy(&queue->park_wake);
+        pthread_mutex_destroy(&queue->park_lock);
+    }
+    free(queue->cells);
+    queue->cells = NULL;
+    queue->mask = 0;
+}
+
+/*
+ * Wake parked consumers after a push. The epoch bump and the parked count
+ * pair with the consumer's count increment and epoch read (all sequentially
+ * consistent): either the consumer's last look at the queue sees the item,
+ * or this sees the consumer and signals it under the lock.
+ */
+static void queue_wake(eth_mpmc_queue_t *queue, int all) {
+    atomic_fetch_add_explicit(&queue->epoch, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->parked, memory_order_seq_cst) == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue->park_lock);
+    if (all) {
+        pthread_cond_broadcast(&queue->park_wake);
+    } else {
+        pthread_cond_signal(&queue->park_wake);
+    }
+    pthread_mutex_unlock(&queue->park_lock);
+}
+
+int eth_mpmc_queue_push(eth_mpmc_queue_t *queue, void *item) {
+    if (!queue || !item) {
+        return QUEUE_ERROR_INVALID;
+    }
+
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        eth_mpmc_cell_t *cell = &queue->cells[pos & queue->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            /* Cell is free for this position: try to claim it */
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->item = item;
+                /* Hand the cell over to the consumer of this position */
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                queue_wake(queue, 0);
+                return QUEUE_ERROR_NONE;
+            }
+            /* Lost the race, pos was reloaded by the CAS */
+        } else if (diff < 0) {
+            /* Consumer of the previous lap has not released the cell yet */
+            return QUEUE_ERROR_FULL;
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+int eth_mpmc_queue_pop(eth_mpmc_queue_t *queue, void **item) {
+    if (!queue || !item) {
+        return QUEUE_ERROR_INVALID;
+    }
+
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+
+    for (;;) {
+        eth_mpmc_cell_t *cell = &queue->cells[pos & queue->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            /* Cell holds an item for this position: try to claim it */
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *item = cell->item;
+                /* Free the cell for the producer one lap ahead */
+                atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+                return QUEUE_ERROR_NONE;
+            }
+        } else if (diff < 0) {
+            /* Producer has not filled this cell yet */
+            return QUEUE_ERROR_EMPTY;
+        } else {
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+int eth_mpmc_queue_pop_wait(eth_mpmc_queue_t *queue, const atomic_int *stop, void **item) {
+    if (!queue || !item) {
+        return QUEUE_ERROR_INVALID;
+    }
+
+    unsigned spins = 0;
+    for (;;) {
+        if (eth_mpmc_queue_pop(queue, item) == QUEUE_ERROR_NONE) {
+            return QUEUE_ERROR_NONE;
+        }
+        if (stop && atomic_load_explicit(stop, memory_order_acquire)) {
+            return QUEUE_ERROR_STOPPED;
+        }
+        if (spins < ETH_MPMC_SPIN_LIMIT) {
+            eth_mpmc_backoff(&spins);
+            continue;
+        }
+
+        /* Announce the wait, then look once more before sleeping */
+        atomic_fetch_add_explicit(&queue->parked, 1, memory_order_seq_cst);
+        unsigned epoch = atomic_load_explicit(&queue->epoch, memory_order_seq_cst);
+        int result = QUEUE_ERROR_EMPTY;
+        if (eth_mpmc_queue_pop(queue, item) == QUEUE_ERROR_NONE) {
+            result = QUEUE_ERROR_NONE;
+        } else if (stop && atomic_load_explicit(stop, memory_order_acquire)) {
+            result = QUEUE_ERROR_STOPPED;
+        } else {
+            pthread_mutex_lock(&queue->park_lock);
+            while (atomic_load_explicit(&queue->epoch, memory_order_seq_cst) == epoch) {
+                pthread_cond_wait(&queue->park_wake, &queue->park_lock);
+            }
+            pthread_mutex_unlock(&queue->park_lock);
+        }
+        atomic_fetch_sub_explicit(&queue->parked, 1, memory_order_relaxed);
+
+        if (result != QUEUE_ERROR_EMPTY) {
+            return result;
+        }
+        spins = 0;
+    }
+}
+
+void eth_mpmc_queue_wake_all(eth_mpmc_queue_t *queue) {
+    if (!queue || !queue->cells) {
+        return;
+    }
+    queue_wake(queue, 1);
+}
+
+size_t eth_mpmc_queue_capacity(const eth_mpmc_queue_t *queue) {
+    return (queue && queue->cells) ? queue->mask + 1 : 0;
+}
+
+void eth_mpmc_backoff(unsigned *spins) {
+    if (!spins) {
+        return;
+    }
+
+    /* Spin briefly, then yield, then sleep, so waiters do not burn a core */
+    if (*spins < 64) {
+        (*spins)++;
+    } else if (*spins < ETH_MPMC_SPIN_LIMIT) {
+        (*spins)++;
+        sched_yield();
+    } else {
+        struct timespec delay = { 0, 100000 }; /* 100us */
+        nanosleep(&delay, NULL);
+    }
+}
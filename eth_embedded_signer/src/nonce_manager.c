@@ -0,0 +1,289 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/nonce_manager.h"
+#include "../include/mpmc_queue.h"
+
+/* Error codes */
+#define NONCE_ERROR_NONE       0
+#define NONCE_ERROR_INVALID   -1
+#define NONCE_ERROR_NOMEM     -2
+#define NONCE_ERROR_FULL      -3
+#define NONCE_ERROR_UNKNOWN   -4
+#define NONCE_ERROR_GAPS_FULL -5
+#define NONCE_ERROR_RESYNC    -6
+
+/* Entry states */
+#define NONCE_ENTRY_EMPTY     0
+#define NONCE_ENTRY_INSERTING 1
+#define NONCE_ENTRY_READY     2
+
+/*
+ * Hash all 20 bytes of an address. Vanity and CREATE2 addresses can share
+ * long prefixes, so every word is mixed in.
+ */
+static size_t nonce_hash(const eth_address_t *address) {
+    uint64_t head, middle;
+    uint32_t tail;
+
+    memcpy(&head, address->data, sizeof(head));
+    memcpy(&middle, address->data + 8, sizeof(middle));
+    memcpy(&tail, address->data + 16, sizeof(tail));
+
+    uint64_t hash = head * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 29) ^ middle) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 32) ^ tail) * 0x94d049bb133111ebULL;
+    return (size_t)(hash ^ (hash >> 31));
+}
+
+/* Find the entry for an address, optionally inserting it (linear probing) */
+static eth_nonce_entry_t *nonce_find(eth_nonce_manager_t *manager, const eth_address_t *address, int create) {
+    size_t index = nonce_hash(address) & manager->mask;
+
+    for (size_t probe = 0; probe <= manager->mask; probe++) {
+        eth_nonce_entry_t *entry = &manager->entries[(index + probe) & manager->mask];
+        unsigned state = atomic_load_explicit(&entry->state, memory_order_acquire);
+
+        if (state == NONCE_ENTRY_EMPTY) {
+            if (!create) {
+                return NULL;
+            }
+
+            /* Claim the empty slot, publish the key once it is written */
+            if (atomic_compare_exchange_strong_explicit(&entry->state, &state, NONCE_ENTRY_INSERTING,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                memcpy(&entry->address, address, sizeof(eth_address_t));
+                atomic_store_explicit(&entry->state, NONCE_ENTRY_READY, memory_order_release);
+                return entry;
+            }
+            /* Someone else claimed it, state now holds their value */
+        }
+
+        /* Wait for a concurrent insert to publish its key */
+        unsigned spins = 0;
+        while (state == NONCE_ENTRY_INSERTING) {
+            eth_mpmc_backoff(&spins);
+            state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        }
+
+        if (memcmp(&entry->address, address, sizeof(eth_address_t)) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+int eth_nonce_manager_init(eth_nonce_manager_t *manager, size_t capacity) {
+    if (!manager || capacity == 0 || capacity > (SIZE_MAX >> 2)) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    /* Keep the load factor at or below one half */
+    size_t size = 4;
+    while (size < capacity * 2) {
+        size <<= 1;
+    }
+
+    manager->entries = calloc(size, sizeof(eth_nonce_entry_t));
+    if (!manager->entries) {
+        return NONCE_ERROR_NOMEM;
+    }
+    manager->mask = size - 1;
+
+    for (size_t i = 0; i < size; i++) {
+        eth_nonce_entry_t *entry = &manager->entries[i];
+        atomic_init(&entry->state, NONCE_ENTRY_EMPTY);
+        atomic_init(&entry->resync, 0);
+        atomic_flag_clear(&entry->ticket_lock);
+        atomic_init(&entry->next, 0);
+        atomic_init(&entry->committed, 0);
+        for (int g = 0; g < ETH_NONCE_GAP_SLOTS; g++) {
+            atomic_init(&entry->gaps[g], 0);
+        }
+    }
+
+    return NONCE_ERROR_NONE;
+}
+
+void eth_nonce_manager_free(eth_nonce_manager_t *manager) {
+    if (!manager) {
+        return;
+    }
+
+    free(manager->entries);
+    manager->entries = NULL;
+    manager->mask = 0;
+}
+
+int eth_nonce_set(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t next_nonce) {
+    if (!manager || !manager->entries || !address) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 1);
+    if (!entry) {
+        return NONCE_ERROR_FULL;
+    }
+
+    for (int g = 0; g < ETH_NONCE_GAP_SLOTS; g++) {
+        atomic_store_explicit(&entry->gaps[g], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&entry->committed, next_nonce, memory_order_relaxed);
+    atomic_store_explicit(&entry->next, next_nonce, memory_order_release);
+    atomic_store_explicit(&entry->resync, 0, memory_order_release);
+
+    return NONCE_ERROR_NONE;
+}
+
+/* Hand out the lowest released nonce, or the next fresh one */
+static int nonce_take(eth_nonce_entry_t *entry, uint64_t *nonce) {
+    /* A lost release left a hole only a resync can close */
+    if (atomic_load_explicit(&entry->resync, memory_order_acquire)) {
+        return NONCE_ERROR_RESYNC;
+    }
+
+    for (;;) {
+        /* Find the lowest released nonce */
+        uint_fast64_t lowest = 0;
+        int lowest_slot = -1;
+
+        for (int g = 0; g < ETH_NONCE_GAP_SLOTS; g++) {
+            uint_fast64_t gap = atomic_load_explicit(&entry->gaps[g], memory_order_acquire);
+            if (gap != 0 && (lowest_slot < 0 || gap < lowest)) {
+                lowest = gap;
+                lowest_slot = g;
+            }
+        }
+
+        if (lowest_slot < 0) {
+            /* No gaps: take a fresh nonce */
+            *nonce = atomic_fetch_add_explicit(&entry->next, 1, memory_order_acq_rel);
+            return NONCE_ERROR_NONE;
+        }
+
+        /* Claim the gap, rescan if another thread got there first */
+        if (atomic_compare_exchange_strong_explicit(&entry->gaps[lowest_slot], &lowest, 0,
+                                                    memory_order_acq_rel, memory_order_relaxed)) {
+            *nonce = lowest - 1;
+            return NONCE_ERROR_NONE;
+        }
+    }
+}
+
+int eth_nonce_reserve(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t *nonce) {
+    if (!manager || !manager->entries || !address || !nonce) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 1);
+    if (!entry) {
+        return NONCE_ERROR_FULL;
+    }
+
+    return nonce_take(entry, nonce);
+}
+
+int eth_nonce_reserve_ticket(eth_nonce_manager_t *manager, const eth_address_t *address,
+                             atomic_uint_fast64_t *counter, uint64_t *nonce, uint64_t *ticket) {
+    if (!manager || !manager->entries || !address || !counter || !nonce || !ticket) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 1);
+    if (!entry) {
+        return NONCE_ERROR_FULL;
+    }
+
+    /* Only reservations for this address wait here, and only for two atomic operations */
+    unsigned spins = 0;
+    while (atomic_flag_test_and_set_explicit(&entry->ticket_lock, memory_order_acquire)) {
+        eth_mpmc_backoff(&spins);
+    }
+
+    int result = nonce_take(entry, nonce);
+    if (result == NONCE_ERROR_NONE) {
+        *ticket = atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+    }
+
+    atomic_flag_clear_explicit(&entry->ticket_lock, memory_order_release);
+
+    return result;
+}
+
+int eth_nonce_commit(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t nonce) {
+    if (!manager || !manager->entries || !address) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 0);
+    if (!entry) {
+        return NONCE_ERROR_UNKNOWN;
+    }
+
+    /* Raise the watermark to nonce + 1 (atomic max) */
+    uint_fast64_t current = atomic_load_explicit(&entry->committed, memory_order_relaxed);
+    while (current < nonce + 1 &&
+           !atomic_compare_exchange_weak_explicit(&entry->committed, &current, nonce + 1,
+                                                  memory_order_release, memory_order_relaxed)) {
+        /* current reloaded by the CAS */
+    }
+
+    return NONCE_ERROR_NONE;
+}
+
+int eth_nonce_release(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t nonce) {
+    if (!manager || !manager->entries || !address) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 0);
+    if (!entry) {
+        return NONCE_ERROR_UNKNOWN;
+    }
+
+    /* Most recent reservation: just roll the counter back, no gap is left */
+    uint_fast64_t expected = nonce + 1;
+    if (atomic_compare_exchange_strong_explicit(&entry->next, &expected, nonce,
+                                                memory_order_acq_rel, memory_order_relaxed)) {
+        return NONCE_ERROR_NONE;
+    }
+
+    /* Otherwise park it in a free gap slot for the next reserve */
+    for (int g = 0; g < ETH_NONCE_GAP_SLOTS; g++) {
+        uint_fast64_t empty = 0;
+        if (atomic_compare_exchange_strong_explicit(&entry->gaps[g], &empty, nonce + 1,
+                                                    memory_order_acq_rel, memory_order_relaxed)) {
+            return NONCE_ERROR_NONE;
+        }
+    }
+
+    /* No room: the nonce would be lost silently, so stop the address until it is resynced */
+    atomic_store_explicit(&entry->resync, 1, memory_order_release);
+
+    return NONCE_ERROR_GAPS_FULL;
+}
+
+int eth_nonce_committed(eth_nonce_manager_t *manager, const eth_address_t *address, uint64_t *committed) {
+    if (!manager || !manager->entries || !address || !committed) {
+        return NONCE_ERROR_INVALID;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 0);
+    if (!entry) {
+        return NONCE_ERROR_UNKNOWN;
+    }
+
+    *committed = atomic_load_explicit(&entry->committed, memory_order_acquire);
+
+    return NONCE_ERROR_NONE;
+}
+
+int eth_nonce_needs_resync(eth_nonce_manager_t *manager, const eth_address_t *address) {
+    if (!manager || !manager->entries || !address) {
+        return 0;
+    }
+
+    eth_nonce_entry_t *entry = nonce_find(manager, address, 0);
+
+    return entry && atomic_load_explicit(&entry->resync, memory_order_acquire) ? 1 : 0;
+}
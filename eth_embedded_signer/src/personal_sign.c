@@ -0,0 +1,165 @@
+#include <string.h>
+#include "../include/personal_sign.h"
+#include "../include/file_map.h"
+
+/* Error codes */
+#define PERSONAL_ERROR_NONE     0
+#define PERSONAL_ERROR_INVALID -1
+#define PERSONAL_ERROR_LENGTH  -2
+#define PERSONAL_ERROR_IO      -3
+
+/* "\x19Ethereum Signed Message:\n" */
+#define PERSONAL_PREFIX        "\x19" "Ethereum Signed Message:\n"
+#define PERSONAL_PREFIX_LENGTH (sizeof(PERSONAL_PREFIX) - 1)
+
+int eth_personal_init(eth_personal_ctx_t *ctx, uint64_t length) {
+    if (!ctx) {
+        return PERSONAL_ERROR_INVALID;
+    }
+
+    /* Decimal length, most significant digit first */
+    char digits[20];
+    size_t digit_count = 0;
+    uint64_t rest = length;
+    do {
+        digits[sizeof(digits) - 1 - digit_count++] = (char)('0' + rest % 10);
+        rest /= 10;
+    } while (rest > 0);
+
+    eth_keccak256_init(&ctx->keccak);
+    eth_keccak256_update(&ctx->keccak, (const uint8_t *)PERSONAL_PREFIX, PERSONAL_PREFIX_LENGTH);
+    eth_keccak256_update(&ctx->keccak, (const uint8_t *)digits + sizeof(digits) - digit_count, digit_count);
+
+    ctx->remaining = length;
+
+    return PERSONAL_ERROR_NONE;
+}
+
+int eth_personal_update(eth_personal_ctx_t *ctx, const uint8_t *data, size_t length) {
+    if (!ctx || (!data && length > 0)) {
+        return PERSONAL_ERROR_INVALID;
+    }
+    if ((uint64_t)length > ctx->remaining) {
+        return PERSONAL_ERROR_LENGTH;
+    }
+
+    eth_keccak256_update(&ctx->keccak, data, length);
+    ctx->remaining -= length;
+
+    return PERSONAL_ERROR_NONE;
+}
+
+int eth_personal_final(eth_personal_ctx_t *ctx, eth_hash_t *hash) {
+    if (!ctx || !hash) {
+        return PERSONAL_ERROR_INVALID;
+    }
+    if (ctx->remaining != 0) {
+        return PERSONAL_ERROR_LENGTH;
+    }
+
+    eth_keccak256_final(&ctx->keccak, hash->data);
+    return PERSONAL_ERROR_NONE;
+}
+
+int eth_personal_hash(const uint8_t *message, size_t length, eth_hash_t *hash) {
+    eth_personal_ctx_t ctx;
+
+    int result = eth_personal_init(&ctx, length);
+    if (result == PERSONAL_ERROR_NONE) {
+        result = eth_personal_update(&ctx, message, length);
+    }
+    if (result == PERSONAL_ERROR_NONE) {
+        result = eth_personal_final(&ctx, hash);
+    }
+    return result;
+}
+
+int eth_personal_sign(const uint8_t *message, size_t length, const eth_private_key_t *private_key,
+                      eth_signature_t *signature) {
+    if (!private_key || !signature) {
+        return PERSONAL_ERROR_INVALID;
+    }
+
+    eth_hash_t hash;
+    int result = eth_personal_hash(message, length, &hash);
+    if (result != PERSONAL_ERROR_NONE) {
+        return result;
+    }
+
+    return eth_sign(&hash, private_key, signature);
+}
+
+/* Sign a finished hash, handing the hash back if asked for */
+static int personal_finish(eth_personal_ctx_t *ctx, const eth_private_key_t *private_key,
+                           eth_hash_t *hash, eth_signature_t *signature) {
+    eth_hash_t digest;
+
+    int result = eth_personal_final(ctx, &digest);
+    if (result != PERSONAL_ERROR_NONE) {
+        return result;
+    }
+    if (hash) {
+        *hash = digest;
+    }
+
+    return eth_sign(&digest, private_key, signature);
+}
+
+int eth_personal_sign_stream(FILE *stream, uint64_t length, const eth_private_key_t *private_key,
+                             eth_hash_t *hash, eth_signature_t *signature) {
+    if (!stream || !private_key || !signature) {
+        return PERSONAL_ERROR_INVALID;
+    }
+
+    eth_personal_ctx_t ctx;
+    eth_personal_init(&ctx, length);
+
+    uint8_t buffer[ETH_PERSONAL_CHUNK_SIZE];
+    while (ctx.remaining > 0) {
+        size_t want = ctx.remaining < sizeof(buffer) ? (size_t)ctx.remaining : sizeof(buffer);
+        size_t got = fread(buffer, 1, want, stream);
+        if (got == 0) {
+            /* Stream ended (or failed) before the announced length */
+            return PERSONAL_ERROR_IO;
+        }
+        eth_personal_update(&ctx, buffer, got);
+    }
+
+    return personal_finish(&ctx, private_key, hash, signature);
+}
+
+int eth_personal_sign_file(const char *path, const eth_private_key_t *private_key,
+                           eth_hash_t *hash, eth_signature_t *signature) {
+    if (!path || !private_key || !signature) {
+        return PERSONAL_ERROR_INVALID;
+    }
+
+    /* The prefix carries the length, so it has to be known up front (no pipes or devices) */
+    uint64_t size;
+    if (eth_file_size(path, &size) != 0) {
+        return PERSONAL_ERROR_IO;
+    }
+
+    /* Hash the mapping in place: no copies, readahead keeps Keccak fed */
+    eth_file_map_t map;
+    if (eth_file_map_open(&map, path, ETH_FILE_MAP_SEQUENTIAL | ETH_FILE_MAP_NO_READ) == 0) {
+        eth_personal_ctx_t ctx;
+        eth_personal_init(&ctx, map.size);
+        eth_personal_update(&ctx, map.data, map.size);
+        eth_file_map_close(&map);
+        return personal_finish(&ctx, private_key, hash, signature);
+    }
+
+    /* Not mappable here: stream it through the fixed buffer instead */
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return PERSONAL_ERROR_IO;
+    }
+
+    /* Reads go straight into the chunk buffer, not through a stdio buffer first */
+    setvbuf(file, NULL, _IONBF, 0);
+    int result = eth_personal_sign_stream(file, size, private_key, hash, signature);
+    fclose(file);
+
+    return result;
+}
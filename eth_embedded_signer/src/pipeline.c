@@ -0,0 +1,357 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/pipeline.h"
+
+/* Error codes */
+#define PIPELINE_ERROR_NONE      0
+#define PIPELINE_ERROR_INVALID  -1
+#define PIPELINE_ERROR_NOMEM    -2
+#define PIPELINE_ERROR_THREAD   -3
+#define PIPELINE_ERROR_STOPPED  -4
+
+/* Default number of jobs in flight */
+#define PIPELINE_DEFAULT_IN_FLIGHT 256
+
+/* Push a job to the next stage. Cannot stay full because at most 'window' jobs are in flight */
+static void pipeline_forward(eth_mpmc_queue_t *queue, eth_pipeline_job_t *job) {
+    unsigned spins = 0;
+
+    while (eth_mpmc_queue_push(queue, job) != 0) {
+        eth_mpmc_backoff(&spins);
+    }
+}
+
+/* Pop the next job for a stage (parking while there is none), or NULL once the pipeline is stopping and the queue is empty */
+static eth_pipeline_job_t *pipeline_take(eth_pipeline_t *pipeline, eth_mpmc_queue_t *queue) {
+    void *item;
+
+    if (eth_mpmc_queue_pop_wait(queue, &pipeline->stopping, &item) != 0) {
+        return NULL;
+    }
+    return item;
+}
+
+/* Wake submitters and drainers parked on 'emitted' */
+static void pipeline_wake_waiters(eth_pipeline_t *pipeline) {
+    atomic_fetch_add_explicit(&pipeline->emit_epoch, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&pipeline->emit_waiters, memory_order_seq_cst) > 0) {
+        pthread_mutex_lock(&pipeline->emit_lock);
+        pthread_cond_broadcast(&pipeline->emit_wake);
+        pthread_mutex_unlock(&pipeline->emit_lock);
+    }
+}
+
+/* Wait until 'emitted' reaches target: spin briefly, then park until the emitter moves it */
+static void pipeline_wait_emitted(eth_pipeline_t *pipeline, uint_fast64_t target) {
+    unsigned spins = 0;
+
+    while (atomic_load_explicit(&pipeline->emitted, memory_order_acquire) < target) {
+        if (spins < ETH_MPMC_SPIN_LIMIT) {
+            eth_mpmc_backoff(&spins);
+            continue;
+        }
+
+        /* Announce the wait, then look once more before sleeping */
+        atomic_fetch_add_explicit(&pipeline->emit_waiters, 1, memory_order_seq_cst);
+        unsigned epoch = atomic_load_explicit(&pipeline->emit_epoch, memory_order_seq_cst);
+        if (atomic_load_explicit(&pipeline->emitted, memory_order_seq_cst) < target) {
+            pthread_mutex_lock(&pipeline->emit_lock);
+            while (atomic_load_explicit(&pipeline->emit_epoch, memory_order_seq_cst) == epoch) {
+                pthread_cond_wait(&pipeline->emit_wake, &pipeline->emit_lock);
+            }
+            pthread_mutex_unlock(&pipeline->emit_lock);
+        }
+        atomic_fetch_sub_explicit(&pipeline->emit_waiters, 1, memory_order_relaxed);
+    }
+}
+
+/*
+ * Hand a finished job to the emitter. Jobs finish out of order, so each one is
+ * parked in the reorder ring and whichever thread holds the 'draining' flag
+ * emits the consecutive run starting at 'emitted'.
+ */
+static void pipeline_publish(eth_pipeline_t *pipeline, eth_pipeline_job_t *job) {
+    size_t mask = pipeline->window - 1;
+
+    atomic_store_explicit(&pipeline->reorder[job->sequence & mask], job, memory_order_seq_cst);
+
+    for (;;) {
+        /*
+         * Sequentially consistent, like the drainer's clear and re-check: either
+         * the drainer's re-check sees the job parked above, or this sees the flag
+         * cleared and drains it here. A weaker order lets both miss it.
+         */
+        if (atomic_flag_test_and_set_explicit(&pipeline->draining, memory_order_seq_cst)) {
+            /* Another thread is emitting and will re-check after it lets go */
+            return;
+        }
+
+        uint_fast64_t first = atomic_load_explicit(&pipeline->emitted, memory_order_relaxed);
+        uint_fast64_t next = first;
+        eth_pipeline_job_t *ready;
+
+        while ((ready = atomic_load_explicit(&pipeline->reorder[next & mask], memory_order_acquire)) != NULL) {
+            atomic_store_explicit(&pipeline->reorder[next & mask], NULL, memory_order_relaxed);
+
+            /* A failed job never reaches the network, give its nonce back */
+            if (ready->status != 0 && ready->nonce_reserved) {
+                ready->nonce_status = eth_nonce_release(ready->nonces, ready->sender, ready->tx->nonce);
+                ready->nonce_reserved = 0;
+            }
+
+            if (pipeline->config.emit) {
+                pipeline->config.emit(ready, pipeline->config.emit_context);
+            }
+
+            next++;
+            /* Frees a slot for submitters waiting on backpressure */
+            atomic_store_explicit(&pipeline->emitted, next, memory_order_release);
+        }
+
+        if (next != first) {
+            pipeline_wake_waiters(pipeline);
+        }
+
+        atomic_flag_clear_explicit(&pipeline->draining, memory_order_seq_cst);
+
+        /* A job may have been parked after our last check but before the flag was cleared */
+        if (atomic_load_explicit(&pipeline->reorder[next & mask], memory_order_seq_cst) == NULL) {
+            return;
+        }
+    }
+}
+
+/* Stage 1: check the policy, encode the unsigned transaction and compute its signing hash */
+static void *pipeline_encode_worker(void *arg) {
+    eth_pipeline_t *pipeline = arg;
+    eth_pipeline_job_t *job;
+
+    while ((job = pipeline_take(pipeline, &pipeline->hash_queue)) != NULL) {
+        if (job->policy) {
+            job->status = eth_policy_check(job->policy, job->tx, &job->policy_result);
+        }
+        if (job->status == 0) {
+            /* The job owns its transaction here, so an attached cache may be brought up to date */
+            job->status = eth_tx_refresh_cache(job->tx);
+        }
+        if (job->status == 0) {
+            job->status = eth_tx_hash(job->tx, &job->sighash);
+        }
+        pipeline_forward(&pipeline->sign_queue, job);
+    }
+
+    return NULL;
+}
+
+/* Stage 2: ECDSA sign the hash */
+static void *pipeline_sign_worker(void *arg) {
+    eth_pipeline_t *pipeline = arg;
+    eth_pipeline_job_t *job;
+
+    while ((job = pipeline_take(pipeline, &pipeline->sign_queue)) != NULL) {
+        if (job->status == 0) {
+            job->status = eth_tx_sign_hash(job->tx, &job->sighash, job->private_key);
+        }
+        pipeline_forward(&pipeline->emit_queue, job);
+    }
+
+    return NULL;
+}
+
+/* Stage 3: encode the signed transaction and emit in submission order */
+static void *pipeline_emit_worker(void *arg) {
+    eth_pipeline_t *pipeline = arg;
+    eth_pipeline_job_t *job;
+
+    while ((job = pipeline_take(pipeline, &pipeline->emit_queue)) != NULL) {
+        if (job->status == 0) {
+            if (job->output) {
+                job->status = eth_tx_encode_signed(job->tx, job->output, job->output_size, &job->output_len);
+            } else {
+                job->output_len = 0;
+            }
+        }
+        pipeline_publish(pipeline, job);
+    }
+
+    return NULL;
+}
+
+/* Stop and join every started thread */
+static void pipeline_stop(eth_pipeline_t *pipeline) {
+    atomic_store_explicit(&pipeline->stopping, 1, memory_order_release);
+    eth_mpmc_queue_wake_all(&pipeline->hash_queue);
+    eth_mpmc_queue_wake_all(&pipeline->sign_queue);
+    eth_mpmc_queue_wake_all(&pipeline->emit_queue);
+
+    for (unsigned i = 0; i < pipeline->thread_count; i++) {
+        pthread_join(pipeline->threads[i], NULL);
+    }
+    pipeline->thread_count = 0;
+}
+
+/* Release queues and buffers */
+static void pipeline_release(eth_pipeline_t *pipeline) {
+    eth_mpmc_queue_free(&pipeline->hash_queue);
+    eth_mpmc_queue_free(&pipeline->sign_queue);
+    eth_mpmc_queue_free(&pipeline->emit_queue);
+    free(pipeline->reorder);
+    free(pipeline->threads);
+    pipeline->reorder = NULL;
+    pipeline->threads = NULL;
+    pthread_cond_destroy(&pipeline->emit_wake);
+    pthread_mutex_destroy(&pipeline->emit_lock);
+}
+
+void eth_pipeline_config_default(eth_pipeline_config_t *config) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->max_in_flight = PIPELINE_DEFAULT_IN_FLIGHT;
+    config->encode_threads = 1;
+    config->sign_threads = 1;
+    config->emit_threads = 1;
+}
+
+int eth_pipeline_init(eth_pipeline_t *pipeline, const eth_pipeline_config_t *config) {
+    if (!pipeline || !config) {
+        return PIPELINE_ERROR_INVALID;
+    }
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->config = *config;
+    if (pthread_mutex_init(&pipeline->emit_lock, NULL) != 0) {
+        return PIPELINE_ERROR_NOMEM;
+    }
+    if (pthread_cond_init(&pipeline->emit_wake, NULL) != 0) {
+        pthread_mutex_destroy(&pipeline->emit_lock);
+        return PIPELINE_ERROR_NOMEM;
+    }
+
+    /* Every stage needs at least one thread */
+    if (pipeline->config.encode_threads == 0) pipeline->config.encode_threads = 1;
+    if (pipeline->config.sign_threads == 0) pipeline->config.sign_threads = 1;
+    if (pipeline->config.emit_threads == 0) pipeline->config.emit_threads = 1;
+    if (pipeline->config.max_in_flight == 0) pipeline->config.max_in_flight = PIPELINE_DEFAULT_IN_FLIGHT;
+
+    /*
+     * All queues get the full window, so a stage never waits on a full queue:
+     * backpressure is applied once, at submit.
+     */
+    if (eth_mpmc_queue_init(&pipeline->hash_queue, pipeline->config.max_in_flight) != 0 ||
+        eth_mpmc_queue_init(&pipeline->sign_queue, pipeline->config.max_in_flight) != 0 ||
+        eth_mpmc_queue_init(&pipeline->emit_queue, pipeline->config.max_in_flight) != 0) {
+        pipeline_release(pipeline);
+        return PIPELINE_ERROR_NOMEM;
+    }
+    pipeline->window = eth_mpmc_queue_capacity(&pipeline->hash_queue);
+
+    pipeline->reorder = calloc(pipeline->window, sizeof(*pipeline->reorder));
+    unsigned total_threads = pipeline->config.encode_threads + pipeline->config.sign_threads +
+                             pipeline->config.emit_threads;
+    pipeline->threads = calloc(total_threads, sizeof(pthread_t));
+    if (!pipeline->reorder || !pipeline->threads) {
+        pipeline_release(pipeline);
+        return PIPELINE_ERROR_NOMEM;
+    }
+
+    for (size_t i = 0; i < pipeline->window; i++) {
+        atomic_init(&pipeline->reorder[i], NULL);
+    }
+    atomic_init(&pipeline->submitted, 0);
+    atomic_init(&pipeline->emitted, 0);
+    atomic_init(&pipeline->emit_epoch, 0);
+    atomic_init(&pipeline->emit_waiters, 0);
+    atomic_flag_clear(&pipeline->draining);
+    atomic_init(&pipeline->stopping, 0);
+
+    /* Start the stage threads */
+    struct {
+        unsigned count;
+        void *(*worker)(void *);
+    } stages[3] = {
+        { pipeline->config.encode_threads, pipeline_encode_worker },
+        { pipeline->config.sign_threads, pipeline_sign_worker },
+        { pipeline->config.emit_threads, pipeline_emit_worker },
+    };
+
+    for (int s = 0; s < 3; s++) {
+        for (unsigned i = 0; i < stages[s].count; i++) {
+            if (pthread_create(&pipeline->threads[pipeline->thread_count], NULL,
+                               stages[s].worker, pipeline) != 0) {
+                pipeline_stop(pipeline);
+                pipeline_release(pipeline);
+                return PIPELINE_ERROR_THREAD;
+            }
+            pipeline->thread_count++;
+        }
+    }
+
+    return PIPELINE_ERROR_NONE;
+}
+
+int eth_pipeline_submit(eth_pipeline_t *pipeline, eth_pipeline_job_t *job) {
+    if (!pipeline || !job || !job->tx || !job->private_key) {
+        return PIPELINE_ERROR_INVALID;
+    }
+    if (atomic_load_explicit(&pipeline->stopping, memory_order_acquire)) {
+        return PIPELINE_ERROR_STOPPED;
+    }
+
+    job->status = 0;
+    job->policy_result = ETH_POLICY_OK;
+    job->output_len = 0;
+    job->nonce_reserved = 0;
+    job->nonce_status = 0;
+
+    if (job->nonces && job->sender) {
+        /*
+         * Nonce and sequence number are taken in one step per sender, so
+         * concurrent submitters for one sender cannot get nonce N with a later
+         * sequence than nonce N + 1. Other senders do not wait on each other.
+         */
+        uint64_t nonce;
+        int result = eth_nonce_reserve_ticket(job->nonces, job->sender, &pipeline->submitted,
+                                              &nonce, &job->sequence);
+        if (result != 0) {
+            return result;
+        }
+        /* Through the setter so a cached sighash is not reused */
+        eth_tx_set_nonce(job->tx, nonce);
+        job->nonce_reserved = 1;
+    } else {
+        job->sequence = atomic_fetch_add_explicit(&pipeline->submitted, 1, memory_order_relaxed);
+    }
+
+    /* Backpressure: wait until this sequence number fits in the window */
+    if (job->sequence >= pipeline->window) {
+        pipeline_wait_emitted(pipeline, job->sequence - pipeline->window + 1);
+    }
+
+    pipeline_forward(&pipeline->hash_queue, job);
+
+    return PIPELINE_ERROR_NONE;
+}
+
+int eth_pipeline_drain(eth_pipeline_t *pipeline) {
+    if (!pipeline) {
+        return PIPELINE_ERROR_INVALID;
+    }
+
+    /* Everything submitted so far */
+    pipeline_wait_emitted(pipeline, atomic_load_explicit(&pipeline->submitted, memory_order_acquire));
+
+    return PIPELINE_ERROR_NONE;
+}
+
+void eth_pipeline_destroy(eth_pipeline_t *pipeline) {
+    if (!pipeline || !pipeline->threads) {
+        return;
+    }
+
+    eth_pipeline_drain(pipeline);
+    pipeline_stop(pipeline);
+    pipeline_release(pipeline);
+}
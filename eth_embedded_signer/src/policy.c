@@ -0,0 +1,529 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/policy.h"
+#include "../include/abi.h"
+#include "../include/hex.h"
+#include "../include/file_map.h"
+
+/* Error codes */
+#define POLICY_ERROR_NONE      0
+#define POLICY_ERROR_INVALID  -1
+#define POLICY_ERROR_NOMEM    -2
+#define POLICY_ERROR_SYNTAX   -3
+#define POLICY_ERROR_IO       -4
+
+/* Most words on one rule line */
+#define POLICY_MAX_TOKENS     8
+
+/* Smallest address table */
+#define POLICY_MIN_SLOTS      16
+
+/* One word of a rule line */
+typedef struct {
+    const char *text;
+    size_t length;
+} policy_token_t;
+
+/* Split a line into words, stopping at a comment */
+static size_t policy_tokenize(const char *line, size_t length, policy_token_t *tokens) {
+    size_t count = 0;
+    size_t i = 0;
+
+    while (i < length && line[i] != '#') {
+        if (line[i] == ' ' || line[i] == '\t' || line[i] == '\r') {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < length && line[i] != ' ' && line[i] != '\t' && line[i] != '\r' && line[i] != '#') {
+            i++;
+        }
+        if (count == POLICY_MAX_TOKENS) {
+            return POLICY_MAX_TOKENS + 1;
+        }
+        tokens[count].text = line + start;
+        tokens[count].length = i - start;
+        count++;
+    }
+
+    return count;
+}
+
+static int policy_token_is(const policy_token_t *token, const char *word) {
+    return token->length == strlen(word) && memcmp(token->text, word, token->length) == 0;
+}
+
+/* Decimal or 0x hex quantity */
+static int policy_parse_u256(const policy_token_t *token, eth_u256_t *value) {
+    if (token->length > 2 && token->text[0] == '0' && (token->text[1] == 'x' || token->text[1] == 'X')) {
+        return eth_u256_set_hex(value, token->text, token->length);
+    }
+    return eth_u256_set_dec(value, token->text, token->length);
+}
+
+static int policy_parse_u64(const policy_token_t *token, uint64_t *value) {
+    eth_u256_t wide;
+    if (policy_parse_u256(token, &wide) != 0 || wide.limb[1] || wide.limb[2] || wide.limb[3]) {
+        return POLICY_ERROR_SYNTAX;
+    }
+    *value = wide.limb[0];
+    return POLICY_ERROR_NONE;
+}
+
+/* Grow an array to hold one more element */
+static int policy_reserve(void **array, size_t count, size_t *capacity, size_t element_size) {
+    if (count < *capacity) {
+        return POLICY_ERROR_NONE;
+    }
+
+    size_t grown = *capacity ? *capacity * 2 : 16;
+    void *resized = realloc(*array, grown * element_size);
+    if (!resized) {
+        return POLICY_ERROR_NOMEM;
+    }
+    *array = resized;
+    *capacity = grown;
+
+    return POLICY_ERROR_NONE;
+}
+
+/* Addresses are hashes already, so mixing the leading bytes is enough */
+static size_t policy_hash(const uint8_t address[20], size_t mask) {
+    uint64_t head = 0;
+    for (int i = 0; i < 8; i++) {
+        head = (head << 8) | address[i];
+    }
+    return (size_t)((head * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+}
+
+int eth_policy_allows_address(const eth_policy_t *policy, const uint8_t address[20]) {
+    if (!policy || !address || !policy->slots) {
+        return 0;
+    }
+
+    for (size_t i = policy_hash(address, policy->slot_mask); ; i = (i + 1) & policy->slot_mask) {
+        uint32_t slot = policy->slots[i];
+        if (slot == 0) {
+            return 0;
+        }
+        if (memcmp(policy->addresses[slot - 1], address, 20) == 0) {
+            return 1;
+        }
+    }
+}
+
+/* Build the address table at no more than half full */
+static int policy_build_table(eth_policy_t *policy) {
+    if (policy->address_count == 0) {
+        return POLICY_ERROR_NONE;
+    }
+    if (policy->address_count > UINT32_MAX - 1) {
+        return POLICY_ERROR_NOMEM;
+    }
+
+    size_t size = POLICY_MIN_SLOTS;
+    while (size < 2 * policy->address_count) {
+        size *= 2;
+    }
+
+    policy->slots = calloc(size, sizeof(uint32_t));
+    if (!policy->slots) {
+        return POLICY_ERROR_NOMEM;
+    }
+    policy->slot_mask = size - 1;
+
+    for (size_t n = 0; n < policy->address_count; n++) {
+        size_t i = policy_hash(policy->addresses[n], policy->slot_mask);
+        while (policy->slots[i] != 0) {
+            if (memcmp(policy->addresses[policy->slots[i] - 1], policy->addresses[n], 20) == 0) {
+                break; /* Listed twice */
+            }
+            i = (i + 1) & policy->slot_mask;
+        }
+        if (policy->slots[i] == 0) {
+            policy->slots[i] = (uint32_t)(n + 1);
+        }
+    }
+
+    return POLICY_ERROR_NONE;
+}
+
+static int policy_compare_chain(const void *a, const void *b) {
+    uint64_t x = ((const eth_policy_chain_t *)a)->chain_id;
+    uint64_t y = ((const eth_policy_chain_t *)b)->chain_id;
+    return (x > y) - (x < y);
+}
+
+static int policy_compare_selector(const void *a, const void *b) {
+    uint32_t x = ((const eth_policy_selector_t *)a)->selector;
+    uint32_t y = ((const eth_policy_selector_t *)b)->selector;
+    return (x > y) - (x < y);
+}
+
+/* allow 0x<address> | any | create */
+static int policy_parse_allow(eth_policy_t *policy, const policy_token_t *tokens, size_t count) {
+    if (count != 2) {
+        return POLICY_ERROR_SYNTAX;
+    }
+    if (policy_token_is(&tokens[1], "any")) {
+        policy->flags |= ETH_POLICY_ANY_DESTINATION;
+        return POLICY_ERROR_NONE;
+    }
+    if (policy_token_is(&tokens[1], "create")) {
+        policy->flags |= ETH_POLICY_ALLOW_CREATE;
+        return POLICY_ERROR_NONE;
+    }
+
+    uint8_t address[20];
+    size_t address_len;
+    if (eth_hex_decode(tokens[1].text, tokens[1].length, address, sizeof(address), &address_len) != 0 ||
+        address_len != 20) {
+        return POLICY_ERROR_SYNTAX;
+    }
+
+    if (policy_reserve((void **)&policy->addresses, policy->address_count,
+                       &policy->address_capacity, sizeof(policy->addresses[0])) != 0) {
+        return POLICY_ERROR_NOMEM;
+    }
+    memcpy(policy->addresses[policy->address_count++], address, 20);
+
+    return POLICY_ERROR_NONE;
+}
+
+/* chain <id> [value <wei>] [gas <limit>] [fee <wei>] */
+static int policy_parse_chain(eth_policy_t *policy, size_t *capacity, const policy_token_t *tokens, size_t count) {
+    eth_policy_chain_t chain;
+
+    if (count < 2 || count % 2 != 0 || policy_parse_u64(&tokens[1], &chain.chain_id) != 0) {
+        return POLICY_ERROR_SYNTAX;
+    }
+    chain.max_gas = UINT64_MAX;
+    memset(&chain.max_value, 0xff, sizeof(chain.max_value));
+    memset(&chain.max_fee, 0xff, sizeof(chain.max_fee));
+
+    for (size_t i = 2; i < count; i += 2) {
+        int result;
+        if (policy_token_is(&tokens[i], "value")) {
+            result = policy_parse_u256(&tokens[i + 1], &chain.max_value);
+        } else if (policy_token_is(&tokens[i], "gas")) {
+            result = policy_parse_u64(&tokens[i + 1], &chain.max_gas);
+        } else if (policy_token_is(&tokens[i], "fee")) {
+            result = policy_parse_u256(&tokens[i + 1], &chain.max_fee);
+        } else {
+            result = POLICY_ERROR_SYNTAX;
+        }
+        if (result != 0) {
+            return POLICY_ERROR_SYNTAX;
+        }
+    }
+
+    for (size_t i = 0; i < policy->chain_count; i++) {
+        if (policy->chains[i].chain_id == chain.chain_id) {
+            return POLICY_ERROR_SYNTAX;
+        }
+    }
+    if (policy_reserve((void **)&policy->chains, policy->chain_count, capacity, sizeof(chain)) != 0) {
+        return POLICY_ERROR_NOMEM;
+    }
+    policy->chains[policy->chain_count++] = chain;
+
+    return POLICY_ERROR_NONE;
+}
+
+/* selector <0x12345678|signature|any> [max_amount <n>] [recipient_allowlisted] */
+static int policy_parse_selector(eth_policy_t *policy, size_t *capacity, const policy_token_t *tokens, size_t count) {
+    eth_policy_selector_t rule;
+
+    if (count < 2) {
+        return POLICY_ERROR_SYNTAX;
+    }
+    if (policy_token_is(&tokens[1], "any")) {
+        if (count != 2) {
+            return POLICY_ERROR_SYNTAX;
+        }
+        policy->flags |= ETH_POLICY_ANY_SELECTOR;
+        return POLICY_ERROR_NONE;
+    }
+
+    memset(&rule, 0, sizeof(rule));
+    if (memchr(tokens[1].text, '(', tokens[1].length)) {
+        if (eth_abi_selector(tokens[1].text, tokens[1].length, &rule.selector) != 0) {
+            return POLICY_ERROR_SYNTAX;
+        }
+    } else {
+        uint8_t bytes[4];
+        size_t bytes_len;
+        if (eth_hex_decode(tokens[1].text, tokens[1].length, bytes, sizeof(bytes), &bytes_len) != 0 ||
+            bytes_len != 4) {
+            return POLICY_ERROR_SYNTAX;
+        }
+        rule.selector = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+                        ((uint32_t)bytes[2] << 8) | bytes[3];
+    }
+
+    for (size_t i = 2; i < count; i++) {
+        if (policy_token_is(&tokens[i], "max_amount") && i + 1 < count) {
+            if (policy_parse_u256(&tokens[++i], &rule.max_amount) != 0) {
+                return POLICY_ERROR_SYNTAX;
+            }
+            rule.flags |= ETH_POLICY_MAX_AMOUNT;
+        } else if (policy_token_is(&tokens[i], "recipient_allowlisted")) {
+            rule.flags |= ETH_POLICY_RECIPIENT_ALLOWLISTED;
+        } else {
+            return POLICY_ERROR_SYNTAX;
+        }
+    }
+
+    /* Token options only make sense for selectors the token decoder knows */
+    if (rule.flags) {
+        uint8_t probe[4] = {
+            (uint8_t)(rule.selector >> 24), (uint8_t)(rule.selector >> 16),
+            (uint8_t)(rule.selector >> 8), (uint8_t)rule.selector
+        };
+        eth_abi_token_call_t call;
+        if (eth_abi_decode_token_call(probe, sizeof(probe), &call) == ETH_ABI_NOT_TOKEN_CALL) {
+            return POLICY_ERROR_SYNTAX;
+        }
+    }
+
+    for (size_t i = 0; i < policy->selector_count; i++) {
+        if (policy->selectors[i].selector == rule.selector) {
+            return POLICY_ERROR_SYNTAX;
+        }
+    }
+    if (policy_reserve((void **)&policy->selectors, policy->selector_count, capacity, sizeof(rule)) != 0) {
+        return POLICY_ERROR_NOMEM;
+    }
+    policy->selectors[policy->selector_count++] = rule;
+
+    return POLICY_ERROR_NONE;
+}
+
+int eth_policy_load(eth_policy_t *policy, const char *text, size_t length) {
+    if (!policy || (!text && length > 0)) {
+        return POLICY_ERROR_INVALID;
+    }
+
+    memset(policy, 0, sizeof(eth_policy_t));
+
+    size_t chain_capacity = 0;
+    size_t selector_capacity = 0;
+    size_t offset = 0;
+    unsigned line_number = 0;
+    int result = POLICY_ERROR_NONE;
+
+    while (offset < length && result == POLICY_ERROR_NONE) {
+        const char *line = text + offset;
+        const char *newline = memchr(line, '\n', length - offset);
+        size_t line_length = newline ? (size_t)(newline - line) : length - offset;
+        offset += line_length + (newline ? 1 : 0);
+        line_number++;
+
+        policy_token_t tokens[POLICY_MAX_TOKENS];
+        size_t count = policy_tokenize(line, line_length, tokens);
+        if (count == 0) {
+            continue;
+        }
+
+        if (count > POLICY_MAX_TOKENS) {
+            result = POLICY_ERROR_SYNTAX;
+        } else if (policy_token_is(&tokens[0], "allow")) {
+            result = policy_parse_allow(policy, tokens, count);
+        } else if (policy_token_is(&tokens[0], "chain")) {
+            result = policy_parse_chain(policy, &chain_capacity, tokens, count);
+        } else if (policy_token_is(&tokens[0], "selector")) {
+            result = policy_parse_selector(policy, &selector_capacity, tokens, count);
+        } else {
+            result = POLICY_ERROR_SYNTAX;
+        }
+    }
+
+    if (result == POLICY_ERROR_NONE) {
+        qsort(policy->chains, policy->chain_count, sizeof(eth_policy_chain_t), policy_compare_chain);
+        qsort(policy->selectors, policy->selector_count, sizeof(eth_policy_selector_t), policy_compare_selector);
+        result = policy_build_table(policy);
+        line_number = 0;
+    }
+
+    if (result != POLICY_ERROR_NONE) {
+        eth_policy_free(policy);
+        policy->error_line = line_number;
+    }
+
+    return result;
+}
+
+int eth_policy_load_file(eth_policy_t *policy, const char *path) {
+    if (!policy || !path) {
+        return POLICY_ERROR_INVALID;
+    }
+
+    eth_file_map_t map;
+    if (eth_file_map_open(&map, path, ETH_FILE_MAP_SEQUENTIAL) != 0) {
+        memset(policy, 0, sizeof(eth_policy_t));
+        return POLICY_ERROR_IO;
+    }
+
+    int result = eth_policy_load(policy, (const char *)map.data, map.size);
+    eth_file_map_close(&map);
+
+    return result;
+}
+
+void eth_policy_free(eth_policy_t *policy) {
+    if (!policy) {
+        return;
+    }
+
+    free(policy->addresses);
+    free(policy->slots);
+    free(policy->selectors);
+    free(policy->chains);
+    memset(policy, 0, sizeof(eth_policy_t));
+}
+
+static const eth_policy_chain_t *policy_find_chain(const eth_policy_t *policy, uint64_t chain_id) {
+    size_t low = 0;
+    size_t high = policy->chain_count;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (policy->chains[mid].chain_id == chain_id) {
+            return &policy->chains[mid];
+        }
+        if (policy->chains[mid].chain_id < chain_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+static const eth_policy_selector_t *policy_find_selector(const eth_policy_t *policy, uint32_t selector) {
+    size_t low = 0;
+    size_t high = policy->selector_count;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (policy->selectors[mid].selector == selector) {
+            return &policy->selectors[mid];
+        }
+        if (policy->selectors[mid].selector < selector) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+/* Calldata checks for a call to an allowed destination */
+static eth_policy_result_t policy_check_call(const eth_policy_t *policy, const eth_transaction_t *tx) {
+    if (tx->data_len < 4) {
+        return (policy->flags & ETH_POLICY_ANY_SELECTOR) ? ETH_POLICY_OK : ETH_POLICY_CALLDATA;
+    }
+
+    uint32_t selector = ((uint32_t)tx->data[0] << 24) | ((uint32_t)tx->data[1] << 16) |
+                        ((uint32_t)tx->data[2] << 8) | tx->data[3];
+    const eth_policy_selector_t *rule = policy_find_selector(policy, selector);
+    if (!rule) {
+        return (policy->flags & ETH_POLICY_ANY_SELECTOR) ? ETH_POLICY_OK : ETH_POLICY_SELECTOR;
+    }
+    if (rule->flags == 0) {
+        return ETH_POLICY_OK;
+    }
+
+    eth_abi_token_call_t call;
+    if (eth_abi_decode_token_call(tx->data, tx->data_len, &call) != 0) {
+        return ETH_POLICY_CALLDATA;
+    }
+    if ((rule->flags & ETH_POLICY_MAX_AMOUNT) && eth_u256_cmp(&call.amount, &rule->max_amount) > 0) {
+        return ETH_POLICY_TOKEN_AMOUNT;
+    }
+    if ((rule->flags & ETH_POLICY_RECIPIENT_ALLOWLISTED) && !eth_policy_allows_address(policy, call.to)) {
+        return ETH_POLICY_TOKEN_RECIPIENT;
+    }
+
+    return ETH_POLICY_OK;
+}
+
+static eth_policy_result_t policy_evaluate(const eth_policy_t *policy, const eth_transaction_t *tx) {
+    const eth_policy_chain_t *chain = policy_find_chain(policy, tx->chain_id);
+    if (!chain) {
+        return ETH_POLICY_UNKNOWN_CHAIN;
+    }
+
+    if (tx->to_len == 0) {
+        if (!(policy->flags & ETH_POLICY_ALLOW_CREATE)) {
+            return ETH_POLICY_CREATE;
+        }
+    } else if (!(policy->flags & ETH_POLICY_ANY_DESTINATION) && !eth_policy_allows_address(policy, tx->to)) {
+        return ETH_POLICY_DESTINATION;
+    }
+
+    const eth_u256_t *fee = tx->tx_type == ETH_EIP1559_TX ? &tx->max_fee : &tx->gas_price;
+    if (eth_u256_cmp(&tx->value, &chain->max_value) > 0) {
+        return ETH_POLICY_VALUE;
+    }
+    if (tx->gas_limit > chain->max_gas) {
+        return ETH_POLICY_GAS;
+    }
+    if (eth_u256_cmp(fee, &chain->max_fee) > 0) {
+        return ETH_POLICY_FEE;
+    }
+
+    /* Init code of a contract creation has no selector */
+    if (tx->to_len > 0 && tx->data_len > 0) {
+        return policy_check_call(policy, tx);
+    }
+
+    return ETH_POLICY_OK;
+}
+
+int eth_policy_check(const eth_policy_t *policy, const eth_transaction_t *tx, eth_policy_result_t *result) {
+    if (!policy || !tx || (!tx->data && tx->data_len > 0)) {
+        return POLICY_ERROR_INVALID;
+    }
+
+    eth_policy_result_t reason = policy_evaluate(policy, tx);
+    if (result) {
+        *result = reason;
+    }
+
+    return reason == ETH_POLICY_OK ? POLICY_ERROR_NONE : ETH_POLICY_DENIED;
+}
+
+int eth_tx_sign_checked(eth_transaction_t *tx, const eth_private_key_t *private_key,
+                        const eth_policy_t *policy, eth_policy_result_t *result) {
+    if (!tx || !private_key || !policy) {
+        return POLICY_ERROR_INVALID;
+    }
+
+    int check = eth_policy_check(policy, tx, result);
+    if (check != 0) {
+        return check;
+    }
+
+    return eth_tx_sign(tx, private_key);
+}
+
+const char *eth_policy_result_string(eth_policy_result_t result) {
+    switch (result) {
+    case ETH_POLICY_OK:              return "allowed";
+    case ETH_POLICY_UNKNOWN_CHAIN:   return "chain not allowed";
+    case ETH_POLICY_DESTINATION:     return "destination not allowlisted";
+    case ETH_POLICY_CREATE:          return "contract creation not allowed";
+    case ETH_POLICY_VALUE:           return "value above cap";
+    case ETH_POLICY_GAS:             return "gas limit above cap";
+    case ETH_POLICY_FEE:             return "fee above cap";
+    case ETH_POLICY_SELECTOR:        return "function not allowed";
+    case ETH_POLICY_CALLDATA:        return "calldata not inspectable";
+    case ETH_POLICY_TOKEN_AMOUNT:    return "token amount above cap";
+    case ETH_POLICY_TOKEN_RECIPIENT: return "token recipient not allowlisted";
+    }
+    return "unknown";
+}
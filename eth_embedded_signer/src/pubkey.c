@@ -0,0 +1,136 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../include/pubkey.h"
+#include "../include/ec.h"
+
+/* Error codes */
+#define PUBKEY_ERROR_NONE     0
+#define PUBKEY_ERROR_INVALID -1
+#define PUBKEY_ERROR_KEY     -2
+
+/* Keys handed to a thread at a time */
+#define PUBKEY_CHUNK 256
+
+int eth_public_key_compress(const eth_public_key_t *public_key, uint8_t compressed[ETH_PUBLIC_KEY_COMPRESSED_SIZE]) {
+    if (!public_key || !compressed) {
+        return PUBKEY_ERROR_INVALID;
+    }
+
+    /* y is big-endian: its parity is the low bit of the last byte */
+    compressed[0] = (uint8_t)(0x02 | (public_key->data[63] & 1));
+    memcpy(compressed + 1, public_key->data, 32);
+    return PUBKEY_ERROR_NONE;
+}
+
+int eth_public_key_decompress(const uint8_t compressed[ETH_PUBLIC_KEY_COMPRESSED_SIZE],
+                              eth_public_key_t *public_key) {
+    if (!compressed || !public_key) {
+        return PUBKEY_ERROR_INVALID;
+    }
+    if (compressed[0] != 0x02 && compressed[0] != 0x03) {
+        return PUBKEY_ERROR_KEY;
+    }
+
+    eth_fe_t x;
+    eth_ge_t point;
+    if (eth_fe_set_bytes(&x, compressed + 1) != 0 || eth_ge_set_xo(&point, &x, compressed[0] & 1) != 0) {
+        return PUBKEY_ERROR_KEY;
+    }
+
+    eth_ge_get_public_key(public_key, &point);
+    return PUBKEY_ERROR_NONE;
+}
+
+int eth_public_key_compress_batch(const eth_public_key_t *public_keys, size_t count, uint8_t *compressed) {
+    if ((!public_keys || !compressed) && count > 0) {
+        return PUBKEY_ERROR_INVALID;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        eth_public_key_compress(&public_keys[i], compressed + i * ETH_PUBLIC_KEY_COMPRESSED_SIZE);
+    }
+    return PUBKEY_ERROR_NONE;
+}
+
+/* Batch decompression shared by all workers */
+typedef struct {
+    const uint8_t *compressed;
+    size_t count;
+    eth_public_key_t *public_keys;
+    uint8_t *valid;
+    atomic_size_t next;              /* First key of the next chunk */
+    atomic_int invalid;              /* Set when some key was rejected */
+} pubkey_batch_ctx_t;
+
+static void pubkey_batch_run(pubkey_batch_ctx_t *ctx) {
+    for (;;) {
+        size_t first = atomic_fetch_add_explicit(&ctx->next, PUBKEY_CHUNK, memory_order_relaxed);
+        if (first >= ctx->count) {
+            return;
+        }
+        size_t last = ctx->count - first > PUBKEY_CHUNK ? first + PUBKEY_CHUNK : ctx->count;
+
+        int invalid = 0;
+        for (size_t i = first; i < last; i++) {
+            int ok = eth_public_key_decompress(ctx->compressed + i * ETH_PUBLIC_KEY_COMPRESSED_SIZE,
+                                               &ctx->public_keys[i]) == PUBKEY_ERROR_NONE;
+            if (!ok) {
+                memset(&ctx->public_keys[i], 0, sizeof(ctx->public_keys[i]));
+                invalid = 1;
+            }
+            if (ctx->valid) {
+                ctx->valid[i] = (uint8_t)ok;
+            }
+        }
+        if (invalid) {
+            atomic_store_explicit(&ctx->invalid, 1, memory_order_relaxed);
+        }
+    }
+}
+
+static void *pubkey_batch_thread(void *arg) {
+    pubkey_batch_run(arg);
+    return NULL;
+}
+
+int eth_public_key_decompress_batch(const uint8_t *compressed, size_t count, unsigned threads,
+                                    eth_public_key_t *public_keys, uint8_t *valid) {
+    if ((!compressed || !public_keys) && count > 0) {
+        return PUBKEY_ERROR_INVALID;
+    }
+
+    pubkey_batch_ctx_t ctx;
+    ctx.compressed = compressed;
+    ctx.count = count;
+    ctx.public_keys = public_keys;
+    ctx.valid = valid;
+    atomic_init(&ctx.next, 0);
+    atomic_init(&ctx.invalid, 0);
+
+    /* No more threads than chunks */
+    size_t chunks = (count + PUBKEY_CHUNK - 1) / PUBKEY_CHUNK;
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > chunks) {
+        threads = chunks > 0 ? (unsigned)chunks : 1;
+    }
+
+    /* If a thread cannot be started the others take its share */
+    pthread_t *workers = threads > 1 ? malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    unsigned started = 0;
+    while (workers && started < threads - 1 &&
+           pthread_create(&workers[started], NULL, pubkey_batch_thread, &ctx) == 0) {
+        started++;
+    }
+    pubkey_batch_run(&ctx);
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+
+    return atomic_load_explicit(&ctx.invalid, memory_order_relaxed) ? ETH_PUBLIC_KEY_INVALID_ENTRIES
+                                                                    : PUBKEY_ERROR_NONE;
+}
@@ -0,0 +1,244 @@
+#include <string.h>
+#include "../include/rfc6979.h"
+#include "../include/sha256.h"
+#include "../include/ec.h"
+
+/* Error codes */
+#define RFC6979_ERROR_NONE     0
+#define RFC6979_ERROR_INVALID -1
+#define RFC6979_ERROR_KEY     -2
+
+/* Derivations run in lockstep (about 300 bytes of stack each; 1 for the smallest footprint) */
+#ifndef ETH_RFC6979_LANES
+#define ETH_RFC6979_LANES ETH_SHA256_LANES
+#endif
+#define RFC6979_LANES ETH_RFC6979_LANES
+
+/* One group of derivations; every step below applies to all of its lanes */
+typedef struct {
+    size_t lanes;
+    uint8_t x[RFC6979_LANES][32];                      /* int2octets(private key) */
+    uint8_t h1[RFC6979_LANES][32];                     /* bits2octets(hash) */
+    uint8_t k[RFC6979_LANES][32];                      /* HMAC key K */
+    uint8_t v[RFC6979_LANES][32];                      /* Chaining value V */
+    uint32_t inner[RFC6979_LANES][8];                  /* SHA-256 state after K ^ ipad */
+    uint32_t outer[RFC6979_LANES][8];                  /* SHA-256 state after K ^ opad */
+    uint32_t state[RFC6979_LANES][8];
+    uint8_t blocks[RFC6979_LANES][ETH_SHA256_BLOCK_SIZE];
+    const uint8_t *block_ptrs[RFC6979_LANES];
+} rfc6979_group_t;
+
+static void rfc6979_store32(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)(value >> 16);
+    bytes[2] = (uint8_t)(value >> 8);
+    bytes[3] = (uint8_t)value;
+}
+
+static void rfc6979_digest(uint8_t output[32], const uint32_t state[8]) {
+    for (int i = 0; i < 8; i++) {
+        rfc6979_store32(output + 4 * i, state[i]);
+    }
+}
+
+/* Final-block padding after used message bytes, for a message of total bytes (key block included) */
+static void rfc6979_pad(uint8_t block[ETH_SHA256_BLOCK_SIZE], size_t used, uint32_t total) {
+    block[used] = 0x80;
+    memset(block + used + 1, 0, ETH_SHA256_BLOCK_SIZE - 4 - used - 1);
+    rfc6979_store32(block + ETH_SHA256_BLOCK_SIZE - 4, total * 8);
+}
+
+/* Compress blocks[j] into state[j] for every lane */
+static void rfc6979_compress(rfc6979_group_t *group) {
+    eth_sha256_compress_multi(group->state, group->block_ptrs, group->lanes);
+}
+
+/* inner/outer = the pads of the keys k[j] */
+static void rfc6979_set_key(rfc6979_group_t *group, const uint32_t iv[8]) {
+    for (size_t j = 0; j < group->lanes; j++) {
+        for (int i = 0; i < 32; i++) {
+            group->blocks[j][i] = group->k[j][i] ^ 0x36;
+        }
+        memset(group->blocks[j] + 32, 0x36, 32);
+        memcpy(group->state[j], iv, 32);
+    }
+    rfc6979_compress(group);
+    memcpy(group->inner, group->state, group->lanes * sizeof(group->inner[0]));
+
+    /* 0x36 ^ 0x5c turns the ipad block into the opad block */
+    for (size_t j = 0; j < group->lanes; j++) {
+        for (int i = 0; i < ETH_SHA256_BLOCK_SIZE; i++) {
+            group->blocks[j][i] ^= 0x36 ^ 0x5c;
+        }
+        memcpy(group->state[j], iv, 32);
+    }
+    rfc6979_compress(group);
+    memcpy(group->outer, group->state, group->lanes * sizeof(group->outer[0]));
+}
+
+/* Outer hash over the inner digests left in state: output[j] = the MACs */
+static void rfc6979_finish(rfc6979_group_t *group, uint8_t (*output)[32]) {
+    for (size_t j = 0; j < group->lanes; j++) {
+        rfc6979_digest(group->blocks[j], group->state[j]);
+        rfc6979_pad(group->blocks[j], 32, ETH_SHA256_BLOCK_SIZE + 32);
+        memcpy(group->state[j], group->outer[j], 32);
+    }
+    rfc6979_compress(group);
+    for (size_t j = 0; j < group->lanes; j++) {
+        rfc6979_digest(output[j], group->state[j]);
+    }
+}
+
+/* v = HMAC_K(V) */
+static void rfc6979_mac_v(rfc6979_group_t *group) {
+    for (size_t j = 0; j < group->lanes; j++) {
+        memcpy(group->blocks[j], group->v[j], 32);
+        rfc6979_pad(group->blocks[j], 32, ETH_SHA256_BLOCK_SIZE + 32);
+        memcpy(group->state[j], group->inner[j], 32);
+    }
+    rfc6979_compress(group);
+    rfc6979_finish(group, group->v);
+}
+
+/* k = HMAC_K(V || tag || x || h1), 97 bytes over two blocks */
+static void rfc6979_mac_k(rfc6979_group_t *group, uint8_t tag) {
+    for (size_t j = 0; j < group->lanes; j++) {
+        memcpy(group->blocks[j], group->v[j], 32);
+        group->blocks[j][32] = tag;
+        memcpy(group->blocks[j] + 33, group->x[j], 31);
+        memcpy(group->state[j], group->inner[j], 32);
+    }
+    rfc6979_compress(group);
+    for (size_t j = 0; j < group->lanes; j++) {
+        group->blocks[j][0] = group->x[j][31];
+        memcpy(group->blocks[j] + 1, group->h1[j], 32);
+        rfc6979_pad(group->blocks[j], 33, ETH_SHA256_BLOCK_SIZE + 97);
+    }
+    rfc6979_compress(group);
+    rfc6979_finish(group, group->k);
+}
+
+/* Candidate rejected (about 2^-128 per nonce): K = HMAC_K(V || 0), V = HMAC_K(V), V = HMAC_K(V) */
+static void rfc6979_retry(uint8_t k[32], uint8_t v[32]) {
+    eth_hmac_sha256_ctx_t ctx;
+    const uint8_t zero = 0;
+
+    eth_hmac_sha256_init(&ctx, k, 32);
+    eth_hmac_sha256_update(&ctx, v, 32);
+    eth_hmac_sha256_update(&ctx, &zero, 1);
+    eth_hmac_sha256_final(&ctx, k);
+    for (int i = 0; i < 2; i++) {
+        eth_hmac_sha256_init(&ctx, k, 32);
+        eth_hmac_sha256_update(&ctx, v, 32);
+        eth_hmac_sha256_final(&ctx, v);
+    }
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+static void rfc6979_run(rfc6979_group_t *group, const eth_hmac_sha256_ctx_t *zero_key, const uint32_t iv[8],
+                        uint8_t *nonces) {
+    for (size_t j = 0; j < group->lanes; j++) {
+        group->block_ptrs[j] = group->blocks[j];
+        memset(group->v[j], 0x01, 32);
+        memcpy(group->inner[j], zero_key->inner.state, 32);
+        memcpy(group->outer[j], zero_key->outer.state, 32);
+    }
+
+    rfc6979_mac_k(group, 0x00);
+    rfc6979_set_key(group, iv);
+    rfc6979_mac_v(group);
+    rfc6979_mac_k(group, 0x01);
+    rfc6979_set_key(group, iv);
+    rfc6979_mac_v(group);
+
+    /* T = V = HMAC_K(V): 256 bits, one round for any candidate in [1, n - 1] */
+    rfc6979_mac_v(group);
+    for (size_t j = 0; j < group->lanes; j++) {
+        eth_scalar_t t;
+        while (eth_scalar_set_bytes(&t, group->v[j]) || eth_scalar_is_zero(&t)) {
+            rfc6979_retry(group->k[j], group->v[j]);
+        }
+        memcpy(nonces + 32 * j, group->v[j], 32);
+        memset(&t, 0, sizeof(t));
+    }
+}
+
+/* Key in [1, n - 1] */
+static int rfc6979_check_key(const eth_private_key_t *private_key) {
+    eth_scalar_t x;
+    int invalid = eth_scalar_set_bytes(&x, private_key->data) || eth_scalar_is_zero(&x);
+    memset(&x, 0, sizeof(x));
+    return invalid ? RFC6979_ERROR_KEY : RFC6979_ERROR_NONE;
+}
+
+/* Lane j derives the nonce of (private_key, hash) */
+static void rfc6979_load(rfc6979_group_t *group, size_t j, const eth_private_key_t *private_key,
+                         const eth_hash_t *hash) {
+    eth_scalar_t h;
+    memcpy(group->x[j], private_key->data, 32);
+    eth_scalar_set_bytes(&h, hash->data);
+    eth_scalar_get_bytes(group->h1[j], &h);
+}
+
+/* Every derivation starts from K = 0, so its pads are shared */
+static void rfc6979_start(eth_hmac_sha256_ctx_t *zero_key, eth_sha256_ctx_t *iv) {
+    static const uint8_t zero[32];
+    eth_hmac_sha256_init(zero_key, zero, sizeof(zero));
+    eth_sha256_init(iv);
+}
+
+int eth_rfc6979_nonce(const eth_private_key_t *private_key, const eth_hash_t *hash, uint8_t nonce[32]) {
+    if (!private_key || !hash || !nonce) {
+        return RFC6979_ERROR_INVALID;
+    }
+    if (rfc6979_check_key(private_key) != RFC6979_ERROR_NONE) {
+        return RFC6979_ERROR_KEY;
+    }
+
+    eth_hmac_sha256_ctx_t zero_key;
+    eth_sha256_ctx_t iv;
+    rfc6979_group_t group;
+    rfc6979_start(&zero_key, &iv);
+    group.lanes = 1;
+    rfc6979_load(&group, 0, private_key, hash);
+    rfc6979_run(&group, &zero_key, iv.state, nonce);
+
+    memset(&group, 0, sizeof(group));
+    return RFC6979_ERROR_NONE;
+}
+
+int eth_rfc6979_nonce_batch(const eth_private_key_t *private_keys, const eth_hash_t *hashes, size_t count,
+                            uint8_t *nonces) {
+    if ((!private_keys || !hashes || !nonces) && count > 0) {
+        return RFC6979_ERROR_INVALID;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (rfc6979_check_key(&private_keys[i]) != RFC6979_ERROR_NONE) {
+            return RFC6979_ERROR_KEY;
+        }
+    }
+
+#if RFC6979_LANES == 1
+    /* No lanes to fill: one derivation after the other, as eth_sign does it */
+    for (size_t i = 0; i < count; i++) {
+        eth_rfc6979_nonce(&private_keys[i], &hashes[i], nonces + 32 * i);
+    }
+#else
+    eth_hmac_sha256_ctx_t zero_key;
+    eth_sha256_ctx_t iv;
+    rfc6979_group_t group;
+    rfc6979_start(&zero_key, &iv);
+
+    for (size_t first = 0; first < count; first += RFC6979_LANES) {
+        group.lanes = count - first < RFC6979_LANES ? count - first : RFC6979_LANES;
+        for (size_t j = 0; j < group.lanes; j++) {
+            rfc6979_load(&group, j, &private_keys[first + j], &hashes[first + j]);
+        }
+        rfc6979_run(&group, &zero_key, iv.state, nonces + 32 * first);
+    }
+
+    memset(&group, 0, sizeof(group));
+#endif
+    return RFC6979_ERROR_NONE;
+}
@@ -148,6 +148,22 @@ int rlp_end_list(rlp_encoder_t *encoder, size_t marker) {
     return RLP_ERROR_NONE;
 }
 
+int rlp_encode_list_header(rlp_encoder_t *encoder, size_t payload_length) {
+    if (!encoder) {
+        return RLP_ERROR_INVALID_PARAM;
+    }
+    
+    return rlp_write_length_prefix(encoder, payload_length, RLP_SHORT_LIST_PREFIX);
+}
+
+int rlp_encode_string_header(rlp_encoder_t *encoder, size_t length) {
+    if (!encoder) {
+        return RLP_ERROR_INVALID_PARAM;
+    }
+    
+    return rlp_write_length_prefix(encoder, length, RLP_SHORT_STRING_PREFIX);
+}
+
 int rlp_encode_byte(rlp_encoder_t *encoder, uint8_t value) {
     if (!encoder) {
         return RLP_ERROR_INVALID_PARAM;
@@ -220,6 +236,74 @@ int rlp_encode_uint(rlp_encoder_t *encoder, uint64_t value) {
     }
 }
 
+int rlp_encode_u256(rlp_encoder_t *encoder, const eth_u256_t *value) {
+    if (!encoder || !value) {
+        return RLP_ERROR_INVALID_PARAM;
+    }
+    
+    /* Big-endian bytes behind one spare byte for the prefix */
+    uint8_t bytes[33];
+    bytes[0] = 0;
+    eth_u256_to_bytes(value, bytes + 1);
+    
+    size_t length = eth_u256_byte_length(value);
+    
+    /*
+     * The prefix goes into the (zero) byte just before the value. A single
+     * byte below 0x80 is its own encoding, so skip the prefix in that case.
+     * Zero has length 0 and comes out as the bare 0x80 prefix.
+     */
+    size_t single = (length == 1) & (bytes[32] < RLP_SINGLE_BYTE_PREFIX);
+    size_t start = 32 - length;
+    bytes[start] = (uint8_t)(RLP_SHORT_STRING_PREFIX + length);
+    
+    return rlp_insert(encoder, bytes + start + single, length + 1 - single);
+}
+
+int rlp_encode_raw(rlp_encoder_t *encoder, const uint8_t *data, size_t length) {
+    if (!encoder || (!data && length > 0)) {
+        return RLP_ERROR_INVALID_PARAM;
+    }
+    
+    if (length == 0) {
+        return RLP_ERROR_NONE;
+    }
+    
+    /* Copied as is, the caller vouches for the encoding */
+    return rlp_insert(encoder, data, length);
+}
+
+/* Number of bytes in the minimal big-endian form of value */
+static size_t rlp_integer_bytes(uint64_t value) {
+    size_t length = 0;
+    while (value) {
+        length++;
+        value >>= 8;
+    }
+    return length;
+}
+
+size_t rlp_uint_length(uint64_t value) {
+    return value < RLP_SINGLE_BYTE_PREFIX ? 1 : 1 + rlp_integer_bytes(value);
+}
+
+size_t rlp_u256_length(const eth_u256_t *value) {
+    size_t length = eth_u256_byte_length(value);
+    return (length <= 1 && value->limb[0] < RLP_SINGLE_BYTE_PREFIX) ? 1 : 1 + length;
+}
+
+size_t rlp_bytes_length(const uint8_t *data, size_t length) {
+    if (length == 1 && data[0] < RLP_SINGLE_BYTE_PREFIX) {
+        return 1;
+    }
+    return rlp_list_header_length(length) + length;
+}
+
+size_t rlp_list_header_length(size_t payload_length) {
+    /* Strings and lists use the same header layout */
+    return payload_length < 56 ? 1 : 1 + rlp_integer_bytes(payload_length);
+}
+
 size_t rlp_get_length(const rlp_encoder_t *encoder) {
     return encoder ? encoder->length : 0;
 } 
\ No newline at end of file
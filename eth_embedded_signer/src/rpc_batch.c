@@ -0,0 +1,211 @@
+#include <string.h>
+#include "../include/rpc_batch.h"
+#include "../include/hex.h"
+
+/* Error codes */
+#define RPC_BATCH_ERROR_NONE       0
+#define RPC_BATCH_ERROR_INVALID   -1
+#define RPC_BATCH_ERROR_TOO_LARGE -2
+#define RPC_BATCH_ERROR_HEX       -3
+
+/* Fixed parts of a request, around the id and the hex payload */
+static const char rpc_prefix[] = "{\"jsonrpc\":\"2.0\",\"id\":";
+static const char rpc_method[] = ",\"method\":\"eth_sendRawTransaction\",\"params\":[\"0x";
+static const char rpc_suffix[] = "\"]}";
+
+#define RPC_LITERAL_LEN(s) (sizeof(s) - 1)
+
+/* Separator, fixed parts and id, everything except the hex payload */
+#define RPC_FRAMING_LEN (1 + RPC_LITERAL_LEN(rpc_prefix) + RPC_LITERAL_LEN(rpc_method) + RPC_LITERAL_LEN(rpc_suffix))
+
+/* Write id right-aligned into the digit buffer */
+static void rpc_set_id(eth_rpc_batch_t *batch, uint64_t id) {
+    size_t pos = ETH_RPC_BATCH_ID_DIGITS;
+
+    do {
+        batch->id[--pos] = (char)('0' + id % 10);
+        id /= 10;
+    } while (id > 0);
+
+    batch->id_len = ETH_RPC_BATCH_ID_DIGITS - pos;
+}
+
+/* Add one to the decimal id in place */
+static void rpc_increment_id(eth_rpc_batch_t *batch) {
+    size_t first = ETH_RPC_BATCH_ID_DIGITS - batch->id_len;
+
+    for (size_t i = ETH_RPC_BATCH_ID_DIGITS; i-- > first;) {
+        if (batch->id[i] != '9') {
+            batch->id[i]++;
+            return;
+        }
+        batch->id[i] = '0';
+    }
+
+    /* All nines: one more digit (wraps to 0 past 20 digits) */
+    if (batch->id_len < ETH_RPC_BATCH_ID_DIGITS) {
+        batch->id_len++;
+        batch->id[ETH_RPC_BATCH_ID_DIGITS - batch->id_len] = '1';
+    } else {
+        rpc_set_id(batch, 0);
+    }
+}
+
+int eth_rpc_batch_init_segments(eth_rpc_batch_t *batch, struct iovec *segments, size_t segment_count, uint64_t first_id) {
+    if (!batch || !segments || segment_count == 0) {
+        return RPC_BATCH_ERROR_INVALID;
+    }
+    /* Room for "[]" in the first segment */
+    if (!segments[0].iov_base || segments[0].iov_len < 2) {
+        return RPC_BATCH_ERROR_INVALID;
+    }
+
+    batch->segments = segments;
+    batch->segment_count = segment_count;
+    batch->segment = 0;
+    batch->length = 0;
+    batch->capacity = segments[0].iov_len;
+    batch->count = 0;
+    batch->total_length = 0;
+    rpc_set_id(batch, first_id);
+
+    return RPC_BATCH_ERROR_NONE;
+}
+
+int eth_rpc_batch_init(eth_rpc_batch_t *batch, char *buffer, size_t size, uint64_t first_id) {
+    if (!batch) {
+        return RPC_BATCH_ERROR_INVALID;
+    }
+
+    batch->single.iov_base = buffer;
+    batch->single.iov_len = size;
+
+    return eth_rpc_batch_init_segments(batch, &batch->single, 1, first_id);
+}
+
+int eth_rpc_batch_add(eth_rpc_batch_t *batch, const uint8_t *raw, size_t raw_len) {
+    if (!batch || !batch->segments || !raw || raw_len == 0 || raw_len > (SIZE_MAX - 64) / 2 - RPC_FRAMING_LEN) {
+        return RPC_BATCH_ERROR_INVALID;
+    }
+
+    /* One more byte stays free for the closing bracket */
+    size_t needed = RPC_FRAMING_LEN + batch->id_len + raw_len * 2 + 1;
+
+    /* Find the first segment with room, starting with the current one */
+    size_t segment = batch->segment;
+    size_t used = batch->length;
+    size_t capacity = batch->capacity;
+    size_t largest = capacity;
+
+    while (capacity - used < needed) {
+        if (++segment == batch->segment_count) {
+            return needed > largest ? RPC_BATCH_ERROR_TOO_LARGE : ETH_RPC_BATCH_FULL;
+        }
+        used = 0;
+        capacity = batch->segments[segment].iov_len;
+        if (capacity > largest) {
+            largest = capacity;
+        }
+    }
+
+    if (segment != batch->segment) {
+        /* Close off the segments left behind with their final lengths */
+        batch->segments[batch->segment].iov_len = batch->length;
+        for (size_t i = batch->segment + 1; i < segment; i++) {
+            batch->segments[i].iov_len = 0;
+        }
+        batch->segment = segment;
+        batch->length = 0;
+        batch->capacity = capacity;
+    }
+
+    char *start = (char *)batch->segments[segment].iov_base + batch->length;
+    char *p = start;
+
+    *p++ = batch->count == 0 ? '[' : ',';
+    memcpy(p, rpc_prefix, RPC_LITERAL_LEN(rpc_prefix));
+    p += RPC_LITERAL_LEN(rpc_prefix);
+    memcpy(p, batch->id + ETH_RPC_BATCH_ID_DIGITS - batch->id_len, batch->id_len);
+    p += batch->id_len;
+    memcpy(p, rpc_method, RPC_LITERAL_LEN(rpc_method));
+    p += RPC_LITERAL_LEN(rpc_method);
+
+    /* Hex goes straight into the output */
+    if (eth_hex_encode(raw, raw_len, p, raw_len * 2) != 0) {
+        return RPC_BATCH_ERROR_HEX;
+    }
+    p += raw_len * 2;
+
+    memcpy(p, rpc_suffix, RPC_LITERAL_LEN(rpc_suffix));
+    p += RPC_LITERAL_LEN(rpc_suffix);
+
+    batch->length += (size_t)(p - start);
+    batch->total_length += (size_t)(p - start);
+    batch->count++;
+    rpc_increment_id(batch);
+
+    return RPC_BATCH_ERROR_NONE;
+}
+
+void eth_rpc_batch_skip(eth_rpc_batch_t *batch) {
+    if (batch) {
+        rpc_increment_id(batch);
+    }
+}
+
+uint64_t eth_rpc_batch_next_id(const eth_rpc_batch_t *batch) {
+    uint64_t id = 0;
+
+    if (batch) {
+        for (size_t i = ETH_RPC_BATCH_ID_DIGITS - batch->id_len; i < ETH_RPC_BATCH_ID_DIGITS; i++) {
+            id = id * 10 + (uint64_t)(batch->id[i] - '0');
+        }
+    }
+
+    return id;
+}
+
+int eth_rpc_batch_finish(eth_rpc_batch_t *batch, size_t *segments_used, size_t *total_length) {
+    if (!batch || !batch->segments) {
+        return RPC_BATCH_ERROR_INVALID;
+    }
+
+    /* The space was kept free by init (empty batch) or the last add */
+    char *p = (char *)batch->segments[batch->segment].iov_base + batch->length;
+    if (batch->count == 0) {
+        *p++ = '[';
+        batch->length++;
+        batch->total_length++;
+    }
+    *p = ']';
+    batch->length++;
+    batch->total_length++;
+
+    batch->segments[batch->segment].iov_len = batch->length;
+    for (size_t i = batch->segment + 1; i < batch->segment_count; i++) {
+        batch->segments[i].iov_len = 0;
+    }
+
+    if (segments_used) {
+        *segments_used = batch->segment + 1;
+    }
+    if (total_length) {
+        *total_length = batch->total_length;
+    }
+
+    /* Nothing more can be added */
+    batch->segments = NULL;
+
+    return RPC_BATCH_ERROR_NONE;
+}
+
+size_t eth_rpc_request_size(size_t raw_len, uint64_t id) {
+    size_t digits = 1;
+
+    while (id >= 10) {
+        id /= 10;
+        digits++;
+    }
+
+    return RPC_FRAMING_LEN + digits + raw_len * 2;
+}
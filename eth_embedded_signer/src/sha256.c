@@ -0,0 +1,403 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "../include/sha256.h"
+#include "../include/cpu.h"
+
+#if ETH_CPU_DISPATCH && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SHA256_HAVE_X86_KERNELS 1
+#endif
+
+/* Kernel signatures: compress count consecutive blocks, or one block into each of 8 states */
+typedef void (*sha256_compress_fn)(uint32_t state[8], const uint8_t *blocks, size_t count);
+typedef void (*sha256_multi_fn)(uint32_t (*states)[8], const uint8_t *const *blocks);
+
+/* Round constants */
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t sha256_rotr(uint32_t value, unsigned shift) {
+    return (value >> shift) | (value << (32 - shift));
+}
+
+static inline uint32_t sha256_load32(const uint8_t *bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+static inline void sha256_store32(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)(value >> 16);
+    bytes[2] = (uint8_t)(value >> 8);
+    bytes[3] = (uint8_t)value;
+}
+
+/* Scalar kernel */
+
+static void sha256_compress_scalar(uint32_t state[8], const uint8_t *blocks, size_t count) {
+    for (; count > 0; count--, blocks += ETH_SHA256_BLOCK_SIZE) {
+        uint32_t w[64];
+
+        for (int i = 0; i < 16; i++) {
+            w[i] = sha256_load32(blocks + 4 * i);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = sha256_rotr(w[i - 15], 7) ^ sha256_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = sha256_rotr(w[i - 2], 17) ^ sha256_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (sha256_rotr(e, 6) ^ sha256_rotr(e, 11) ^ sha256_rotr(e, 25)) +
+                          ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+            uint32_t t2 = (sha256_rotr(a, 2) ^ sha256_rotr(a, 13) ^ sha256_rotr(a, 22)) +
+                          ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(SHA256_HAVE_X86_KERNELS)
+
+/*
+ * SHA-NI kernel. The instructions keep the state as ABEF / CDGH halves and
+ * do two rounds per sha256rnds2; sha256msg1/msg2 extend the schedule four
+ * words at a time.
+ */
+__attribute__((target("sha,sse4.1")))
+static void sha256_compress_shani(uint32_t state[8], const uint8_t *blocks, size_t count) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);    /* CDAB */
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B); /* EFGH */
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                       /* ABEF */
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);                                            /* CDGH */
+
+    for (; count > 0; count--, blocks += ETH_SHA256_BLOCK_SIZE) {
+        __m128i saved0 = state0, saved1 = state1;
+        __m128i msg[4];
+
+        for (int q = 0; q < 16; q++) {
+            if (q < 4) {
+                msg[q] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 16 * q)), byte_swap);
+            } else {
+                __m128i w = _mm_sha256msg1_epu32(msg[q % 4], msg[(q + 1) % 4]);
+                w = _mm_add_epi32(w, _mm_alignr_epi8(msg[(q + 3) % 4], msg[(q + 2) % 4], 4));
+                msg[q % 4] = _mm_sha256msg2_epu32(w, msg[(q + 3) % 4]);
+            }
+
+            __m128i wk = _mm_add_epi32(msg[q % 4], _mm_loadu_si128((const __m128i *)&sha256_k[4 * q]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+        }
+
+        state0 = _mm_add_epi32(state0, saved0);
+        state1 = _mm_add_epi32(state1, saved1);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);                     /* FEBA */
+    state1 = _mm_shuffle_epi32(state1, 0xB1);                  /* DCHG */
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);               /* DCBA */
+    state1 = _mm_alignr_epi8(state1, tmp, 8);                  /* HGFE */
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+/*
+ * AVX2 multi-buffer kernel: eight independent states, one per 32-bit lane,
+ * run the scalar round function side by side.
+ */
+#define SHA256_ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+__attribute__((target("avx2")))
+static void sha256_multi_avx2(uint32_t (*states)[8], const uint8_t *const *blocks) {
+    __m256i w[16], v[8];
+    uint32_t lanes[8];
+
+    for (int i = 0; i < 8; i++) {
+        v[i] = _mm256_setr_epi32((int)states[0][i], (int)states[1][i], (int)states[2][i], (int)states[3][i],
+                                 (int)states[4][i], (int)states[5][i], (int)states[6][i], (int)states[7][i]);
+    }
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < 8; j++) {
+            lanes[j] = sha256_load32(blocks[j] + 4 * i);
+        }
+        w[i] = _mm256_loadu_si256((const __m256i *)lanes);
+    }
+
+    __m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+
+    for (int i = 0; i < 64; i++) {
+        if (i >= 16) {
+            __m256i w15 = w[(i + 1) & 15], w2 = w[(i + 14) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(SHA256_ROTR8(w15, 7), SHA256_ROTR8(w15, 18)),
+                                          _mm256_srli_epi32(w15, 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(SHA256_ROTR8(w2, 17), SHA256_ROTR8(w2, 19)),
+                                          _mm256_srli_epi32(w2, 10));
+            w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0), _mm256_add_epi32(w[(i + 9) & 15], s1));
+        }
+
+        __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(SHA256_ROTR8(e, 6), SHA256_ROTR8(e, 11)), SHA256_ROTR8(e, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+                                      _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32((int)sha256_k[i]),
+                                                                            w[i & 15])));
+        __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(SHA256_ROTR8(a, 2), SHA256_ROTR8(a, 13)), SHA256_ROTR8(a, 22));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(s0, maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    v[0] = _mm256_add_epi32(v[0], a);
+    v[1] = _mm256_add_epi32(v[1], b);
+    v[2] = _mm256_add_epi32(v[2], c);
+    v[3] = _mm256_add_epi32(v[3], d);
+    v[4] = _mm256_add_epi32(v[4], e);
+    v[5] = _mm256_add_epi32(v[5], f);
+    v[6] = _mm256_add_epi32(v[6], g);
+    v[7] = _mm256_add_epi32(v[7], h);
+
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)lanes, v[i]);
+        for (int j = 0; j < 8; j++) {
+            states[j][i] = lanes[j];
+        }
+    }
+}
+
+#undef SHA256_ROTR8
+
+#endif /* SHA256_HAVE_X86_KERNELS */
+
+/* Selected kernels, resolved on first use */
+typedef struct {
+    sha256_compress_fn compress;
+    sha256_multi_fn multi;          /* NULL: states are compressed one by one */
+    const char *name;
+} sha256_backend_t;
+
+static const sha256_backend_t *sha256_select(void) {
+    static const sha256_backend_t scalar = { sha256_compress_scalar, NULL, "scalar" };
+#if defined(SHA256_HAVE_X86_KERNELS)
+    static const sha256_backend_t shani = { sha256_compress_shani, NULL, "sha-ni" };
+    static const sha256_backend_t avx2 = { sha256_compress_scalar, sha256_multi_avx2, "avx2" };
+
+    uint32_t features = eth_cpu_features();
+
+    if (features & ETH_CPU_SHA) {
+        return &shani;
+    }
+    if (features & ETH_CPU_AVX2) {
+        return &avx2;
+    }
+#endif
+    return &scalar;
+}
+
+static const sha256_backend_t *sha256_backend_get(void) {
+#if !ETH_CPU_DISPATCH
+    return sha256_select();
+#else
+    /* Racing first calls all pick the same table, so relaxed ordering is enough */
+    static _Atomic(const sha256_backend_t *) backend = NULL;
+    const sha256_backend_t *selected = atomic_load_explicit(&backend, memory_order_relaxed);
+
+    if (!selected) {
+        selected = sha256_select();
+        atomic_store_explicit(&backend, selected, memory_order_relaxed);
+    }
+    return selected;
+#endif
+}
+
+/* Public API */
+
+void eth_sha256_init(eth_sha256_ctx_t *ctx) {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+}
+
+void eth_sha256_update(eth_sha256_ctx_t *ctx, const uint8_t *data, size_t length) {
+    sha256_compress_fn compress = sha256_backend_get()->compress;
+    size_t used = (size_t)(ctx->length % ETH_SHA256_BLOCK_SIZE);
+
+    ctx->length += length;
+
+    if (used > 0) {
+        size_t take = ETH_SHA256_BLOCK_SIZE - used;
+        if (take > length) {
+            take = length;
+        }
+        memcpy(ctx->buffer + used, data, take);
+        data += take;
+        length -= take;
+        if (used + take < ETH_SHA256_BLOCK_SIZE) {
+            return;
+        }
+        compress(ctx->state, ctx->buffer, 1);
+    }
+
+    /* Whole blocks straight from the input, in one kernel call */
+    if (length >= ETH_SHA256_BLOCK_SIZE) {
+        size_t blocks = length / ETH_SHA256_BLOCK_SIZE;
+        compress(ctx->state, data, blocks);
+        data += blocks * ETH_SHA256_BLOCK_SIZE;
+        length -= blocks * ETH_SHA256_BLOCK_SIZE;
+    }
+
+    if (length > 0) {
+        memcpy(ctx->buffer, data, length);
+    }
+}
+
+void eth_sha256_final(eth_sha256_ctx_t *ctx, uint8_t output[32]) {
+    sha256_compress_fn compress = sha256_backend_get()->compress;
+    size_t used = (size_t)(ctx->length % ETH_SHA256_BLOCK_SIZE);
+
+    /* 0x80, zeros, then the bit length in the last 8 bytes */
+    ctx->buffer[used++] = 0x80;
+    if (used > ETH_SHA256_BLOCK_SIZE - 8) {
+        memset(ctx->buffer + used, 0, ETH_SHA256_BLOCK_SIZE - used);
+        compress(ctx->state, ctx->buffer, 1);
+        used = 0;
+    }
+    memset(ctx->buffer + used, 0, ETH_SHA256_BLOCK_SIZE - 8 - used);
+    sha256_store32(ctx->buffer + ETH_SHA256_BLOCK_SIZE - 8, (uint32_t)(ctx->length >> 29));
+    sha256_store32(ctx->buffer + ETH_SHA256_BLOCK_SIZE - 4, (uint32_t)(ctx->length << 3));
+    compress(ctx->state, ctx->buffer, 1);
+
+    for (int i = 0; i < 8; i++) {
+        sha256_store32(output + 4 * i, ctx->state[i]);
+    }
+}
+
+void eth_sha256(const uint8_t *data, size_t length, uint8_t output[32]) {
+    eth_sha256_ctx_t ctx;
+
+    eth_sha256_init(&ctx);
+    eth_sha256_update(&ctx, data, length);
+    eth_sha256_final(&ctx, output);
+}
+
+void eth_sha256_compress_multi(uint32_t (*states)[8], const uint8_t *const *blocks, size_t count) {
+    const sha256_backend_t *backend = sha256_backend_get();
+    size_t i = 0;
+
+    if (backend->multi) {
+        for (; count - i >= ETH_SHA256_LANES; i += ETH_SHA256_LANES) {
+            backend->multi(states + i, blocks + i);
+        }
+
+        /* A partial group still beats one by one; idle lanes hash a copy */
+        size_t left = count - i;
+        if (left >= 2) {
+            uint32_t group[ETH_SHA256_LANES][8];
+            const uint8_t *group_blocks[ETH_SHA256_LANES];
+            for (size_t j = 0; j < ETH_SHA256_LANES; j++) {
+                size_t lane = j < left ? i + j : i;
+                memcpy(group[j], states[lane], sizeof(group[j]));
+                group_blocks[j] = blocks[lane];
+            }
+            backend->multi(group, group_blocks);
+            for (size_t j = 0; j < left; j++) {
+                memcpy(states[i + j], group[j], sizeof(group[j]));
+            }
+            i = count;
+        }
+    }
+
+    for (; i < count; i++) {
+        backend->compress(states[i], blocks[i], 1);
+    }
+}
+
+void eth_hmac_sha256_init(eth_hmac_sha256_ctx_t *ctx, const uint8_t *key, size_t length) {
+    uint8_t block[ETH_SHA256_BLOCK_SIZE];
+
+    memset(block, 0, sizeof(block));
+    if (length > ETH_SHA256_BLOCK_SIZE) {
+        /* Long keys are hashed first */
+        eth_sha256(key, length, block);
+    } else if (length > 0) {
+        memcpy(block, key, length);
+    }
+
+    for (size_t i = 0; i < sizeof(block); i++) {
+        block[i] ^= 0x36;
+    }
+    eth_sha256_init(&ctx->inner);
+    eth_sha256_update(&ctx->inner, block, sizeof(block));
+
+    /* 0x36 ^ 0x5c turns the ipad block into the opad block */
+    for (size_t i = 0; i < sizeof(block); i++) {
+        block[i] ^= 0x36 ^ 0x5c;
+    }
+    eth_sha256_init(&ctx->outer);
+    eth_sha256_update(&ctx->outer, block, sizeof(block));
+
+    memset(block, 0, sizeof(block));
+}
+
+void eth_hmac_sha256_update(eth_hmac_sha256_ctx_t *ctx, const uint8_t *data, size_t length) {
+    eth_sha256_update(&ctx->inner, data, length);
+}
+
+void eth_hmac_sha256_final(eth_hmac_sha256_ctx_t *ctx, uint8_t output[32]) {
+    uint8_t inner[32];
+
+    eth_sha256_final(&ctx->inner, inner);
+    eth_sha256_update(&ctx->outer, inner, sizeof(inner));
+    eth_sha256_final(&ctx->outer, output);
+}
+
+void eth_hmac_sha256(const uint8_t *key, size_t key_length, const uint8_t *data, size_t length,
+                     uint8_t output[32]) {
+    eth_hmac_sha256_ctx_t ctx;
+
+    eth_hmac_sha256_init(&ctx, key, key_length);
+    eth_hmac_sha256_update(&ctx, data, length);
+    eth_hmac_sha256_final(&ctx, output);
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+const char *eth_sha256_backend(void) {
+    return sha256_backend_get()->name;
+}
@@ -0,0 +1,287 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include "../include/sign_queue.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/eventfd.h>
+#define SIGN_QUEUE_HAVE_EVENTFD 1
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <fcntl.h>
+#define SIGN_QUEUE_HAVE_PIPE 1
+#endif
+
+/* Error codes */
+#define SIGN_QUEUE_ERROR_NONE      0
+#define SIGN_QUEUE_ERROR_INVALID  -1
+#define SIGN_QUEUE_ERROR_NOMEM    -2
+#define SIGN_QUEUE_ERROR_THREAD   -3
+#define SIGN_QUEUE_ERROR_STOPPED  -4
+
+/* Open the wakeup descriptor (eventfd, or a self-pipe on other POSIX systems) */
+static void sign_queue_open_event(eth_sign_queue_t *queue) {
+    queue->event_fd = -1;
+    queue->event_write_fd = -1;
+
+#if defined(SIGN_QUEUE_HAVE_EVENTFD)
+    queue->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    queue->event_write_fd = queue->event_fd;
+#elif defined(SIGN_QUEUE_HAVE_PIPE)
+    int fds[2];
+    if (pipe(fds) == 0) {
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+        queue->event_fd = fds[0];
+        queue->event_write_fd = fds[1];
+    }
+#endif
+}
+
+/* Close the wakeup descriptor */
+static void sign_queue_close_event(eth_sign_queue_t *queue) {
+#if defined(SIGN_QUEUE_HAVE_EVENTFD) || defined(SIGN_QUEUE_HAVE_PIPE)
+    if (queue->event_write_fd >= 0 && queue->event_write_fd != queue->event_fd) {
+        close(queue->event_write_fd);
+    }
+    if (queue->event_fd >= 0) {
+        close(queue->event_fd);
+    }
+#endif
+    queue->event_fd = -1;
+    queue->event_write_fd = -1;
+}
+
+/* Make the wakeup descriptor readable */
+static void sign_queue_signal(eth_sign_queue_t *queue) {
+#if defined(SIGN_QUEUE_HAVE_EVENTFD)
+    uint64_t one = 1;
+    if (write(queue->event_write_fd, &one, sizeof(one)) < 0) {
+        /* Counter saturated: the loop is already due to wake up */
+    }
+#elif defined(SIGN_QUEUE_HAVE_PIPE)
+    uint8_t one = 1;
+    if (write(queue->event_write_fd, &one, sizeof(one)) < 0) {
+        /* Pipe full: the loop is already due to wake up */
+    }
+#else
+    (void)queue;
+#endif
+}
+
+/* Consume pending wakeups so the descriptor reads as idle again */
+static void sign_queue_consume_event(eth_sign_queue_t *queue) {
+#if defined(SIGN_QUEUE_HAVE_EVENTFD)
+    uint64_t count;
+    if (read(queue->event_fd, &count, sizeof(count)) < 0) {
+        /* Nothing pending */
+    }
+#elif defined(SIGN_QUEUE_HAVE_PIPE)
+    uint8_t scratch[64];
+    while (read(queue->event_fd, scratch, sizeof(scratch)) > 0) {
+        /* Drain the pipe */
+    }
+#else
+    (void)queue;
+#endif
+}
+
+/* Worker: sign submitted jobs and move them to the completion queue */
+static void *sign_queue_worker(void *arg) {
+    eth_sign_queue_t *queue = arg;
+    unsigned spins = 0;
+    void *item;
+
+    /* Parks while there is nothing to sign; ends once stopping and the queue is empty */
+    while (eth_mpmc_queue_pop_wait(&queue->submit_queue, &queue->stopping, &item) == 0) {
+        spins = 0;
+
+        eth_sign_completion_t *slot = item;
+        eth_sign_job_t *job = slot->job;
+
+        slot->output_len = 0;
+        if (job->policy) {
+            slot->status = eth_tx_sign_checked(job->tx, job->private_key, job->policy, &slot->policy_result);
+        } else {
+            slot->status = eth_tx_sign(job->tx, job->private_key);
+        }
+        if (slot->status == 0 && job->output) {
+            slot->status = eth_tx_encode_signed(job->tx, job->output, job->output_size, &slot->output_len);
+        }
+
+        /* A failed job never reaches the network, give its nonce back */
+        if (slot->status != 0 && job->nonces && job->sender) {
+            slot->nonce_status = eth_nonce_release(job->nonces, job->sender, job->tx->nonce);
+        }
+
+        /* Cannot fail: the completion queue has room for every slot */
+        while (eth_mpmc_queue_push(&queue->completion_queue, slot) != 0) {
+            eth_mpmc_backoff(&spins);
+        }
+
+        /* Only the first completion after a poll wakes the loop, the rest ride along */
+        if (atomic_exchange_explicit(&queue->wake_armed, 0, memory_order_acq_rel)) {
+            sign_queue_signal(queue);
+        }
+    }
+
+    return NULL;
+}
+
+/* Stop and join every started worker */
+static void sign_queue_stop(eth_sign_queue_t *queue) {
+    atomic_store_explicit(&queue->stopping, 1, memory_order_release);
+    eth_mpmc_queue_wake_all(&queue->submit_queue);
+
+    for (unsigned i = 0; i < queue->thread_count; i++) {
+        pthread_join(queue->threads[i], NULL);
+    }
+    queue->thread_count = 0;
+}
+
+/* Release queues, slots and the wakeup descriptor */
+static void sign_queue_release(eth_sign_queue_t *queue) {
+    eth_mpmc_queue_free(&queue->free_slots);
+    eth_mpmc_queue_free(&queue->submit_queue);
+    eth_mpmc_queue_free(&queue->completion_queue);
+    sign_queue_close_event(queue);
+    free(queue->slots);
+    free(queue->threads);
+    queue->slots = NULL;
+    queue->threads = NULL;
+}
+
+int eth_sign_queue_init(eth_sign_queue_t *queue, unsigned threads, size_t depth) {
+    if (!queue || depth == 0) {
+        return SIGN_QUEUE_ERROR_INVALID;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    sign_queue_open_event(queue);
+
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    if (eth_mpmc_queue_init(&queue->free_slots, depth) != 0 ||
+        eth_mpmc_queue_init(&queue->submit_queue, depth) != 0 ||
+        eth_mpmc_queue_init(&queue->completion_queue, depth) != 0) {
+        sign_queue_release(queue);
+        return SIGN_QUEUE_ERROR_NOMEM;
+    }
+
+    /* Every queue has the same power-of-two capacity, one slot per cell */
+    size_t slot_count = eth_mpmc_queue_capacity(&queue->free_slots);
+    queue->slots = calloc(slot_count, sizeof(eth_sign_completion_t));
+    queue->threads = calloc(threads, sizeof(pthread_t));
+    if (!queue->slots || !queue->threads) {
+        sign_queue_release(queue);
+        return SIGN_QUEUE_ERROR_NOMEM;
+    }
+
+    for (size_t i = 0; i < slot_count; i++) {
+        eth_mpmc_queue_push(&queue->free_slots, &queue->slots[i]);
+    }
+
+    atomic_init(&queue->wake_armed, 1);
+    atomic_init(&queue->stopping, 0);
+
+    for (unsigned i = 0; i < threads; i++) {
+        if (pthread_create(&queue->threads[i], NULL, sign_queue_worker, queue) != 0) {
+            sign_queue_stop(queue);
+            sign_queue_release(queue);
+            return SIGN_QUEUE_ERROR_THREAD;
+        }
+        queue->thread_count++;
+    }
+
+    return SIGN_QUEUE_ERROR_NONE;
+}
+
+int eth_sign_queue_submit(eth_sign_queue_t *queue, eth_sign_job_t *job, void *user_data) {
+    if (!queue || !queue->slots || !job || !job->tx || !job->private_key) {
+        return SIGN_QUEUE_ERROR_INVALID;
+    }
+    if (atomic_load_explicit(&queue->stopping, memory_order_acquire)) {
+        return SIGN_QUEUE_ERROR_STOPPED;
+    }
+
+    void *item;
+    if (eth_mpmc_queue_pop(&queue->free_slots, &item) != 0) {
+        return ETH_SIGN_QUEUE_FULL;
+    }
+
+    eth_sign_completion_t *slot = item;
+
+    /* Reserve the nonce in submission order */
+    if (job->nonces && job->sender) {
+        uint64_t nonce;
+        int result = eth_nonce_reserve(job->nonces, job->sender, &nonce);
+        if (result != 0) {
+            eth_mpmc_queue_push(&queue->free_slots, slot);
+            return result;
+        }
+        /* Through the setter so a cached sighash is not reused */
+        eth_tx_set_nonce(job->tx, nonce);
+    }
+
+    slot->job = job;
+    slot->user_data = user_data;
+    slot->output_len = 0;
+    slot->status = 0;
+    slot->policy_result = ETH_POLICY_OK;
+    slot->nonce_status = 0;
+
+    /* A free slot guarantees room in the submit queue, retry only covers a racing pop */
+    unsigned spins = 0;
+    while (eth_mpmc_queue_push(&queue->submit_queue, slot) != 0) {
+        eth_mpmc_backoff(&spins);
+    }
+
+    return SIGN_QUEUE_ERROR_NONE;
+}
+
+int eth_sign_queue_poll(eth_sign_queue_t *queue, eth_sign_completion_t *completions, size_t max) {
+    if (!queue || !queue->slots || (!completions && max > 0)) {
+        return SIGN_QUEUE_ERROR_INVALID;
+    }
+
+    /*
+     * Clear the descriptor and re-arm before looking at the queue: a worker that
+     * finishes after the arm signals again, one that finished before it is
+     * picked up below.
+     */
+    sign_queue_consume_event(queue);
+    atomic_store_explicit(&queue->wake_armed, 1, memory_order_seq_cst);
+
+    size_t count = 0;
+    void *item;
+
+    while (count < max && eth_mpmc_queue_pop(&queue->completion_queue, &item) == 0) {
+        eth_sign_completion_t *slot = item;
+        completions[count++] = *slot;
+
+        /* Return the slot to the free list */
+        unsigned spins = 0;
+        while (eth_mpmc_queue_push(&queue->free_slots, slot) != 0) {
+            eth_mpmc_backoff(&spins);
+        }
+    }
+
+    return (int)count;
+}
+
+int eth_sign_queue_fd(const eth_sign_queue_t *queue) {
+    return queue ? queue->event_fd : -1;
+}
+
+void eth_sign_queue_destroy(eth_sign_queue_t *queue) {
+    if (!queue || !queue->slots) {
+        return;
+    }
+
+    sign_queue_stop(queue);
+    sign_queue_release(queue);
+}
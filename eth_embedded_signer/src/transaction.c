@@ -1,6 +1,8 @@
 #include <string.h>
+#include <stdbool.h>
 #include "../include/transaction.h"
 #include "../include/rlp.h"
+#include "../include/keccak.h"
 
 /* Error codes */
 #define TX_ERROR_NONE           0
@@ -23,9 +25,154 @@ int eth_tx_init(eth_transaction_t *tx, eth_tx_type_t tx_type) {
     return TX_ERROR_NONE;
 }
 
-/* Helper function to encode a transaction field as bytes */
-static int encode_tx_field_bytes(rlp_encoder_t *encoder, const uint8_t *data, uint8_t length) {
-    return rlp_encode_bytes(encoder, data, length);
+/* Record what changed so an attached cache knows what to redo */
+static void tx_mark_dirty(eth_transaction_t *tx, unsigned bits) {
+    if (tx->cache) {
+        tx->cache->dirty |= bits;
+    }
+}
+
+/* Attach (or detach with NULL) an encoding and sighash cache */
+int eth_tx_attach_cache(eth_transaction_t *tx, eth_tx_cache_t *cache, uint8_t *buffer, size_t buffer_size) {
+    if (!tx || (cache && (!buffer || buffer_size == 0))) {
+        return TX_ERROR_INVALID;
+    }
+    
+    if (cache) {
+        memset(cache, 0, sizeof(eth_tx_cache_t));
+        cache->encoding = buffer;
+        cache->encoding_size = buffer_size;
+        cache->dirty = ETH_TX_DIRTY_BODY;
+    }
+    
+    tx->cache = cache;
+    
+    return TX_ERROR_NONE;
+}
+
+/* Force a full re-encode on the next hash */
+void eth_tx_invalidate(eth_transaction_t *tx) {
+    if (tx) {
+        tx_mark_dirty(tx, ETH_TX_DIRTY_BODY);
+    }
+}
+
+int eth_tx_set_nonce(eth_transaction_t *tx, uint64_t nonce) {
+    if (!tx) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->nonce = nonce;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_NONCE);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_chain_id(eth_transaction_t *tx, uint64_t chain_id) {
+    if (!tx) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->chain_id = chain_id;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_BODY);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_gas_limit(eth_transaction_t *tx, uint64_t gas_limit) {
+    if (!tx) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->gas_limit = gas_limit;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_BODY);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_to(eth_transaction_t *tx, const uint8_t to[20]) {
+    if (!tx) {
+        return TX_ERROR_INVALID;
+    }
+    
+    if (to) {
+        memcpy(tx->to, to, 20);
+        tx->to_len = 20;
+    } else {
+        /* Contract creation */
+        tx->to_len = 0;
+    }
+    tx_mark_dirty(tx, ETH_TX_DIRTY_BODY);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_value(eth_transaction_t *tx, const eth_u256_t *value) {
+    if (!tx || !value) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->value = *value;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_BODY);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_data(eth_transaction_t *tx, uint8_t *data, size_t data_len) {
+    if (!tx || (!data && data_len > 0)) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->data = data;
+    tx->data_len = data_len;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_BODY);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_gas_price(eth_transaction_t *tx, const eth_u256_t *gas_price) {
+    if (!tx || !gas_price) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->gas_price = *gas_price;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_FEES);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_max_fee(eth_transaction_t *tx, const eth_u256_t *max_fee) {
+    if (!tx || !max_fee) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->max_fee = *max_fee;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_FEES);
+    
+    return TX_ERROR_NONE;
+}
+
+int eth_tx_set_max_priority_fee(eth_transaction_t *tx, const eth_u256_t *max_priority_fee) {
+    if (!tx || !max_priority_fee) {
+        return TX_ERROR_INVALID;
+    }
+    
+    tx->max_priority_fee = *max_priority_fee;
+    tx_mark_dirty(tx, ETH_TX_DIRTY_FEES);
+    
+    return TX_ERROR_NONE;
+}
+
+/* Helper function to encode a quantity field (minimal length, no leading zeros) */
+static int encode_tx_field_u256(rlp_encoder_t *encoder, const eth_u256_t *value) {
+    return rlp_encode_u256(encoder, value);
+}
+
+/* Helper function to encode a signature scalar, which is a quantity too */
+static int encode_tx_field_scalar(rlp_encoder_t *encoder, const uint8_t scalar[32]) {
+    eth_u256_t value;
+    eth_u256_set_bytes(&value, scalar, 32);
+    return rlp_encode_u256(encoder, &value);
 }
 
 /* Helper function to encode a transaction field as uint */
@@ -42,6 +189,26 @@ static int encode_tx_data(rlp_encoder_t *encoder, const uint8_t *data, size_t le
     return rlp_encode_bytes(encoder, data, length);
 }
 
+/* Helper function to encode the access list (entries are stored pre-encoded) */
+static int encode_tx_access_list(rlp_encoder_t *encoder, const eth_transaction_t *tx) {
+    if (!tx->access_list && tx->access_list_len > 0) {
+        return TX_ERROR_INVALID;
+    }
+    
+    size_t marker;
+    int result = rlp_begin_list(encoder, &marker);
+    if (result != 0) {
+        return result;
+    }
+    
+    result = rlp_encode_raw(encoder, tx->access_list, tx->access_list_len);
+    if (result != 0) {
+        return result;
+    }
+    
+    return rlp_end_list(encoder, marker);
+}
+
 /* Helper function to encode a transaction based on type */
 static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder, bool include_signature) {
     int result;
@@ -62,7 +229,7 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         if (result != 0) return result;
         
         /* 2. Gas price */
-        result = encode_tx_field_bytes(encoder, tx->gas_price, tx->gas_price_len);
+        result = encode_tx_field_u256(encoder, &tx->gas_price);
         if (result != 0) return result;
         
         /* 3. Gas limit */
@@ -79,7 +246,7 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         if (result != 0) return result;
         
         /* 5. Value */
-        result = encode_tx_field_bytes(encoder, tx->value, tx->value_len);
+        result = encode_tx_field_u256(encoder, &tx->value);
         if (result != 0) return result;
         
         /* 6. Data */
@@ -88,15 +255,15 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         
         if (include_signature) {
             /* 7. V */
-            result = rlp_encode_byte(encoder, tx->v);
+            result = rlp_encode_uint(encoder, tx->v);
             if (result != 0) return result;
             
             /* 8. R */
-            result = rlp_encode_bytes(encoder, tx->r, 32);
+            result = encode_tx_field_scalar(encoder, tx->r);
             if (result != 0) return result;
             
             /* 9. S */
-            result = rlp_encode_bytes(encoder, tx->s, 32);
+            result = encode_tx_field_scalar(encoder, tx->s);
             if (result != 0) return result;
         } else {
             /* For EIP-155 replay protection: v = chainId, r = 0, s = 0 */
@@ -123,7 +290,7 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         if (result != 0) return result;
         
         /* 3. Gas price */
-        result = encode_tx_field_bytes(encoder, tx->gas_price, tx->gas_price_len);
+        result = encode_tx_field_u256(encoder, &tx->gas_price);
         if (result != 0) return result;
         
         /* 4. Gas limit */
@@ -140,32 +307,28 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         if (result != 0) return result;
         
         /* 6. Value */
-        result = encode_tx_field_bytes(encoder, tx->value, tx->value_len);
+        result = encode_tx_field_u256(encoder, &tx->value);
         if (result != 0) return result;
         
         /* 7. Data */
         result = encode_tx_data(encoder, tx->data, tx->data_len);
         if (result != 0) return result;
         
-        /* 8. Access list (empty for this implementation) */
-        size_t access_list_marker;
-        result = rlp_begin_list(encoder, &access_list_marker);
-        if (result != 0) return result;
-        
-        result = rlp_end_list(encoder, access_list_marker);
+        /* 8. Access list */
+        result = encode_tx_access_list(encoder, tx);
         if (result != 0) return result;
         
         if (include_signature) {
             /* 9. V (just recovery ID 0/1 for EIP-2930) */
-            result = rlp_encode_byte(encoder, tx->v);
+            result = rlp_encode_uint(encoder, tx->v);
             if (result != 0) return result;
             
             /* 10. R */
-            result = rlp_encode_bytes(encoder, tx->r, 32);
+            result = encode_tx_field_scalar(encoder, tx->r);
             if (result != 0) return result;
             
             /* 11. S */
-            result = rlp_encode_bytes(encoder, tx->s, 32);
+            result = encode_tx_field_scalar(encoder, tx->s);
             if (result != 0) return result;
         }
     } else if (tx->tx_type == ETH_EIP1559_TX) {
@@ -180,11 +343,11 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         if (result != 0) return result;
         
         /* 3. Max priority fee per gas */
-        result = encode_tx_field_bytes(encoder, tx->max_priority_fee, tx->max_priority_fee_len);
+        result = encode_tx_field_u256(encoder, &tx->max_priority_fee);
         if (result != 0) return result;
         
         /* 4. Max fee per gas */
-        result = encode_tx_field_bytes(encoder, tx->max_fee, tx->max_fee_len);
+        result = encode_tx_field_u256(encoder, &tx->max_fee);
         if (result != 0) return result;
         
         /* 5. Gas limit */
@@ -201,32 +364,28 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
         if (result != 0) return result;
         
         /* 7. Value */
-        result = encode_tx_field_bytes(encoder, tx->value, tx->value_len);
+        result = encode_tx_field_u256(encoder, &tx->value);
         if (result != 0) return result;
         
         /* 8. Data */
         result = encode_tx_data(encoder, tx->data, tx->data_len);
         if (result != 0) return result;
         
-        /* 9. Access list (empty for this implementation) */
-        size_t access_list_marker;
-        result = rlp_begin_list(encoder, &access_list_marker);
-        if (result != 0) return result;
-        
-        result = rlp_end_list(encoder, access_list_marker);
+        /* 9. Access list */
+        result = encode_tx_access_list(encoder, tx);
         if (result != 0) return result;
         
         if (include_signature) {
             /* 10. V (just recovery ID 0/1 for EIP-1559) */
-            result = rlp_encode_byte(encoder, tx->v);
+            result = rlp_encode_uint(encoder, tx->v);
             if (result != 0) return result;
             
             /* 11. R */
-            result = rlp_encode_bytes(encoder, tx->r, 32);
+            result = encode_tx_field_scalar(encoder, tx->r);
             if (result != 0) return result;
             
             /* 12. S */
-            result = rlp_encode_bytes(encoder, tx->s, 32);
+            result = encode_tx_field_scalar(encoder, tx->s);
             if (result != 0) return result;
         }
     } else {
@@ -239,9 +398,9 @@ static int encode_tx_by_type(const eth_transaction_t *tx, rlp_encoder_t *encoder
     return result;
 }
 
-/* RLP encode a transaction (unsigned) */
-int eth_tx_encode(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size, size_t *output_size) {
-    if (!tx || !buffer || buffer_size == 0 || !output_size) {
+/* RLP encode a transaction (unsigned), bypassing the cache */
+static int encode_tx_unsigned(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size, size_t *output_size) {
+    if (!buffer || buffer_size == 0) {
         return TX_ERROR_INVALID;
     }
     
@@ -279,24 +438,286 @@ int eth_tx_encode(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_si
     return TX_ERROR_NONE;
 }
 
-/* Hash a transaction for signing */
-int eth_tx_hash(const eth_transaction_t *tx, eth_hash_t *hash) {
-    if (!tx || !hash) {
+/* Length of the type byte in front of the RLP list */
+static size_t tx_type_prefix_length(const eth_transaction_t *tx) {
+    return tx->tx_type == ETH_LEGACY_TX ? 0 : 1;
+}
+
+/* Length of the list header that starts at list */
+static size_t tx_list_header_length(const uint8_t *list) {
+    return list[0] < 0xf8 ? 1 : 1 + (size_t)(list[0] - 0xf7);
+}
+
+/*
+ * Encode the leading fields on their own: chain id (typed transactions),
+ * nonce and the fee fields, in list order. fee_offset is where the fees
+ * start within the output.
+ */
+static int encode_tx_head(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size,
+                          size_t *output_size, size_t *fee_offset) {
+    rlp_encoder_t encoder;
+    int result = rlp_encoder_init(&encoder, buffer, buffer_size);
+    if (result != 0) {
+        return result;
+    }
+    
+    if (tx->tx_type != ETH_LEGACY_TX) {
+        result = encode_tx_field_uint(&encoder, tx->chain_id);
+        if (result != 0) return result;
+    }
+    
+    result = encode_tx_field_uint(&encoder, tx->nonce);
+    if (result != 0) return result;
+    
+    *fee_offset = rlp_get_length(&encoder);
+    
+    if (tx->tx_type == ETH_EIP1559_TX) {
+        result = encode_tx_field_u256(&encoder, &tx->max_priority_fee);
+        if (result != 0) return result;
+        
+        result = encode_tx_field_u256(&encoder, &tx->max_fee);
+        if (result != 0) return result;
+    } else {
+        result = encode_tx_field_u256(&encoder, &tx->gas_price);
+        if (result != 0) return result;
+    }
+    
+    *output_size = rlp_get_length(&encoder);
+    
+    return TX_ERROR_NONE;
+}
+
+/* Absorb what a scratch encoder holds and empty it for the next fields */
+static void hash_tx_flush(eth_keccak_ctx_t *ctx, rlp_encoder_t *encoder) {
+    eth_keccak256_update(ctx, encoder->buffer, rlp_get_length(encoder));
+    encoder->length = 0;
+}
+
+/*
+ * Hash a transaction for signing, bypassing the cache. The encoding is
+ * never built: the list length is summed from the field lengths, then the
+ * header and the short fields go through a small scratch buffer into
+ * Keccak while data and the access list are absorbed in place, so stack
+ * use stays the same for any data size.
+ */
+static int hash_tx_unsigned(const eth_transaction_t *tx, eth_hash_t *hash) {
+    if (tx->tx_type != ETH_LEGACY_TX && tx->tx_type != ETH_EIP2930_TX && tx->tx_type != ETH_EIP1559_TX) {
+        return TX_ERROR_UNSUPPORTED;
+    }
+    if ((!tx->data && tx->data_len > 0) || (!tx->access_list && tx->access_list_len > 0)) {
         return TX_ERROR_INVALID;
     }
     
-    /* Encode the transaction for hashing */
-    uint8_t buffer[1024]; /* Buffer for encoded transaction */
+    /* Chain id (typed), nonce and fees */
+    uint8_t head[84];
+    size_t head_len, fee_offset;
+    int result = encode_tx_head(tx, head, sizeof(head), &head_len, &fee_offset);
+    if (result != 0) {
+        return result;
+    }
+    
+    size_t data_len = rlp_bytes_length(tx->data, tx->data_len);
+    size_t payload = head_len + rlp_uint_length(tx->gas_limit) + rlp_bytes_length(tx->to, tx->to_len) +
+                     rlp_u256_length(&tx->value) + data_len;
+    if (tx->tx_type == ETH_LEGACY_TX) {
+        /* EIP-155 tail: chain id, empty r, empty s */
+        payload += rlp_uint_length(tx->chain_id) + 2;
+    } else {
+        payload += rlp_list_header_length(tx->access_list_len) + tx->access_list_len;
+    }
+    
+    /* Flushed after at most 9 + 21 + 33 bytes (gas limit, to, value), so encoding into it cannot fail */
+    uint8_t scratch[64];
+    rlp_encoder_t encoder;
+    eth_keccak_ctx_t ctx;
+    rlp_encoder_init(&encoder, scratch, sizeof(scratch));
+    eth_keccak256_init(&ctx);
+    
+    if (tx->tx_type != ETH_LEGACY_TX) {
+        rlp_encode_byte(&encoder, tx->tx_type == ETH_EIP2930_TX ? 0x01 : 0x02);
+    }
+    rlp_encode_list_header(&encoder, payload);
+    hash_tx_flush(&ctx, &encoder);
+    eth_keccak256_update(&ctx, head, head_len);
+    
+    encode_tx_field_uint(&encoder, tx->gas_limit);
+    rlp_encode_bytes(&encoder, tx->to, tx->to_len);
+    encode_tx_field_u256(&encoder, &tx->value);
+    hash_tx_flush(&ctx, &encoder);
+    
+    /* A lone byte below 0x80 is its own encoding, anything else gets a header */
+    if (data_len == tx->data_len) {
+        rlp_encode_raw(&encoder, tx->data, tx->data_len);
+    } else {
+        rlp_encode_string_header(&encoder, tx->data_len);
+        hash_tx_flush(&ctx, &encoder);
+        eth_keccak256_update(&ctx, tx->data, tx->data_len);
+    }
+    
+    if (tx->tx_type == ETH_LEGACY_TX) {
+        rlp_encode_uint(&encoder, tx->chain_id);
+        rlp_encode_bytes(&encoder, NULL, 0);
+        rlp_encode_bytes(&encoder, NULL, 0);
+        hash_tx_flush(&ctx, &encoder);
+    } else {
+        rlp_encode_list_header(&encoder, tx->access_list_len);
+        hash_tx_flush(&ctx, &encoder);
+        eth_keccak256_update(&ctx, tx->access_list, tx->access_list_len);
+    }
+    
+    eth_keccak256_final(&ctx, hash->data);
+    return TX_ERROR_NONE;
+}
+
+/*
+ * Swap new leading fields (nonce and fees) into the cached encoding. Only
+ * the list header and those fields are rewritten; the rest of the encoding
+ * moves at most once.
+ */
+static int tx_cache_patch_head(const eth_transaction_t *tx, eth_tx_cache_t *cache) {
+    uint8_t head[84]; /* Two 9-byte integers and two 33-byte quantities at most */
+    size_t head_len, fee_offset;
+    
+    int result = encode_tx_head(tx, head, sizeof(head), &head_len, &fee_offset);
+    if (result != 0) {
+        return result;
+    }
+    
+    uint8_t *encoding = cache->encoding;
+    size_t prefix = tx_type_prefix_length(tx);
+    size_t old_tail = cache->fee_offset + cache->fee_len;
+    size_t payload = cache->encoding_len - old_tail + head_len;
+    size_t new_header = rlp_list_header_length(payload);
+    size_t new_tail = prefix + new_header + head_len;
+    
+    if (new_tail + (cache->encoding_len - old_tail) > cache->encoding_size) {
+        return TX_ERROR_BUFFER_SMALL;
+    }
+    
+    memmove(encoding + new_tail, encoding + old_tail, cache->encoding_len - old_tail);
+    
+    rlp_encoder_t encoder;
+    result = rlp_encoder_init(&encoder, encoding + prefix, cache->encoding_size - prefix);
+    if (result != 0) {
+        return result;
+    }
+    result = rlp_encode_list_header(&encoder, payload);
+    if (result != 0) {
+        return result;
+    }
+    memcpy(encoding + prefix + new_header, head, head_len);
+    
+    cache->fee_offset = prefix + new_header + fee_offset;
+    cache->fee_len = head_len - fee_offset;
+    cache->encoding_len = new_tail + (cache->encoding_len - old_tail);
+    
+    return TX_ERROR_NONE;
+}
+
+/* Re-encode into the cache buffer and note where the fees sit */
+static int tx_cache_encode(const eth_transaction_t *tx, eth_tx_cache_t *cache) {
     size_t encoded_size;
     
-    /* Encode the transaction */
-    int result = eth_tx_encode(tx, buffer, sizeof(buffer), &encoded_size);
+    int result = encode_tx_unsigned(tx, cache->encoding, cache->encoding_size, &encoded_size);
+    if (result != 0) {
+        return result;
+    }
+    
+    size_t prefix = tx_type_prefix_length(tx);
+    size_t header = tx_list_header_length(cache->encoding + prefix);
+    
+    cache->fee_offset = prefix + header + rlp_uint_length(tx->nonce);
+    if (tx->tx_type != ETH_LEGACY_TX) {
+        cache->fee_offset += rlp_uint_length(tx->chain_id);
+    }
+    
+    if (tx->tx_type == ETH_EIP1559_TX) {
+        cache->fee_len = rlp_u256_length(&tx->max_priority_fee) + rlp_u256_length(&tx->max_fee);
+    } else {
+        cache->fee_len = rlp_u256_length(&tx->gas_price);
+    }
+    
+    cache->encoding_len = encoded_size;
+    
+    return TX_ERROR_NONE;
+}
+
+/* Bring the cached encoding and sighash up to date */
+int eth_tx_refresh_cache(eth_transaction_t *tx) {
+    if (!tx) {
+        return TX_ERROR_INVALID;
+    }
+    
+    eth_tx_cache_t *cache = tx->cache;
+    int result;
+    
+    if (!cache || cache->dirty == 0) {
+        return TX_ERROR_NONE;
+    }
+    
+    /* Nonce and fee changes patch the encoding, anything else re-encodes it */
+    result = TX_ERROR_INVALID;
+    if ((cache->dirty & ETH_TX_DIRTY_BODY) == 0 && cache->encoding_len > 0) {
+        result = tx_cache_patch_head(tx, cache);
+    }
+    if (result != 0) {
+        result = tx_cache_encode(tx, cache);
+    }
+    
+    if (result == 0) {
+        result = eth_keccak256(cache->encoding, cache->encoding_len, &cache->sighash);
+    } else {
+        /* Too big for the cache buffer (or invalid): hash it the long way */
+        cache->encoding_len = 0;
+        result = hash_tx_unsigned(tx, &cache->sighash);
+    }
     if (result != 0) {
         return result;
     }
     
-    /* Hash the encoded transaction */
-    return eth_keccak256(buffer, encoded_size, hash);
+    cache->dirty = 0;
+    
+    return TX_ERROR_NONE;
+}
+
+/* The attached cache if it is current, NULL if there is none or it is stale (read-only) */
+static const eth_tx_cache_t *tx_cache_current(const eth_transaction_t *tx) {
+    return (tx->cache && tx->cache->dirty == 0) ? tx->cache : NULL;
+}
+
+/* RLP encode a transaction (unsigned) */
+int eth_tx_encode(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size, size_t *output_size) {
+    if (!tx || !buffer || buffer_size == 0 || !output_size) {
+        return TX_ERROR_INVALID;
+    }
+    
+    /* Served from the cache unless it is stale or the encoding did not fit there */
+    const eth_tx_cache_t *cache = tx_cache_current(tx);
+    if (cache && cache->encoding_len > 0) {
+        if (cache->encoding_len > buffer_size) {
+            return TX_ERROR_BUFFER_SMALL;
+        }
+        memcpy(buffer, cache->encoding, cache->encoding_len);
+        *output_size = cache->encoding_len;
+        return TX_ERROR_NONE;
+    }
+    
+    return encode_tx_unsigned(tx, buffer, buffer_size, output_size);
+}
+
+/* Hash a transaction for signing */
+int eth_tx_hash(const eth_transaction_t *tx, eth_hash_t *hash) {
+    if (!tx || !hash) {
+        return TX_ERROR_INVALID;
+    }
+    
+    const eth_tx_cache_t *cache = tx_cache_current(tx);
+    if (cache) {
+        *hash = cache->sighash;
+        return TX_ERROR_NONE;
+    }
+    
+    return hash_tx_unsigned(tx, hash);
 }
 
 /* Sign a transaction with a private key */
@@ -305,16 +726,29 @@ int eth_tx_sign(eth_transaction_t *tx, const eth_private_key_t *private_key) {
         return TX_ERROR_INVALID;
     }
     
-    /* Hash the transaction for signing */
+    /* Hash the transaction for signing (from the cache, if one is attached) */
     eth_hash_t hash;
-    int result = eth_tx_hash(tx, &hash);
+    int result = eth_tx_refresh_cache(tx);
+    if (result == 0) {
+        result = eth_tx_hash(tx, &hash);
+    }
     if (result != 0) {
         return result;
     }
     
+    return eth_tx_sign_hash(tx, &hash, private_key);
+}
+
+/* Sign an already computed signing hash and store the signature in the transaction */
+int eth_tx_sign_hash(eth_transaction_t *tx, const eth_hash_t *hash, const eth_private_key_t *private_key) {
+    if (!tx || !hash || !private_key) {
+        return TX_ERROR_INVALID;
+    }
+    
     /* Sign the hash */
     eth_signature_t signature;
-    result = eth_sign(&hash, private_key, &signature);
+    uint8_t recovery_id;
+    int result = eth_sign_recoverable(hash, private_key, &signature, &recovery_id);
     if (result != 0) {
         return result;
     }
@@ -323,25 +757,77 @@ int eth_tx_sign(eth_transaction_t *tx, const eth_private_key_t *private_key) {
     memcpy(tx->r, signature.data, 32);
     memcpy(tx->s, signature.data + 32, 32);
     
-    /* Set V (recovery ID) - for simplicity, use 0 here */
-    /* In a real implementation, you would determine the correct recovery ID */
+    /* Set V from the recovery ID */
     if (tx->tx_type == ETH_LEGACY_TX) {
         /* For EIP-155, V = 35/36 + chainId*2 */
-        tx->v = 35 + (tx->chain_id * 2);
+        tx->v = 35 + (tx->chain_id * 2) + recovery_id;
     } else {
         /* For EIP-2930/1559, V is just the recovery ID (0/1) */
-        tx->v = 0;
+        tx->v = recovery_id;
     }
     
     return TX_ERROR_NONE;
 }
 
+/*
+ * Build the signed encoding from the cached unsigned one: same fields, with
+ * the EIP-155 tail (chain id, 0, 0) of legacy transactions swapped for v, r,
+ * s, and v, r, s appended for typed transactions.
+ */
+static int encode_tx_signed_cached(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size, size_t *output_size) {
+    const eth_tx_cache_t *cache = tx->cache;
+    uint8_t signature[75]; /* v (up to 9 bytes) plus two 33-byte scalars at most */
+    rlp_encoder_t encoder;
+    int result;
+    
+    result = rlp_encoder_init(&encoder, signature, sizeof(signature));
+    if (result != 0) return result;
+    result = rlp_encode_uint(&encoder, tx->v);
+    if (result != 0) return result;
+    result = encode_tx_field_scalar(&encoder, tx->r);
+    if (result != 0) return result;
+    result = encode_tx_field_scalar(&encoder, tx->s);
+    if (result != 0) return result;
+    size_t signature_len = rlp_get_length(&encoder);
+    
+    size_t prefix = tx_type_prefix_length(tx);
+    size_t header = tx_list_header_length(cache->encoding + prefix);
+    size_t fields_len = cache->encoding_len - prefix - header;
+    if (tx->tx_type == ETH_LEGACY_TX) {
+        fields_len -= rlp_uint_length(tx->chain_id) + 2;
+    }
+    
+    size_t payload = fields_len + signature_len;
+    if (prefix + rlp_list_header_length(payload) + payload > buffer_size) {
+        return TX_ERROR_BUFFER_SMALL;
+    }
+    
+    memcpy(buffer, cache->encoding, prefix);
+    result = rlp_encoder_init(&encoder, buffer + prefix, buffer_size - prefix);
+    if (result != 0) return result;
+    result = rlp_encode_list_header(&encoder, payload);
+    if (result != 0) return result;
+    result = rlp_encode_raw(&encoder, cache->encoding + prefix + header, fields_len);
+    if (result != 0) return result;
+    result = rlp_encode_raw(&encoder, signature, signature_len);
+    if (result != 0) return result;
+    
+    *output_size = prefix + rlp_get_length(&encoder);
+    
+    return TX_ERROR_NONE;
+}
+
 /* RLP encode a signed transaction */
 int eth_tx_encode_signed(const eth_transaction_t *tx, uint8_t *buffer, size_t buffer_size, size_t *output_size) {
     if (!tx || !buffer || buffer_size == 0 || !output_size) {
         return TX_ERROR_INVALID;
     }
     
+    const eth_tx_cache_t *cache = tx_cache_current(tx);
+    if (cache && cache->encoding_len > 0) {
+        return encode_tx_signed_cached(tx, buffer, buffer_size, output_size);
+    }
+    
     rlp_encoder_t encoder;
     int result;
     
@@ -374,4 +860,64 @@ int eth_tx_encode_signed(const eth_transaction_t *tx, uint8_t *buffer, size_t bu
     *output_size = rlp_get_length(&encoder);
     
     return TX_ERROR_NONE;
-} 
\ No newline at end of file
+}
+
+/* Re-sign a transaction with new fees */
+int eth_tx_rebump(eth_transaction_t *tx, const eth_u256_t *new_tip, const eth_u256_t *new_max_fee,
+                  const eth_private_key_t *private_key, uint8_t *buffer, size_t buffer_size, size_t *output_size) {
+    if (!tx || !new_max_fee || !private_key || !buffer || !output_size) {
+        return TX_ERROR_INVALID;
+    }
+    
+    int result;
+    
+    /* Through the setters, so a cached encoding only has its fees patched */
+    if (tx->tx_type == ETH_EIP1559_TX) {
+        if (!new_tip) {
+            return TX_ERROR_INVALID;
+        }
+        result = eth_tx_set_max_priority_fee(tx, new_tip);
+        if (result != 0) return result;
+        result = eth_tx_set_max_fee(tx, new_max_fee);
+        if (result != 0) return result;
+    } else {
+        result = eth_tx_set_gas_price(tx, new_max_fee);
+        if (result != 0) return result;
+    }
+    
+    result = eth_tx_sign(tx, private_key);
+    if (result != 0) {
+        return result;
+    }
+    
+    return eth_tx_encode_signed(tx, buffer, buffer_size, output_size);
+}
+
+/* Re-sign a set of transactions with new fees */
+int eth_tx_rebump_batch(eth_transaction_t *txs, size_t count, const eth_u256_t *new_tip,
+                        const eth_u256_t *new_max_fee, const eth_private_key_t *private_key,
+                        uint8_t *buffer, size_t buffer_size, size_t *offsets) {
+    if ((!txs && count > 0) || !buffer || !offsets) {
+        return TX_ERROR_INVALID;
+    }
+    
+    size_t used = 0;
+    offsets[0] = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        if (used == buffer_size) {
+            return TX_ERROR_BUFFER_SMALL;
+        }
+        
+        size_t length;
+        int result = eth_tx_rebump(&txs[i], new_tip, new_max_fee, private_key,
+                                   buffer + used, buffer_size - used, &length);
+        if (result != 0) {
+            return result;
+        }
+        used += length;
+        offsets[i + 1] = used;
+    }
+    
+    return TX_ERROR_NONE;
+}
@@ -0,0 +1,318 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/tx_batch.h"
+#include "../include/rlp.h"
+
+/* Error codes */
+#define TX_BATCH_ERROR_NONE         0
+#define TX_BATCH_ERROR_INVALID     -1
+#define TX_BATCH_ERROR_NOMEM       -2
+#define TX_BATCH_ERROR_UNSUPPORTED -3
+#define TX_BATCH_ERROR_BUFFER      -4
+
+/* Rows allocated when none were asked for */
+#define TX_BATCH_MIN_CAPACITY      64
+
+/* Encodings up to this size are hashed from a stack buffer */
+#define TX_BATCH_STACK_ENCODING    1024
+
+/* Grow one column to rows entries */
+#define TX_BATCH_GROW_COLUMN(column, rows)                                    \
+    do {                                                                      \
+        void *grown = realloc((column), (rows) * sizeof(*(column)));          \
+        if (!grown) {                                                         \
+            return TX_BATCH_ERROR_NOMEM;                                      \
+        }                                                                     \
+        (column) = grown;                                                     \
+    } while (0)
+
+/* Make room for rows entries in every column */
+static int tx_batch_grow(eth_tx_batch_t *batch, size_t rows) {
+    if (rows <= batch->capacity) {
+        return TX_BATCH_ERROR_NONE;
+    }
+
+    /* A failure part way leaves the grown columns bigger than capacity, which is harmless */
+    TX_BATCH_GROW_COLUMN(batch->tx_type, rows);
+    TX_BATCH_GROW_COLUMN(batch->chain_id, rows);
+    TX_BATCH_GROW_COLUMN(batch->nonce, rows);
+    TX_BATCH_GROW_COLUMN(batch->gas_limit, rows);
+    TX_BATCH_GROW_COLUMN(batch->to, rows);
+    TX_BATCH_GROW_COLUMN(batch->to_len, rows);
+    TX_BATCH_GROW_COLUMN(batch->value, rows);
+    TX_BATCH_GROW_COLUMN(batch->fee_cap, rows);
+    TX_BATCH_GROW_COLUMN(batch->priority_fee, rows);
+    TX_BATCH_GROW_COLUMN(batch->data_offset, rows);
+    TX_BATCH_GROW_COLUMN(batch->data_len, rows);
+
+    batch->capacity = rows;
+    return TX_BATCH_ERROR_NONE;
+}
+
+/* Calldata of one row (NULL when empty) */
+static const uint8_t *tx_batch_row_data(const eth_tx_batch_t *batch, size_t i) {
+    return batch->data_len[i] ? batch->heap + batch->data_offset[i] : NULL;
+}
+
+/* Length of the list payload of one row (everything inside the outer list) */
+static size_t tx_batch_payload_size(const eth_tx_batch_t *batch, size_t i) {
+    size_t size = rlp_uint_length(batch->nonce[i])
+                + rlp_u256_length(&batch->fee_cap[i])
+                + rlp_uint_length(batch->gas_limit[i])
+                + (batch->to_len[i] ? 21 : 1)
+                + rlp_u256_length(&batch->value[i])
+                + rlp_bytes_length(tx_batch_row_data(batch, i), batch->data_len[i]);
+
+    switch (batch->tx_type[i]) {
+    case ETH_LEGACY_TX:
+        /* EIP-155: chain id, empty r, empty s */
+        return size + rlp_uint_length(batch->chain_id[i]) + 2;
+    case ETH_EIP2930_TX:
+        /* Chain id and an empty access list */
+        return size + rlp_uint_length(batch->chain_id[i]) + 1;
+    default:
+        /* Chain id, priority fee and an empty access list */
+        return size + rlp_uint_length(batch->chain_id[i]) + rlp_u256_length(&batch->priority_fee[i]) + 1;
+    }
+}
+
+/* Total size of one row's unsigned encoding */
+static size_t tx_batch_row_size(const eth_tx_batch_t *batch, size_t i) {
+    size_t payload = tx_batch_payload_size(batch, i);
+    return (batch->tx_type[i] != ETH_LEGACY_TX ? 1 : 0) + rlp_list_header_length(payload) + payload;
+}
+
+/* Encode one row, header first, straight from the columns */
+static int tx_batch_encode_row(const eth_tx_batch_t *batch, size_t i, rlp_encoder_t *encoder) {
+    uint8_t type = batch->tx_type[i];
+    int result = 0;
+
+    if (type != ETH_LEGACY_TX) {
+        result |= rlp_encode_byte(encoder, type);
+    }
+    result |= rlp_encode_list_header(encoder, tx_batch_payload_size(batch, i));
+
+    /* Field order follows encode_tx_by_type in transaction.c */
+    if (type != ETH_LEGACY_TX) {
+        result |= rlp_encode_uint(encoder, batch->chain_id[i]);
+    }
+    result |= rlp_encode_uint(encoder, batch->nonce[i]);
+    if (type == ETH_EIP1559_TX) {
+        result |= rlp_encode_u256(encoder, &batch->priority_fee[i]);
+    }
+    result |= rlp_encode_u256(encoder, &batch->fee_cap[i]);
+    result |= rlp_encode_uint(encoder, batch->gas_limit[i]);
+    result |= rlp_encode_bytes(encoder, batch->to[i], batch->to_len[i]);
+    result |= rlp_encode_u256(encoder, &batch->value[i]);
+    result |= rlp_encode_bytes(encoder, tx_batch_row_data(batch, i), batch->data_len[i]);
+
+    if (type == ETH_LEGACY_TX) {
+        result |= rlp_encode_uint(encoder, batch->chain_id[i]);
+        result |= rlp_encode_bytes(encoder, NULL, 0);
+        result |= rlp_encode_bytes(encoder, NULL, 0);
+    } else {
+        result |= rlp_encode_list_header(encoder, 0);
+    }
+
+    return result ? TX_BATCH_ERROR_BUFFER : TX_BATCH_ERROR_NONE;
+}
+
+static int tx_batch_range_valid(const eth_tx_batch_t *batch, size_t first, size_t count) {
+    return batch && first <= batch->count && count <= batch->count - first;
+}
+
+int eth_tx_batch_init(eth_tx_batch_t *batch, size_t capacity) {
+    if (!batch) {
+        return TX_BATCH_ERROR_INVALID;
+    }
+
+    memset(batch, 0, sizeof(*batch));
+
+    int result = tx_batch_grow(batch, capacity ? capacity : TX_BATCH_MIN_CAPACITY);
+    if (result != TX_BATCH_ERROR_NONE) {
+        eth_tx_batch_free(batch);
+    }
+
+    return result;
+}
+
+void eth_tx_batch_free(eth_tx_batch_t *batch) {
+    if (!batch) {
+        return;
+    }
+
+    free(batch->tx_type);
+    free(batch->chain_id);
+    free(batch->nonce);
+    free(batch->gas_limit);
+    free(batch->to);
+    free(batch->to_len);
+    free(batch->value);
+    free(batch->fee_cap);
+    free(batch->priority_fee);
+    free(batch->data_offset);
+    free(batch->data_len);
+    free(batch->heap);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void eth_tx_batch_clear(eth_tx_batch_t *batch) {
+    if (batch) {
+        batch->count = 0;
+        batch->heap_size = 0;
+    }
+}
+
+int eth_tx_batch_add(eth_tx_batch_t *batch, const eth_transaction_t *tx) {
+    if (!batch || !tx || (!tx->data && tx->data_len > 0) || tx->data_len > UINT32_MAX ||
+        tx->tx_type > ETH_EIP1559_TX || (tx->to_len != 0 && tx->to_len != 20)) {
+        return TX_BATCH_ERROR_INVALID;
+    }
+    if (tx->access_list_len > 0) {
+        return TX_BATCH_ERROR_UNSUPPORTED;
+    }
+
+    if (batch->count == batch->capacity) {
+        size_t rows = batch->capacity ? batch->capacity * 2 : TX_BATCH_MIN_CAPACITY;
+        if (tx_batch_grow(batch, rows) != TX_BATCH_ERROR_NONE) {
+            return TX_BATCH_ERROR_NOMEM;
+        }
+    }
+
+    /* Grow the heap geometrically */
+    if (tx->data_len > batch->heap_capacity - batch->heap_size) {
+        size_t capacity = batch->heap_capacity ? batch->heap_capacity : 4096;
+        while (capacity - batch->heap_size < tx->data_len) {
+            capacity *= 2;
+        }
+        uint8_t *heap = realloc(batch->heap, capacity);
+        if (!heap) {
+            return TX_BATCH_ERROR_NOMEM;
+        }
+        batch->heap = heap;
+        batch->heap_capacity = capacity;
+    }
+
+    size_t i = batch->count;
+    batch->tx_type[i] = (uint8_t)tx->tx_type;
+    batch->chain_id[i] = tx->chain_id;
+    batch->nonce[i] = tx->nonce;
+    batch->gas_limit[i] = tx->gas_limit;
+    memcpy(batch->to[i], tx->to, 20);
+    batch->to_len[i] = tx->to_len;
+    batch->value[i] = tx->value;
+    if (tx->tx_type == ETH_EIP1559_TX) {
+        batch->fee_cap[i] = tx->max_fee;
+        batch->priority_fee[i] = tx->max_priority_fee;
+    } else {
+        batch->fee_cap[i] = tx->gas_price;
+        eth_u256_set_u64(&batch->priority_fee[i], 0);
+    }
+    batch->data_offset[i] = batch->heap_size;
+    batch->data_len[i] = (uint32_t)tx->data_len;
+
+    if (tx->data_len > 0) {
+        memcpy(batch->heap + batch->heap_size, tx->data, tx->data_len);
+        batch->heap_size += tx->data_len;
+    }
+    batch->count++;
+
+    return TX_BATCH_ERROR_NONE;
+}
+
+int eth_tx_batch_get(const eth_tx_batch_t *batch, size_t index, eth_transaction_t *tx) {
+    if (!batch || !tx || index >= batch->count) {
+        return TX_BATCH_ERROR_INVALID;
+    }
+
+    eth_tx_init(tx, (eth_tx_type_t)batch->tx_type[index]);
+    tx->chain_id = batch->chain_id[index];
+    tx->nonce = batch->nonce[index];
+    tx->gas_limit = batch->gas_limit[index];
+    memcpy(tx->to, batch->to[index], 20);
+    tx->to_len = batch->to_len[index];
+    tx->value = batch->value[index];
+    if (tx->tx_type == ETH_EIP1559_TX) {
+        tx->max_fee = batch->fee_cap[index];
+        tx->max_priority_fee = batch->priority_fee[index];
+    } else {
+        tx->gas_price = batch->fee_cap[index];
+    }
+    tx->data = (uint8_t *)tx_batch_row_data(batch, index);
+    tx->data_len = batch->data_len[index];
+
+    return TX_BATCH_ERROR_NONE;
+}
+
+size_t eth_tx_batch_encoded_size(const eth_tx_batch_t *batch, size_t first, size_t count) {
+    if (!tx_batch_range_valid(batch, first, count)) {
+        return 0;
+    }
+
+    size_t total = 0;
+    for (size_t i = first; i < first + count; i++) {
+        total += tx_batch_row_size(batch, i);
+    }
+
+    return total;
+}
+
+int eth_tx_batch_encode(const eth_tx_batch_t *batch, size_t first, size_t count,
+                        uint8_t *buffer, size_t buffer_size, size_t *offsets) {
+    if (!tx_batch_range_valid(batch, first, count) || !buffer || buffer_size == 0 || !offsets) {
+        return TX_BATCH_ERROR_INVALID;
+    }
+
+    rlp_encoder_t encoder;
+    rlp_encoder_init(&encoder, buffer, buffer_size);
+
+    for (size_t i = 0; i < count; i++) {
+        offsets[i] = encoder.length;
+        int result = tx_batch_encode_row(batch, first + i, &encoder);
+        if (result != TX_BATCH_ERROR_NONE) {
+            return result;
+        }
+    }
+    offsets[count] = encoder.length;
+
+    return TX_BATCH_ERROR_NONE;
+}
+
+int eth_tx_batch_hash(const eth_tx_batch_t *batch, size_t first, size_t count, eth_hash_t *hashes) {
+    if (!tx_batch_range_valid(batch, first, count) || (!hashes && count > 0)) {
+        return TX_BATCH_ERROR_INVALID;
+    }
+
+    /* One scratch buffer sized for the largest row */
+    size_t largest = 0;
+    for (size_t i = first; i < first + count; i++) {
+        size_t size = tx_batch_row_size(batch, i);
+        largest = size > largest ? size : largest;
+    }
+
+    uint8_t stack_buffer[TX_BATCH_STACK_ENCODING];
+    uint8_t *buffer = stack_buffer;
+    if (largest > sizeof(stack_buffer)) {
+        buffer = malloc(largest);
+        if (!buffer) {
+            return TX_BATCH_ERROR_NOMEM;
+        }
+    }
+
+    int result = TX_BATCH_ERROR_NONE;
+    for (size_t i = 0; i < count && result == TX_BATCH_ERROR_NONE; i++) {
+        rlp_encoder_t encoder;
+        rlp_encoder_init(&encoder, buffer, largest ? largest : 1);
+
+        result = tx_batch_encode_row(batch, first + i, &encoder);
+        if (result == TX_BATCH_ERROR_NONE && eth_keccak256(buffer, encoder.length, &hashes[i]) != 0) {
+            result = TX_BATCH_ERROR_INVALID;
+        }
+    }
+
+    if (buffer != stack_buffer) {
+        free(buffer);
+    }
+
+    return result;
+}
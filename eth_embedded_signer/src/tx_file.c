@@ -0,0 +1,331 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/tx_file.h"
+
+/* Error codes */
+#define TX_FILE_ERROR_NONE       0
+#define TX_FILE_ERROR_INVALID   -1
+#define TX_FILE_ERROR_IO        -2
+#define TX_FILE_ERROR_NOMEM     -3
+#define TX_FILE_ERROR_FORMAT    -4
+#define TX_FILE_ERROR_VERSION   -5
+#define TX_FILE_ERROR_RANGE     -6
+#define TX_FILE_ERROR_UNSUPPORTED -7
+
+/* Header field offsets */
+#define HDR_MAGIC          0
+#define HDR_VERSION        4
+#define HDR_HEADER_SIZE    6
+#define HDR_RECORD_SIZE    8
+#define HDR_COUNT         16
+#define HDR_RECORDS       24
+#define HDR_HEAP          32
+#define HDR_HEAP_SIZE     40
+
+/* Record field offsets */
+#define REC_TYPE           0
+#define REC_TO_LEN         1
+#define REC_VALUE_LEN      2
+#define REC_GAS_PRICE_LEN  3
+#define REC_PRIORITY_LEN   4
+#define REC_MAX_FEE_LEN    5
+#define REC_CHAIN_ID       8
+#define REC_NONCE         16
+#define REC_GAS_LIMIT     24
+#define REC_DATA_OFFSET   32
+#define REC_DATA_LEN      40
+#define REC_TO            48
+#define REC_VALUE         72
+#define REC_GAS_PRICE    104
+#define REC_PRIORITY     136
+#define REC_MAX_FEE      168
+
+static const uint8_t tx_file_magic[4] = { 'E', 'T', 'X', 'B' };
+
+/* Little-endian helpers */
+static uint16_t read_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t read_le64(const uint8_t *p) {
+    return (uint64_t)read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+}
+
+static void write_le16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void write_le32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void write_le64(uint8_t *p, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/* Store a quantity as its minimal big-endian bytes plus length */
+static void write_quantity(uint8_t *record, size_t length_offset, size_t offset, const eth_u256_t *value) {
+    uint8_t bytes[32];
+    size_t length = eth_u256_byte_length(value);
+
+    eth_u256_to_bytes(value, bytes);
+    record[length_offset] = (uint8_t)length;
+    memcpy(record + offset, bytes + 32 - length, length);
+}
+
+/* Check that [offset, offset + length) lies inside size without overflowing */
+static int in_bounds(uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+/* Point the reader's sections into data, after checking the header */
+static int tx_file_parse(eth_tx_file_t *reader, const uint8_t *data, size_t size) {
+    reader->records = NULL;
+    reader->heap = NULL;
+    reader->count = 0;
+    reader->heap_size = 0;
+
+    if (size < ETH_TX_FILE_HEADER_SIZE || memcmp(data + HDR_MAGIC, tx_file_magic, 4) != 0) {
+        return TX_FILE_ERROR_FORMAT;
+    }
+    if (read_le16(data + HDR_VERSION) != ETH_TX_FILE_VERSION) {
+        return TX_FILE_ERROR_VERSION;
+    }
+    if (read_le16(data + HDR_HEADER_SIZE) < ETH_TX_FILE_HEADER_SIZE ||
+        read_le16(data + HDR_RECORD_SIZE) != ETH_TX_FILE_RECORD_SIZE) {
+        return TX_FILE_ERROR_FORMAT;
+    }
+
+    uint64_t count = read_le64(data + HDR_COUNT);
+    uint64_t records = read_le64(data + HDR_RECORDS);
+    uint64_t heap = read_le64(data + HDR_HEAP);
+    uint64_t heap_size = read_le64(data + HDR_HEAP_SIZE);
+
+    /* Every section has to lie inside the file */
+    if (count > UINT64_MAX / ETH_TX_FILE_RECORD_SIZE ||
+        !in_bounds(records, count * ETH_TX_FILE_RECORD_SIZE, size) ||
+        !in_bounds(heap, heap_size, size) ||
+        records < ETH_TX_FILE_HEADER_SIZE) {
+        return TX_FILE_ERROR_FORMAT;
+    }
+
+    reader->records = data + records;
+    reader->heap = data + heap;
+    reader->count = count;
+    reader->heap_size = heap_size;
+
+    return TX_FILE_ERROR_NONE;
+}
+
+int eth_tx_file_open_buffer(eth_tx_file_t *reader, const uint8_t *data, size_t size) {
+    if (!reader || (!data && size > 0)) {
+        return TX_FILE_ERROR_INVALID;
+    }
+
+    /* The caller owns the buffer: nothing for eth_tx_file_close to unmap */
+    memset(&reader->map, 0, sizeof(reader->map));
+    return tx_file_parse(reader, data, size);
+}
+
+int eth_tx_file_open(eth_tx_file_t *reader, const char *path) {
+    if (!reader || !path) {
+        return TX_FILE_ERROR_INVALID;
+    }
+
+    /* Records are random access, so no sequential readahead hint */
+    eth_file_map_t map;
+    memset(&reader->map, 0, sizeof(reader->map));
+    if (eth_file_map_open(&map, path, 0) != 0) {
+        return TX_FILE_ERROR_IO;
+    }
+
+    int result = tx_file_parse(reader, map.data, map.size);
+    if (result != TX_FILE_ERROR_NONE) {
+        eth_file_map_close(&map);
+        return result;
+    }
+
+    reader->map = map;
+    return TX_FILE_ERROR_NONE;
+}
+
+int eth_tx_file_get(const eth_tx_file_t *reader, uint64_t index, eth_transaction_t *tx) {
+    if (!reader || !tx) {
+        return TX_FILE_ERROR_INVALID;
+    }
+    if (index >= reader->count) {
+        return TX_FILE_ERROR_RANGE;
+    }
+
+    const uint8_t *record = reader->records + index * ETH_TX_FILE_RECORD_SIZE;
+    uint8_t tx_type = record[REC_TYPE];
+    uint8_t to_len = record[REC_TO_LEN];
+    uint64_t data_offset = read_le64(record + REC_DATA_OFFSET);
+    uint32_t data_len = read_le32(record + REC_DATA_LEN);
+
+    if (tx_type > ETH_EIP1559_TX || (to_len != 0 && to_len != 20) ||
+        record[REC_VALUE_LEN] > 32 || record[REC_GAS_PRICE_LEN] > 32 ||
+        record[REC_PRIORITY_LEN] > 32 || record[REC_MAX_FEE_LEN] > 32 ||
+        !in_bounds(data_offset, data_len, reader->heap_size)) {
+        return TX_FILE_ERROR_FORMAT;
+    }
+
+    eth_tx_init(tx, (eth_tx_type_t)tx_type);
+    tx->chain_id = read_le64(record + REC_CHAIN_ID);
+    tx->nonce = read_le64(record + REC_NONCE);
+    tx->gas_limit = read_le64(record + REC_GAS_LIMIT);
+
+    tx->to_len = to_len;
+    memcpy(tx->to, record + REC_TO, to_len);
+    eth_u256_set_bytes(&tx->value, record + REC_VALUE, record[REC_VALUE_LEN]);
+    eth_u256_set_bytes(&tx->gas_price, record + REC_GAS_PRICE, record[REC_GAS_PRICE_LEN]);
+    eth_u256_set_bytes(&tx->max_priority_fee, record + REC_PRIORITY, record[REC_PRIORITY_LEN]);
+    eth_u256_set_bytes(&tx->max_fee, record + REC_MAX_FEE, record[REC_MAX_FEE_LEN]);
+
+    /* Calldata stays in the mapping */
+    tx->data = data_len ? (uint8_t *)(reader->heap + data_offset) : NULL;
+    tx->data_len = data_len;
+
+    return TX_FILE_ERROR_NONE;
+}
+
+void eth_tx_file_close(eth_tx_file_t *reader) {
+    if (!reader) {
+        return;
+    }
+
+    eth_file_map_close(&reader->map);
+    reader->records = NULL;
+    reader->heap = NULL;
+    reader->count = 0;
+    reader->heap_size = 0;
+}
+
+int eth_tx_file_writer_open(eth_tx_file_writer_t *writer, const char *path) {
+    if (!writer || !path) {
+        return TX_FILE_ERROR_INVALID;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        return TX_FILE_ERROR_IO;
+    }
+
+    /* Placeholder header, rewritten by finish once the counts are known */
+    uint8_t header[ETH_TX_FILE_HEADER_SIZE] = { 0 };
+    if (fwrite(header, 1, sizeof(header), writer->file) != sizeof(header)) {
+        writer->error = 1;
+    }
+
+    return writer->error ? TX_FILE_ERROR_IO : TX_FILE_ERROR_NONE;
+}
+
+int eth_tx_file_writer_add(eth_tx_file_writer_t *writer, const eth_transaction_t *tx) {
+    if (!writer || !writer->file || !tx || (!tx->data && tx->data_len > 0) || tx->data_len > UINT32_MAX) {
+        return TX_FILE_ERROR_INVALID;
+    }
+    if (tx->to_len != 0 && tx->to_len != 20) {
+        return TX_FILE_ERROR_INVALID;
+    }
+
+    /* Version 1 records have no room for an access list */
+    if (tx->access_list_len > 0) {
+        return TX_FILE_ERROR_UNSUPPORTED;
+    }
+
+    /* Grow the heap geometrically */
+    if (tx->data_len > writer->heap_capacity - writer->heap_size) {
+        size_t capacity = writer->heap_capacity ? writer->heap_capacity : 4096;
+        while (capacity - writer->heap_size < tx->data_len) {
+            capacity *= 2;
+        }
+        uint8_t *heap = realloc(writer->heap, capacity);
+        if (!heap) {
+            return TX_FILE_ERROR_NOMEM;
+        }
+        writer->heap = heap;
+        writer->heap_capacity = capacity;
+    }
+
+    uint8_t record[ETH_TX_FILE_RECORD_SIZE];
+    memset(record, 0, sizeof(record));
+
+    record[REC_TYPE] = (uint8_t)tx->tx_type;
+    record[REC_TO_LEN] = tx->to_len;
+    write_le64(record + REC_CHAIN_ID, tx->chain_id);
+    write_le64(record + REC_NONCE, tx->nonce);
+    write_le64(record + REC_GAS_LIMIT, tx->gas_limit);
+    write_le64(record + REC_DATA_OFFSET, writer->heap_size);
+    write_le32(record + REC_DATA_LEN, (uint32_t)tx->data_len);
+    memcpy(record + REC_TO, tx->to, tx->to_len);
+    write_quantity(record, REC_VALUE_LEN, REC_VALUE, &tx->value);
+    write_quantity(record, REC_GAS_PRICE_LEN, REC_GAS_PRICE, &tx->gas_price);
+    write_quantity(record, REC_PRIORITY_LEN, REC_PRIORITY, &tx->max_priority_fee);
+    write_quantity(record, REC_MAX_FEE_LEN, REC_MAX_FEE, &tx->max_fee);
+
+    if (fwrite(record, 1, sizeof(record), writer->file) != sizeof(record)) {
+        writer->error = 1;
+        return TX_FILE_ERROR_IO;
+    }
+
+    if (tx->data_len > 0) {
+        memcpy(writer->heap + writer->heap_size, tx->data, tx->data_len);
+        writer->heap_size += tx->data_len;
+    }
+    writer->count++;
+
+    return TX_FILE_ERROR_NONE;
+}
+
+int eth_tx_file_writer_finish(eth_tx_file_writer_t *writer) {
+    if (!writer || !writer->file) {
+        return TX_FILE_ERROR_INVALID;
+    }
+
+    uint64_t records = ETH_TX_FILE_HEADER_SIZE;
+    uint64_t heap = records + writer->count * ETH_TX_FILE_RECORD_SIZE;
+
+    /* Heap goes right after the last record */
+    if (writer->heap_size > 0 &&
+        fwrite(writer->heap, 1, writer->heap_size, writer->file) != writer->heap_size) {
+        writer->error = 1;
+    }
+
+    uint8_t header[ETH_TX_FILE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header + HDR_MAGIC, tx_file_magic, 4);
+    write_le16(header + HDR_VERSION, ETH_TX_FILE_VERSION);
+    write_le16(header + HDR_HEADER_SIZE, ETH_TX_FILE_HEADER_SIZE);
+    write_le16(header + HDR_RECORD_SIZE, ETH_TX_FILE_RECORD_SIZE);
+    write_le64(header + HDR_COUNT, writer->count);
+    write_le64(header + HDR_RECORDS, records);
+    write_le64(header + HDR_HEAP, heap);
+    write_le64(header + HDR_HEAP_SIZE, writer->heap_size);
+
+    if (fseek(writer->file, 0, SEEK_SET) != 0 ||
+        fwrite(header, 1, sizeof(header), writer->file) != sizeof(header)) {
+        writer->error = 1;
+    }
+    if (fclose(writer->file) != 0) {
+        writer->error = 1;
+    }
+
+    free(writer->heap);
+    writer->file = NULL;
+    writer->heap = NULL;
+    writer->heap_size = 0;
+    writer->heap_capacity = 0;
+
+    return writer->error ? TX_FILE_ERROR_IO : TX_FILE_ERROR_NONE;
+}
@@ -0,0 +1,693 @@
+#include <string.h>
+#include "../include/tx_json.h"
+#include "../include/rlp.h"
+#include "../include/hex.h"
+
+/* Error codes */
+#define TX_JSON_ERROR_NONE      0
+#define TX_JSON_ERROR_INVALID  -1
+#define TX_JSON_ERROR_SYNTAX   -2
+#define TX_JSON_ERROR_FIELD    -3
+#define TX_JSON_ERROR_RANGE    -4
+#define TX_JSON_ERROR_NOMEM    -5
+
+/* Nesting allowed inside skipped (unknown) values */
+#define TX_JSON_MAX_DEPTH      32
+
+/* Known fields, one bit each to catch duplicates */
+#define FIELD_TYPE             (1u << 0)
+#define FIELD_CHAIN_ID         (1u << 1)
+#define FIELD_NONCE            (1u << 2)
+#define FIELD_TO               (1u << 3)
+#define FIELD_VALUE            (1u << 4)
+#define FIELD_GAS              (1u << 5)
+#define FIELD_GAS_PRICE        (1u << 6)
+#define FIELD_MAX_FEE          (1u << 7)
+#define FIELD_PRIORITY_FEE     (1u << 8)
+#define FIELD_DATA             (1u << 9)
+#define FIELD_ACCESS_LIST      (1u << 10)
+#define FIELD_FROM             (1u << 11)
+
+/* Fields each type may not carry */
+#define FIELDS_NOT_LEGACY      (FIELD_MAX_FEE | FIELD_PRIORITY_FEE | FIELD_ACCESS_LIST)
+#define FIELDS_NOT_EIP2930     (FIELD_MAX_FEE | FIELD_PRIORITY_FEE)
+#define FIELDS_NOT_EIP1559     (FIELD_GAS_PRICE)
+
+typedef struct {
+    const char *name;
+    size_t length;
+    unsigned field;
+} json_key_t;
+
+static const json_key_t json_keys[] = {
+    { "type", 4, FIELD_TYPE },
+    { "chainId", 7, FIELD_CHAIN_ID },
+    { "nonce", 5, FIELD_NONCE },
+    { "to", 2, FIELD_TO },
+    { "value", 5, FIELD_VALUE },
+    { "gas", 3, FIELD_GAS },
+    { "gasLimit", 8, FIELD_GAS },
+    { "gasPrice", 8, FIELD_GAS_PRICE },
+    { "maxFeePerGas", 12, FIELD_MAX_FEE },
+    { "maxPriorityFeePerGas", 20, FIELD_PRIORITY_FEE },
+    { "data", 4, FIELD_DATA },
+    { "input", 5, FIELD_DATA },
+    { "accessList", 10, FIELD_ACCESS_LIST },
+    { "from", 4, FIELD_FROM }
+};
+
+/* Parser state for one object */
+typedef struct {
+    const char *pos;        /* Current character */
+    const char *end;        /* End of input */
+    eth_arena_t *arena;     /* Receives calldata and access lists */
+} json_parser_t;
+
+/* Value of a hex digit, -1 if c is not one */
+static int hex_digit_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void json_skip_whitespace(json_parser_t *p) {
+    while (p->pos < p->end && (*p->pos == ' ' || *p->pos == '\n' || *p->pos == '\r' || *p->pos == '\t')) {
+        p->pos++;
+    }
+}
+
+/* Consume c (after whitespace) */
+static int json_expect(json_parser_t *p, char c) {
+    json_skip_whitespace(p);
+    if (p->pos >= p->end || *p->pos != c) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+    p->pos++;
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Consume a literal such as null or true */
+static int json_literal(json_parser_t *p, const char *literal, size_t length) {
+    if ((size_t)(p->end - p->pos) < length || memcmp(p->pos, literal, length) != 0) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+    p->pos += length;
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Check for null (after whitespace) and consume it */
+static int json_is_null(json_parser_t *p) {
+    json_skip_whitespace(p);
+    return p->pos < p->end && *p->pos == 'n' && json_literal(p, "null", 4) == TX_JSON_ERROR_NONE;
+}
+
+/* Read a string, returning its raw contents (escapes are validated, not decoded) */
+static int json_string(json_parser_t *p, const char **str, size_t *length, int *escaped) {
+    json_skip_whitespace(p);
+    if (p->pos >= p->end || *p->pos != '"') {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+
+    const char *start = ++p->pos;
+    *escaped = 0;
+
+    while (p->pos < p->end) {
+        unsigned char c = (unsigned char)*p->pos;
+
+        if (c == '"') {
+            *str = start;
+            *length = (size_t)(p->pos - start);
+            p->pos++;
+            return TX_JSON_ERROR_NONE;
+        }
+        if (c < 0x20) {
+            return TX_JSON_ERROR_SYNTAX;
+        }
+        if (c == '\\') {
+            *escaped = 1;
+            if (++p->pos >= p->end) {
+                break;
+            }
+            if (*p->pos == 'u') {
+                if (p->end - p->pos < 5) {
+                    break;
+                }
+                for (int i = 1; i <= 4; i++) {
+                    if (hex_digit_value(p->pos[i]) < 0) {
+                        return TX_JSON_ERROR_SYNTAX;
+                    }
+                }
+                p->pos += 5;
+                continue;
+            }
+            if (!strchr("\"\\/bfnrt", *p->pos)) {
+                return TX_JSON_ERROR_SYNTAX;
+            }
+        }
+        p->pos++;
+    }
+
+    /* Unterminated */
+    return TX_JSON_ERROR_SYNTAX;
+}
+
+/* Skip a number without interpreting it */
+static int json_skip_number(json_parser_t *p) {
+    const char *start = p->pos;
+
+    if (p->pos < p->end && *p->pos == '-') p->pos++;
+    const char *digits = p->pos;
+    while (p->pos < p->end && *p->pos >= '0' && *p->pos <= '9') p->pos++;
+    if (p->pos == digits) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+    if (p->pos < p->end && *p->pos == '.') {
+        p->pos++;
+        digits = p->pos;
+        while (p->pos < p->end && *p->pos >= '0' && *p->pos <= '9') p->pos++;
+        if (p->pos == digits) {
+            return TX_JSON_ERROR_SYNTAX;
+        }
+    }
+    if (p->pos < p->end && (*p->pos == 'e' || *p->pos == 'E')) {
+        p->pos++;
+        if (p->pos < p->end && (*p->pos == '+' || *p->pos == '-')) p->pos++;
+        digits = p->pos;
+        while (p->pos < p->end && *p->pos >= '0' && *p->pos <= '9') p->pos++;
+        if (p->pos == digits) {
+            return TX_JSON_ERROR_SYNTAX;
+        }
+    }
+
+    return p->pos > start ? TX_JSON_ERROR_NONE : TX_JSON_ERROR_SYNTAX;
+}
+
+/* Skip any value (for keys we do not use) */
+static int json_skip_value(json_parser_t *p, int depth) {
+    const char *str;
+    size_t length;
+    int escaped;
+    int result;
+
+    if (depth > TX_JSON_MAX_DEPTH) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+
+    json_skip_whitespace(p);
+    if (p->pos >= p->end) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+
+    switch (*p->pos) {
+    case '"':
+        return json_string(p, &str, &length, &escaped);
+    case 't':
+        return json_literal(p, "true", 4);
+    case 'f':
+        return json_literal(p, "false", 5);
+    case 'n':
+        return json_literal(p, "null", 4);
+    case '[':
+        p->pos++;
+        json_skip_whitespace(p);
+        if (p->pos < p->end && *p->pos == ']') {
+            p->pos++;
+            return TX_JSON_ERROR_NONE;
+        }
+        for (;;) {
+            result = json_skip_value(p, depth + 1);
+            if (result != TX_JSON_ERROR_NONE) return result;
+            json_skip_whitespace(p);
+            if (p->pos < p->end && *p->pos == ',') { p->pos++; continue; }
+            return json_expect(p, ']');
+        }
+    case '{':
+        p->pos++;
+        json_skip_whitespace(p);
+        if (p->pos < p->end && *p->pos == '}') {
+            p->pos++;
+            return TX_JSON_ERROR_NONE;
+        }
+        for (;;) {
+            result = json_string(p, &str, &length, &escaped);
+            if (result != TX_JSON_ERROR_NONE) return result;
+            result = json_expect(p, ':');
+            if (result != TX_JSON_ERROR_NONE) return result;
+            result = json_skip_value(p, depth + 1);
+            if (result != TX_JSON_ERROR_NONE) return result;
+            json_skip_whitespace(p);
+            if (p->pos < p->end && *p->pos == ',') { p->pos++; continue; }
+            return json_expect(p, '}');
+        }
+    default:
+        return json_skip_number(p);
+    }
+}
+
+/* Read a 0x-prefixed hex string, returning the digits after the prefix */
+static int json_hex_string(json_parser_t *p, const char **digits, size_t *count) {
+    const char *str;
+    size_t length;
+    int escaped;
+
+    int result = json_string(p, &str, &length, &escaped);
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+    if (escaped || length < 2 || str[0] != '0' || (str[1] != 'x' && str[1] != 'X')) {
+        return TX_JSON_ERROR_FIELD;
+    }
+
+    *digits = str + 2;
+    *count = length - 2;
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Read a quantity: a 0x-prefixed hex string or a plain JSON integer */
+static int json_quantity(json_parser_t *p, eth_u256_t *value) {
+    json_skip_whitespace(p);
+    if (p->pos >= p->end) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+
+    if (*p->pos == '"') {
+        const char *digits;
+        size_t count;
+        int result = json_hex_string(p, &digits, &count);
+        if (result != TX_JSON_ERROR_NONE) {
+            return result;
+        }
+        return eth_u256_set_hex(value, digits, count) == 0 ? TX_JSON_ERROR_NONE : TX_JSON_ERROR_FIELD;
+    }
+
+    if (*p->pos >= '0' && *p->pos <= '9') {
+        const char *start = p->pos;
+        while (p->pos < p->end && *p->pos >= '0' && *p->pos <= '9') {
+            p->pos++;
+        }
+        size_t count = (size_t)(p->pos - start);
+
+        /* Integers only, without the leading zeros JSON does not allow */
+        if ((count > 1 && *start == '0') ||
+            (p->pos < p->end && (*p->pos == '.' || *p->pos == 'e' || *p->pos == 'E'))) {
+            return TX_JSON_ERROR_FIELD;
+        }
+        return eth_u256_set_dec(value, start, count) == 0 ? TX_JSON_ERROR_NONE : TX_JSON_ERROR_FIELD;
+    }
+
+    return TX_JSON_ERROR_FIELD;
+}
+
+/* Read a quantity that has to fit in 64 bits */
+static int json_u64(json_parser_t *p, uint64_t *value) {
+    eth_u256_t quantity;
+
+    int result = json_quantity(p, &quantity);
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+    if (quantity.limb[1] | quantity.limb[2] | quantity.limb[3]) {
+        return TX_JSON_ERROR_RANGE;
+    }
+
+    *value = quantity.limb[0];
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Read hex data of an exact size (addresses, storage keys) */
+static int json_fixed_hex(json_parser_t *p, uint8_t *output, size_t size) {
+    const char *digits;
+    size_t count;
+    size_t decoded;
+
+    int result = json_hex_string(p, &digits, &count);
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+    if (count != size * 2 || eth_hex_decode(digits, count, output, size, &decoded) != 0) {
+        return TX_JSON_ERROR_FIELD;
+    }
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Read calldata into the arena */
+static int json_data(json_parser_t *p, eth_transaction_t *tx) {
+    const char *digits;
+    size_t count;
+
+    tx->data = NULL;
+    tx->data_len = 0;
+    if (json_is_null(p)) {
+        return TX_JSON_ERROR_NONE;
+    }
+
+    int result = json_hex_string(p, &digits, &count);
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+    if (count & 1) {
+        return TX_JSON_ERROR_FIELD;
+    }
+    if (count == 0) {
+        return TX_JSON_ERROR_NONE;
+    }
+
+    uint8_t *data = eth_arena_alloc(p->arena, count / 2, 1);
+    if (!data) {
+        return TX_JSON_ERROR_NOMEM;
+    }
+    if (eth_hex_decode(digits, count, data, count / 2, &tx->data_len) != 0) {
+        return TX_JSON_ERROR_FIELD;
+    }
+    tx->data = data;
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Read one {"address", "storageKeys"} entry as an RLP list [address, [keys...]] */
+static int json_access_entry(json_parser_t *p, rlp_encoder_t *encoder) {
+    static const uint8_t zero_address[20] = { 0 };
+    size_t entry_marker, keys_marker;
+    int have_address = 0, have_keys = 0;
+    const char *key;
+    size_t key_len;
+    int escaped;
+    int result;
+
+    result = json_expect(p, '{');
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+
+    /*
+     * The address has to come first in the encoding but may come last in the
+     * object: encode a placeholder and fill it in when the key shows up.
+     */
+    if (rlp_begin_list(encoder, &entry_marker) != 0 ||
+        rlp_encode_bytes(encoder, zero_address, sizeof(zero_address)) != 0) {
+        return TX_JSON_ERROR_NOMEM;
+    }
+    size_t address_offset = encoder->length - sizeof(zero_address);
+    if (rlp_begin_list(encoder, &keys_marker) != 0) {
+        return TX_JSON_ERROR_NOMEM;
+    }
+
+    json_skip_whitespace(p);
+    if (p->pos < p->end && *p->pos == '}') {
+        return TX_JSON_ERROR_FIELD;
+    }
+
+    for (;;) {
+        result = json_string(p, &key, &key_len, &escaped);
+        if (result != TX_JSON_ERROR_NONE) return result;
+        result = json_expect(p, ':');
+        if (result != TX_JSON_ERROR_NONE) return result;
+
+        if (!escaped && key_len == 7 && memcmp(key, "address", 7) == 0) {
+            if (have_address) {
+                return TX_JSON_ERROR_FIELD;
+            }
+            result = json_fixed_hex(p, encoder->buffer + address_offset, 20);
+            have_address = 1;
+        } else if (!escaped && key_len == 11 && memcmp(key, "storageKeys", 11) == 0) {
+            if (have_keys) {
+                return TX_JSON_ERROR_FIELD;
+            }
+            have_keys = 1;
+
+            result = json_expect(p, '[');
+            if (result != TX_JSON_ERROR_NONE) return result;
+            json_skip_whitespace(p);
+            if (p->pos < p->end && *p->pos == ']') {
+                p->pos++;
+            } else {
+                for (;;) {
+                    uint8_t storage_key[32];
+                    result = json_fixed_hex(p, storage_key, sizeof(storage_key));
+                    if (result != TX_JSON_ERROR_NONE) return result;
+                    if (rlp_encode_bytes(encoder, storage_key, sizeof(storage_key)) != 0) {
+                        return TX_JSON_ERROR_NOMEM;
+                    }
+                    json_skip_whitespace(p);
+                    if (p->pos < p->end && *p->pos == ',') { p->pos++; continue; }
+                    result = json_expect(p, ']');
+                    break;
+                }
+            }
+        } else {
+            result = json_skip_value(p, 1);
+        }
+        if (result != TX_JSON_ERROR_NONE) return result;
+
+        json_skip_whitespace(p);
+        if (p->pos < p->end && *p->pos == ',') { p->pos++; continue; }
+        result = json_expect(p, '}');
+        if (result != TX_JSON_ERROR_NONE) return result;
+        break;
+    }
+
+    if (!have_address) {
+        return TX_JSON_ERROR_FIELD;
+    }
+    if (rlp_end_list(encoder, keys_marker) != 0 || rlp_end_list(encoder, entry_marker) != 0) {
+        return TX_JSON_ERROR_NOMEM;
+    }
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Read the access list, RLP-encoded straight into the arena */
+static int json_access_list(json_parser_t *p, eth_transaction_t *tx) {
+    tx->access_list = NULL;
+    tx->access_list_len = 0;
+    if (json_is_null(p)) {
+        return TX_JSON_ERROR_NONE;
+    }
+
+    int result = json_expect(p, '[');
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+    json_skip_whitespace(p);
+    if (p->pos < p->end && *p->pos == ']') {
+        p->pos++;
+        return TX_JSON_ERROR_NONE;
+    }
+
+    /* Encode at the top of the arena and claim what was used afterwards */
+    size_t available;
+    uint8_t *top = eth_arena_top(p->arena, &available);
+    rlp_encoder_t encoder;
+    if (!top || rlp_encoder_init(&encoder, top, available) != 0) {
+        return TX_JSON_ERROR_NOMEM;
+    }
+
+    for (;;) {
+        result = json_access_entry(p, &encoder);
+        if (result != TX_JSON_ERROR_NONE) return result;
+        json_skip_whitespace(p);
+        if (p->pos < p->end && *p->pos == ',') { p->pos++; continue; }
+        result = json_expect(p, ']');
+        if (result != TX_JSON_ERROR_NONE) return result;
+        break;
+    }
+
+    eth_arena_advance(p->arena, encoder.length);
+    tx->access_list = top;
+    tx->access_list_len = encoder.length;
+    return TX_JSON_ERROR_NONE;
+}
+
+/* Map a key to its field bit, 0 if unknown */
+static unsigned json_lookup_key(const char *key, size_t length) {
+    for (size_t i = 0; i < sizeof(json_keys) / sizeof(json_keys[0]); i++) {
+        if (json_keys[i].length == length && memcmp(json_keys[i].name, key, length) == 0) {
+            return json_keys[i].field;
+        }
+    }
+    return 0;
+}
+
+/* Read one field value into the transaction */
+static int json_field(json_parser_t *p, unsigned field, eth_transaction_t *tx, uint64_t *type) {
+    uint8_t from[20];
+
+    switch (field) {
+    case FIELD_TYPE:
+        return json_u64(p, type);
+    case FIELD_CHAIN_ID:
+        return json_u64(p, &tx->chain_id);
+    case FIELD_NONCE:
+        return json_u64(p, &tx->nonce);
+    case FIELD_GAS:
+        return json_u64(p, &tx->gas_limit);
+    case FIELD_VALUE:
+        return json_quantity(p, &tx->value);
+    case FIELD_GAS_PRICE:
+        return json_quantity(p, &tx->gas_price);
+    case FIELD_MAX_FEE:
+        return json_quantity(p, &tx->max_fee);
+    case FIELD_PRIORITY_FEE:
+        return json_quantity(p, &tx->max_priority_fee);
+    case FIELD_TO:
+        /* null means contract creation */
+        if (json_is_null(p)) {
+            tx->to_len = 0;
+            return TX_JSON_ERROR_NONE;
+        }
+        tx->to_len = 20;
+        return json_fixed_hex(p, tx->to, sizeof(tx->to));
+    case FIELD_DATA:
+        return json_data(p, tx);
+    case FIELD_ACCESS_LIST:
+        return json_access_list(p, tx);
+    case FIELD_FROM:
+        return json_fixed_hex(p, from, sizeof(from));
+    default:
+        return json_skip_value(p, 1);
+    }
+}
+
+/* Read one transaction object */
+static int json_transaction(json_parser_t *p, eth_transaction_t *tx) {
+    unsigned seen = 0;
+    uint64_t type = 0;
+    const char *key;
+    size_t key_len;
+    int escaped;
+    int result;
+
+    eth_tx_init(tx, ETH_LEGACY_TX);
+
+    result = json_expect(p, '{');
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+
+    json_skip_whitespace(p);
+    if (p->pos < p->end && *p->pos == '}') {
+        p->pos++;
+    } else {
+        for (;;) {
+            result = json_string(p, &key, &key_len, &escaped);
+            if (result != TX_JSON_ERROR_NONE) return result;
+            result = json_expect(p, ':');
+            if (result != TX_JSON_ERROR_NONE) return result;
+
+            unsigned field = escaped ? 0 : json_lookup_key(key, key_len);
+            if (field & seen) {
+                return TX_JSON_ERROR_FIELD;
+            }
+            seen |= field;
+
+            result = json_field(p, field, tx, &type);
+            if (result != TX_JSON_ERROR_NONE) return result;
+
+            json_skip_whitespace(p);
+            if (p->pos < p->end && *p->pos == ',') { p->pos++; continue; }
+            result = json_expect(p, '}');
+            if (result != TX_JSON_ERROR_NONE) return result;
+            break;
+        }
+    }
+
+    /* Infer the type from the fields when it is not given */
+    if (!(seen & FIELD_TYPE)) {
+        if (seen & (FIELD_MAX_FEE | FIELD_PRIORITY_FEE)) {
+            type = ETH_EIP1559_TX;
+        } else if (seen & FIELD_ACCESS_LIST) {
+            type = ETH_EIP2930_TX;
+        } else {
+            type = ETH_LEGACY_TX;
+        }
+    }
+
+    unsigned not_allowed;
+    switch (type) {
+    case ETH_LEGACY_TX:  not_allowed = FIELDS_NOT_LEGACY;  break;
+    case ETH_EIP2930_TX: not_allowed = FIELDS_NOT_EIP2930; break;
+    case ETH_EIP1559_TX: not_allowed = FIELDS_NOT_EIP1559; break;
+    default:
+        return TX_JSON_ERROR_FIELD;
+    }
+    /* An explicitly empty access list is fine on a legacy transaction */
+    if (type == ETH_LEGACY_TX && tx->access_list_len == 0) {
+        not_allowed &= ~FIELD_ACCESS_LIST;
+    }
+    if (seen & not_allowed) {
+        return TX_JSON_ERROR_FIELD;
+    }
+
+    tx->tx_type = (eth_tx_type_t)type;
+    return TX_JSON_ERROR_NONE;
+}
+
+int eth_tx_json_reader_init(eth_tx_json_reader_t *reader, const char *input, size_t size, eth_arena_t *arena) {
+    if (!reader || (!input && size > 0) || !arena) {
+        return TX_JSON_ERROR_INVALID;
+    }
+
+    reader->input = input;
+    reader->size = size;
+    reader->offset = 0;
+    reader->arena = arena;
+    reader->error_offset = 0;
+
+    return TX_JSON_ERROR_NONE;
+}
+
+int eth_tx_json_next(eth_tx_json_reader_t *reader, eth_transaction_t *tx) {
+    if (!reader || !tx) {
+        return TX_JSON_ERROR_INVALID;
+    }
+
+    json_parser_t parser;
+    parser.pos = reader->input + reader->offset;
+    parser.end = reader->input + reader->size;
+    parser.arena = reader->arena;
+
+    json_skip_whitespace(&parser);
+    if (parser.pos >= parser.end) {
+        reader->offset = reader->size;
+        return ETH_TX_JSON_END;
+    }
+
+    size_t arena_used = reader->arena->used;
+    int result = json_transaction(&parser, tx);
+
+    if (result != TX_JSON_ERROR_NONE) {
+        /* Drop what the failed object put in the arena and resume at the next line */
+        reader->arena->used = arena_used;
+        reader->error_offset = (size_t)(parser.pos - reader->input);
+
+        const char *newline = memchr(parser.pos, '\n', (size_t)(parser.end - parser.pos));
+        parser.pos = newline ? newline + 1 : parser.end;
+    }
+
+    reader->offset = (size_t)(parser.pos - reader->input);
+    return result;
+}
+
+int eth_tx_json_parse(const char *json, size_t length, eth_transaction_t *tx, eth_arena_t *arena) {
+    eth_tx_json_reader_t reader;
+
+    int result = eth_tx_json_reader_init(&reader, json, length, arena);
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+
+    result = eth_tx_json_next(&reader, tx);
+    if (result == ETH_TX_JSON_END) {
+        return TX_JSON_ERROR_SYNTAX;
+    }
+    if (result != TX_JSON_ERROR_NONE) {
+        return result;
+    }
+
+    /* Nothing but whitespace may follow the object */
+    for (size_t i = reader.offset; i < length; i++) {
+        if (json[i] != ' ' && json[i] != '\n' && json[i] != '\r' && json[i] != '\t') {
+            return TX_JSON_ERROR_SYNTAX;
+        }
+    }
+    return TX_JSON_ERROR_NONE;
+}
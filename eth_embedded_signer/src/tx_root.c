@@ -0,0 +1,559 @@
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../include/tx_root.h"
+#include "../include/rlp.h"
+#include "../include/keccak.h"
+
+/* Error codes */
+#define TX_ROOT_ERROR_NONE       0
+#define TX_ROOT_ERROR_INVALID   -1
+#define TX_ROOT_ERROR_NO_SPACE  -2
+#define TX_ROOT_ERROR_ENCODING  -3
+
+/* Longest key: RLP of a 64-bit index */
+#define TX_ROOT_KEY_MAX 9
+
+/* Nodes on the longest path: at most one per key nibble, then the leaf */
+#define TX_ROOT_MAX_LEVELS (2 * TX_ROOT_KEY_MAX + 1)
+
+/* Largest node built in a buffer: a branch of 16 hash references and an empty value */
+#define TX_ROOT_NODE_MAX (3 + 16 * 33 + 1)
+
+/* Fewest transactions per thread worth starting a thread for */
+#define TX_ROOT_PARALLEL_MIN 256
+
+/* Subtrees per thread, so that threads finishing early pick up more */
+#define TX_ROOT_TASKS_PER_THREAD 8
+
+/* Reference to a node from its parent */
+typedef struct {
+    uint8_t data[32];   /* Hash, or the node itself when its encoding is shorter than 32 bytes */
+    uint8_t length;     /* Length of data (0 for an empty branch slot) */
+    uint8_t hashed;     /* Set when data is a hash */
+} tx_root_ref_t;
+
+/* Scratch one thread needs: per level a branch's child references and node buffer */
+#define TX_ROOT_SCRATCH_SIZE (TX_ROOT_MAX_LEVELS * (16 * sizeof(tx_root_ref_t) + TX_ROOT_NODE_MAX))
+
+/* Subtree hashed by one worker */
+typedef struct {
+    size_t lo;          /* First key position */
+    size_t hi;          /* One past the last key position */
+    unsigned depth;     /* Key nibbles above the subtree */
+    tx_root_ref_t ref;  /* Reference to the subtree root */
+} tx_root_task_t;
+
+typedef enum {
+    TX_ROOT_HASH,       /* Hash every node */
+    TX_ROOT_PLAN,       /* Walk the top of the trie, record subtrees of at most 'cutoff' keys as tasks */
+    TX_ROOT_JOIN        /* Hash the top of the trie, taking the subtrees from the tasks */
+} tx_root_mode_t;
+
+typedef struct {
+    const uint8_t *const *raw_txs;  /* Values, by transaction index */
+    const size_t *lengths;          /* Value lengths */
+    size_t count;                   /* Number of transactions */
+    tx_root_mode_t mode;            /* Only changed while no worker runs */
+    size_t cutoff;                  /* Largest subtree run as one task */
+    tx_root_task_t *tasks;          /* Tasks in walk order (NULL while counting) */
+    size_t task_count;              /* Tasks recorded */
+    size_t task_cursor;             /* Next task used by the join */
+    atomic_size_t next_task;        /* Next task taken by a worker */
+    atomic_int error;               /* First error seen by a worker */
+} tx_root_ctx_t;
+
+typedef struct {
+    tx_root_ctx_t *ctx;
+    eth_arena_t scratch;            /* Node buffers of this thread */
+    pthread_t thread;
+} tx_root_worker_t;
+
+/*
+ * Keys are RLP(index). Compared bytewise they sort as 1..127 (single byte),
+ * 0 (0x80), then 128, 129, ... (0x81 xx, 0x82 xx xx, ...), so the key at
+ * each position is known without sorting.
+ */
+static size_t tx_root_index(size_t count, size_t position) {
+    size_t single_byte = count > 128 ? 127 : count - 1;
+
+    if (position < single_byte) {
+        return position + 1;
+    }
+    if (position == single_byte) {
+        return 0;
+    }
+    return position;
+}
+
+/* RLP of an index as rlp_encode_uint writes it, without going through an encoder */
+static unsigned tx_root_key(size_t index, uint8_t key[TX_ROOT_KEY_MAX]) {
+    if (index == 0) {
+        key[0] = 0x80;
+        return 1;
+    }
+    if (index < 0x80) {
+        key[0] = (uint8_t)index;
+        return 1;
+    }
+
+    unsigned length = 0;
+    for (size_t value = index; value != 0; value >>= 8) {
+        length++;
+    }
+    key[0] = (uint8_t)(0x80 + length);
+    for (unsigned i = 0; i < length; i++) {
+        key[length - i] = (uint8_t)(index >> (8 * i));
+    }
+    return length + 1;
+}
+
+static unsigned tx_root_key_nibble(const uint8_t *key, unsigned depth) {
+    return (depth & 1) ? key[depth >> 1] & 0x0f : key[depth >> 1] >> 4;
+}
+
+static unsigned tx_root_nibble(size_t count, size_t position, unsigned depth) {
+    uint8_t key[TX_ROOT_KEY_MAX];
+
+    tx_root_key(tx_root_index(count, position), key);
+    return tx_root_key_nibble(key, depth);
+}
+
+/* First position in [lo, hi) whose nibble at 'depth' is above 'nibble' (nibbles ascend over the run) */
+static size_t tx_root_split(size_t count, size_t lo, size_t hi, unsigned depth, unsigned nibble) {
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tx_root_nibble(count, mid, depth) <= nibble) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Nibbles from 'depth' on shared by every key of a run (those of its first and last key) */
+static unsigned tx_root_common(size_t count, size_t first, size_t last, unsigned depth) {
+    uint8_t a[TX_ROOT_KEY_MAX], b[TX_ROOT_KEY_MAX];
+    unsigned a_nibbles = 2 * tx_root_key(tx_root_index(count, first), a);
+    unsigned b_nibbles = 2 * tx_root_key(tx_root_index(count, last), b);
+    unsigned limit = a_nibbles < b_nibbles ? a_nibbles : b_nibbles;
+    unsigned n = depth;
+
+    while (n < limit && tx_root_key_nibble(a, n) == tx_root_key_nibble(b, n)) {
+        n++;
+    }
+    return n - depth;
+}
+
+/* Hex-prefix encoding of key nibbles [from, to) */
+static size_t tx_root_path(const uint8_t *key, unsigned from, unsigned to, int leaf,
+                           uint8_t path[TX_ROOT_KEY_MAX + 1]) {
+    unsigned flag = leaf ? 2 : 0;
+    size_t length = 1;
+
+    if ((to - from) & 1) {
+        path[0] = (uint8_t)(((flag | 1) << 4) | tx_root_key_nibble(key, from));
+        from++;
+    } else {
+        path[0] = (uint8_t)(flag << 4);
+    }
+    for (; from < to; from += 2) {
+        path[length++] = (uint8_t)((tx_root_key_nibble(key, from) << 4) | tx_root_key_nibble(key, from + 1));
+    }
+    return length;
+}
+
+static size_t tx_root_ref_length(const tx_root_ref_t *ref) {
+    if (ref->hashed) {
+        return 33;
+    }
+    return ref->length != 0 ? ref->length : 1;
+}
+
+static int tx_root_encode_ref(rlp_encoder_t *encoder, const tx_root_ref_t *ref) {
+    if (ref->hashed || ref->length == 0) {
+        /* 32-byte hash as a string, or the empty string for a missing child */
+        return rlp_encode_bytes(encoder, ref->data, ref->length);
+    }
+    /* Short nodes are embedded in the parent as they are */
+    return rlp_encode_raw(encoder, ref->data, ref->length);
+}
+
+static void tx_root_finish(const uint8_t *node, size_t length, tx_root_ref_t *ref) {
+    if (length < 32) {
+        memcpy(ref->data, node, length);
+        ref->length = (uint8_t)length;
+        ref->hashed = 0;
+        return;
+    }
+
+    eth_keccak_ctx_t keccak;
+    eth_keccak256_init(&keccak);
+    eth_keccak256_update(&keccak, node, length);
+    eth_keccak256_final(&keccak, ref->data);
+    ref->length = 32;
+    ref->hashed = 1;
+}
+
+/* Header of an RLP string of 'length' bytes (length above one byte) */
+static size_t tx_root_string_header(size_t length, uint8_t *out) {
+    if (length < 56) {
+        out[0] = (uint8_t)(0x80 + length);
+        return 1;
+    }
+
+    size_t length_bytes = 0;
+    for (size_t value = length; value != 0; value >>= 8) {
+        length_bytes++;
+    }
+    out[0] = (uint8_t)(0xb7 + length_bytes);
+    for (size_t i = 0; i < length_bytes; i++) {
+        out[length_bytes - i] = (uint8_t)(length >> (8 * i));
+    }
+    return length_bytes + 1;
+}
+
+/*
+ * Leaf [path, raw tx]. Only the head of the node is built; the transaction
+ * itself is hashed where it lies instead of being copied into a buffer.
+ */
+static int tx_root_leaf(tx_root_ctx_t *ctx, size_t position, unsigned depth, tx_root_ref_t *ref) {
+    size_t index = tx_root_index(ctx->count, position);
+    const uint8_t *value = ctx->raw_txs[index];
+    size_t value_length = ctx->lengths[index];
+
+    if (!value && value_length != 0) {
+        return TX_ROOT_ERROR_INVALID;
+    }
+
+    uint8_t key[TX_ROOT_KEY_MAX];
+    uint8_t path[TX_ROOT_KEY_MAX + 1];
+    unsigned key_nibbles = 2 * tx_root_key(index, key);
+    size_t path_length = tx_root_path(key, depth, key_nibbles, 1, path);
+    size_t payload = rlp_bytes_length(path, path_length) + rlp_bytes_length(value, value_length);
+    size_t total = rlp_list_header_length(payload) + payload;
+
+    /* List header, path and value header: at most 9 + 11 + 9 bytes */
+    uint8_t head[32];
+    rlp_encoder_t encoder;
+    if (rlp_encoder_init(&encoder, head, sizeof(head)) != 0 ||
+        rlp_encode_list_header(&encoder, payload) != 0 ||
+        rlp_encode_bytes(&encoder, path, path_length) != 0) {
+        return TX_ROOT_ERROR_ENCODING;
+    }
+
+    if (total < 32) {
+        /* Short enough to be embedded in the parent */
+        if (rlp_encode_bytes(&encoder, value, value_length) != 0) {
+            return TX_ROOT_ERROR_ENCODING;
+        }
+        tx_root_finish(head, rlp_get_length(&encoder), ref);
+        return TX_ROOT_ERROR_NONE;
+    }
+
+    size_t head_length = rlp_get_length(&encoder);
+    head_length += tx_root_string_header(value_length, head + head_length);
+
+    eth_keccak_ctx_t keccak;
+    eth_keccak256_init(&keccak);
+    eth_keccak256_update(&keccak, head, head_length);
+    eth_keccak256_update(&keccak, value, value_length);
+    eth_keccak256_final(&keccak, ref->data);
+    ref->length = 32;
+    ref->hashed = 1;
+
+    return TX_ROOT_ERROR_NONE;
+}
+
+static int tx_root_node(tx_root_ctx_t *ctx, eth_arena_t *scratch, size_t lo, size_t hi,
+                        unsigned depth, tx_root_ref_t *ref);
+
+/* Branch over a run whose keys differ at 'depth'; the value slot is always empty */
+static int tx_root_branch(tx_root_ctx_t *ctx, eth_arena_t *scratch, size_t lo, size_t hi,
+                          unsigned depth, tx_root_ref_t *ref) {
+    tx_root_ref_t planned;
+    tx_root_ref_t *children = NULL;
+    size_t mark = 0;
+    int result = TX_ROOT_ERROR_NONE;
+
+    if (ctx->mode != TX_ROOT_PLAN) {
+        mark = scratch->used;
+        children = eth_arena_alloc(scratch, 16 * sizeof(tx_root_ref_t), 1);
+        if (!children) {
+            return TX_ROOT_ERROR_NO_SPACE;
+        }
+    }
+
+    size_t start = lo;
+    for (unsigned nibble = 0; nibble < 16; nibble++) {
+        size_t end = start < hi ? tx_root_split(ctx->count, start, hi, depth, nibble) : hi;
+        tx_root_ref_t *child = children ? &children[nibble] : &planned;
+
+        if (end > start) {
+            result = tx_root_node(ctx, scratch, start, end, depth + 1, child);
+            if (result != TX_ROOT_ERROR_NONE) {
+                break;
+            }
+        } else {
+            child->length = 0;
+            child->hashed = 0;
+        }
+        start = end;
+    }
+
+    if (result != TX_ROOT_ERROR_NONE || !children) {
+        if (children) {
+            scratch->used = mark;
+        }
+        return result;
+    }
+
+    size_t payload = 1;
+    for (unsigned nibble = 0; nibble < 16; nibble++) {
+        payload += tx_root_ref_length(&children[nibble]);
+    }
+
+    uint8_t *node = eth_arena_alloc(scratch, TX_ROOT_NODE_MAX, 1);
+    rlp_encoder_t encoder;
+    if (!node) {
+        result = TX_ROOT_ERROR_NO_SPACE;
+    } else if (rlp_encoder_init(&encoder, node, TX_ROOT_NODE_MAX) != 0 ||
+               rlp_encode_list_header(&encoder, payload) != 0) {
+        result = TX_ROOT_ERROR_ENCODING;
+    } else {
+        for (unsigned nibble = 0; nibble < 16 && result == TX_ROOT_ERROR_NONE; nibble++) {
+            if (tx_root_encode_ref(&encoder, &children[nibble]) != 0) {
+                result = TX_ROOT_ERROR_ENCODING;
+            }
+        }
+        if (result == TX_ROOT_ERROR_NONE && rlp_encode_bytes(&encoder, node, 0) != 0) {
+            result = TX_ROOT_ERROR_ENCODING;
+        }
+        if (result == TX_ROOT_ERROR_NONE) {
+            tx_root_finish(node, rlp_get_length(&encoder), ref);
+        }
+    }
+
+    scratch->used = mark;
+    return result;
+}
+
+/* Extension [path, child] over the nibbles every key of the run shares, above a branch */
+static int tx_root_extension(tx_root_ctx_t *ctx, eth_arena_t *scratch, size_t lo, size_t hi,
+                             unsigned depth, unsigned shared, tx_root_ref_t *ref) {
+    tx_root_ref_t child;
+    int result = tx_root_branch(ctx, scratch, lo, hi, depth + shared, &child);
+    if (result != TX_ROOT_ERROR_NONE || ctx->mode == TX_ROOT_PLAN) {
+        return result;
+    }
+
+    uint8_t key[TX_ROOT_KEY_MAX];
+    uint8_t path[TX_ROOT_KEY_MAX + 1];
+    tx_root_key(tx_root_index(ctx->count, lo), key);
+    size_t path_length = tx_root_path(key, depth, depth + shared, 0, path);
+    size_t payload = rlp_bytes_length(path, path_length) + tx_root_ref_length(&child);
+
+    size_t mark = scratch->used;
+    size_t node_size = 3 + (TX_ROOT_KEY_MAX + 2) + 33;
+    uint8_t *node = eth_arena_alloc(scratch, node_size, 1);
+    rlp_encoder_t encoder;
+    if (!node) {
+        return TX_ROOT_ERROR_NO_SPACE;
+    }
+    if (rlp_encoder_init(&encoder, node, node_size) != 0 ||
+        rlp_encode_list_header(&encoder, payload) != 0 ||
+        rlp_encode_bytes(&encoder, path, path_length) != 0 ||
+        tx_root_encode_ref(&encoder, &child) != 0) {
+        result = TX_ROOT_ERROR_ENCODING;
+    } else {
+        tx_root_finish(node, rlp_get_length(&encoder), ref);
+    }
+
+    scratch->used = mark;
+    return result;
+}
+
+/* Root of the subtree over key positions [lo, hi), whose keys share 'depth' nibbles */
+static int tx_root_node(tx_root_ctx_t *ctx, eth_arena_t *scratch, size_t lo, size_t hi,
+                        unsigned depth, tx_root_ref_t *ref) {
+    if (ctx->mode != TX_ROOT_HASH && hi - lo <= ctx->cutoff) {
+        if (ctx->mode == TX_ROOT_PLAN) {
+            if (ctx->tasks) {
+                tx_root_task_t *task = &ctx->tasks[ctx->task_count];
+                task->lo = lo;
+                task->hi = hi;
+                task->depth = depth;
+            }
+            ctx->task_count++;
+        } else {
+            /* The join walks the trie in the same order as the plan */
+            *ref = ctx->tasks[ctx->task_cursor++].ref;
+        }
+        return TX_ROOT_ERROR_NONE;
+    }
+
+    if (hi - lo == 1) {
+        return tx_root_leaf(ctx, lo, depth, ref);
+    }
+
+    unsigned shared = tx_root_common(ctx->count, lo, hi - 1, depth);
+    if (shared > 0) {
+        return tx_root_extension(ctx, scratch, lo, hi, depth, shared, ref);
+    }
+    return tx_root_branch(ctx, scratch, lo, hi, depth, ref);
+}
+
+static void tx_root_run_tasks(tx_root_worker_t *worker) {
+    tx_root_ctx_t *ctx = worker->ctx;
+
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&ctx->next_task, 1, memory_order_relaxed);
+        if (i >= ctx->task_count) {
+            return;
+        }
+
+        tx_root_task_t *task = &ctx->tasks[i];
+        int result = tx_root_node(ctx, &worker->scratch, task->lo, task->hi, task->depth, &task->ref);
+        if (result != TX_ROOT_ERROR_NONE) {
+            atomic_store_explicit(&ctx->error, result, memory_order_relaxed);
+        }
+    }
+}
+
+static void *tx_root_thread(void *arg) {
+    tx_root_run_tasks(arg);
+    return NULL;
+}
+
+/* Threads actually used: no more than the transactions keep busy */
+static unsigned tx_root_threads(size_t count, unsigned threads) {
+    size_t useful = count / TX_ROOT_PARALLEL_MIN;
+
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > useful) {
+        threads = useful > 0 ? (unsigned)useful : 1;
+    }
+    return threads;
+}
+
+/* Walk the top of the trie and count (tasks == NULL) or record its subtrees */
+static void tx_root_plan(tx_root_ctx_t *ctx, unsigned threads, tx_root_task_t *tasks) {
+    tx_root_ref_t top;
+
+    ctx->mode = TX_ROOT_PLAN;
+    ctx->cutoff = ctx->count / ((size_t)threads * TX_ROOT_TASKS_PER_THREAD);
+    ctx->tasks = tasks;
+    ctx->task_count = 0;
+    tx_root_node(ctx, NULL, 0, ctx->count, 0, &top);
+}
+
+size_t eth_tx_root_arena_size(size_t count, unsigned threads) {
+    threads = tx_root_threads(count, threads);
+
+    size_t size = threads * (sizeof(tx_root_worker_t) + TX_ROOT_SCRATCH_SIZE) + _Alignof(tx_root_worker_t);
+    if (threads > 1) {
+        tx_root_ctx_t ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.count = count;
+        tx_root_plan(&ctx, threads, NULL);
+        size += ctx.task_count * sizeof(tx_root_task_t) + _Alignof(tx_root_task_t);
+    }
+    return size;
+}
+
+int eth_tx_root(const uint8_t *const *raw_txs, const size_t *lengths, size_t count,
+                eth_arena_t *arena, unsigned threads, uint8_t root[32]) {
+    if (!arena || !root || (count > 0 && (!raw_txs || !lengths))) {
+        return TX_ROOT_ERROR_INVALID;
+    }
+
+    tx_root_ref_t top;
+    if (count == 0) {
+        /* Empty trie: the hash of the empty string */
+        top.data[0] = 0x80;
+        top.length = 1;
+        top.hashed = 0;
+    } else {
+        threads = tx_root_threads(count, threads);
+
+        size_t mark = arena->used;
+        tx_root_ctx_t ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.raw_txs = raw_txs;
+        ctx.lengths = lengths;
+        ctx.count = count;
+        atomic_init(&ctx.next_task, 0);
+        atomic_init(&ctx.error, TX_ROOT_ERROR_NONE);
+
+        tx_root_worker_t *workers = eth_arena_alloc(arena, threads * sizeof(tx_root_worker_t),
+                                                    _Alignof(tx_root_worker_t));
+        if (!workers) {
+            return TX_ROOT_ERROR_NO_SPACE;
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            void *scratch = eth_arena_alloc(arena, TX_ROOT_SCRATCH_SIZE, 1);
+            if (!scratch) {
+                arena->used = mark;
+                return TX_ROOT_ERROR_NO_SPACE;
+            }
+            workers[i].ctx = &ctx;
+            eth_arena_init(&workers[i].scratch, scratch, TX_ROOT_SCRATCH_SIZE);
+        }
+
+        int result;
+        if (threads == 1) {
+            ctx.mode = TX_ROOT_HASH;
+            result = tx_root_node(&ctx, &workers[0].scratch, 0, count, 0, &top);
+        } else {
+            /* Split the trie into subtrees, once to count them and once to record them */
+            tx_root_plan(&ctx, threads, NULL);
+            tx_root_task_t *tasks = eth_arena_alloc(arena, ctx.task_count * sizeof(tx_root_task_t),
+                                                    _Alignof(tx_root_task_t));
+            if (!tasks) {
+                arena->used = mark;
+                return TX_ROOT_ERROR_NO_SPACE;
+            }
+            tx_root_plan(&ctx, threads, tasks);
+
+            /* Hash the subtrees; if a thread cannot be started the others take its share */
+            ctx.mode = TX_ROOT_HASH;
+            unsigned started = 1;
+            while (started < threads &&
+                   pthread_create(&workers[started].thread, NULL, tx_root_thread, &workers[started]) == 0) {
+                started++;
+            }
+            tx_root_run_tasks(&workers[0]);
+            for (unsigned i = 1; i < started; i++) {
+                pthread_join(workers[i].thread, NULL);
+            }
+
+            result = atomic_load_explicit(&ctx.error, memory_order_relaxed);
+            if (result == TX_ROOT_ERROR_NONE) {
+                /* Hash the nodes above the subtrees */
+                ctx.mode = TX_ROOT_JOIN;
+                ctx.task_cursor = 0;
+                result = tx_root_node(&ctx, &workers[0].scratch, 0, count, 0, &top);
+            }
+        }
+
+        arena->used = mark;
+        if (result != TX_ROOT_ERROR_NONE) {
+            return result;
+        }
+    }
+
+    if (top.hashed) {
+        memcpy(root, top.data, 32);
+    } else {
+        /* The root is hashed even when it is shorter than a hash */
+        eth_keccak_ctx_t keccak;
+        eth_keccak256_init(&keccak);
+        eth_keccak256_update(&keccak, top.data, top.length);
+        eth_keccak256_final(&keccak, root);
+    }
+
+    return TX_ROOT_ERROR_NONE;
+}
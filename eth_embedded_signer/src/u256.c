@@ -0,0 +1,162 @@
+#include <string.h>
+#include "../include/u256.h"
+
+/* Error codes */
+#define U256_ERROR_NONE      0
+#define U256_ERROR_INVALID  -1
+#define U256_ERROR_RANGE    -2
+
+/* Decimal digits folded in per multiply (10^9 fits in 32 bits) */
+#define U256_DEC_CHUNK       9
+
+/* value = value * multiplier + addend, in 32-bit halves so no 128-bit type is needed */
+static int u256_mul_add_small(eth_u256_t *value, uint32_t multiplier, uint32_t addend) {
+    uint64_t carry = addend;
+
+    for (int i = 0; i < 4; i++) {
+        uint64_t lo = (value->limb[i] & 0xffffffffu) * multiplier + carry;
+        uint64_t hi = (value->limb[i] >> 32) * multiplier + (lo >> 32);
+        value->limb[i] = (hi << 32) | (lo & 0xffffffffu);
+        carry = hi >> 32;
+    }
+
+    return carry ? U256_ERROR_RANGE : U256_ERROR_NONE;
+}
+
+void eth_u256_set_u64(eth_u256_t *value, uint64_t source) {
+    value->limb[0] = source;
+    value->limb[1] = 0;
+    value->limb[2] = 0;
+    value->limb[3] = 0;
+}
+
+int eth_u256_set_dec(eth_u256_t *value, const char *digits, size_t length) {
+    if (!value || !digits || length == 0) {
+        return U256_ERROR_INVALID;
+    }
+
+    eth_u256_t result = { { 0, 0, 0, 0 } };
+    size_t i = 0;
+
+    while (i < length) {
+        uint32_t chunk = 0;
+        uint32_t multiplier = 1;
+
+        for (size_t n = 0; n < U256_DEC_CHUNK && i < length; n++, i++) {
+            if (digits[i] < '0' || digits[i] > '9') {
+                return U256_ERROR_INVALID;
+            }
+            chunk = chunk * 10 + (uint32_t)(digits[i] - '0');
+            multiplier *= 10;
+        }
+
+        if (u256_mul_add_small(&result, multiplier, chunk) != U256_ERROR_NONE) {
+            return U256_ERROR_RANGE;
+        }
+    }
+
+    *value = result;
+    return U256_ERROR_NONE;
+}
+
+int eth_u256_set_hex(eth_u256_t *value, const char *digits, size_t length) {
+    if (!value || !digits) {
+        return U256_ERROR_INVALID;
+    }
+
+    if (length >= 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+        digits += 2;
+        length -= 2;
+    }
+    if (length == 0) {
+        return U256_ERROR_INVALID;
+    }
+
+    /* Leading zeros do not count towards the 64-digit limit */
+    size_t first = 0;
+    while (first < length && digits[first] == '0') {
+        first++;
+    }
+    if (length - first > 64) {
+        for (size_t i = first; i < length; i++) {
+            char c = digits[i];
+            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
+                return U256_ERROR_INVALID;
+            }
+        }
+        return U256_ERROR_RANGE;
+    }
+
+    eth_u256_t result = { { 0, 0, 0, 0 } };
+
+    /* Nibble n (counting from the right) lands in limb n / 16 */
+    for (size_t n = 0; n < length - first; n++) {
+        char c = digits[length - 1 - n];
+        uint64_t nibble;
+
+        if (c >= '0' && c <= '9') nibble = (uint64_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') nibble = (uint64_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') nibble = (uint64_t)(c - 'A' + 10);
+        else return U256_ERROR_INVALID;
+
+        result.limb[n / 16] |= nibble << (4 * (n % 16));
+    }
+
+    *value = result;
+    return U256_ERROR_NONE;
+}
+
+int eth_u256_set_bytes(eth_u256_t *value, const uint8_t *bytes, size_t length) {
+    if (!value || (!bytes && length > 0) || length > 32) {
+        return U256_ERROR_INVALID;
+    }
+
+    eth_u256_set_u64(value, 0);
+    for (size_t n = 0; n < length; n++) {
+        value->limb[n / 8] |= (uint64_t)bytes[length - 1 - n] << (8 * (n % 8));
+    }
+
+    return U256_ERROR_NONE;
+}
+
+void eth_u256_to_bytes(const eth_u256_t *value, uint8_t output[32]) {
+    for (int n = 0; n < 32; n++) {
+        output[31 - n] = (uint8_t)(value->limb[n / 8] >> (8 * (n % 8)));
+    }
+}
+
+size_t eth_u256_byte_length(const eth_u256_t *value) {
+    unsigned bits = 0;
+
+    /*
+     * Bit length of the highest non-zero limb. The selects compile to
+     * conditional moves, so the cost does not depend on the value.
+     */
+    for (unsigned i = 0; i < 4; i++) {
+        uint64_t limb = value->limb[i];
+#if defined(__GNUC__)
+        unsigned limb_bits = 64u - (unsigned)__builtin_clzll(limb | 1);
+#else
+        unsigned limb_bits = 1;
+        for (uint64_t v = limb >> 1; v; v >>= 1) {
+            limb_bits++;
+        }
+#endif
+        bits = limb ? 64u * i + limb_bits : bits;
+    }
+
+    return (bits + 7) / 8;
+}
+
+int eth_u256_is_zero(const eth_u256_t *value) {
+    return (value->limb[0] | value->limb[1] | value->limb[2] | value->limb[3]) == 0;
+}
+
+int eth_u256_cmp(const eth_u256_t *a, const eth_u256_t *b) {
+    for (int i = 3; i >= 0; i--) {
+        if (a->limb[i] != b->limb[i]) {
+            return a->limb[i] < b->limb[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
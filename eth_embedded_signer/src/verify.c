@@ -0,0 +1,109 @@
+#include <string.h>
+#include "../include/verify.h"
+
+/* Error codes */
+#define VERIFY_ERROR_NONE     0
+#define VERIFY_ERROR_INVALID -1
+#define VERIFY_ERROR_KEY     -2
+#define VERIFY_ERROR_FULL    -3
+
+/* Tables start on a cache line */
+#define VERIFY_TABLE_ALIGN 64
+
+#define VERIFY_TABLE_BYTES (ETH_EC_TABLE_SIZE * sizeof(eth_ge_storage_t))
+
+/* r and u1 = z / s, u2 = r / s; non-zero if r or s is out of range */
+static int verify_scalars(const eth_hash_t *hash, const eth_signature_t *signature,
+                          eth_scalar_t *r, eth_scalar_t *u1, eth_scalar_t *u2) {
+    eth_scalar_t s, z, w;
+
+    if (eth_scalar_set_bytes(r, signature->data) || eth_scalar_is_zero(r) ||
+        eth_scalar_set_bytes(&s, signature->data + 32) || eth_scalar_is_zero(&s)) {
+        return 1;
+    }
+
+    eth_scalar_set_bytes(&z, hash->data);
+    eth_scalar_inv(&w, &s);
+    eth_scalar_mul(u1, &z, &w);
+    eth_scalar_mul(u2, r, &w);
+    return 0;
+}
+
+int eth_verify(const eth_hash_t *hash, const eth_signature_t *signature, const eth_public_key_t *public_key) {
+    if (!hash || !signature || !public_key) {
+        return VERIFY_ERROR_INVALID;
+    }
+
+    eth_ge_t q;
+    if (eth_ge_set_public_key(&q, public_key) != 0) {
+        return VERIFY_ERROR_KEY;
+    }
+
+    eth_scalar_t r, u1, u2;
+    if (verify_scalars(hash, signature, &r, &u1, &u2)) {
+        return ETH_VERIFY_MISMATCH;
+    }
+
+    eth_gej_t acc;
+    eth_ec_mul_var(&acc, &q, &u2);
+    eth_ec_mul_gen_add_var(&acc, &u1);
+    return eth_gej_x_mod_n_equals_var(&acc, &r) ? VERIFY_ERROR_NONE : ETH_VERIFY_MISMATCH;
+}
+
+size_t eth_verifier_set_arena_size(size_t capacity) {
+    return capacity * VERIFY_TABLE_BYTES + VERIFY_TABLE_ALIGN;
+}
+
+int eth_verifier_set_init(eth_verifier_set_t *set, eth_arena_t *arena, size_t capacity) {
+    if (!set || !arena || capacity == 0 || capacity > SIZE_MAX / VERIFY_TABLE_BYTES) {
+        return VERIFY_ERROR_INVALID;
+    }
+
+    set->tables = eth_arena_alloc(arena, capacity * VERIFY_TABLE_BYTES, VERIFY_TABLE_ALIGN);
+    if (!set->tables) {
+        return VERIFY_ERROR_FULL;
+    }
+    set->count = 0;
+    set->capacity = capacity;
+    return VERIFY_ERROR_NONE;
+}
+
+int eth_verifier_set_add(eth_verifier_set_t *set, const eth_public_key_t *public_key, size_t *key_index) {
+    if (!set || !set->tables || !public_key) {
+        return VERIFY_ERROR_INVALID;
+    }
+    if (set->count >= set->capacity) {
+        return VERIFY_ERROR_FULL;
+    }
+
+    eth_ge_t q;
+    if (eth_ge_set_public_key(&q, public_key) != 0) {
+        return VERIFY_ERROR_KEY;
+    }
+
+    eth_ec_table_build(set->tables + set->count * ETH_EC_TABLE_SIZE, &q);
+    if (key_index) {
+        *key_index = set->count;
+    }
+    set->count++;
+    return VERIFY_ERROR_NONE;
+}
+
+int eth_verify_known(const eth_verifier_set_t *set, size_t key_index, const eth_hash_t *hash,
+                     const eth_signature_t *signature) {
+    if (!set || !hash || !signature || key_index >= set->count) {
+        return VERIFY_ERROR_INVALID;
+    }
+
+    eth_scalar_t r, u1, u2;
+    if (verify_scalars(hash, signature, &r, &u1, &u2)) {
+        return ETH_VERIFY_MISMATCH;
+    }
+
+    eth_gej_t acc;
+    memset(&acc, 0, sizeof(acc));
+    acc.infinity = 1;
+    eth_ec_table_mul_add_var(&acc, set->tables + key_index * ETH_EC_TABLE_SIZE, &u2);
+    eth_ec_mul_gen_add_var(&acc, &u1);
+    return eth_gej_x_mod_n_equals_var(&acc, &r) ? VERIFY_ERROR_NONE : ETH_VERIFY_MISMATCH;
+}
@@ -0,0 +1,79 @@
+#ifndef ETH_EMBEDDED_TEST_H
+#define ETH_EMBEDDED_TEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Minimal known-answer test harness. Each suite is a function that runs its
+ * checks and records failures; run_tests exits non-zero if any check failed.
+ */
+
+/* Number of failed checks so far */
+extern int test_failures;
+
+/* Record a failure (with its location) unless the condition holds */
+#define TEST_CHECK(condition) \
+    test_check((condition) != 0, #condition, __FILE__, __LINE__)
+
+/* Compare bytes against a hex string */
+#define TEST_CHECK_HEX(data, length, hex) \
+    test_check_hex((data), (length), (hex), __FILE__, __LINE__)
+
+/**
+ * @brief Record the result of one check
+ *
+ * @param passed Non-zero if the check passed
+ * @param expression Text of the check
+ * @param file Source file
+ * @param line Source line
+ */
+void test_check(int passed, const char *expression, const char *file, int line);
+
+/**
+ * @brief Check bytes against the expected value given in hex
+ *
+ * @param data Bytes to check
+ * @param length Number of bytes
+ * @param hex Expected value (lowercase hex, no 0x prefix)
+ * @param file Source file
+ * @param line Source line
+ */
+void test_check_hex(const uint8_t *data, size_t length, const char *hex, const char *file, int line);
+
+/**
+ * @brief Decode a hex string of known length (aborts the run on bad input)
+ *
+ * @param hex Hex digits, no 0x prefix
+ * @param output Output buffer
+ * @param length Number of bytes to decode
+ */
+void test_hex_bytes(const char *hex, uint8_t *output, size_t length);
+
+/* Suites */
+void test_crypto(void);
+void test_hd(void);
+void test_eip712(void);
+void test_tx_root(void);
+void test_personal_sign(void);
+void test_transaction(void);
+void test_rpc_batch(void);
+void test_nonce_manager(void);
+void test_pipeline(void);
+void test_sign_queue(void);
+void test_batch_sign(void);
+void test_tx_file(void);
+void test_hex(void);
+void test_tx_json(void);
+void test_u256(void);
+void test_tx_batch(void);
+void test_abi(void);
+void test_policy(void);
+void test_pubkey(void);
+void test_verify(void);
+void test_sha256(void);
+void test_cpu(void);
+void test_ec(void);
+
+#endif /* ETH_EMBEDDED_TEST_H */
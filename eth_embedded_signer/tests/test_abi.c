@@ -0,0 +1,317 @@
+#include <string.h>
+#include "test.h"
+#include "../include/abi.h"
+
+/* Address used as recipient throughout */
+static const char abi_recipient_hex[] = "5aaeb6053f3e94c9b9a09f33669435e7ef1beaed";
+
+/* Selectors from the table and hashed ones */
+static void abi_test_selectors(void) {
+    static const struct {
+        const char *signature;
+        uint32_t selector;
+        int in_table;
+    } selectors[] = {
+        { "transfer(address,uint256)", 0xa9059cbb, 1 },
+        { "approve(address,uint256)", 0x095ea7b3, 1 },
+        { "safeTransferFrom(address,address,uint256,bytes)", 0xb88d4fde, 1 },
+        { "baz(uint32,bool)", 0xcdcd77c0, 0 },
+        { "sam(bytes,bool,uint256[])", 0xa5643bf2, 0 },
+    };
+    uint32_t selector = 0;
+
+    for (size_t i = 0; i < sizeof(selectors) / sizeof(selectors[0]); i++) {
+        const char *signature = selectors[i].signature;
+        TEST_CHECK(eth_abi_selector(signature, strlen(signature), &selector) == 0);
+        TEST_CHECK(selector == selectors[i].selector);
+
+        const char *found = eth_abi_selector_signature(selectors[i].selector);
+        TEST_CHECK(selectors[i].in_table ? found && strcmp(found, signature) == 0 : found == NULL);
+    }
+}
+
+/* Single calls: the Solidity ABI specification examples and an ERC-20 transfer */
+static void abi_test_encode(void) {
+    static uint8_t memory[2048];
+    eth_abi_encoder_t encoder;
+    eth_arena_t arena;
+    eth_u256_t amount;
+    uint8_t recipient[20];
+    uint8_t *calldata = NULL;
+    size_t length = 0;
+
+    test_hex_bytes(abi_recipient_hex, recipient, sizeof(recipient));
+    TEST_CHECK(eth_arena_init(&arena, memory, sizeof(memory)) == 0);
+
+    /* transfer(0x5aae..., 10^18) */
+    eth_u256_set_u64(&amount, 1000000000000000000ULL);
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &arena, 0xa9059cbb, 2) == 0);
+    TEST_CHECK(eth_abi_put_address(&encoder, recipient) == 0);
+    TEST_CHECK(eth_abi_put_uint(&encoder, &amount) == 0);
+    TEST_CHECK(eth_abi_encode_end(&encoder, &calldata, &length) == 0);
+    TEST_CHECK_HEX(calldata, length,
+                   "a9059cbb"
+                   "0000000000000000000000005aaeb6053f3e94c9b9a09f33669435e7ef1beaed"
+                   "0000000000000000000000000000000000000000000000000de0b6b3a7640000");
+
+    /* baz(69, true) */
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &arena, 0xcdcd77c0, 2) == 0);
+    TEST_CHECK(eth_abi_put_u64(&encoder, 69) == 0);
+    TEST_CHECK(eth_abi_put_bool(&encoder, 7) == 0);
+    TEST_CHECK(eth_abi_encode_end(&encoder, &calldata, &length) == 0);
+    TEST_CHECK_HEX(calldata, length,
+                   "cdcd77c0"
+                   "0000000000000000000000000000000000000000000000000000000000000045"
+                   "0000000000000000000000000000000000000000000000000000000000000001");
+
+    /* sam("dave", true, [1, 2, 3]): dynamic arguments go behind the head */
+    eth_u256_t elements[3];
+    for (size_t i = 0; i < 3; i++) {
+        eth_u256_set_u64(&elements[i], i + 1);
+    }
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &arena, 0xa5643bf2, 3) == 0);
+    TEST_CHECK(eth_abi_put_bytes(&encoder, (const uint8_t *)"dave", 4) == 0);
+    TEST_CHECK(eth_abi_put_bool(&encoder, 1) == 0);
+    TEST_CHECK(eth_abi_put_uint_array(&encoder, elements, 3) == 0);
+    TEST_CHECK(eth_abi_encode_end(&encoder, &calldata, &length) == 0);
+    TEST_CHECK_HEX(calldata, length,
+                   "a5643bf2"
+                   "0000000000000000000000000000000000000000000000000000000000000060"
+                   "0000000000000000000000000000000000000000000000000000000000000001"
+                   "00000000000000000000000000000000000000000000000000000000000000a0"
+                   "0000000000000000000000000000000000000000000000000000000000000004"
+                   "6461766500000000000000000000000000000000000000000000000000000000"
+                   "0000000000000000000000000000000000000000000000000000000000000003"
+                   "0000000000000000000000000000000000000000000000000000000000000001"
+                   "0000000000000000000000000000000000000000000000000000000000000002"
+                   "0000000000000000000000000000000000000000000000000000000000000003");
+
+    /* bytes32 and an empty byte string */
+    uint8_t word[32];
+    memset(word, 0x5c, sizeof(word));
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &arena, 0x01020304, 2) == 0);
+    TEST_CHECK(eth_abi_put_bytes32(&encoder, word) == 0);
+    TEST_CHECK(eth_abi_put_bytes(&encoder, NULL, 0) == 0);
+    TEST_CHECK(eth_abi_encode_end(&encoder, &calldata, &length) == 0);
+    TEST_CHECK_HEX(calldata, length,
+                   "01020304"
+                   "5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c5c"
+                   "0000000000000000000000000000000000000000000000000000000000000040"
+                   "0000000000000000000000000000000000000000000000000000000000000000");
+
+    /* Too few or too many arguments: nothing is left behind in the arena */
+    size_t used = arena.used;
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &arena, 0xa9059cbb, 2) == 0);
+    TEST_CHECK(eth_abi_put_address(&encoder, recipient) == 0);
+    TEST_CHECK(eth_abi_encode_end(&encoder, &calldata, &length) != 0);
+    TEST_CHECK(arena.used == used);
+
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &arena, 0xcdcd77c0, 1) == 0);
+    TEST_CHECK(eth_abi_put_u64(&encoder, 1) == 0);
+    TEST_CHECK(eth_abi_put_bool(&encoder, 1) != 0);
+
+    /* No room in the arena */
+    static uint8_t small_memory[40];
+    eth_arena_t small;
+    TEST_CHECK(eth_arena_init(&small, small_memory, sizeof(small_memory)) == 0);
+    TEST_CHECK(eth_abi_encode_begin(&encoder, &small, 0xa9059cbb, 2) != 0);
+}
+
+/* A batch of calls matches encoding each one on its own */
+static void abi_test_batch(void) {
+    static uint8_t memory[4096], single_memory[512];
+    uint8_t recipients[4][20];
+    eth_u256_t amounts[4];
+    eth_abi_bytes_t notes[4];
+    uint8_t *calldata[4];
+    size_t lengths[4];
+    eth_arena_t arena, single;
+
+    for (size_t i = 0; i < 4; i++) {
+        memset(recipients[i], 0x10 + (int)i, sizeof(recipients[i]));
+        eth_u256_set_u64(&amounts[i], 1000 * i);
+        notes[i].data = (const uint8_t *)"a note that runs past one word";
+        notes[i].length = 10 * i;
+    }
+
+    /* All static, then with a dynamic column */
+    const eth_abi_column_t static_columns[] = {
+        { ETH_ABI_ADDRESS, recipients },
+        { ETH_ABI_UINT256, amounts },
+    };
+    const eth_abi_column_t dynamic_columns[] = {
+        { ETH_ABI_ADDRESS, recipients },
+        { ETH_ABI_BYTES, notes },
+        { ETH_ABI_UINT256, amounts },
+    };
+
+    for (int dynamic = 0; dynamic <= 1; dynamic++) {
+        const eth_abi_column_t *columns = dynamic ? dynamic_columns : static_columns;
+        size_t arg_count = dynamic ? 3 : 2;
+
+        TEST_CHECK(eth_arena_init(&arena, memory, sizeof(memory)) == 0);
+        TEST_CHECK(eth_abi_encode_batch(&arena, 0x12345678, columns, arg_count, 4, calldata, lengths) == 0);
+
+        for (size_t i = 0; i < 4; i++) {
+            eth_abi_encoder_t encoder;
+            uint8_t *expected = NULL;
+            size_t expected_len = 0;
+
+            TEST_CHECK(eth_arena_init(&single, single_memory, sizeof(single_memory)) == 0);
+            TEST_CHECK(eth_abi_encode_begin(&encoder, &single, 0x12345678, arg_count) == 0);
+            TEST_CHECK(eth_abi_put_address(&encoder, recipients[i]) == 0);
+            if (dynamic) {
+                TEST_CHECK(eth_abi_put_bytes(&encoder, notes[i].data, notes[i].length) == 0);
+            }
+            TEST_CHECK(eth_abi_put_uint(&encoder, &amounts[i]) == 0);
+            TEST_CHECK(eth_abi_encode_end(&encoder, &expected, &expected_len) == 0);
+
+            TEST_CHECK(lengths[i] == expected_len && memcmp(calldata[i], expected, expected_len) == 0);
+        }
+    }
+
+    /* Out of room part way: rolled back */
+    TEST_CHECK(eth_arena_init(&arena, memory, 200) == 0);
+    TEST_CHECK(eth_abi_encode_batch(&arena, 0x12345678, static_columns, 2, 4, calldata, lengths) != 0);
+    TEST_CHECK(arena.used == 0);
+}
+
+/* Build calldata from a selector and hex words */
+static size_t abi_calldata(uint8_t *out, size_t size, const char *hex) {
+    size_t length = strlen(hex) / 2;
+
+    if (length > size) {
+        return 0;
+    }
+    test_hex_bytes(hex, out, length);
+    return length;
+}
+
+/* Generic accessors, with every bounds and range check tripped once */
+static void abi_test_decode(void) {
+    static const char sam[] =
+        "a5643bf2"
+        "0000000000000000000000000000000000000000000000000000000000000060"
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "00000000000000000000000000000000000000000000000000000000000000a0"
+        "0000000000000000000000000000000000000000000000000000000000000004"
+        "6461766500000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000003"
+        "0000000000000000000000000000000000000000000000000000000000000001"
+        "0000000000000000000000000000000000000000000000000000000000000002"
+        "0000000000000000000000000000000000000000000000000000000000000003";
+    uint8_t calldata[512];
+    eth_abi_call_t call;
+    eth_abi_bytes_t bytes;
+    const uint8_t *elements = NULL;
+    size_t count = 0;
+    uint64_t small = 0;
+    int flag = 0;
+
+    size_t length = abi_calldata(calldata, sizeof(calldata), sam);
+    TEST_CHECK(eth_abi_decode(&call, calldata, length) == 0);
+    TEST_CHECK(call.selector == 0xa5643bf2 && call.args == calldata + 4 && call.args_length == length - 4);
+
+    /* Views point into the calldata */
+    TEST_CHECK(eth_abi_get_bytes(&call, 0, &bytes) == 0);
+    TEST_CHECK(bytes.length == 4 && memcmp(bytes.data, "dave", 4) == 0 && bytes.data == calldata + 4 + 0x80);
+    TEST_CHECK(eth_abi_get_bool(&call, 1, &flag) == 0 && flag == 1);
+    TEST_CHECK(eth_abi_get_array(&call, 2, &elements, &count) == 0 && count == 3);
+    TEST_CHECK(elements == calldata + 4 + 0xc0 && elements[95] == 3);
+    TEST_CHECK(eth_abi_get_u64(&call, 2, &small) == 0 && small == 0xa0);
+    TEST_CHECK(eth_abi_word(&call, 8) != NULL && eth_abi_word(&call, 9) == NULL);
+
+    /* Bools other than 0/1 and addresses with upper bytes set are malformed */
+    TEST_CHECK(eth_abi_get_bool(&call, 2, &flag) != 0);
+    calldata[4 + 32 + 11] = 1;
+    const uint8_t *address = NULL;
+    TEST_CHECK(eth_abi_get_address(&call, 1, &address) != 0);
+    calldata[4 + 32 + 11] = 0;
+    TEST_CHECK(eth_abi_get_address(&call, 1, &address) == 0 && address == calldata + 4 + 32 + 12);
+
+    /* Values past 64 bits only come out as uint256 */
+    eth_u256_t value;
+    calldata[4 + 32 + 23] = 1;
+    TEST_CHECK(eth_abi_get_u64(&call, 1, &small) != 0);
+    TEST_CHECK(eth_abi_get_uint(&call, 1, &value) == 0 && value.limb[1] == 1 && value.limb[0] == 1);
+    calldata[4 + 32 + 23] = 0;
+
+    /* Offsets and lengths that run past the end */
+    calldata[4 + 31] = 0xff;
+    TEST_CHECK(eth_abi_get_bytes(&call, 0, &bytes) != 0);
+    calldata[4 + 31] = 0x60;
+    calldata[4 + 0x60 + 31] = 0xff;
+    TEST_CHECK(eth_abi_get_bytes(&call, 0, &bytes) != 0);
+    calldata[4 + 0x60 + 31] = 0x04;
+    calldata[4 + 0xa0 + 24] = 0x01;
+    TEST_CHECK(eth_abi_get_array(&call, 2, &elements, &count) != 0);
+    calldata[4 + 0xa0 + 24] = 0x00;
+    TEST_CHECK(eth_abi_get_array(&call, 2, &elements, &count) == 0 && count == 3);
+
+    TEST_CHECK(eth_abi_decode(&call, calldata, 3) != 0);
+}
+
+/* The token fast path: exact lengths, from/to/amount views, data */
+static void abi_test_token_calls(void) {
+    uint8_t calldata[512];
+    eth_abi_token_call_t token;
+    size_t length;
+
+    length = abi_calldata(calldata, sizeof(calldata),
+                          "a9059cbb"
+                          "0000000000000000000000005aaeb6053f3e94c9b9a09f33669435e7ef1beaed"
+                          "0000000000000000000000000000000000000000000000000de0b6b3a7640000");
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length, &token) == 0);
+    TEST_CHECK(token.op == ETH_ABI_TOKEN_TRANSFER && token.selector == 0xa9059cbb && token.from == NULL);
+    TEST_CHECK_HEX(token.to, 20, abi_recipient_hex);
+    TEST_CHECK(token.amount.limb[0] == 1000000000000000000ULL && token.data.length == 0);
+
+    /* One byte too many or too few is malformed, not "some other call" */
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length + 1, &token) < 0);
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length - 1, &token) < 0);
+
+    length = abi_calldata(calldata, sizeof(calldata),
+                          "23b872dd"
+                          "0000000000000000000000001111111111111111111111111111111111111111"
+                          "0000000000000000000000002222222222222222222222222222222222222222"
+                          "0000000000000000000000000000000000000000000000000000000000000007");
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length, &token) == 0);
+    TEST_CHECK(token.op == ETH_ABI_TOKEN_TRANSFER_FROM && token.amount.limb[0] == 7);
+    TEST_CHECK(token.from == calldata + 16 && token.to == calldata + 48);
+
+    length = abi_calldata(calldata, sizeof(calldata),
+                          "a22cb465"
+                          "0000000000000000000000003333333333333333333333333333333333333333"
+                          "0000000000000000000000000000000000000000000000000000000000000001");
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length, &token) == 0);
+    TEST_CHECK(token.op == ETH_ABI_TOKEN_SET_APPROVAL_FOR_ALL && token.amount.limb[0] == 1);
+    calldata[length - 1] = 2;
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length, &token) < 0);
+
+    length = abi_calldata(calldata, sizeof(calldata),
+                          "b88d4fde"
+                          "0000000000000000000000001111111111111111111111111111111111111111"
+                          "0000000000000000000000002222222222222222222222222222222222222222"
+                          "000000000000000000000000000000000000000000000000000000000000002a"
+                          "0000000000000000000000000000000000000000000000000000000000000080"
+                          "0000000000000000000000000000000000000000000000000000000000000003"
+                          "c0ffee0000000000000000000000000000000000000000000000000000000000");
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length, &token) == 0);
+    TEST_CHECK(token.op == ETH_ABI_TOKEN_SAFE_TRANSFER_FROM && token.amount.limb[0] == 42);
+    TEST_CHECK_HEX(token.data.data, token.data.length, "c0ffee");
+
+    /* Not a token selector at all */
+    length = abi_calldata(calldata, sizeof(calldata),
+                          "cdcd77c0"
+                          "0000000000000000000000000000000000000000000000000000000000000045"
+                          "0000000000000000000000000000000000000000000000000000000000000001");
+    TEST_CHECK(eth_abi_decode_token_call(calldata, length, &token) == ETH_ABI_NOT_TOKEN_CALL);
+}
+
+void test_abi(void) {
+    abi_test_selectors();
+    abi_test_encode();
+    abi_test_batch();
+    abi_test_decode();
+    abi_test_token_calls();
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/batch_sign.h"
+#include "../include/tx_file.h"
+#include "../include/transaction.h"
+
+/* Scratch files, in the working directory */
+#define BATCH_INPUT_PATH  "run_tests_batch_input.bin"
+#define BATCH_OUTPUT_PATH "run_tests_batch_output.bin"
+
+#define BATCH_TEST_COUNT  50
+
+/* Every BATCH_TEST_DENIED-th transaction goes to chain 5 */
+#define BATCH_TEST_DENIED 6
+
+/* Transaction i of the input file */
+static void batch_test_tx(eth_transaction_t *tx, size_t i) {
+    eth_tx_init(tx, (eth_tx_type_t)(i % 3));
+    tx->nonce = i;
+    tx->chain_id = i % BATCH_TEST_DENIED == BATCH_TEST_DENIED - 1 ? 5 : 1;
+    tx->gas_limit = 21000 + i;
+    tx->to_len = 20;
+    memset(tx->to, 0x42, sizeof(tx->to));
+    eth_u256_set_u64(&tx->value, 7 * i);
+    eth_u256_set_u64(&tx->gas_price, 3000000000ULL);
+    eth_u256_set_u64(&tx->max_fee, 3000000000ULL);
+    eth_u256_set_u64(&tx->max_priority_fee, 1000000000);
+}
+
+/* What the failure callback was told */
+typedef struct {
+    uint64_t indexes[BATCH_TEST_COUNT];
+    eth_policy_result_t reasons[BATCH_TEST_COUNT];
+    size_t count;
+} batch_test_failures_t;
+
+static void batch_test_failure(uint64_t index, int status, eth_policy_result_t reason, void *context) {
+    batch_test_failures_t *failures = context;
+
+    TEST_CHECK(status != 0);
+    if (failures->count < BATCH_TEST_COUNT) {
+        failures->indexes[failures->count] = index;
+        failures->reasons[failures->count] = reason;
+    }
+    failures->count++;
+}
+
+/* Read a whole file */
+static uint8_t *batch_read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long length;
+
+    if (!file) {
+        return NULL;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)length + 1);
+        if (data && fread(data, 1, (size_t)length, file) == (size_t)length) {
+            *size = (size_t)length;
+        } else {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    fclose(file);
+    return data;
+}
+
+/* Check the binary output record by record; denied transactions leave an empty record */
+static void batch_check_output(const eth_private_key_t *key, int with_policy) {
+    size_t size = 0, offset = 0;
+    uint8_t *output = batch_read_file(BATCH_OUTPUT_PATH, &size);
+
+    TEST_CHECK(output != NULL);
+    if (!output) {
+        return;
+    }
+
+    for (size_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        eth_transaction_t tx;
+        uint8_t raw[256];
+        size_t raw_len = 0;
+
+        if (size - offset < 4) {
+            TEST_CHECK(!"one record per input transaction");
+            break;
+        }
+        uint32_t length = (uint32_t)output[offset] | (uint32_t)output[offset + 1] << 8 |
+                          (uint32_t)output[offset + 2] << 16 | (uint32_t)output[offset + 3] << 24;
+        offset += 4;
+
+        if (with_policy && i % BATCH_TEST_DENIED == BATCH_TEST_DENIED - 1) {
+            TEST_CHECK(length == 0);
+            continue;
+        }
+
+        batch_test_tx(&tx, i);
+        TEST_CHECK(eth_tx_sign(&tx, key) == 0);
+        TEST_CHECK(eth_tx_encode_signed(&tx, raw, sizeof(raw), &raw_len) == 0);
+        TEST_CHECK(length == raw_len && size - offset >= raw_len && memcmp(output + offset, raw, raw_len) == 0);
+        if (size - offset < length) {
+            break;
+        }
+        offset += length;
+    }
+
+    TEST_CHECK(offset == size);
+    free(output);
+}
+
+void test_batch_sign(void) {
+    static const char rules[] = "allow any\nchain 1\n";
+    eth_batch_sign_options_t options;
+    eth_batch_sign_stats_t stats;
+    eth_tx_file_writer_t writer;
+    eth_private_key_t key;
+    eth_policy_t policy;
+    batch_test_failures_t failures;
+
+    memset(key.data, 0x2b, sizeof(key.data));
+    TEST_CHECK(eth_tx_file_writer_open(&writer, BATCH_INPUT_PATH) == 0);
+    for (size_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        eth_transaction_t tx;
+        batch_test_tx(&tx, i);
+        TEST_CHECK(eth_tx_file_writer_add(&writer, &tx) == 0);
+    }
+    TEST_CHECK(eth_tx_file_writer_finish(&writer) == 0);
+
+    memset(&options, 0, sizeof(options));
+    options.input_path = BATCH_INPUT_PATH;
+    options.output_path = BATCH_OUTPUT_PATH;
+    options.private_key = &key;
+    options.threads = 3;
+    options.format = ETH_BATCH_OUTPUT_BINARY;
+
+    /* Everything signs */
+    memset(&stats, 0xff, sizeof(stats));
+    TEST_CHECK(eth_batch_sign_file(&options, &stats) == 0);
+    TEST_CHECK(stats.signed_count == BATCH_TEST_COUNT && stats.failed_count == 0 && stats.denied_count == 0);
+    batch_check_output(&key, 0);
+
+    /* Chain 5 is not allowed: those records stay empty and the callback hears why, in order */
+    size_t denied = BATCH_TEST_COUNT / BATCH_TEST_DENIED;
+    TEST_CHECK(eth_policy_load(&policy, rules, sizeof(rules) - 1) == 0);
+    memset(&failures, 0, sizeof(failures));
+    options.policy = &policy;
+    options.on_failure = batch_test_failure;
+    options.failure_context = &failures;
+    TEST_CHECK(eth_batch_sign_file(&options, &stats) != 0);
+    TEST_CHECK(stats.signed_count == BATCH_TEST_COUNT - denied);
+    TEST_CHECK(stats.failed_count == denied && stats.denied_count == denied);
+    TEST_CHECK(failures.count == denied);
+    for (size_t i = 0; i < denied && i < failures.count; i++) {
+        TEST_CHECK(failures.indexes[i] == i * BATCH_TEST_DENIED + BATCH_TEST_DENIED - 1);
+        TEST_CHECK(failures.reasons[i] == ETH_POLICY_UNKNOWN_CHAIN);
+    }
+    batch_check_output(&key, 1);
+    eth_policy_free(&policy);
+    options.policy = NULL;
+
+    /* A record with a bad destination length stops the batch and says which one */
+    FILE *file = fopen(BATCH_INPUT_PATH, "r+b");
+    TEST_CHECK(file != NULL);
+    if (file) {
+        TEST_CHECK(fseek(file, ETH_TX_FILE_HEADER_SIZE + 17 * ETH_TX_FILE_RECORD_SIZE + 1, SEEK_SET) == 0);
+        TEST_CHECK(fputc(7, file) == 7);
+        fclose(file);
+        memset(&stats, 0, sizeof(stats));
+        TEST_CHECK(eth_batch_sign_file(&options, &stats) == ETH_BATCH_MALFORMED);
+        TEST_CHECK(stats.malformed_index == 17 && stats.signed_count == 17);
+    }
+
+    /* A missing input file is an error, not an empty batch */
+    options.input_path = "run_tests_batch_missing.bin";
+    TEST_CHECK(eth_batch_sign_file(&options, NULL) == ETH_BATCH_UNREADABLE);
+
+    remove(BATCH_INPUT_PATH);
+    remove(BATCH_OUTPUT_PATH);
+}
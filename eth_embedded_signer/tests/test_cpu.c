@@ -0,0 +1,80 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/cpu.h"
+#include "../include/ec.h"
+#include "../include/hex.h"
+#include "../include/keccak.h"
+#include "../include/sha256.h"
+
+/*
+ * Every suite checks its kernels against known answers, so ctest runs the
+ * whole binary once per ETH_SIGNER_CPU setting (see CMakeLists.txt). This
+ * suite checks that the kernels picked match the features allowed.
+ */
+
+/* Kernel name -> feature it needs (0: none) */
+static uint32_t cpu_test_needs(const char *backend) {
+    static const struct {
+        const char *name;
+        uint32_t features;
+    } needs[] = {
+        { "sha-ni", ETH_CPU_SHA },
+        { "avx2", ETH_CPU_AVX2 },
+        { "ssse3", ETH_CPU_SSSE3 },
+        { "bmi2", ETH_CPU_BMI2 },
+        { "int128", ETH_CPU_MUL64 },
+    };
+
+    for (size_t i = 0; i < sizeof(needs) / sizeof(needs[0]); i++) {
+        if (strcmp(backend, needs[i].name) == 0) {
+            return needs[i].features;
+        }
+    }
+    return 0;
+}
+
+void test_cpu(void) {
+    uint32_t detected = eth_cpu_detected();
+    uint32_t features = eth_cpu_features();
+    const char *override = getenv(ETH_CPU_ENV);
+    const char *backends[4];
+    char text[64];
+
+    /* Never more than the CPU has */
+    TEST_CHECK((features & ~detected) == 0);
+    TEST_CHECK(eth_cpu_features() == features);
+
+    backends[0] = eth_keccak_backend();
+    backends[1] = eth_sha256_backend();
+    backends[2] = eth_fe_backend();
+    backends[3] = eth_hex_backend();
+    for (size_t i = 0; i < 4; i++) {
+        uint32_t needs = cpu_test_needs(backends[i]);
+        TEST_CHECK((features & needs) == needs);
+    }
+
+#if ETH_CPU_DISPATCH
+    if (override && strcmp(override, "scalar") == 0) {
+        TEST_CHECK(features == 0);
+        TEST_CHECK(strcmp(backends[2], "portable") == 0);
+    } else if (override && strcmp(override, "baseline") == 0) {
+        TEST_CHECK((features & ~ETH_CPU_MUL64) == 0);
+    }
+#else
+    (void)override;
+#endif
+
+    /* Names, in bit order */
+    TEST_CHECK(eth_cpu_describe(0, text, sizeof(text)) == 0 && text[0] == '\0');
+    TEST_CHECK(eth_cpu_describe(ETH_CPU_AVX2 | ETH_CPU_SSSE3 | ETH_CPU_MUL64, text, sizeof(text)) == 0);
+    TEST_CHECK(strcmp(text, "ssse3 avx2 mul64") == 0);
+    TEST_CHECK(eth_cpu_describe(0x7f, text, sizeof(text)) == 0);
+    TEST_CHECK(strcmp(text, "ssse3 sse4.1 avx2 bmi2 sha avx512 mul64") == 0);
+
+    /* Truncation keeps whole names and a terminator */
+    TEST_CHECK(eth_cpu_describe(0x7f, text, 13) != 0);
+    TEST_CHECK(strcmp(text, "ssse3 sse4.1") == 0);
+    TEST_CHECK(eth_cpu_describe(ETH_CPU_SSSE3, text, 5) != 0 && text[0] == '\0');
+    TEST_CHECK(eth_cpu_describe(ETH_CPU_SSSE3, NULL, 0) != 0);
+}
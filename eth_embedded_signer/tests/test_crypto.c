@@ -0,0 +1,126 @@
+#include <string.h>
+#include "test.h"
+#include "../include/crypto.h"
+#include "../include/rfc6979.h"
+#include "../include/sha256.h"
+
+/*
+ * RFC 6979 / secp256k1 vectors: key, SHA-256 of the message, nonce, and the
+ * low-s signature with its recovery ID.
+ */
+static const struct {
+    const char *key;
+    const char *message;
+    const char *nonce;
+    const char *signature;
+    uint8_t recovery_id;
+} crypto_vectors[] = {
+    {
+        "0000000000000000000000000000000000000000000000000000000000000001",
+        "Satoshi Nakamoto",
+        "8f8a276c19f4149656b280621e358cce24f5f52542772691ee69063b74f15d15",
+        "934b1ea10a4b3c1757e2b0c017d0b6143ce3c9a7e6a4a49860d7a6ab210ee3d8"
+        "2442ce9d2b916064108014783e923ec36b49743e2ffa1c4496f01a512aafd9e5",
+        1
+    },
+    {
+        "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+        "Satoshi Nakamoto",
+        "33a19b60e25fb6f4435af53a3d42d493644827367e6453928554f43e49aa6f90",
+        "fd567d121db66e382991534ada77a6bd3106f0a1098c231e47993447cd6af2d0"
+        "6b39cd0eb1bc8603e159ef5c20a5c8ad685a45b06ce9bebed3f153d10d93bed5",
+        0
+    },
+    {
+        "0000000000000000000000000000000000000000000000000000000000000001",
+        "Everything should be made as simple as possible, but not simpler.",
+        "ec633bd56a5774a0940cb97e27a9e4e51dc94af737596a0c5cbb3d30332d92a5",
+        "33a69cd2065432a30f3d1ce4eb0d59b8ab58c74f27c41a7fdb5696ad4e6108c9"
+        "6f807982866f785d3f6418d24163ddae117b7db4d5fdf0071de069fa54342262",
+        0
+    },
+    {
+        "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+        "All those moments will be lost in time, like tears in rain. Time to die...",
+        "02b8b47f0a72ec6b38a15e02ebe1d6c6ce9235e6b3f4852b5a9b64de8cdbe633",
+        "059385ce615b7ab6a0db2a3b83f0566d3bc750e958121635ba497ccb4e3ce801"
+        "391bf93814fda99c98014ada8567dd7c067a50ac0a7ef7aa613b87e0eec17eb5",
+        1
+    },
+};
+
+#define CRYPTO_VECTOR_COUNT (sizeof(crypto_vectors) / sizeof(crypto_vectors[0]))
+
+void test_crypto(void) {
+    eth_private_key_t keys[CRYPTO_VECTOR_COUNT];
+    eth_hash_t hashes[CRYPTO_VECTOR_COUNT];
+    uint8_t nonces[CRYPTO_VECTOR_COUNT * 32];
+
+    for (size_t i = 0; i < CRYPTO_VECTOR_COUNT; i++) {
+        eth_signature_t signature;
+        eth_public_key_t public_key, recovered;
+        uint8_t nonce[32];
+        uint8_t recovery_id = 0xFF;
+
+        test_hex_bytes(crypto_vectors[i].key, keys[i].data, sizeof(keys[i].data));
+        eth_sha256((const uint8_t *)crypto_vectors[i].message, strlen(crypto_vectors[i].message), hashes[i].data);
+
+        TEST_CHECK(eth_rfc6979_nonce(&keys[i], &hashes[i], nonce) == 0);
+        TEST_CHECK_HEX(nonce, sizeof(nonce), crypto_vectors[i].nonce);
+
+        TEST_CHECK(eth_sign_recoverable(&hashes[i], &keys[i], &signature, &recovery_id) == 0);
+        TEST_CHECK_HEX(signature.data, sizeof(signature.data), crypto_vectors[i].signature);
+        TEST_CHECK(recovery_id == crypto_vectors[i].recovery_id);
+
+        /* Recovery gives back the signer's key */
+        TEST_CHECK(eth_private_key_to_public_key(&keys[i], &public_key) == 0);
+        TEST_CHECK(eth_recover_public_key(&signature, &hashes[i], recovery_id, &recovered) == 0);
+        TEST_CHECK(memcmp(recovered.data, public_key.data, sizeof(public_key.data)) == 0);
+    }
+
+    /* The batch derivation agrees with the single one */
+    TEST_CHECK(eth_rfc6979_nonce_batch(keys, hashes, CRYPTO_VECTOR_COUNT, nonces) == 0);
+    for (size_t i = 0; i < CRYPTO_VECTOR_COUNT; i++) {
+        TEST_CHECK_HEX(nonces + i * 32, 32, crypto_vectors[i].nonce);
+    }
+
+    /* Across several lane groups, with the pairs shuffled, every nonce matches its single derivation */
+    enum { CRYPTO_BATCH_PAIRS = 5 * CRYPTO_VECTOR_COUNT + 1 };
+    eth_private_key_t batch_keys[CRYPTO_BATCH_PAIRS];
+    eth_hash_t batch_hashes[CRYPTO_BATCH_PAIRS];
+    uint8_t batch_nonces[CRYPTO_BATCH_PAIRS * 32], single[32];
+    int mismatches = 0;
+    for (size_t i = 0; i < CRYPTO_BATCH_PAIRS; i++) {
+        batch_keys[i] = keys[i % CRYPTO_VECTOR_COUNT];
+        batch_hashes[i] = hashes[(i * 3 + i / CRYPTO_VECTOR_COUNT) % CRYPTO_VECTOR_COUNT];
+    }
+    TEST_CHECK(eth_rfc6979_nonce_batch(batch_keys, batch_hashes, CRYPTO_BATCH_PAIRS, batch_nonces) == 0);
+    for (size_t i = 0; i < CRYPTO_BATCH_PAIRS; i++) {
+        TEST_CHECK(eth_rfc6979_nonce(&batch_keys[i], &batch_hashes[i], single) == 0);
+        mismatches += memcmp(single, batch_nonces + 32 * i, 32) != 0;
+    }
+    TEST_CHECK(mismatches == 0);
+
+    /* n is not a key, alone or inside a batch */
+    test_hex_bytes("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141",
+                   batch_keys[7].data, sizeof(batch_keys[7].data));
+    TEST_CHECK(eth_rfc6979_nonce(&batch_keys[7], &batch_hashes[7], single) != 0);
+    TEST_CHECK(eth_rfc6979_nonce_batch(batch_keys, batch_hashes, CRYPTO_BATCH_PAIRS, batch_nonces) != 0);
+
+    /* Key 1 is the generator; key n - 1 is its negation */
+    eth_public_key_t public_key;
+    eth_address_t address;
+    TEST_CHECK(eth_private_key_to_public_key(&keys[0], &public_key) == 0);
+    TEST_CHECK(eth_public_key_to_address(&public_key, &address) == 0);
+    TEST_CHECK_HEX(address.data, sizeof(address.data), "7e5f4552091a69125d5dfcb7b8c2659029395bdf");
+    TEST_CHECK(eth_private_key_to_public_key(&keys[1], &public_key) == 0);
+    TEST_CHECK_HEX(public_key.data, sizeof(public_key.data),
+                   "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"
+                   "b7c52588d95c3b9aa25b0403f1eef75702e84bb7597aabe663b82f6f04ef2777");
+
+    /* Zero is not a key */
+    eth_private_key_t zero;
+    eth_signature_t signature;
+    memset(&zero, 0, sizeof(zero));
+    TEST_CHECK(eth_sign(&hashes[0], &zero, &signature) != 0);
+}
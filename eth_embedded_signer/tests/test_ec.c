@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/ec.h"
+
+/* Scalars beyond the known multiples, compared across the k * G paths */
+#define EC_TEST_SCALARS 64
+
+/* k * G from independent point arithmetic, for scalars touching every window */
+static const struct {
+    const char *k;
+    const char *point;
+} ec_gen_vectors[] = {
+    { "0000000000000000000000000000000000000000000000000000000000000001",
+      "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"
+      "483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8" },
+    { "0000000000000000000000000000000000000000000000000000000000000002",
+      "c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5"
+      "1ae168fea63dc339a3c58419466ceaeef7f632653266d0e1236431a950cfe52a" },
+    { "0000000000000000000000000000000000000000000000000000000000000003",
+      "f9308a019258c31049344f85f89d5229b531c845836f99b08601f113bce036f9"
+      "388f7b0f632de8140fe337e62a37f3566500a99934c2231b6cb9fd7584b8e672" },
+    { "00000000000000000000000000000000ffffffffffffffffffffffffffffffff",
+      "6c034fd8cc8bd548e12569b630710400e6c24a05d9d6b32f08522a241e936da8"
+      "47ec36379eabcb793bfa408f7898ea619798b51289138f979b8eb3fd33d25f15" },
+    { "8000000000000000000000000000000000000000000000000000000000003039",
+      "cdd1c738e14ebf6ca7b7aa795f5852110cf730f6553d425bfe53f14132052f1e"
+      "c6803f23a50c13736a3c2ee340813e02590d8614930fa18e6985b70994469c63" },
+    { "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd036413f",
+      "c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5"
+      "e51e970159c23cc65c3a7be6b99315110809cd9acd992f1edc9bce55af301705" },
+};
+
+/* Affine x || y of a Jacobian point */
+static void ec_test_affine(const eth_gej_t *point, eth_public_key_t *out) {
+    eth_ge_t affine;
+
+    eth_ge_set_gej(&affine, point);
+    eth_ge_get_public_key(out, &affine);
+}
+
+/*
+ * The generator table is generated at build time (ETH_EC_GEN_TABLE_BITS-bit
+ * windows): the constant-time and variable-time k * G paths that use it must
+ * match known multiples and the generic multiply, which does not.
+ */
+void test_ec(void) {
+    eth_ge_t generator;
+    eth_gej_t point;
+    eth_scalar_t k;
+    eth_public_key_t expected, constant_time, variable_time, generic, accumulated;
+    uint8_t bytes[32];
+
+    eth_ge_set_generator(&generator);
+
+    for (size_t i = 0; i < sizeof(ec_gen_vectors) / sizeof(ec_gen_vectors[0]); i++) {
+        test_hex_bytes(ec_gen_vectors[i].k, bytes, sizeof(bytes));
+        TEST_CHECK(eth_scalar_set_bytes(&k, bytes) == 0);
+
+        eth_ec_mul_gen(&point, &k);
+        ec_test_affine(&point, &constant_time);
+        TEST_CHECK_HEX(constant_time.data, 64, ec_gen_vectors[i].point);
+
+        eth_ec_mul_gen_var(&point, &k);
+        ec_test_affine(&point, &variable_time);
+        TEST_CHECK_HEX(variable_time.data, 64, ec_gen_vectors[i].point);
+    }
+
+    /* Pseudo-random scalars: every path agrees */
+    int mismatches = 0;
+    for (size_t i = 0; i < EC_TEST_SCALARS; i++) {
+        for (size_t b = 0; b < sizeof(bytes); b++) {
+            bytes[b] = (uint8_t)((i + 1) * 0x9d + b * 0x3b + (b * i >> 2));
+        }
+        bytes[0] &= 0x7f;
+        if (eth_scalar_set_bytes(&k, bytes) != 0) {
+            continue;
+        }
+
+        eth_ec_mul_var(&point, &generator, &k);
+        ec_test_affine(&point, &expected);
+        eth_ec_mul_gen(&point, &k);
+        ec_test_affine(&point, &constant_time);
+        eth_ec_mul_gen_var(&point, &k);
+        ec_test_affine(&point, &variable_time);
+
+        /* G + k * G through the accumulating form */
+        eth_gej_t sum;
+        eth_gej_set_ge(&sum, &generator);
+        eth_ec_mul_gen_add_var(&sum, &k);
+        ec_test_affine(&sum, &accumulated);
+        eth_ec_mul_var(&point, &generator, &k);
+        eth_gej_add_ge_var(&sum, &point, &generator);
+        ec_test_affine(&sum, &generic);
+
+        mismatches += memcmp(&expected, &constant_time, sizeof(expected)) != 0;
+        mismatches += memcmp(&expected, &variable_time, sizeof(expected)) != 0;
+        mismatches += memcmp(&generic, &accumulated, sizeof(generic)) != 0;
+    }
+    TEST_CHECK(mismatches == 0);
+
+    /* The table of G built at run time gives the same multiples as the generated one */
+    eth_ge_storage_t *table = malloc(ETH_EC_TABLE_SIZE * sizeof(*table));
+    TEST_CHECK(table != NULL);
+    if (table) {
+        eth_ec_table_build(table, &generator);
+        for (size_t i = 0; i < sizeof(ec_gen_vectors) / sizeof(ec_gen_vectors[0]); i++) {
+            test_hex_bytes(ec_gen_vectors[i].k, bytes, sizeof(bytes));
+            TEST_CHECK(eth_scalar_set_bytes(&k, bytes) == 0);
+            memset(&point, 0, sizeof(point));
+            point.infinity = 1;
+            eth_ec_table_mul_add_var(&point, table, &k);
+            ec_test_affine(&point, &generic);
+            TEST_CHECK_HEX(generic.data, 64, ec_gen_vectors[i].point);
+        }
+        free(table);
+    }
+}
@@ -0,0 +1,186 @@
+#include <string.h>
+#include "test.h"
+#include "../include/eip712.h"
+
+/* Two's complement of -magnitude over 256 bits */
+static void eip712_negative(eth_u256_t *value, uint64_t magnitude) {
+    memset(value->limb, 0xff, sizeof(value->limb));
+    value->limb[0] = ~magnitude + 1;
+}
+
+/*
+ * Arrays (fixed, dynamic, of structs and inside them), signed and small
+ * integers, bool, bytesN and bytes, against an independent Python encoder.
+ */
+static void eip712_test_arrays(void) {
+    static const char schema_text[] =
+        "Order(address maker,uint8 side,int64 delta,bool open,bytes4 tag,bytes note,"
+        "uint256[3] amounts,Leg[] legs)\n"
+        "Leg(string venue,int256[] prices)";
+    static const uint8_t tag[4] = { 0xde, 0xad, 0xbe, 0xef };
+    uint8_t maker[20], note[100];
+    eth_eip712_schema_t schema;
+    eth_eip712_value_t amounts[3], prices[2], first_leg[2], second_leg[2], legs[2], fields[8], order;
+    eth_hash_t hash;
+
+    if (eth_eip712_schema_load(&schema, schema_text, sizeof(schema_text) - 1) != 0) {
+        TEST_CHECK(!"Order schema loads");
+        return;
+    }
+    const eth_eip712_type_t *type = eth_eip712_find_type(&schema, "Order");
+    TEST_CHECK(type != NULL && eth_eip712_find_type(&schema, "Leg") != NULL);
+    TEST_CHECK(eth_eip712_find_type(&schema, "Person") == NULL);
+    if (!type) {
+        eth_eip712_schema_free(&schema);
+        return;
+    }
+
+    /* encodeType lists Leg after Order */
+    TEST_CHECK_HEX(type->type_hash.data, 32, "fb972f17948bab7111c3fb49992806ffaaa8331ef7e208963b76f6541ac6e2c1");
+    TEST_CHECK(type->field_count == 8 && type->fields[6].array == ETH_EIP712_FIXED_ARRAY &&
+               type->fields[6].array_length == 3 && type->fields[7].array == ETH_EIP712_DYNAMIC_ARRAY);
+
+    memset(maker, 0xab, sizeof(maker));
+    memset(note, 'x', sizeof(note));
+    memset(amounts, 0, sizeof(amounts));
+    memset(prices, 0, sizeof(prices));
+    memset(first_leg, 0, sizeof(first_leg));
+    memset(second_leg, 0, sizeof(second_leg));
+    memset(legs, 0, sizeof(legs));
+    memset(fields, 0, sizeof(fields));
+    memset(&order, 0, sizeof(order));
+
+    for (size_t i = 0; i < 3; i++) {
+        eth_u256_set_u64(&amounts[i].number, i + 1);
+    }
+    eth_u256_set_u64(&prices[0].number, 7);
+    eip712_negative(&prices[1].number, 7);
+    first_leg[0].data = (const uint8_t *)"dex";
+    first_leg[0].length = 3;
+    first_leg[1].items = prices;
+    first_leg[1].count = 2;
+    second_leg[0].data = (const uint8_t *)"";
+    legs[0].items = first_leg;
+    legs[0].count = 2;
+    legs[1].items = second_leg;
+    legs[1].count = 2;
+
+    fields[0].data = maker;
+    fields[0].length = sizeof(maker);
+    eth_u256_set_u64(&fields[1].number, 255);
+    eip712_negative(&fields[2].number, 5);
+    eth_u256_set_u64(&fields[3].number, 1);
+    fields[4].data = tag;
+    fields[4].length = sizeof(tag);
+    fields[5].data = note;
+    fields[5].length = sizeof(note);
+    fields[6].items = amounts;
+    fields[6].count = 3;
+    fields[7].items = legs;
+    fields[7].count = 2;
+    order.items = fields;
+    order.count = 8;
+
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, "6881c53434205d1b70d3489820f6c7f4456492da18929f322e75e51b6f1f9360");
+
+    /* An empty dynamic array hashes as keccak256("") */
+    fields[7].count = 0;
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, "8813e644b3433775304e3412341006962bbd4ccd8c83833a6650ce0b4d9567b4");
+
+    /* Values that do not fit their type are refused */
+    fields[6].count = 2;
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) != 0);
+    fields[6].count = 3;
+    eth_u256_set_u64(&fields[1].number, 256);
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) != 0);
+    eth_u256_set_u64(&fields[1].number, 255);
+    eth_u256_set_u64(&fields[3].number, 2);
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) != 0);
+    eth_u256_set_u64(&fields[3].number, 1);
+    fields[0].length = 19;
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) != 0);
+    fields[0].length = 20;
+    order.count = 7;
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) != 0);
+    order.count = 8;
+    TEST_CHECK(eth_eip712_hash_struct(type, &order, &hash) == 0);
+
+    eth_eip712_schema_free(&schema);
+}
+
+/* The "Mail" example of EIP-712 */
+void test_eip712(void) {
+    static const char schema_text[] =
+        "Mail(Person from,Person to,string contents)\n"
+        "Person(string name,address wallet)\n";
+    uint8_t contract[20], cow_wallet[20], bob_wallet[20];
+    eth_eip712_schema_t schema;
+    eth_eip712_domain_t domain;
+    eth_private_key_t cow_key;
+    eth_hash_t hash;
+
+    test_hex_bytes("cccccccccccccccccccccccccccccccccccccccc", contract, sizeof(contract));
+    test_hex_bytes("cd2a3d9f938e13cd947ec05abc7fe734df8dd826", cow_wallet, sizeof(cow_wallet));
+    test_hex_bytes("bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb", bob_wallet, sizeof(bob_wallet));
+    test_hex_bytes("c85ef7d79691fe79573b1a7064c19c1a9819ebdbd1faaab1a8ec92344438aaf4", cow_key.data, sizeof(cow_key.data));
+
+    TEST_CHECK(eth_eip712_domain_init(&domain, "Ether Mail", "1", 1, contract, NULL) == 0);
+    TEST_CHECK_HEX(domain.separator.data, 32, "f2cee375fa42b42143804025fc449deafd50cc031ca257e0b194a650a912090f");
+
+    if (eth_eip712_schema_load(&schema, schema_text, sizeof(schema_text) - 1) != 0) {
+        TEST_CHECK(!"Mail schema loads");
+        return;
+    }
+
+    const eth_eip712_type_t *mail = eth_eip712_find_type(&schema, "Mail");
+    TEST_CHECK(mail != NULL);
+    if (mail) {
+        eth_eip712_value_t from[2], to[2], fields[3], message;
+        eth_signature_t signature;
+
+        memset(from, 0, sizeof(from));
+        memset(to, 0, sizeof(to));
+        memset(fields, 0, sizeof(fields));
+        memset(&message, 0, sizeof(message));
+
+        from[0].data = (const uint8_t *)"Cow";
+        from[0].length = 3;
+        from[1].data = cow_wallet;
+        from[1].length = sizeof(cow_wallet);
+        to[0].data = (const uint8_t *)"Bob";
+        to[0].length = 3;
+        to[1].data = bob_wallet;
+        to[1].length = sizeof(bob_wallet);
+        fields[0].items = from;
+        fields[0].count = 2;
+        fields[1].items = to;
+        fields[1].count = 2;
+        fields[2].data = (const uint8_t *)"Hello, Bob!";
+        fields[2].length = 11;
+        message.items = fields;
+        message.count = 3;
+
+        TEST_CHECK_HEX(mail->type_hash.data, 32, "a0cedeb2dc280ba39b857546d74f5549c3a1d7bdc2dd96bf881f76108e23dac2");
+
+        TEST_CHECK(eth_eip712_hash_struct(mail, &message, &hash) == 0);
+        TEST_CHECK_HEX(hash.data, 32, "c52c0ee5d84264471806290a3f2c4cecfc5490626bf912d01f240d7a274b371e");
+
+        TEST_CHECK(eth_eip712_hash(&domain, mail, &message, &hash) == 0);
+        TEST_CHECK_HEX(hash.data, 32, "be609aee343fb3c4b28e1df9e632fca64fcfaede20f02e86244efddf30957bd2");
+
+        TEST_CHECK(eth_eip712_sign(&domain, mail, &message, &cow_key, &signature) == 0);
+        TEST_CHECK_HEX(signature.data, sizeof(signature.data),
+                       "4355c47d63924e8a72e509b65029052eb6c299d53a04e167c5775fd466751c9d"
+                       "07299936d304c153f6443dfa05f40ff007d72911b6f72307f996231605b91562");
+    }
+
+    eth_eip712_schema_free(&schema);
+
+    /* A field of an undefined struct type is rejected */
+    static const char broken[] = "Mail(Person from,string contents)";
+    TEST_CHECK(eth_eip712_schema_load(&schema, broken, sizeof(broken) - 1) != 0);
+
+    eip712_test_arrays();
+}
@@ -0,0 +1,142 @@
+#include <string.h>
+#include "test.h"
+#include "../include/hd.h"
+
+#define HD_RANGE_START 7
+#define HD_RANGE_COUNT 300
+
+/*
+ * Deposit addresses of the seed of "abandon abandon ... about": the first one
+ * is the published m/44'/60'/0'/0/0 address, and the bulk range agrees with
+ * one-by-one derivation from the private and from the public account node.
+ */
+static void hd_test_range(void) {
+    static const char seed_hex[] =
+        "5eb00bbddcf069084889a8ab9155568165f5c453ccb85e70811aaed6f6da5fc1"
+        "9a5ac40b389cd370d086206dec8aa6c43daea6690f20ad3d8d48b2d2ce9e38e4";
+    static eth_public_key_t public_keys[HD_RANGE_COUNT];
+    static eth_address_t addresses[HD_RANGE_COUNT], threaded[HD_RANGE_COUNT];
+    uint8_t seed[64];
+    eth_hd_node_t root, account, child;
+    eth_hd_cache_t cache;
+    eth_hd_parent_t parent;
+    eth_address_t address;
+    const eth_hd_node_t *node = NULL;
+
+    test_hex_bytes(seed_hex, seed, sizeof(seed));
+    TEST_CHECK(eth_hd_node_from_seed(&root, seed, sizeof(seed)) == 0);
+    eth_hd_cache_init(&cache, &root);
+
+    TEST_CHECK(eth_hd_cache_derive_path(&cache, "m/44'/60'/0'/0/0", &node) == 0);
+    TEST_CHECK(node != NULL && eth_public_key_to_address(&node->public_key, &address) == 0);
+    TEST_CHECK_HEX(address.data, 20, "9858effd232b4033e47d90003d41ec34ecaeda94");
+
+    TEST_CHECK(eth_hd_cache_derive_path(&cache, "m/44h/60h/0h/0", &node) == 0);
+    if (!node) {
+        return;
+    }
+    account = *node;
+
+    TEST_CHECK(eth_hd_parent_init(&parent, &account) == 0);
+    TEST_CHECK(eth_hd_derive_range(&parent, HD_RANGE_START, HD_RANGE_START + HD_RANGE_COUNT, 1,
+                                   public_keys, addresses) == 0);
+    TEST_CHECK(eth_hd_derive_range(&parent, HD_RANGE_START, HD_RANGE_START + HD_RANGE_COUNT, 3,
+                                   NULL, threaded) == 0);
+    TEST_CHECK(memcmp(addresses, threaded, sizeof(addresses)) == 0);
+
+    /* The same account as an xpub */
+    eth_hd_node_t public_account;
+    TEST_CHECK(eth_hd_node_from_public(&public_account, &account.public_key, account.chain_code) == 0);
+
+    int mismatches = 0;
+    for (uint32_t i = 0; i < HD_RANGE_COUNT; i++) {
+        if (eth_hd_node_derive(&account, HD_RANGE_START + i, &child) != 0 ||
+            memcmp(&child.public_key, &public_keys[i], sizeof(child.public_key)) != 0 ||
+            eth_public_key_to_address(&child.public_key, &address) != 0 ||
+            memcmp(&address, &addresses[i], sizeof(address)) != 0) {
+            mismatches++;
+        }
+        if (eth_hd_node_derive(&public_account, HD_RANGE_START + i, &child) != 0 ||
+            memcmp(&child.public_key, &public_keys[i], sizeof(child.public_key)) != 0 || child.has_private) {
+            mismatches++;
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+
+    /* Hardened indexes are out of range, and so is an empty range */
+    TEST_CHECK(eth_hd_derive_range(&parent, ETH_HD_HARDENED - 1, ETH_HD_HARDENED + 1, 1, NULL, addresses) < 0);
+    TEST_CHECK(eth_hd_derive_range(&parent, 5, 5, 1, NULL, addresses) == 0);
+
+    eth_hd_cache_wipe(&cache);
+}
+
+/* Paths the parser accepts and refuses */
+static void hd_test_paths(void) {
+    uint32_t path[ETH_HD_MAX_DEPTH];
+    size_t depth = 0;
+
+    TEST_CHECK(eth_hd_parse_path("m", path, ETH_HD_MAX_DEPTH, &depth) == 0 && depth == 0);
+    TEST_CHECK(eth_hd_parse_path("m/44'/60h/0'/0/2147483647", path, ETH_HD_MAX_DEPTH, &depth) == 0);
+    TEST_CHECK(depth == 5 && path[0] == (ETH_HD_HARDENED | 44) && path[1] == (ETH_HD_HARDENED | 60) &&
+               path[3] == 0 && path[4] == 2147483647u);
+
+    static const char *const broken[] = {
+        "", "44'/60'", "m/", "m//0", "m/2147483648", "m/1x", "m/-1", "m/0'/'",
+    };
+    for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); i++) {
+        TEST_CHECK(eth_hd_parse_path(broken[i], path, ETH_HD_MAX_DEPTH, &depth) != 0);
+    }
+    TEST_CHECK(eth_hd_parse_path("m/0/1/2", path, 2, &depth) != 0);
+}
+
+/* BIP-32 test vector 1 (seed 000102...0f) */
+void test_hd(void) {
+    static const uint8_t seed[16] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    };
+    eth_hd_node_t root;
+    eth_hd_cache_t cache;
+    const eth_hd_node_t *node = NULL;
+
+    TEST_CHECK(eth_hd_node_from_seed(&root, seed, sizeof(seed)) == 0);
+    TEST_CHECK_HEX(root.private_key.data, 32, "e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35");
+    TEST_CHECK_HEX(root.chain_code, 32, "873dff81c02f525623fd1fe5167eac3a55a049de3d314bb42ee227ffed37d508");
+    TEST_CHECK_HEX(root.compressed, 33, "0339a36013301597daef41fbe593a02cc513d0b55527ec2df1050e2e8ff49c85c2");
+
+    eth_hd_cache_init(&cache, &root);
+
+    TEST_CHECK(eth_hd_cache_derive_path(&cache, "m/0'", &node) == 0);
+    TEST_CHECK(node != NULL && node->depth == 1 && node->child_number == ETH_HD_HARDENED);
+    if (node) {
+        TEST_CHECK_HEX(node->private_key.data, 32, "edb2e14f9ee77d26dd93b4ecede8d16ed408ce149b6cd80b0715a2d911a0afea");
+        TEST_CHECK_HEX(node->chain_code, 32, "47fdacbd0f1097043b78c63c20c34ef4ed9a111d980047ad16282c7ae6236141");
+    }
+
+    TEST_CHECK(eth_hd_cache_derive_path(&cache, "m/0'/1/2'/2/1000000000", &node) == 0);
+    TEST_CHECK(node != NULL && node->depth == 5 && node->child_number == 1000000000);
+    if (node) {
+        TEST_CHECK_HEX(node->private_key.data, 32, "471b76e389e528d6de6d816857e012c5455051cad6660850e58372a6c3e6e7c8");
+        TEST_CHECK_HEX(node->chain_code, 32, "c783e67b921d2beb8f6b389cc646d7263b4145701dadd2161548a8b078e65e9e");
+        TEST_CHECK_HEX(node->compressed, 33, "022a471424da5e657499d1ff51cb43c47481a03b1e77f951fe64cec9f5a48f7011");
+    }
+
+    /* Deriving straight from the root, without the cache, gives the same key */
+    static const uint32_t path[] = { ETH_HD_HARDENED, 1, ETH_HD_HARDENED | 2, 2, 1000000000 };
+    eth_hd_node_t parent = root, child;
+    for (size_t i = 0; i < sizeof(path) / sizeof(path[0]); i++) {
+        TEST_CHECK(eth_hd_node_derive(&parent, path[i], &child) == 0);
+        parent = child;
+    }
+    TEST_CHECK_HEX(parent.private_key.data, 32, "471b76e389e528d6de6d816857e012c5455051cad6660850e58372a6c3e6e7c8");
+
+    /* Hardened children need the private key */
+    eth_hd_node_t public_root = root;
+    eth_hd_node_neuter(&public_root);
+    TEST_CHECK(eth_hd_node_derive(&public_root, ETH_HD_HARDENED, &child) != 0);
+
+    eth_hd_cache_wipe(&cache);
+
+    hd_test_range();
+    hd_test_paths();
+}
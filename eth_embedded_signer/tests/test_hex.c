@@ -0,0 +1,74 @@
+#include <string.h>
+#include "test.h"
+#include "../include/hex.h"
+
+/* Longer than a few AVX2 blocks, so every kernel runs its blocks and its tail */
+#define HEX_TEST_MAX 200
+
+/* Plain one-digit-at-a-time reference */
+static void hex_reference(const uint8_t *data, size_t length, char *output, int upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    for (size_t i = 0; i < length; i++) {
+        output[2 * i] = digits[data[i] >> 4];
+        output[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+}
+
+void test_hex(void) {
+    uint8_t data[HEX_TEST_MAX], decoded[HEX_TEST_MAX];
+    char text[2 * HEX_TEST_MAX + 2], expected[2 * HEX_TEST_MAX];
+    size_t length = 0;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 151 + 7);
+    }
+    /* Digits on both sides of the 9/a boundary in both nibbles */
+    data[0] = 0x00;
+    data[1] = 0xff;
+    data[2] = 0x9a;
+    data[3] = 0xa9;
+
+    /* Every length, against the reference, in both directions and both cases */
+    for (size_t n = 0; n <= HEX_TEST_MAX; n++) {
+        hex_reference(data, n, expected, 0);
+        memset(text, '?', sizeof(text));
+        TEST_CHECK(eth_hex_encode(data, n, text, 2 * n) == 0);
+        TEST_CHECK(memcmp(text, expected, 2 * n) == 0 && text[2 * n] == '?');
+
+        memset(decoded, 0, sizeof(decoded));
+        TEST_CHECK(eth_hex_decode(text, 2 * n, decoded, n, &length) == 0);
+        TEST_CHECK(length == n && memcmp(decoded, data, n) == 0);
+
+        /* Upper case with a 0X prefix */
+        text[0] = '0';
+        text[1] = 'X';
+        hex_reference(data, n, text + 2, 1);
+        TEST_CHECK(eth_hex_decode(text, 2 * n + 2, decoded, n, &length) == 0);
+        TEST_CHECK(length == n && memcmp(decoded, data, n) == 0);
+    }
+
+    /* A bad character is caught wherever it lands in a block */
+    static const char bad[] = { 'g', 'G', '/', ':', '@', '`', ' ', '\0', (char)0x80, (char)0xb0 };
+    hex_reference(data, HEX_TEST_MAX, expected, 0);
+    for (size_t position = 0; position < 2 * 72; position++) {
+        memcpy(text, expected, 2 * HEX_TEST_MAX);
+        text[position] = bad[position % sizeof(bad)];
+        TEST_CHECK(eth_hex_decode(text, 2 * 72, decoded, sizeof(decoded), &length) != 0);
+    }
+
+    /* Odd digit counts, short buffers and missing pointers */
+    TEST_CHECK(eth_hex_decode("abc", 3, decoded, sizeof(decoded), &length) != 0);
+    TEST_CHECK(eth_hex_decode("0xabc", 5, decoded, sizeof(decoded), &length) != 0);
+    TEST_CHECK(eth_hex_decode("abcd", 4, decoded, 1, &length) != 0);
+    TEST_CHECK(eth_hex_encode(data, 2, text, 3) != 0);
+    TEST_CHECK(eth_hex_decode("abcd", 4, decoded, 2, NULL) != 0);
+
+    /* A bare prefix is zero bytes */
+    length = 1;
+    TEST_CHECK(eth_hex_decode("0x", 2, decoded, 0, &length) == 0 && length == 0);
+
+    /* Named after the kernel in use */
+    const char *backend = eth_hex_backend();
+    TEST_CHECK(strcmp(backend, "avx2") == 0 || strcmp(backend, "ssse3") == 0 || strcmp(backend, "scalar") == 0);
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+
+int test_failures = 0;
+
+/* Value of one hex digit, -1 if it is not one */
+static int test_hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void test_check(int passed, const char *expression, const char *file, int line) {
+    if (!passed) {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        test_failures++;
+    }
+}
+
+void test_check_hex(const uint8_t *data, size_t length, const char *hex, const char *file, int line) {
+    static const char digits[] = "0123456789abcdef";
+    int passed = strlen(hex) == length * 2;
+
+    for (size_t i = 0; passed && i < length; i++) {
+        passed = hex[2 * i] == digits[data[i] >> 4] && hex[2 * i + 1] == digits[data[i] & 0x0F];
+    }
+
+    if (!passed) {
+        fprintf(stderr, "%s:%d: check failed\n  expected %s\n  got      ", file, line, hex);
+        for (size_t i = 0; i < length; i++) {
+            fprintf(stderr, "%02x", data[i]);
+        }
+        fprintf(stderr, "\n");
+        test_failures++;
+    }
+}
+
+void test_hex_bytes(const char *hex, uint8_t *output, size_t length) {
+    if (strlen(hex) != length * 2) {
+        fprintf(stderr, "bad test vector: %s\n", hex);
+        exit(2);
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        int high = test_hex_digit(hex[2 * i]);
+        int low = test_hex_digit(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            fprintf(stderr, "bad test vector: %s\n", hex);
+            exit(2);
+        }
+        output[i] = (uint8_t)(high << 4 | low);
+    }
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        void (*run)(void);
+    } suites[] = {
+        { "crypto", test_crypto },
+        { "hd", test_hd },
+        { "eip712", test_eip712 },
+        { "tx_root", test_tx_root },
+        { "personal_sign", test_personal_sign },
+        { "transaction", test_transaction },
+        { "rpc_batch", test_rpc_batch },
+        { "nonce_manager", test_nonce_manager },
+        { "pipeline", test_pipeline },
+        { "sign_queue", test_sign_queue },
+        { "batch_sign", test_batch_sign },
+        { "tx_file", test_tx_file },
+        { "hex", test_hex },
+        { "tx_json", test_tx_json },
+        { "u256", test_u256 },
+        { "tx_batch", test_tx_batch },
+        { "abi", test_abi },
+        { "policy", test_policy },
+        { "pubkey", test_pubkey },
+        { "verify", test_verify },
+        { "sha256", test_sha256 },
+        { "cpu", test_cpu },
+        { "ec", test_ec },
+    };
+
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); i++) {
+        int before = test_failures;
+        suites[i].run();
+        printf("%-16s %s\n", suites[i].name, test_failures == before ? "ok" : "FAILED");
+    }
+
+    if (test_failures != 0) {
+        printf("%d check(s) failed\n", test_failures);
+        return 1;
+    }
+
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <string.h>
+#include "test.h"
+#include "../include/nonce_manager.h"
+
+/* Address whose bytes are all 'fill' except the last, so many share a long prefix */
+static void nonce_address(eth_address_t *address, uint8_t fill, uint8_t last) {
+    memset(address->data, fill, sizeof(address->data));
+    address->data[sizeof(address->data) - 1] = last;
+}
+
+void test_nonce_manager(void) {
+    eth_nonce_manager_t manager;
+    eth_address_t sender;
+    uint64_t nonce = 0, committed = 0;
+
+    TEST_CHECK(eth_nonce_manager_init(&manager, 64) == 0);
+    nonce_address(&sender, 0xaa, 0);
+
+    /* Unknown addresses start at 0 */
+    for (uint64_t i = 0; i < 3; i++) {
+        TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == i);
+    }
+
+    /* Releasing the latest reservation rolls the counter back */
+    TEST_CHECK(eth_nonce_set(&manager, &sender, 100) == 0);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 100);
+    TEST_CHECK(eth_nonce_release(&manager, &sender, 100) == 0);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 100);
+
+    /* Older releases are handed out again, lowest first, before fresh nonces */
+    for (uint64_t i = 101; i < 111; i++) {
+        TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == i);
+    }
+    TEST_CHECK(eth_nonce_release(&manager, &sender, 105) == 0);
+    TEST_CHECK(eth_nonce_release(&manager, &sender, 102) == 0);
+    TEST_CHECK(eth_nonce_release(&manager, &sender, 103) == 0);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 102);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 103);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 105);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 111);
+
+    /* The commit watermark only moves up */
+    TEST_CHECK(eth_nonce_commit(&manager, &sender, 104) == 0);
+    TEST_CHECK(eth_nonce_commit(&manager, &sender, 101) == 0);
+    TEST_CHECK(eth_nonce_committed(&manager, &sender, &committed) == 0 && committed == 105);
+
+    /* One release more than the gap list holds marks the address for resync */
+    TEST_CHECK(eth_nonce_set(&manager, &sender, 0) == 0);
+    for (uint64_t i = 0; i < ETH_NONCE_GAP_SLOTS + 2; i++) {
+        TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == i);
+    }
+    for (uint64_t i = 0; i < ETH_NONCE_GAP_SLOTS; i++) {
+        TEST_CHECK(eth_nonce_release(&manager, &sender, i) == 0);
+    }
+    TEST_CHECK(eth_nonce_needs_resync(&manager, &sender) == 0);
+    TEST_CHECK(eth_nonce_release(&manager, &sender, ETH_NONCE_GAP_SLOTS) != 0);
+    TEST_CHECK(eth_nonce_needs_resync(&manager, &sender) == 1);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) != 0);
+    TEST_CHECK(eth_nonce_set(&manager, &sender, 42) == 0);
+    TEST_CHECK(eth_nonce_needs_resync(&manager, &sender) == 0);
+    TEST_CHECK(eth_nonce_reserve(&manager, &sender, &nonce) == 0 && nonce == 42);
+
+    /* Tickets come from the shared counter together with the nonce */
+    atomic_uint_fast64_t counter;
+    uint64_t ticket = 0;
+    atomic_init(&counter, 7);
+    TEST_CHECK(eth_nonce_reserve_ticket(&manager, &sender, &counter, &nonce, &ticket) == 0);
+    TEST_CHECK(nonce == 43 && ticket == 7 && atomic_load(&counter) == 8);
+
+    /* Addresses that differ only in their last byte are kept apart */
+    for (unsigned i = 0; i < 32; i++) {
+        eth_address_t address;
+        nonce_address(&address, 0x5c, (uint8_t)i);
+        TEST_CHECK(eth_nonce_set(&manager, &address, 1000 + i) == 0);
+    }
+    for (unsigned i = 0; i < 32; i++) {
+        eth_address_t address;
+        nonce_address(&address, 0x5c, (uint8_t)i);
+        TEST_CHECK(eth_nonce_reserve(&manager, &address, &nonce) == 0 && nonce == 1000 + i);
+    }
+
+    /* Releases for an address the manager never saw are rejected */
+    nonce_address(&sender, 0x01, 0x02);
+    TEST_CHECK(eth_nonce_release(&manager, &sender, 0) != 0);
+    TEST_CHECK(eth_nonce_committed(&manager, &sender, &committed) != 0);
+
+    eth_nonce_manager_free(&manager);
+
+    /* A full table refuses new addresses (capacity 1 gives four entries) */
+    TEST_CHECK(eth_nonce_manager_init(&manager, 1) == 0);
+    for (unsigned i = 0; i < 5; i++) {
+        nonce_address(&sender, 0x77, (uint8_t)i);
+        int result = eth_nonce_reserve(&manager, &sender, &nonce);
+        TEST_CHECK(i < 4 ? result == 0 : result != 0);
+    }
+    eth_nonce_manager_free(&manager);
+}
@@ -0,0 +1,149 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/personal_sign.h"
+#include "../include/file_map.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#define PERSONAL_TEST_HAVE_FIFO 1
+#endif
+
+/* Scratch files, in the working directory */
+#define PERSONAL_FILE_PATH  "run_tests_personal.bin"
+#define PERSONAL_EMPTY_PATH "run_tests_personal_empty.bin"
+#define PERSONAL_FIFO_PATH  "run_tests_personal.fifo"
+
+/* Just over 1 MiB, so the length prefix has seven digits and mapping is worth it */
+#define PERSONAL_FILE_SIZE  (1048576 + 7)
+
+/* A large file signs like the same bytes in memory; files of unknown size are refused */
+static void personal_test_files(const eth_private_key_t *key) {
+    eth_hash_t hash, expected;
+    eth_signature_t signature, expected_signature;
+    eth_personal_ctx_t ctx;
+    eth_file_map_t map;
+    uint64_t size = 0;
+    uint8_t *message = malloc(PERSONAL_FILE_SIZE);
+    FILE *file;
+
+    TEST_CHECK(message != NULL);
+    if (!message) {
+        return;
+    }
+    for (size_t i = 0; i < PERSONAL_FILE_SIZE; i++) {
+        message[i] = (uint8_t)(i * 131 + (i >> 11));
+    }
+
+    file = fopen(PERSONAL_FILE_PATH, "wb");
+    TEST_CHECK(file != NULL);
+    if (file) {
+        TEST_CHECK(fwrite(message, 1, PERSONAL_FILE_SIZE, file) == PERSONAL_FILE_SIZE);
+        fclose(file);
+    }
+
+    TEST_CHECK(eth_personal_hash(message, PERSONAL_FILE_SIZE, &expected) == 0);
+    TEST_CHECK(eth_personal_sign(message, PERSONAL_FILE_SIZE, key, &expected_signature) == 0);
+
+    /* Uneven pieces across the Keccak block size */
+    TEST_CHECK(eth_personal_init(&ctx, PERSONAL_FILE_SIZE) == 0);
+    for (size_t offset = 0, piece = 1; offset < PERSONAL_FILE_SIZE; piece = piece * 3 % 1000 + 1) {
+        size_t length = PERSONAL_FILE_SIZE - offset < piece ? PERSONAL_FILE_SIZE - offset : piece;
+        TEST_CHECK(eth_personal_update(&ctx, message + offset, length) == 0);
+        offset += length;
+    }
+    TEST_CHECK(eth_personal_final(&ctx, &hash) == 0);
+    TEST_CHECK(memcmp(hash.data, expected.data, 32) == 0);
+
+    TEST_CHECK(eth_file_size(PERSONAL_FILE_PATH, &size) == 0 && size == PERSONAL_FILE_SIZE);
+    TEST_CHECK(eth_file_map_open(&map, PERSONAL_FILE_PATH, ETH_FILE_MAP_SEQUENTIAL) == 0);
+    TEST_CHECK(map.size == PERSONAL_FILE_SIZE && map.data && memcmp(map.data, message, PERSONAL_FILE_SIZE) == 0);
+    eth_file_map_close(&map);
+
+    memset(&hash, 0, sizeof(hash));
+    TEST_CHECK(eth_personal_sign_file(PERSONAL_FILE_PATH, key, &hash, &signature) == 0);
+    TEST_CHECK(memcmp(hash.data, expected.data, 32) == 0);
+    TEST_CHECK(memcmp(signature.data, expected_signature.data, sizeof(signature.data)) == 0);
+
+    /* An empty file is the empty message */
+    file = fopen(PERSONAL_EMPTY_PATH, "wb");
+    TEST_CHECK(file != NULL);
+    if (file) {
+        fclose(file);
+        TEST_CHECK(eth_personal_sign_file(PERSONAL_EMPTY_PATH, key, &hash, &signature) == 0);
+        TEST_CHECK_HEX(hash.data, 32, "5f35dce98ba4fba25530a026ed80b2cecdaa31091ba4958b99b52ea1d068adad");
+    }
+
+    TEST_CHECK(eth_personal_sign_file("run_tests_personal_missing.bin", key, NULL, &signature) != 0);
+
+#if defined(PERSONAL_TEST_HAVE_FIFO)
+    /* A pipe has no length to put in the prefix: it is refused, without waiting for a writer */
+    remove(PERSONAL_FIFO_PATH);
+    if (mkfifo(PERSONAL_FIFO_PATH, 0600) == 0) {
+        TEST_CHECK(eth_file_size(PERSONAL_FIFO_PATH, &size) != 0);
+        TEST_CHECK(eth_personal_sign_file(PERSONAL_FIFO_PATH, key, NULL, &signature) != 0);
+        remove(PERSONAL_FIFO_PATH);
+    }
+    TEST_CHECK(eth_personal_sign_file("/dev/null", key, NULL, &signature) != 0);
+#endif
+
+    remove(PERSONAL_FILE_PATH);
+    remove(PERSONAL_EMPTY_PATH);
+    free(message);
+}
+
+/* personal_sign of "hello" (EIP-191 version 0x45) with key 0x11...11 */
+void test_personal_sign(void) {
+    static const char hello_hash[] = "50b2c43fd39106bafbba0da34fc430e1f91e3c96ea2acee2bc34119f92b37750";
+    static const char hello_signature[] =
+        "9208d5f86a1f5d9c1908dbb42969925675ceb388616fc5b186c248e4967a03e0"
+        "2e9d28a1adcb8cce60ebcef9756dee20522a2987afea3055f4edd8380d425f89";
+    eth_private_key_t key;
+    eth_signature_t signature;
+    eth_personal_ctx_t ctx;
+    eth_hash_t hash;
+
+    memset(key.data, 0x11, sizeof(key.data));
+
+    TEST_CHECK(eth_personal_hash((const uint8_t *)"hello", 5, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, hello_hash);
+
+    TEST_CHECK(eth_personal_hash((const uint8_t *)"", 0, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, "5f35dce98ba4fba25530a026ed80b2cecdaa31091ba4958b99b52ea1d068adad");
+
+    /* Streaming in pieces gives the same hash */
+    TEST_CHECK(eth_personal_init(&ctx, 5) == 0);
+    TEST_CHECK(eth_personal_update(&ctx, (const uint8_t *)"he", 2) == 0);
+    TEST_CHECK(eth_personal_update(&ctx, (const uint8_t *)"llo", 3) == 0);
+    TEST_CHECK(eth_personal_final(&ctx, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, hello_hash);
+
+    /* More bytes than announced in the prefix is an error */
+    TEST_CHECK(eth_personal_init(&ctx, 4) == 0);
+    TEST_CHECK(eth_personal_update(&ctx, (const uint8_t *)"hello", 5) != 0);
+
+    TEST_CHECK(eth_personal_sign((const uint8_t *)"hello", 5, &key, &signature) == 0);
+    TEST_CHECK_HEX(signature.data, sizeof(signature.data), hello_signature);
+
+    /* Same signature from a stream of known length, and a short stream fails */
+    FILE *stream = tmpfile();
+    TEST_CHECK(stream != NULL);
+    if (stream) {
+        TEST_CHECK(fwrite("hello", 1, 5, stream) == 5);
+        rewind(stream);
+        memset(&signature, 0, sizeof(signature));
+        TEST_CHECK(eth_personal_sign_stream(stream, 5, &key, &hash, &signature) == 0);
+        TEST_CHECK_HEX(hash.data, 32, hello_hash);
+        TEST_CHECK_HEX(signature.data, sizeof(signature.data), hello_signature);
+
+        rewind(stream);
+        TEST_CHECK(eth_personal_sign_stream(stream, 6, &key, NULL, &signature) != 0);
+        fclose(stream);
+    }
+
+    personal_test_files(&key);
+}
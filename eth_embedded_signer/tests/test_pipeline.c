@@ -0,0 +1,143 @@
+#include <string.h>
+#include "test.h"
+#include "../include/pipeline.h"
+
+/* More jobs than the window, so submitters block on backpressure */
+#define PIPELINE_TEST_JOBS   96
+#define PIPELINE_TEST_WINDOW 8
+
+/* Where the nonce manager starts the sender */
+#define PIPELINE_TEST_FIRST_NONCE 1000
+
+/* Every job sent to chain 5 is denied by the policy */
+#define PIPELINE_TEST_DENIED 7
+
+typedef struct {
+    uint64_t next;      /* Sequence number the next emit should carry */
+    unsigned out_of_order;
+    unsigned emitted;
+} pipeline_test_log_t;
+
+static void pipeline_test_emit(eth_pipeline_job_t *job, void *context) {
+    pipeline_test_log_t *log = context;
+
+    if ((uint64_t)(size_t)job->user_data != log->next) {
+        log->out_of_order++;
+    }
+    log->next++;
+    log->emitted++;
+}
+
+/* A transfer for job i; every PIPELINE_TEST_DENIED-th one goes to chain 5 */
+static void pipeline_test_tx(eth_transaction_t *tx, size_t i) {
+    uint8_t to[20];
+    eth_u256_t value;
+
+    memset(to, 0x35, sizeof(to));
+    eth_tx_init(tx, (eth_tx_type_t)(i % 3));
+    eth_tx_set_nonce(tx, i);
+    eth_tx_set_chain_id(tx, i % PIPELINE_TEST_DENIED == PIPELINE_TEST_DENIED - 1 ? 5 : 1);
+    eth_tx_set_gas_limit(tx, 21000 + i);
+    eth_tx_set_to(tx, to);
+    eth_u256_set_u64(&value, 1000 + i);
+    eth_tx_set_value(tx, &value);
+    eth_u256_set_u64(&value, 1000000000);
+    eth_tx_set_gas_price(tx, &value);
+    eth_tx_set_max_priority_fee(tx, &value);
+    eth_u256_set_u64(&value, 2000000000);
+    eth_tx_set_max_fee(tx, &value);
+}
+
+/* Sign everything through a pipeline; with a nonce manager the nonces come from it */
+static void pipeline_test_run(const eth_policy_t *policy, eth_nonce_manager_t *nonces) {
+    static eth_transaction_t txs[PIPELINE_TEST_JOBS];
+    static eth_pipeline_job_t jobs[PIPELINE_TEST_JOBS];
+    static uint8_t outputs[PIPELINE_TEST_JOBS][256];
+    eth_pipeline_config_t config;
+    eth_pipeline_t pipeline;
+    pipeline_test_log_t log;
+    eth_private_key_t key;
+    eth_address_t sender;
+
+    memset(key.data, 0x46, sizeof(key.data));
+    memset(sender.data, 0x9d, sizeof(sender.data));
+    memset(&log, 0, sizeof(log));
+    if (nonces) {
+        eth_nonce_set(nonces, &sender, PIPELINE_TEST_FIRST_NONCE);
+    }
+
+    eth_pipeline_config_default(&config);
+    config.max_in_flight = PIPELINE_TEST_WINDOW;
+    config.encode_threads = 2;
+    config.sign_threads = 3;
+    config.emit_threads = 2;
+    config.emit = pipeline_test_emit;
+    config.emit_context = &log;
+    if (eth_pipeline_init(&pipeline, &config) != 0) {
+        TEST_CHECK(!"pipeline starts");
+        return;
+    }
+
+    for (size_t i = 0; i < PIPELINE_TEST_JOBS; i++) {
+        pipeline_test_tx(&txs[i], i);
+        memset(&jobs[i], 0, sizeof(jobs[i]));
+        jobs[i].tx = &txs[i];
+        jobs[i].private_key = &key;
+        jobs[i].output = outputs[i];
+        jobs[i].output_size = sizeof(outputs[i]);
+        jobs[i].user_data = (void *)i;
+        jobs[i].policy = policy;
+        jobs[i].nonces = nonces;
+        jobs[i].sender = &sender;
+        TEST_CHECK(eth_pipeline_submit(&pipeline, &jobs[i]) == 0);
+    }
+
+    /* Nothing is left in flight after a drain */
+    TEST_CHECK(eth_pipeline_drain(&pipeline) == 0);
+    TEST_CHECK(log.emitted == PIPELINE_TEST_JOBS && log.out_of_order == 0);
+    eth_pipeline_destroy(&pipeline);
+
+    for (size_t i = 0; i < PIPELINE_TEST_JOBS; i++) {
+        int denied = policy && i % PIPELINE_TEST_DENIED == PIPELINE_TEST_DENIED - 1;
+
+        if (denied) {
+            TEST_CHECK(jobs[i].status == ETH_POLICY_DENIED);
+            TEST_CHECK(jobs[i].policy_result == ETH_POLICY_UNKNOWN_CHAIN);
+            TEST_CHECK(jobs[i].output_len == 0);
+            continue;
+        }
+
+        /* Nonces are handed out in submission order */
+        if (nonces) {
+            TEST_CHECK(txs[i].nonce == PIPELINE_TEST_FIRST_NONCE + i);
+        }
+
+        /* Same bytes as signing the transaction directly */
+        eth_transaction_t expected;
+        uint8_t raw[256];
+        size_t raw_len = 0;
+
+        pipeline_test_tx(&expected, i);
+        eth_tx_set_nonce(&expected, txs[i].nonce);
+        TEST_CHECK(eth_tx_sign(&expected, &key) == 0);
+        TEST_CHECK(eth_tx_encode_signed(&expected, raw, sizeof(raw), &raw_len) == 0);
+        TEST_CHECK(jobs[i].status == 0);
+        TEST_CHECK(jobs[i].output_len == raw_len && memcmp(jobs[i].output, raw, raw_len) == 0);
+    }
+}
+
+void test_pipeline(void) {
+    static const char rules[] = "allow any\nchain 1\nselector any\n";
+    eth_nonce_manager_t nonces;
+    eth_policy_t policy;
+
+    pipeline_test_run(NULL, NULL);
+
+    TEST_CHECK(eth_nonce_manager_init(&nonces, 16) == 0);
+    pipeline_test_run(NULL, &nonces);
+    eth_nonce_manager_free(&nonces);
+
+    TEST_CHECK(eth_policy_load(&policy, rules, sizeof(rules) - 1) == 0);
+    pipeline_test_run(&policy, NULL);
+    eth_policy_free(&policy);
+}
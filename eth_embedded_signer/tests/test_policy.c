@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/policy.h"
+
+static const char policy_rules[] =
+    "# Treasury policy\n"
+    "allow 0x1111111111111111111111111111111111111111\n"
+    "allow 0x2222222222222222222222222222222222222222   # token contract\n"
+    "\n"
+    "chain 1 value 1000000000000000000 gas 100000 fee 0x174876e800\n"
+    "chain 137\n"
+    "selector transfer(address,uint256) max_amount 1000 recipient_allowlisted\n"
+    "selector 0x095ea7b3\n";
+
+/* A transfer of 'value' wei to an address filled with 'to', on chain 1, inside every cap */
+static void policy_test_tx(eth_transaction_t *tx, uint8_t to, uint64_t value) {
+    eth_u256_t amount;
+
+    eth_tx_init(tx, ETH_EIP1559_TX);
+    eth_tx_set_chain_id(tx, 1);
+    eth_tx_set_gas_limit(tx, 100000);
+    if (to) {
+        memset(tx->to, to, sizeof(tx->to));
+        tx->to_len = 20;
+    }
+    eth_u256_set_u64(&amount, value);
+    eth_tx_set_value(tx, &amount);
+    eth_u256_set_u64(&amount, 100000000000ULL);
+    eth_tx_set_max_fee(tx, &amount);
+    eth_tx_set_max_priority_fee(tx, &amount);
+}
+
+/* Token call calldata: selector, recipient filled with 'to', amount */
+static void policy_token_call(uint8_t calldata[68], uint32_t selector, uint8_t to, uint64_t amount) {
+    memset(calldata, 0, 68);
+    for (int i = 0; i < 4; i++) {
+        calldata[i] = (uint8_t)(selector >> (24 - 8 * i));
+    }
+    memset(calldata + 16, to, 20);
+    for (int i = 0; i < 8; i++) {
+        calldata[67 - i] = (uint8_t)(amount >> (8 * i));
+    }
+}
+
+/* Check and return the reason */
+static eth_policy_result_t policy_reason(const eth_policy_t *policy, const eth_transaction_t *tx) {
+    eth_policy_result_t result = ETH_POLICY_OK;
+    int status = eth_policy_check(policy, tx, &result);
+
+    TEST_CHECK(status == (result == ETH_POLICY_OK ? 0 : ETH_POLICY_DENIED));
+    return result;
+}
+
+/* Every reason a transaction can be denied for, and what gets through */
+static void policy_test_rules(void) {
+    eth_policy_t policy;
+    eth_transaction_t tx;
+    eth_u256_t amount;
+    uint8_t calldata[68];
+
+    if (eth_policy_load(&policy, policy_rules, sizeof(policy_rules) - 1) != 0) {
+        TEST_CHECK(!"policy loads");
+        return;
+    }
+
+    policy_test_tx(&tx, 0x11, 1000000000000000000ULL);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_OK);
+
+    /* Chain, destination and creation */
+    eth_tx_set_chain_id(&tx, 5);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_UNKNOWN_CHAIN);
+    policy_test_tx(&tx, 0x33, 1);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_DESTINATION);
+    policy_test_tx(&tx, 0, 0);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_CREATE);
+
+    /* Caps of chain 1, one above each */
+    policy_test_tx(&tx, 0x11, 1000000000000000001ULL);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_VALUE);
+    policy_test_tx(&tx, 0x11, 1);
+    eth_tx_set_gas_limit(&tx, 100001);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_GAS);
+    policy_test_tx(&tx, 0x11, 1);
+    eth_u256_set_u64(&amount, 100000000001ULL);
+    eth_tx_set_max_fee(&tx, &amount);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_FEE);
+
+    /* Legacy transactions are capped on the gas price */
+    eth_tx_init(&tx, ETH_LEGACY_TX);
+    eth_tx_set_chain_id(&tx, 1);
+    memset(tx.to, 0x11, sizeof(tx.to));
+    tx.to_len = 20;
+    eth_tx_set_gas_price(&tx, &amount);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_FEE);
+
+    /* Chain 137 has no caps */
+    policy_test_tx(&tx, 0x11, 0);
+    eth_tx_set_chain_id(&tx, 137);
+    memset(amount.limb, 0xff, sizeof(amount.limb));
+    eth_tx_set_value(&tx, &amount);
+    eth_tx_set_gas_limit(&tx, 30000000);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_OK);
+
+    /* Token transfers: amount capped, recipient allowlisted */
+    policy_test_tx(&tx, 0x22, 0);
+    policy_token_call(calldata, 0xa9059cbb, 0x11, 1000);
+    eth_tx_set_data(&tx, calldata, sizeof(calldata));
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_OK);
+    policy_token_call(calldata, 0xa9059cbb, 0x11, 1001);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_TOKEN_AMOUNT);
+    policy_token_call(calldata, 0xa9059cbb, 0x33, 1);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_TOKEN_RECIPIENT);
+    policy_token_call(calldata, 0xa9059cbb, 0x11, 1);
+    eth_tx_set_data(&tx, calldata, sizeof(calldata) - 1);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_CALLDATA);
+
+    /* approve is listed without limits; anything else is not listed */
+    policy_token_call(calldata, 0x095ea7b3, 0x33, 1ULL << 60);
+    eth_tx_set_data(&tx, calldata, sizeof(calldata));
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_OK);
+    policy_token_call(calldata, 0x23b872dd, 0x11, 1);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_SELECTOR);
+
+    /* Denied transactions are not signed */
+    eth_private_key_t key;
+    eth_policy_result_t result = ETH_POLICY_OK;
+    uint8_t zero[32] = { 0 };
+    memset(key.data, 0x46, sizeof(key.data));
+    TEST_CHECK(eth_tx_sign_checked(&tx, &key, &policy, &result) == ETH_POLICY_DENIED);
+    TEST_CHECK(result == ETH_POLICY_SELECTOR && memcmp(tx.r, zero, 32) == 0 && memcmp(tx.s, zero, 32) == 0);
+    policy_token_call(calldata, 0x095ea7b3, 0x33, 1);
+    TEST_CHECK(eth_tx_sign_checked(&tx, &key, &policy, &result) == 0 && result == ETH_POLICY_OK);
+    TEST_CHECK(memcmp(tx.r, zero, 32) != 0);
+
+    eth_policy_free(&policy);
+
+    /* The wildcards */
+    static const char open_rules[] = "allow any\nallow create\nchain 1\nselector any\n";
+    TEST_CHECK(eth_policy_load(&policy, open_rules, sizeof(open_rules) - 1) == 0);
+    policy_test_tx(&tx, 0, 5);
+    policy_token_call(calldata, 0xdeadbeef, 0x44, 1);
+    eth_tx_set_data(&tx, calldata, 7);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_OK);
+    policy_test_tx(&tx, 0x44, 5);
+    TEST_CHECK(policy_reason(&policy, &tx) == ETH_POLICY_OK);
+    eth_policy_free(&policy);
+
+    /* Every reason has its own description */
+    for (int i = ETH_POLICY_OK; i <= ETH_POLICY_TOKEN_RECIPIENT; i++) {
+        const char *text = eth_policy_result_string((eth_policy_result_t)i);
+        TEST_CHECK(text != NULL && text[0] != '\0');
+        for (int j = ETH_POLICY_OK; j < i; j++) {
+            TEST_CHECK(strcmp(text, eth_policy_result_string((eth_policy_result_t)j)) != 0);
+        }
+    }
+}
+
+/* A large allowlist: every entry found, nothing else */
+static void policy_test_allowlist(void) {
+    enum { POLICY_TEST_ADDRESSES = 5000 };
+    size_t size = POLICY_TEST_ADDRESSES * 52 + 16;
+    char *rules = malloc(size);
+    size_t length = 0;
+    eth_policy_t policy;
+    uint8_t address[20];
+
+    if (!rules) {
+        TEST_CHECK(!"allowlist fits in memory");
+        return;
+    }
+
+    /* Addresses that differ in a few bytes only */
+    for (unsigned i = 0; i < POLICY_TEST_ADDRESSES; i++) {
+        length += (size_t)snprintf(rules + length, size - length,
+                                   "allow 0x00000000%08x0000000000000000%08x\n", i, i * 7);
+    }
+    length += (size_t)snprintf(rules + length, size - length, "chain 1\n");
+
+    TEST_CHECK(eth_policy_load(&policy, rules, length) == 0);
+    TEST_CHECK(policy.address_count == POLICY_TEST_ADDRESSES);
+
+    unsigned found = 0, false_hits = 0;
+    for (unsigned i = 0; i < POLICY_TEST_ADDRESSES; i++) {
+        memset(address, 0, sizeof(address));
+        for (int b = 0; b < 4; b++) {
+            address[4 + b] = (uint8_t)(i >> (24 - 8 * b));
+            address[16 + b] = (uint8_t)((i * 7) >> (24 - 8 * b));
+        }
+        found += (unsigned)eth_policy_allows_address(&policy, address);
+
+        /* Same high part, different low part */
+        address[19] ^= 0x80;
+        false_hits += (unsigned)eth_policy_allows_address(&policy, address);
+    }
+    TEST_CHECK(found == POLICY_TEST_ADDRESSES && false_hits == 0);
+
+    eth_policy_free(&policy);
+    free(rules);
+}
+
+void test_policy(void) {
+    eth_policy_t policy;
+
+    policy_test_rules();
+    policy_test_allowlist();
+
+    /* Bad lines are refused with their line number */
+    static const struct {
+        const char *text;
+        unsigned line;
+    } broken[] = {
+        { "allow 0x1234\n", 1 },
+        { "chain 1\n\nchain\n", 3 },
+        { "chain 1 value\n", 1 },
+        { "chain 1\nselector 0x1234\n", 2 },
+        { "# ok\nallow everyone\n", 2 },
+        { "chain 1\nfrobnicate\n", 2 },
+        { "chain 1\nselector transfer(address,uint256) max_amount\n", 2 },
+    };
+    for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); i++) {
+        TEST_CHECK(eth_policy_load(&policy, broken[i].text, strlen(broken[i].text)) != 0);
+        TEST_CHECK(policy.error_line == broken[i].line);
+    }
+}
@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/pubkey.h"
+
+#define PUBKEY_TEST_COUNT 257
+
+/* The generator, and its negation (same x, odd y) */
+static void pubkey_test_generator(void) {
+    eth_private_key_t one, minus_one;
+    eth_public_key_t generator, negated, decoded;
+    uint8_t compressed[ETH_PUBLIC_KEY_COMPRESSED_SIZE];
+
+    memset(one.data, 0, sizeof(one.data));
+    one.data[31] = 1;
+    test_hex_bytes("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+                   minus_one.data, sizeof(minus_one.data));
+    TEST_CHECK(eth_private_key_to_public_key(&one, &generator) == 0);
+    TEST_CHECK(eth_private_key_to_public_key(&minus_one, &negated) == 0);
+
+    TEST_CHECK(eth_public_key_compress(&generator, compressed) == 0);
+    TEST_CHECK_HEX(compressed, sizeof(compressed), "0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+    TEST_CHECK(eth_public_key_decompress(compressed, &decoded) == 0);
+    TEST_CHECK_HEX(decoded.data, 64,
+                   "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"
+                   "483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8");
+
+    TEST_CHECK(eth_public_key_compress(&negated, compressed) == 0);
+    TEST_CHECK_HEX(compressed, sizeof(compressed), "0379be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+    TEST_CHECK(eth_public_key_decompress(compressed, &decoded) == 0);
+    TEST_CHECK(memcmp(decoded.data, negated.data, sizeof(decoded.data)) == 0);
+}
+
+/* Compressed keys that must be refused: bad prefixes, x >= p, x^3 + 7 not a square */
+static void pubkey_test_invalid(void) {
+    static const char *const invalid[] = {
+        "0479be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798",
+        "0079be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798",
+        "02fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc30",
+        "03ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+        "020000000000000000000000000000000000000000000000000000000000000005",
+        "030000000000000000000000000000000000000000000000000000000000000000",
+    };
+    uint8_t compressed[ETH_PUBLIC_KEY_COMPRESSED_SIZE];
+    eth_public_key_t decoded;
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        test_hex_bytes(invalid[i], compressed, sizeof(compressed));
+        TEST_CHECK(eth_public_key_decompress(compressed, &decoded) != 0);
+    }
+
+    /* x = 1 is on the curve, with either parity */
+    test_hex_bytes("020000000000000000000000000000000000000000000000000000000000000001", compressed, sizeof(compressed));
+    TEST_CHECK(eth_public_key_decompress(compressed, &decoded) == 0 && (decoded.data[63] & 1) == 0);
+    compressed[0] = 0x03;
+    TEST_CHECK(eth_public_key_decompress(compressed, &decoded) == 0 && (decoded.data[63] & 1) == 1);
+}
+
+/* Batches round trip, with any thread count, and flag the entries that are broken */
+static void pubkey_test_batch(void) {
+    eth_public_key_t *keys = malloc(PUBKEY_TEST_COUNT * sizeof(*keys));
+    eth_public_key_t *decoded = malloc(PUBKEY_TEST_COUNT * sizeof(*decoded));
+    uint8_t *compressed = malloc(PUBKEY_TEST_COUNT * ETH_PUBLIC_KEY_COMPRESSED_SIZE);
+    uint8_t valid[PUBKEY_TEST_COUNT];
+
+    TEST_CHECK(keys && decoded && compressed);
+    if (!keys || !decoded || !compressed) {
+        free(keys);
+        free(decoded);
+        free(compressed);
+        return;
+    }
+
+    for (size_t i = 0; i < PUBKEY_TEST_COUNT; i++) {
+        eth_private_key_t key;
+        memset(key.data, 0, sizeof(key.data));
+        key.data[0] = 0x5a;
+        key.data[30] = (uint8_t)(i >> 8);
+        key.data[31] = (uint8_t)i;
+        TEST_CHECK(eth_private_key_to_public_key(&key, &keys[i]) == 0);
+    }
+
+    TEST_CHECK(eth_public_key_compress_batch(keys, PUBKEY_TEST_COUNT, compressed) == 0);
+    for (size_t i = 0; i < PUBKEY_TEST_COUNT; i++) {
+        uint8_t single[ETH_PUBLIC_KEY_COMPRESSED_SIZE];
+        TEST_CHECK(eth_public_key_compress(&keys[i], single) == 0);
+        TEST_CHECK(memcmp(single, compressed + i * ETH_PUBLIC_KEY_COMPRESSED_SIZE, sizeof(single)) == 0);
+    }
+
+    for (unsigned threads = 0; threads <= 4; threads += 2) {
+        memset(decoded, 0xee, PUBKEY_TEST_COUNT * sizeof(*decoded));
+        memset(valid, 0xee, sizeof(valid));
+        TEST_CHECK(eth_public_key_decompress_batch(compressed, PUBKEY_TEST_COUNT, threads, decoded, valid) == 0);
+        TEST_CHECK(memcmp(decoded, keys, PUBKEY_TEST_COUNT * sizeof(*keys)) == 0);
+        for (size_t i = 0; i < PUBKEY_TEST_COUNT; i++) {
+            TEST_CHECK(valid[i] == 1);
+        }
+    }
+
+    /* Break a few entries: the rest still decode */
+    compressed[3 * ETH_PUBLIC_KEY_COMPRESSED_SIZE] = 0x04;
+    memset(compressed + 100 * ETH_PUBLIC_KEY_COMPRESSED_SIZE + 1, 0xff, 32);
+    TEST_CHECK(eth_public_key_decompress_batch(compressed, PUBKEY_TEST_COUNT, 3, decoded, valid) ==
+               ETH_PUBLIC_KEY_INVALID_ENTRIES);
+    uint8_t zero[sizeof(eth_public_key_t)] = { 0 };
+    for (size_t i = 0; i < PUBKEY_TEST_COUNT; i++) {
+        int broken = i == 3 || i == 100;
+        TEST_CHECK(valid[i] == !broken);
+        TEST_CHECK(memcmp(&decoded[i], broken ? (const void *)zero : (const void *)&keys[i], sizeof(zero)) == 0);
+    }
+    TEST_CHECK(eth_public_key_decompress_batch(compressed, PUBKEY_TEST_COUNT, 1, decoded, NULL) ==
+               ETH_PUBLIC_KEY_INVALID_ENTRIES);
+
+    free(keys);
+    free(decoded);
+    free(compressed);
+}
+
+void test_pubkey(void) {
+    pubkey_test_generator();
+    pubkey_test_invalid();
+    pubkey_test_batch();
+}
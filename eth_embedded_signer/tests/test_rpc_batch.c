@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/rpc_batch.h"
+#include "../include/batch_sign.h"
+#include "../include/tx_file.h"
+#include "../include/policy.h"
+
+/* Signed EIP-155 example transaction (chain 1) */
+static const char rpc_raw_hex[] =
+    "f86c098504a817c800825208943535353535353535353535353535353535353535880de0b6b3a76400008025"
+    "a028ef61340bd939bc2195fe537567866003e1a15d3c71ff63e1590620aa636276"
+    "a067cbe9d8997f761aecb703304b3800ccf555c9f3dc64214b297fb1966a3b6d83";
+
+#define RPC_RAW_LEN ((sizeof(rpc_raw_hex) - 1) / 2)
+
+/* Scratch files for the end-to-end check, in the working directory */
+#define RPC_INPUT_PATH "run_tests_rpc_input.bin"
+#define RPC_HEX_PATH   "run_tests_rpc_output.hex"
+#define RPC_JSON_PATH  "run_tests_rpc_output.json"
+
+/* Append one request as the JSON-RPC spec spells it out */
+static size_t rpc_expected_request(char *out, size_t size, char separator, unsigned long long id, const char *hex) {
+    int length = snprintf(out, size,
+                          "%c{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"eth_sendRawTransaction\",\"params\":[\"0x%s\"]}",
+                          separator, id, hex);
+    return length < 0 ? 0 : (size_t)length;
+}
+
+/* Framing, ids, skips and running out of room in one buffer or in segments */
+static void rpc_test_builder(void) {
+    uint8_t raw[RPC_RAW_LEN];
+    char expected[2048], buffer[2048];
+    eth_rpc_batch_t batch;
+    size_t length = 0, used = 0, total = 0;
+
+    test_hex_bytes(rpc_raw_hex, raw, sizeof(raw));
+
+    /* Ids carry into a new digit, and a skip uses one up */
+    length = rpc_expected_request(expected, sizeof(expected), '[', 99, rpc_raw_hex);
+    length += rpc_expected_request(expected + length, sizeof(expected) - length, ',', 100, rpc_raw_hex);
+    length += rpc_expected_request(expected + length, sizeof(expected) - length, ',', 102, rpc_raw_hex);
+    expected[length++] = ']';
+
+    TEST_CHECK(eth_rpc_batch_init(&batch, buffer, sizeof(buffer), 99) == 0);
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == 0);
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == 0);
+    eth_rpc_batch_skip(&batch);
+    TEST_CHECK(eth_rpc_batch_next_id(&batch) == 102);
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == 0);
+    TEST_CHECK(eth_rpc_batch_finish(&batch, &used, &total) == 0);
+    TEST_CHECK(used == 1 && total == length);
+    TEST_CHECK(total == length && memcmp(buffer, expected, length) == 0);
+    TEST_CHECK(total == eth_rpc_request_size(sizeof(raw), 99) + eth_rpc_request_size(sizeof(raw), 100) +
+                        eth_rpc_request_size(sizeof(raw), 102) + 1);
+
+    /* An empty batch is "[]" */
+    TEST_CHECK(eth_rpc_batch_init(&batch, buffer, 2, 0) == 0);
+    TEST_CHECK(eth_rpc_batch_finish(&batch, NULL, &total) == 0);
+    TEST_CHECK(total == 2 && memcmp(buffer, "[]", 2) == 0);
+
+    /* Exactly one request fits: the next one reports full, the batch stays valid */
+    size_t one = eth_rpc_request_size(sizeof(raw), 7) + 1;
+    TEST_CHECK(eth_rpc_batch_init(&batch, buffer, one, 7) == 0);
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == 0);
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == ETH_RPC_BATCH_FULL);
+    TEST_CHECK(eth_rpc_batch_next_id(&batch) == 8);
+    TEST_CHECK(eth_rpc_batch_finish(&batch, NULL, &total) == 0);
+    length = rpc_expected_request(expected, sizeof(expected), '[', 7, rpc_raw_hex);
+    expected[length++] = ']';
+    TEST_CHECK(total == length && memcmp(buffer, expected, length) == 0);
+
+    /* A request larger than the whole buffer is an error, not "full" */
+    TEST_CHECK(eth_rpc_batch_init(&batch, buffer, one - 1, 7) == 0);
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) < 0);
+
+    /* Segments sized for one request each: requests never straddle two */
+    static char segment_memory[3][512];
+    struct iovec segments[3];
+    for (size_t i = 0; i < 3; i++) {
+        segments[i].iov_base = segment_memory[i];
+        segments[i].iov_len = eth_rpc_request_size(sizeof(raw), 8 + i) + 1;
+    }
+    TEST_CHECK(eth_rpc_batch_init_segments(&batch, segments, 3, 8) == 0);
+    for (size_t i = 0; i < 3; i++) {
+        TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == 0);
+    }
+    TEST_CHECK(eth_rpc_batch_add(&batch, raw, sizeof(raw)) == ETH_RPC_BATCH_FULL);
+    TEST_CHECK(eth_rpc_batch_finish(&batch, &used, &total) == 0);
+    TEST_CHECK(used == 3);
+
+    length = 0;
+    for (size_t i = 0; i < 3; i++) {
+        length += rpc_expected_request(expected + length, sizeof(expected) - length, i ? ',' : '[', 8 + i, rpc_raw_hex);
+    }
+    expected[length++] = ']';
+
+    /* Gathered like writev would */
+    size_t gathered = 0;
+    for (size_t i = 0; i < used; i++) {
+        memcpy(buffer + gathered, segments[i].iov_base, segments[i].iov_len);
+        gathered += segments[i].iov_len;
+    }
+    TEST_CHECK(gathered == total && total == length && memcmp(buffer, expected, length) == 0);
+}
+
+/* Read a whole file into a NUL-terminated buffer */
+static char *rpc_read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    char *data = NULL;
+    long length;
+
+    if (!file) {
+        return NULL;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)length + 1);
+        if (data && fread(data, 1, (size_t)length, file) == (size_t)length) {
+            data[length] = '\0';
+            *size = (size_t)length;
+        } else {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    fclose(file);
+    return data;
+}
+
+/*
+ * Check --rpc output against --hex output of the same input: every line is one
+ * JSON array of at most batch_size requests, request i carries id i and the
+ * raw transaction of hex line i, and failed transactions (empty hex lines) are
+ * left out. Returns the number of JSON lines, -1 if they do not match.
+ */
+static int rpc_check_against_hex(const char *hex, const char *json, unsigned batch_size) {
+    static char request[1 << 16];
+    unsigned long long id = 0;
+    int lines = 0;
+
+    while (*json) {
+        unsigned in_line = 0;
+        char separator = '[';
+
+        for (;;) {
+            /* Next transaction that was signed */
+            while (*hex == '\n') {
+                hex++;
+                id++;
+            }
+            if (*hex == '\0') {
+                break;
+            }
+
+            const char *end = strchr(hex, '\n');
+            if (!end || end - hex < 3 || hex[0] != '0' || hex[1] != 'x' || (size_t)(end - hex) > sizeof(request) / 2) {
+                return -1;
+            }
+
+            char digits[sizeof(request) / 2];
+            memcpy(digits, hex + 2, (size_t)(end - hex) - 2);
+            digits[end - hex - 2] = '\0';
+
+            size_t length = rpc_expected_request(request, sizeof(request), separator, id, digits);
+            if (strncmp(json, request, length) != 0) {
+                /* The line may have ended before this transaction */
+                break;
+            }
+            json += length;
+            hex = end + 1;
+            id++;
+            in_line++;
+            separator = ',';
+        }
+
+        if (in_line == 0 || in_line > batch_size || json[0] != ']' || json[1] != '\n') {
+            return -1;
+        }
+        json += 2;
+        lines++;
+    }
+
+    /* Every signed transaction made it out */
+    while (*hex == '\n') {
+        hex++;
+    }
+    return *hex == '\0' ? lines : -1;
+}
+
+/* Sign the input as hex and as JSON-RPC and compare the two */
+static int rpc_sign_both(const eth_private_key_t *key, const eth_policy_t *policy, unsigned batch_size) {
+    eth_batch_sign_options_t options;
+    char *hex, *json;
+    size_t hex_size = 0, json_size = 0;
+    int lines = -1;
+
+    memset(&options, 0, sizeof(options));
+    options.input_path = RPC_INPUT_PATH;
+    options.private_key = key;
+    options.threads = 2;
+    options.policy = policy;
+
+    options.output_path = RPC_HEX_PATH;
+    options.format = ETH_BATCH_OUTPUT_HEX;
+    eth_batch_sign_file(&options, NULL);
+
+    options.output_path = RPC_JSON_PATH;
+    options.format = ETH_BATCH_OUTPUT_RPC;
+    options.rpc_batch_size = batch_size;
+    eth_batch_sign_file(&options, NULL);
+
+    hex = rpc_read_file(RPC_HEX_PATH, &hex_size);
+    json = rpc_read_file(RPC_JSON_PATH, &json_size);
+    if (hex && json) {
+        lines = rpc_check_against_hex(hex, json, batch_size);
+    }
+
+    free(hex);
+    free(json);
+    remove(RPC_HEX_PATH);
+    remove(RPC_JSON_PATH);
+    return lines;
+}
+
+/* Write a batch file of 'count' transfers; every 'denied'-th one goes to chain 5 */
+static int rpc_write_input(size_t count, size_t denied, uint8_t *calldata, size_t calldata_len) {
+    eth_tx_file_writer_t writer;
+    uint8_t to[20];
+
+    memset(to, 0x35, sizeof(to));
+    if (eth_tx_file_writer_open(&writer, RPC_INPUT_PATH) != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        eth_transaction_t tx;
+        eth_tx_init(&tx, (eth_tx_type_t)(i % 3));
+        tx.nonce = i;
+        tx.chain_id = denied && i % denied == denied - 1 ? 5 : 1;
+        tx.gas_limit = 21000 + i;
+        tx.to_len = 20;
+        memcpy(tx.to, to, sizeof(to));
+        eth_u256_set_u64(&tx.value, 1000 + i);
+        eth_u256_set_u64(&tx.gas_price, 1000000000);
+        eth_u256_set_u64(&tx.max_fee, 2000000000);
+        eth_u256_set_u64(&tx.max_priority_fee, 1000000000);
+        tx.data = calldata;
+        tx.data_len = calldata_len;
+        eth_tx_file_writer_add(&writer, &tx);
+    }
+
+    return eth_tx_file_writer_finish(&writer);
+}
+
+void test_rpc_batch(void) {
+    static const char rules[] = "allow any\nchain 1\nselector any\n";
+    eth_private_key_t key;
+    eth_policy_t policy;
+
+    rpc_test_builder();
+
+    memset(key.data, 0x11, sizeof(key.data));
+    TEST_CHECK(eth_policy_load(&policy, rules, sizeof(rules) - 1) == 0);
+
+    /* Seven transactions, the fourth denied: batches of 2, 2 and 2 with id 3 missing */
+    TEST_CHECK(rpc_write_input(7, 4, NULL, 0) == 0);
+    TEST_CHECK(rpc_sign_both(&key, &policy, 2) == 3);
+
+    /* About 5 MB of requests in one batch overflow the 4 MB write buffer: it is split in two */
+    size_t calldata_len = 8192;
+    uint8_t *calldata = calloc(1, calldata_len);
+    TEST_CHECK(calldata != NULL);
+    if (calldata) {
+        calldata[0] = 0xa9;
+        TEST_CHECK(rpc_write_input(320, 100, calldata, calldata_len) == 0);
+        TEST_CHECK(rpc_sign_both(&key, &policy, 1000000) == 2);
+        free(calldata);
+    }
+
+    eth_policy_free(&policy);
+    remove(RPC_INPUT_PATH);
+}
@@ -0,0 +1,112 @@
+#include <string.h>
+#include "test.h"
+#include "../include/sha256.h"
+
+/* Messages of the multi-buffer check: one padded block each, so up to 55 bytes */
+#define SHA256_TEST_LANES (2 * ETH_SHA256_LANES + 1)
+
+static const uint32_t sha256_test_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/* FIPS 180-4 examples */
+static void sha256_test_vectors(void) {
+    static const char two_blocks[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    static uint8_t million[1000000];
+    eth_sha256_ctx_t ctx;
+    uint8_t digest[32];
+
+    eth_sha256((const uint8_t *)"abc", 3, digest);
+    TEST_CHECK_HEX(digest, 32, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    eth_sha256(NULL, 0, digest);
+    TEST_CHECK_HEX(digest, 32, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    eth_sha256((const uint8_t *)two_blocks, sizeof(two_blocks) - 1, digest);
+    TEST_CHECK_HEX(digest, 32, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    /* One million 'a', in one call and in pieces that straddle blocks */
+    memset(million, 'a', sizeof(million));
+    eth_sha256(million, sizeof(million), digest);
+    TEST_CHECK_HEX(digest, 32, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    eth_sha256_init(&ctx);
+    for (size_t offset = 0, piece = 1; offset < sizeof(million); piece = piece % 200 + 7) {
+        size_t length = sizeof(million) - offset < piece ? sizeof(million) - offset : piece;
+        eth_sha256_update(&ctx, million + offset, length);
+        offset += length;
+    }
+    eth_sha256_final(&ctx, digest);
+    TEST_CHECK_HEX(digest, 32, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+/* Lanes of the multi-buffer kernel each give the digest of their own message */
+static void sha256_test_multi(void) {
+    uint8_t blocks[SHA256_TEST_LANES][ETH_SHA256_BLOCK_SIZE];
+    const uint8_t *pointers[SHA256_TEST_LANES];
+    uint32_t states[SHA256_TEST_LANES][8];
+
+    for (size_t count = 1; count <= SHA256_TEST_LANES; count++) {
+        int mismatches = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            size_t length = (i * 13 + count) % 56;
+            memset(blocks[i], 0, sizeof(blocks[i]));
+            for (size_t j = 0; j < length; j++) {
+                blocks[i][j] = (uint8_t)(i * 7 + j);
+            }
+            blocks[i][length] = 0x80;
+            blocks[i][62] = (uint8_t)(length * 8 >> 8);
+            blocks[i][63] = (uint8_t)(length * 8);
+            pointers[i] = blocks[i];
+            memcpy(states[i], sha256_test_iv, sizeof(sha256_test_iv));
+        }
+
+        eth_sha256_compress_multi(states, pointers, count);
+
+        for (size_t i = 0; i < count; i++) {
+            size_t length = (i * 13 + count) % 56;
+            uint8_t digest[32], lane[32];
+            eth_sha256(blocks[i], length, digest);
+            for (size_t w = 0; w < 8; w++) {
+                lane[4 * w] = (uint8_t)(states[i][w] >> 24);
+                lane[4 * w + 1] = (uint8_t)(states[i][w] >> 16);
+                lane[4 * w + 2] = (uint8_t)(states[i][w] >> 8);
+                lane[4 * w + 3] = (uint8_t)states[i][w];
+            }
+            mismatches += memcmp(digest, lane, 32) != 0;
+        }
+        TEST_CHECK(mismatches == 0);
+    }
+}
+
+/* RFC 4231 test cases 1, 2 and 6 (key longer than a block) */
+static void sha256_test_hmac(void) {
+    static const char long_message[] = "Test Using Larger Than Block-Size Key - Hash Key First";
+    eth_hmac_sha256_ctx_t ctx;
+    uint8_t key[131], mac[32];
+
+    memset(key, 0x0b, 20);
+    eth_hmac_sha256(key, 20, (const uint8_t *)"Hi There", 8, mac);
+    TEST_CHECK_HEX(mac, 32, "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+
+    eth_hmac_sha256((const uint8_t *)"Jefe", 4, (const uint8_t *)"what do ya want for nothing?", 28, mac);
+    TEST_CHECK_HEX(mac, 32, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    memset(key, 0xaa, sizeof(key));
+    eth_hmac_sha256(key, sizeof(key), (const uint8_t *)long_message, sizeof(long_message) - 1, mac);
+    TEST_CHECK_HEX(mac, 32, "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+
+    /* The same, streamed */
+    eth_hmac_sha256_init(&ctx, key, sizeof(key));
+    eth_hmac_sha256_update(&ctx, (const uint8_t *)long_message, 20);
+    eth_hmac_sha256_update(&ctx, (const uint8_t *)long_message + 20, sizeof(long_message) - 21);
+    eth_hmac_sha256_final(&ctx, mac);
+    TEST_CHECK_HEX(mac, 32, "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+void test_sha256(void) {
+    const char *backend = eth_sha256_backend();
+
+    TEST_CHECK(strcmp(backend, "sha-ni") == 0 || strcmp(backend, "avx2") == 0 || strcmp(backend, "scalar") == 0);
+    sha256_test_vectors();
+    sha256_test_multi();
+    sha256_test_hmac();
+}
@@ -0,0 +1,119 @@
+#include <string.h>
+#include <poll.h>
+#include "test.h"
+#include "../include/sign_queue.h"
+
+/* More jobs than slots, so submit reports full and the loop has to poll */
+#define SIGN_QUEUE_TEST_JOBS  64
+#define SIGN_QUEUE_TEST_DEPTH 8
+
+/* Every job sent to chain 5 is denied by the policy */
+#define SIGN_QUEUE_TEST_DENIED 5
+
+/* A transfer for job i; every SIGN_QUEUE_TEST_DENIED-th one goes to chain 5 */
+static void sign_queue_test_tx(eth_transaction_t *tx, size_t i) {
+    uint8_t to[20];
+    eth_u256_t value;
+
+    memset(to, 0x35, sizeof(to));
+    eth_tx_init(tx, (eth_tx_type_t)(i % 3));
+    eth_tx_set_nonce(tx, i);
+    eth_tx_set_chain_id(tx, i % SIGN_QUEUE_TEST_DENIED == SIGN_QUEUE_TEST_DENIED - 1 ? 5 : 1);
+    eth_tx_set_gas_limit(tx, 21000);
+    eth_tx_set_to(tx, to);
+    eth_u256_set_u64(&value, 1 + i);
+    eth_tx_set_value(tx, &value);
+    eth_u256_set_u64(&value, 1000000000);
+    eth_tx_set_gas_price(tx, &value);
+    eth_tx_set_max_priority_fee(tx, &value);
+    eth_tx_set_max_fee(tx, &value);
+}
+
+void test_sign_queue(void) {
+    static const char rules[] = "allow any\nchain 1\nselector any\n";
+    static eth_transaction_t txs[SIGN_QUEUE_TEST_JOBS];
+    static eth_sign_job_t jobs[SIGN_QUEUE_TEST_JOBS];
+    static uint8_t outputs[SIGN_QUEUE_TEST_JOBS][256];
+    unsigned char seen[SIGN_QUEUE_TEST_JOBS];
+    eth_sign_completion_t completions[4];
+    eth_sign_queue_t queue;
+    eth_policy_t policy;
+    eth_private_key_t key;
+    size_t submitted = 0, completed = 0;
+    int full = 0;
+
+    memset(key.data, 0x46, sizeof(key.data));
+    memset(seen, 0, sizeof(seen));
+    TEST_CHECK(eth_policy_load(&policy, rules, sizeof(rules) - 1) == 0);
+    if (eth_sign_queue_init(&queue, 3, SIGN_QUEUE_TEST_DEPTH) != 0) {
+        TEST_CHECK(!"sign queue starts");
+        eth_policy_free(&policy);
+        return;
+    }
+
+    while (completed < SIGN_QUEUE_TEST_JOBS) {
+        while (submitted < SIGN_QUEUE_TEST_JOBS) {
+            sign_queue_test_tx(&txs[submitted], submitted);
+            memset(&jobs[submitted], 0, sizeof(jobs[submitted]));
+            jobs[submitted].tx = &txs[submitted];
+            jobs[submitted].private_key = &key;
+            jobs[submitted].output = outputs[submitted];
+            jobs[submitted].output_size = sizeof(outputs[submitted]);
+            jobs[submitted].policy = &policy;
+
+            int result = eth_sign_queue_submit(&queue, &jobs[submitted], (void *)submitted);
+            if (result == ETH_SIGN_QUEUE_FULL) {
+                full = 1;
+                break;
+            }
+            TEST_CHECK(result == 0);
+            submitted++;
+        }
+
+        int count = eth_sign_queue_poll(&queue, completions, sizeof(completions) / sizeof(completions[0]));
+        TEST_CHECK(count >= 0);
+        if (count <= 0) {
+            /* Nothing yet: wait on the descriptor like an event loop would */
+            struct pollfd wait = { eth_sign_queue_fd(&queue), POLLIN, 0 };
+            if (wait.fd >= 0) {
+                poll(&wait, 1, 1000);
+            }
+            continue;
+        }
+
+        for (int c = 0; c < count; c++) {
+            size_t i = (size_t)completions[c].user_data;
+            int denied = i % SIGN_QUEUE_TEST_DENIED == SIGN_QUEUE_TEST_DENIED - 1;
+
+            TEST_CHECK(i < SIGN_QUEUE_TEST_JOBS && completions[c].job == &jobs[i] && !seen[i]);
+            if (i >= SIGN_QUEUE_TEST_JOBS) {
+                continue;
+            }
+            seen[i] = 1;
+            completed++;
+
+            /* The reason for a denial comes back with the completion */
+            if (denied) {
+                TEST_CHECK(completions[c].status == ETH_POLICY_DENIED);
+                TEST_CHECK(completions[c].policy_result == ETH_POLICY_UNKNOWN_CHAIN);
+                TEST_CHECK(completions[c].output_len == 0);
+                continue;
+            }
+
+            /* Same bytes as signing the transaction directly */
+            eth_transaction_t expected;
+            uint8_t raw[256];
+            size_t raw_len = 0;
+
+            sign_queue_test_tx(&expected, i);
+            TEST_CHECK(eth_tx_sign(&expected, &key) == 0);
+            TEST_CHECK(eth_tx_encode_signed(&expected, raw, sizeof(raw), &raw_len) == 0);
+            TEST_CHECK(completions[c].status == 0 && completions[c].policy_result == ETH_POLICY_OK);
+            TEST_CHECK(completions[c].output_len == raw_len && memcmp(outputs[i], raw, raw_len) == 0);
+        }
+    }
+
+    TEST_CHECK(full);
+    eth_sign_queue_destroy(&queue);
+    eth_policy_free(&policy);
+}
@@ -0,0 +1,300 @@
+#include <string.h>
+#include "test.h"
+#include "../include/transaction.h"
+
+/*
+ * The EIP-155 example transaction (nonce 9, 20 gwei, 21000 gas, 1 ether to
+ * 0x3535...35, key 0x4646...46), signed for chain 1 and for chain 137, where
+ * v no longer fits in a byte.
+ */
+static const struct {
+    uint64_t chain_id;
+    const char *sighash;
+    uint64_t v;
+    const char *raw;
+} transaction_vectors[] = {
+    {
+        1,
+        "daf5a779ae972f972197303d7b574746c7ef83eadac0f2791ad23db92e4c8e53",
+        37,
+        "f86c098504a817c800825208943535353535353535353535353535353535353535880de0b6b3a76400008025"
+        "a028ef61340bd939bc2195fe537567866003e1a15d3c71ff63e1590620aa636276"
+        "a067cbe9d8997f761aecb703304b3800ccf555c9f3dc64214b297fb1966a3b6d83"
+    },
+    {
+        137,
+        "4bc497ae18410a9c4732e6d80d4dd0fe13ead15b1b551000ee2079dc9a761a04",
+        310,
+        "f86e098504a817c800825208943535353535353535353535353535353535353535880de0b6b3a764000080820136"
+        "a00d02a2ce7ed82574448f5581c0c45a2eb0b6e2ccf6971eff1dae61b6bb1cec81"
+        "a00ce65a784c4aa7fe79935ec1fadee65e7a0238186fffd3848275dc275b26ccf1"
+    },
+};
+
+/* Fill in the EIP-155 example through the setters */
+static void transaction_example(eth_transaction_t *tx, uint64_t chain_id) {
+    static const char wei[] = "1000000000000000000";
+    uint8_t to[20];
+    eth_u256_t value;
+
+    memset(to, 0x35, sizeof(to));
+    eth_tx_set_nonce(tx, 9);
+    eth_u256_set_u64(&value, 20000000000ULL);
+    eth_tx_set_gas_price(tx, &value);
+    eth_tx_set_gas_limit(tx, 21000);
+    eth_tx_set_to(tx, to);
+    eth_u256_set_dec(&value, wei, sizeof(wei) - 1);
+    eth_tx_set_value(tx, &value);
+    eth_tx_set_chain_id(tx, chain_id);
+}
+
+/* Encodings and hash of a cached transaction match a copy without the cache */
+static void transaction_check_cached(const eth_transaction_t *cached, const eth_private_key_t *key) {
+    eth_transaction_t plain = *cached;
+    uint8_t a[512], b[512];
+    size_t a_len = 0, b_len = 0;
+    eth_hash_t a_hash, b_hash;
+
+    plain.cache = NULL;
+    TEST_CHECK(eth_tx_encode(cached, a, sizeof(a), &a_len) == 0);
+    TEST_CHECK(eth_tx_encode(&plain, b, sizeof(b), &b_len) == 0);
+    TEST_CHECK(a_len == b_len && memcmp(a, b, a_len) == 0);
+    TEST_CHECK(eth_tx_hash(cached, &a_hash) == 0 && eth_tx_hash(&plain, &b_hash) == 0);
+    TEST_CHECK(memcmp(a_hash.data, b_hash.data, sizeof(a_hash.data)) == 0);
+
+    /* Same signature (RFC 6979 is deterministic), so the signed bytes match too */
+    TEST_CHECK(eth_tx_sign_hash(&plain, &b_hash, key) == 0);
+    TEST_CHECK(eth_tx_encode_signed(&plain, b, sizeof(b), &b_len) == 0);
+    eth_transaction_t signed_copy = *cached;
+    memcpy(signed_copy.r, plain.r, sizeof(plain.r));
+    memcpy(signed_copy.s, plain.s, sizeof(plain.s));
+    signed_copy.v = plain.v;
+    TEST_CHECK(eth_tx_encode_signed(&signed_copy, a, sizeof(a), &a_len) == 0);
+    TEST_CHECK(a_len == b_len && memcmp(a, b, a_len) == 0);
+}
+
+/* Every setter, then a direct write, against the uncached result; the const functions never touch the cache */
+static void transaction_test_cache(const eth_private_key_t *key) {
+    uint8_t calldata[80], to[20];
+    eth_u256_t amount;
+
+    memset(calldata, 0xab, sizeof(calldata));
+    memset(to, 0x77, sizeof(to));
+
+    for (int type = ETH_LEGACY_TX; type <= ETH_EIP1559_TX; type++) {
+        /* A buffer big enough, and one too small so everything goes the long way */
+        static const size_t buffer_sizes[] = { 512, 16 };
+        for (size_t b = 0; b < sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); b++) {
+            eth_transaction_t tx;
+            eth_tx_cache_t cache;
+            uint8_t buffer[512];
+
+            eth_tx_init(&tx, (eth_tx_type_t)type);
+            TEST_CHECK(eth_tx_attach_cache(&tx, &cache, buffer, buffer_sizes[b]) == 0);
+            transaction_example(&tx, 1);
+
+            /* Stale: the const functions encode from the fields and leave the cache alone */
+            TEST_CHECK(cache.dirty != 0);
+            transaction_check_cached(&tx, key);
+            TEST_CHECK(cache.dirty != 0);
+
+            TEST_CHECK(eth_tx_refresh_cache(&tx) == 0 && cache.dirty == 0);
+            transaction_check_cached(&tx, key);
+
+            for (int step = 0; step < 9; step++) {
+                switch (step) {
+                case 0:
+                    eth_tx_set_nonce(&tx, 0);
+                    break;
+                case 1:
+                    eth_tx_set_nonce(&tx, 1ULL << 40);
+                    break;
+                case 2:
+                    eth_u256_set_u64(&amount, 0x80);
+                    eth_tx_set_max_fee(&tx, &amount);
+                    eth_tx_set_gas_price(&tx, &amount);
+                    break;
+                case 3:
+                    eth_u256_set_dec(&amount, "123456789012345678901234567890", 30);
+                    eth_tx_set_max_priority_fee(&tx, &amount);
+                    eth_tx_set_gas_price(&tx, &amount);
+                    break;
+                case 4:
+                    eth_tx_set_data(&tx, calldata, sizeof(calldata));
+                    break;
+                case 5:
+                    eth_tx_set_to(&tx, NULL);
+                    break;
+                case 6:
+                    eth_tx_set_chain_id(&tx, 42161);
+                    eth_tx_set_gas_limit(&tx, 1);
+                    break;
+                case 7:
+                    eth_tx_set_to(&tx, to);
+                    eth_tx_set_value(&tx, &amount);
+                    break;
+                default:
+                    /* Written directly, then flagged */
+                    tx.nonce = 5;
+                    eth_tx_invalidate(&tx);
+                    break;
+                }
+                TEST_CHECK(eth_tx_refresh_cache(&tx) == 0);
+                transaction_check_cached(&tx, key);
+            }
+        }
+    }
+
+    /* Without a cache there is nothing to refresh */
+    eth_transaction_t bare;
+    eth_tx_init(&bare, ETH_LEGACY_TX);
+    TEST_CHECK(eth_tx_refresh_cache(&bare) == 0);
+    TEST_CHECK(eth_tx_refresh_cache(NULL) != 0);
+}
+
+/* Signed encoding of the example with the given fees, built from scratch */
+static size_t transaction_fresh_signed(eth_tx_type_t type, const eth_u256_t *tip, const eth_u256_t *max_fee,
+                                       const eth_private_key_t *key, uint8_t *output, size_t output_size) {
+    eth_transaction_t tx;
+    size_t length = 0;
+
+    eth_tx_init(&tx, type);
+    transaction_example(&tx, 1);
+    if (type == ETH_EIP1559_TX) {
+        eth_tx_set_max_priority_fee(&tx, tip);
+        eth_tx_set_max_fee(&tx, max_fee);
+    } else {
+        eth_tx_set_gas_price(&tx, max_fee);
+    }
+    if (eth_tx_sign(&tx, key) != 0 || eth_tx_encode_signed(&tx, output, output_size, &length) != 0) {
+        return 0;
+    }
+    return length;
+}
+
+/* Re-signing with new fees gives the same bytes as signing the bumped transaction from scratch */
+static void transaction_test_rebump(const eth_private_key_t *key) {
+    eth_u256_t tip, max_fee;
+    uint8_t bumped[256], expected[256];
+
+    /* Fees that change the encoded length in both directions */
+    static const struct {
+        uint64_t tip;
+        uint64_t max_fee;
+    } bumps[] = {
+        { 2000000000ULL, 30000000000ULL },
+        { 0x7f, 0x80 },
+        { 1ULL << 56, UINT64_MAX },
+    };
+
+    for (int type = ETH_LEGACY_TX; type <= ETH_EIP1559_TX; type++) {
+        for (int cached = 0; cached <= 1; cached++) {
+            eth_transaction_t tx;
+            eth_tx_cache_t cache;
+            uint8_t cache_buffer[256];
+            size_t length = 0;
+
+            eth_tx_init(&tx, (eth_tx_type_t)type);
+            if (cached) {
+                TEST_CHECK(eth_tx_attach_cache(&tx, &cache, cache_buffer, sizeof(cache_buffer)) == 0);
+            }
+            transaction_example(&tx, 1);
+            TEST_CHECK(eth_tx_sign(&tx, key) == 0);
+
+            for (size_t i = 0; i < sizeof(bumps) / sizeof(bumps[0]); i++) {
+                eth_u256_set_u64(&tip, bumps[i].tip);
+                eth_u256_set_u64(&max_fee, bumps[i].max_fee);
+
+                size_t expected_len = transaction_fresh_signed((eth_tx_type_t)type, &tip, &max_fee, key,
+                                                               expected, sizeof(expected));
+                TEST_CHECK(expected_len > 0);
+                TEST_CHECK(eth_tx_rebump(&tx, &tip, &max_fee, key, bumped, sizeof(bumped), &length) == 0);
+                TEST_CHECK(length == expected_len && memcmp(bumped, expected, length) == 0);
+            }
+
+            /* EIP-1559 needs both fees; a short buffer is an error */
+            if (type == ETH_EIP1559_TX) {
+                TEST_CHECK(eth_tx_rebump(&tx, NULL, &max_fee, key, bumped, sizeof(bumped), &length) != 0);
+            }
+            TEST_CHECK(eth_tx_rebump(&tx, &tip, &max_fee, key, bumped, 10, &length) != 0);
+        }
+    }
+
+    /* A batch lands back to back, each one as if re-signed on its own */
+    eth_transaction_t txs[3];
+    uint8_t batch[3 * 256];
+    size_t offsets[4];
+    eth_u256_set_u64(&tip, 3000000000ULL);
+    eth_u256_set_u64(&max_fee, 90000000000ULL);
+    for (size_t i = 0; i < 3; i++) {
+        eth_tx_init(&txs[i], (eth_tx_type_t)i);
+        transaction_example(&txs[i], 1);
+    }
+    TEST_CHECK(eth_tx_rebump_batch(txs, 3, &tip, &max_fee, key, batch, sizeof(batch), offsets) == 0);
+    TEST_CHECK(offsets[0] == 0);
+    for (size_t i = 0; i < 3; i++) {
+        size_t expected_len = transaction_fresh_signed((eth_tx_type_t)i, &tip, &max_fee, key,
+                                                       expected, sizeof(expected));
+        TEST_CHECK(offsets[i + 1] - offsets[i] == expected_len);
+        TEST_CHECK(memcmp(batch + offsets[i], expected, expected_len) == 0);
+    }
+
+    /* Out of room part way: the offsets before the failure still hold */
+    TEST_CHECK(eth_tx_rebump_batch(txs, 3, &tip, &max_fee, key, batch, offsets[2] + 1, offsets) != 0);
+    TEST_CHECK(offsets[2] - offsets[1] > 0);
+}
+
+void test_transaction(void) {
+    eth_private_key_t key;
+    memset(key.data, 0x46, sizeof(key.data));
+
+    for (size_t i = 0; i < sizeof(transaction_vectors) / sizeof(transaction_vectors[0]); i++) {
+        /* Once without and once with the encoding cache (signed encoding built from the cached one) */
+        for (int cached = 0; cached <= 1; cached++) {
+            eth_transaction_t tx;
+            eth_tx_cache_t cache;
+            uint8_t cache_buffer[256];
+            uint8_t encoded[256];
+            size_t encoded_len = 0;
+            eth_hash_t hash;
+
+            eth_tx_init(&tx, ETH_LEGACY_TX);
+            if (cached) {
+                TEST_CHECK(eth_tx_attach_cache(&tx, &cache, cache_buffer, sizeof(cache_buffer)) == 0);
+            }
+            transaction_example(&tx, transaction_vectors[i].chain_id);
+
+            TEST_CHECK(eth_tx_hash(&tx, &hash) == 0);
+            TEST_CHECK_HEX(hash.data, 32, transaction_vectors[i].sighash);
+
+            TEST_CHECK(eth_tx_sign(&tx, &key) == 0);
+            TEST_CHECK(tx.v == transaction_vectors[i].v);
+            TEST_CHECK(eth_tx_encode_signed(&tx, encoded, sizeof(encoded), &encoded_len) == 0);
+            TEST_CHECK_HEX(encoded, encoded_len, transaction_vectors[i].raw);
+        }
+    }
+
+    /* v = chain_id * 2 + 35 + recovery ID, far past a byte and past 32 bits */
+    static const uint64_t chain_ids[] = { 110, 111, 42161, 1ULL << 40 };
+    for (size_t i = 0; i < sizeof(chain_ids) / sizeof(chain_ids[0]); i++) {
+        eth_transaction_t tx;
+        uint8_t encoded[256];
+        size_t encoded_len = 0;
+
+        eth_tx_init(&tx, ETH_LEGACY_TX);
+        transaction_example(&tx, chain_ids[i]);
+        TEST_CHECK(eth_tx_sign(&tx, &key) == 0);
+        TEST_CHECK(tx.v == chain_ids[i] * 2 + 35 || tx.v == chain_ids[i] * 2 + 36);
+        TEST_CHECK(eth_tx_encode_signed(&tx, encoded, sizeof(encoded), &encoded_len) == 0);
+    }
+
+    /* Typed transactions carry the bare recovery ID */
+    eth_transaction_t typed;
+    eth_tx_init(&typed, ETH_EIP1559_TX);
+    transaction_example(&typed, 137);
+    TEST_CHECK(eth_tx_sign(&typed, &key) == 0);
+    TEST_CHECK(typed.v <= 1);
+
+    transaction_test_cache(&key);
+    transaction_test_rebump(&key);
+}
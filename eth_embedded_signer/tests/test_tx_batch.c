@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/tx_batch.h"
+
+#define TX_BATCH_TEST_COUNT 40
+
+/* Row i: every type, contract creations, calldata from empty to past the long-list boundary */
+static void tx_batch_test_tx(eth_transaction_t *tx, size_t i, uint8_t *calldata) {
+    eth_tx_init(tx, (eth_tx_type_t)(i % 3));
+    tx->chain_id = i % 4 == 0 ? 1 : 1 + i * 977;
+    tx->nonce = i * i * 1000003;
+    tx->gas_limit = 21000 + i * 5000;
+    if (i % 5 != 4) {
+        tx->to_len = 20;
+        memset(tx->to, (int)i, sizeof(tx->to));
+    }
+    eth_u256_set_u64(&tx->value, i % 2 ? 0 : 1000000000000000000ULL * i);
+    if (i == 7) {
+        memset(tx->value.limb, 0xff, sizeof(tx->value.limb));
+    }
+    eth_u256_set_u64(&tx->gas_price, 1000000000ULL + i);
+    eth_u256_set_u64(&tx->max_fee, 2000000000ULL + i);
+    eth_u256_set_u64(&tx->max_priority_fee, i);
+    tx->data = i % 6 ? calldata : NULL;
+    tx->data_len = i % 6 ? i * 7 : 0;
+}
+
+void test_tx_batch(void) {
+    static uint8_t calldata[TX_BATCH_TEST_COUNT * 7];
+    static uint8_t encoded[TX_BATCH_TEST_COUNT * 512];
+    size_t offsets[TX_BATCH_TEST_COUNT + 1];
+    eth_hash_t hashes[TX_BATCH_TEST_COUNT];
+    eth_tx_batch_t batch;
+    eth_transaction_t tx;
+
+    for (size_t i = 0; i < sizeof(calldata); i++) {
+        calldata[i] = (uint8_t)(i * 29 + 3);
+    }
+
+    /* Starts small so the columns and heap have to grow */
+    if (eth_tx_batch_init(&batch, 2) != 0) {
+        TEST_CHECK(!"batch allocates");
+        return;
+    }
+    for (size_t i = 0; i < TX_BATCH_TEST_COUNT; i++) {
+        tx_batch_test_tx(&tx, i, calldata);
+        TEST_CHECK(eth_tx_batch_add(&batch, &tx) == 0);
+    }
+    TEST_CHECK(batch.count == TX_BATCH_TEST_COUNT);
+
+    /* Encoding, hashing and row loads all agree with the per-transaction code */
+    size_t total = eth_tx_batch_encoded_size(&batch, 0, TX_BATCH_TEST_COUNT);
+    TEST_CHECK(total > 0 && total <= sizeof(encoded));
+    TEST_CHECK(eth_tx_batch_encode(&batch, 0, TX_BATCH_TEST_COUNT, encoded, sizeof(encoded), offsets) == 0);
+    TEST_CHECK(eth_tx_batch_hash(&batch, 0, TX_BATCH_TEST_COUNT, hashes) == 0);
+    TEST_CHECK(offsets[0] == 0 && offsets[TX_BATCH_TEST_COUNT] == total);
+
+    for (size_t i = 0; i < TX_BATCH_TEST_COUNT; i++) {
+        eth_transaction_t loaded;
+        uint8_t expected[512], again[512];
+        size_t expected_len = 0, again_len = 0;
+        eth_hash_t hash;
+
+        tx_batch_test_tx(&tx, i, calldata);
+        TEST_CHECK(eth_tx_encode(&tx, expected, sizeof(expected), &expected_len) == 0);
+        TEST_CHECK(eth_tx_hash(&tx, &hash) == 0);
+
+        TEST_CHECK(offsets[i + 1] - offsets[i] == expected_len);
+        TEST_CHECK(memcmp(encoded + offsets[i], expected, expected_len) == 0);
+        TEST_CHECK(memcmp(hashes[i].data, hash.data, sizeof(hash.data)) == 0);
+        TEST_CHECK(eth_tx_batch_encoded_size(&batch, i, 1) == expected_len);
+
+        TEST_CHECK(eth_tx_batch_get(&batch, i, &loaded) == 0);
+        TEST_CHECK(loaded.data_len == tx.data_len && loaded.to_len == tx.to_len);
+        TEST_CHECK(eth_tx_encode(&loaded, again, sizeof(again), &again_len) == 0);
+        TEST_CHECK(again_len == expected_len && memcmp(again, expected, expected_len) == 0);
+    }
+
+    /* A range in the middle starts its offsets at 0 */
+    TEST_CHECK(eth_tx_batch_encode(&batch, 10, 5, encoded, sizeof(encoded), offsets) == 0);
+    TEST_CHECK(offsets[0] == 0 && offsets[5] == eth_tx_batch_encoded_size(&batch, 10, 5));
+
+    /* Bad ranges, short buffers and access lists */
+    TEST_CHECK(eth_tx_batch_encoded_size(&batch, TX_BATCH_TEST_COUNT - 1, 2) == 0);
+    TEST_CHECK(eth_tx_batch_encode(&batch, 0, 2, encoded, eth_tx_batch_encoded_size(&batch, 0, 2) - 1, offsets) != 0);
+    TEST_CHECK(eth_tx_batch_hash(&batch, TX_BATCH_TEST_COUNT, 1, hashes) != 0);
+    TEST_CHECK(eth_tx_batch_get(&batch, TX_BATCH_TEST_COUNT, &tx) != 0);
+
+    uint8_t access_list[2] = { 0xc0, 0xc0 };
+    tx_batch_test_tx(&tx, 1, calldata);
+    tx.access_list = access_list;
+    tx.access_list_len = sizeof(access_list);
+    TEST_CHECK(eth_tx_batch_add(&batch, &tx) != 0);
+    TEST_CHECK(batch.count == TX_BATCH_TEST_COUNT);
+
+    /* Clearing keeps the memory for the next batch */
+    size_t capacity = batch.capacity;
+    eth_tx_batch_clear(&batch);
+    TEST_CHECK(batch.count == 0 && batch.heap_size == 0 && batch.capacity == capacity);
+    tx_batch_test_tx(&tx, 3, calldata);
+    TEST_CHECK(eth_tx_batch_add(&batch, &tx) == 0 && batch.count == 1);
+
+    eth_tx_batch_free(&batch);
+}
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/tx_file.h"
+
+/* Scratch file, in the working directory */
+#define TX_FILE_TEST_PATH "run_tests_tx_file.bin"
+
+#define TX_FILE_TEST_COUNT 3
+
+/* One transaction of each type: a contract creation, a call with calldata, a large transfer */
+static void tx_file_test_tx(eth_transaction_t *tx, size_t i, uint8_t *calldata, size_t calldata_len) {
+    static const char value[] = "115792089237316195423570985008687907853269984665640564039457584007913129639935";
+
+    eth_tx_init(tx, (eth_tx_type_t)i);
+    tx->chain_id = 1 + i * 1000;
+    tx->nonce = 0xfedcba9876543210ULL >> i;
+    tx->gas_limit = 30000000 + i;
+    eth_u256_set_u64(&tx->gas_price, 7);
+    eth_u256_set_u64(&tx->max_priority_fee, 0);
+    eth_u256_set_u64(&tx->max_fee, 123456789012ULL);
+    if (i != 0) {
+        tx->to_len = 20;
+        memset(tx->to, 0xa0 + (int)i, sizeof(tx->to));
+    }
+    if (i == 2) {
+        eth_u256_set_dec(&tx->value, value, sizeof(value) - 1);
+    } else {
+        eth_u256_set_u64(&tx->value, i);
+        tx->data = calldata + i;
+        tx->data_len = calldata_len - i;
+    }
+}
+
+/* Read a whole file */
+static uint8_t *tx_file_read(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long length;
+
+    if (!file) {
+        return NULL;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)length);
+        if (data && fread(data, 1, (size_t)length, file) == (size_t)length) {
+            *size = (size_t)length;
+        } else {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    fclose(file);
+    return data;
+}
+
+/* Every transaction comes back with the same unsigned encoding */
+static void tx_file_check_records(const eth_tx_file_t *reader, uint8_t *calldata, size_t calldata_len) {
+    TEST_CHECK(reader->count == TX_FILE_TEST_COUNT);
+
+    for (size_t i = 0; i < TX_FILE_TEST_COUNT && i < reader->count; i++) {
+        eth_transaction_t expected, loaded;
+        uint8_t a[512], b[512];
+        size_t a_len = 0, b_len = 0;
+
+        tx_file_test_tx(&expected, i, calldata, calldata_len);
+        TEST_CHECK(eth_tx_file_get(reader, i, &loaded) == 0);
+        TEST_CHECK(loaded.tx_type == expected.tx_type && loaded.chain_id == expected.chain_id);
+        TEST_CHECK(loaded.data_len == expected.data_len);
+        TEST_CHECK(eth_tx_encode(&expected, a, sizeof(a), &a_len) == 0);
+        TEST_CHECK(eth_tx_encode(&loaded, b, sizeof(b), &b_len) == 0);
+        TEST_CHECK(a_len == b_len && memcmp(a, b, a_len) == 0);
+    }
+
+    eth_transaction_t tx;
+    TEST_CHECK(eth_tx_file_get(reader, TX_FILE_TEST_COUNT, &tx) != 0);
+}
+
+void test_tx_file(void) {
+    uint8_t calldata[68];
+    eth_tx_file_writer_t writer;
+    eth_tx_file_t reader;
+    size_t size = 0;
+
+    for (size_t i = 0; i < sizeof(calldata); i++) {
+        calldata[i] = (uint8_t)(i * 37 + 1);
+    }
+
+    TEST_CHECK(eth_tx_file_writer_open(&writer, TX_FILE_TEST_PATH) == 0);
+    for (size_t i = 0; i < TX_FILE_TEST_COUNT; i++) {
+        eth_transaction_t tx;
+        tx_file_test_tx(&tx, i, calldata, sizeof(calldata));
+        TEST_CHECK(eth_tx_file_writer_add(&writer, &tx) == 0);
+    }
+    TEST_CHECK(eth_tx_file_writer_finish(&writer) == 0);
+
+    /* Mapped from disk */
+    if (eth_tx_file_open(&reader, TX_FILE_TEST_PATH) == 0) {
+        tx_file_check_records(&reader, calldata, sizeof(calldata));
+        eth_tx_file_close(&reader);
+    } else {
+        TEST_CHECK(!"batch file opens");
+    }
+
+    uint8_t *file = tx_file_read(TX_FILE_TEST_PATH, &size);
+    remove(TX_FILE_TEST_PATH);
+    TEST_CHECK(file != NULL);
+    if (!file) {
+        return;
+    }
+
+    /* Header as documented: magic, version, sizes, count, then records, then the heap */
+    size_t heap_size = sizeof(calldata) + sizeof(calldata) - 1;
+    TEST_CHECK(size == ETH_TX_FILE_HEADER_SIZE + TX_FILE_TEST_COUNT * ETH_TX_FILE_RECORD_SIZE + heap_size);
+    TEST_CHECK_HEX(file, 18, "45545842" "0100" "4000" "c800" "000000000000" "0300");
+    TEST_CHECK(file[24] == ETH_TX_FILE_HEADER_SIZE && file[32] == (uint8_t)(size - heap_size) && file[40] == heap_size);
+
+    /* The same bytes from memory */
+    TEST_CHECK(eth_tx_file_open_buffer(&reader, file, size) == 0);
+    tx_file_check_records(&reader, calldata, sizeof(calldata));
+    eth_tx_file_close(&reader);
+
+    /* Malformed headers are refused */
+    uint8_t *broken = malloc(size);
+    if (broken) {
+        memcpy(broken, file, size);
+        broken[0] = 'X';
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, broken, size) != 0);
+
+        memcpy(broken, file, size);
+        broken[4] = 2;
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, broken, size) != 0);
+
+        /* More records than the file holds */
+        memcpy(broken, file, size);
+        broken[16] = 4;
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, broken, size) != 0);
+
+        /* Heap running past the end */
+        memcpy(broken, file, size);
+        broken[40]++;
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, broken, size) != 0);
+
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, file, ETH_TX_FILE_HEADER_SIZE - 1) != 0);
+
+        /* A bad record is only an error for that record */
+        memcpy(broken, file, size);
+        broken[ETH_TX_FILE_HEADER_SIZE + ETH_TX_FILE_RECORD_SIZE + 1] = 7;
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, broken, size) == 0);
+        eth_transaction_t tx;
+        TEST_CHECK(eth_tx_file_get(&reader, 0, &tx) == 0);
+        TEST_CHECK(eth_tx_file_get(&reader, 1, &tx) != 0);
+        TEST_CHECK(eth_tx_file_get(&reader, 2, &tx) == 0);
+
+        /* Calldata pointing outside the heap */
+        memcpy(broken, file, size);
+        broken[ETH_TX_FILE_HEADER_SIZE + 40] = (uint8_t)(heap_size + 1);
+        TEST_CHECK(eth_tx_file_open_buffer(&reader, broken, size) == 0);
+        TEST_CHECK(eth_tx_file_get(&reader, 0, &tx) != 0);
+        free(broken);
+    }
+
+    free(file);
+}
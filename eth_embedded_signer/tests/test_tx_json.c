@@ -0,0 +1,111 @@
+#include <string.h>
+#include "test.h"
+#include "../include/tx_json.h"
+
+/* Parse one object with a fresh arena */
+static int tx_json_parse_text(const char *json, eth_transaction_t *tx, eth_arena_t *arena) {
+    eth_arena_reset(arena);
+    return eth_tx_json_parse(json, strlen(json), tx, arena);
+}
+
+void test_tx_json(void) {
+    static uint8_t arena_memory[4096];
+    eth_arena_t arena;
+    eth_transaction_t tx;
+    eth_hash_t hash;
+    eth_u256_t expected;
+
+    TEST_CHECK(eth_arena_init(&arena, arena_memory, sizeof(arena_memory)) == 0);
+
+    /* The EIP-155 example: no type and no fee market fields, so legacy */
+    static const char legacy[] =
+        "{\"chainId\":\"0x1\",\"nonce\":\"0x9\",\"gasPrice\":\"0x4a817c800\",\"gas\":\"0x5208\","
+        "\"to\":\"0x3535353535353535353535353535353535353535\",\"value\":\"0xde0b6b3a7640000\"}";
+    TEST_CHECK(tx_json_parse_text(legacy, &tx, &arena) == 0);
+    TEST_CHECK(tx.tx_type == ETH_LEGACY_TX && tx.nonce == 9 && tx.gas_limit == 21000 && tx.to_len == 20);
+    TEST_CHECK(eth_tx_hash(&tx, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, "daf5a779ae972f972197303d7b574746c7ef83eadac0f2791ad23db92e4c8e53");
+
+    /* The same with plain integers, the aliases, "from", an unknown nested key and loose whitespace */
+    static const char aliases[] =
+        " {\n \"from\" : \"0x9d8a62f656a8d1615c1294fd71e9cfb3e4855a4f\", \"chainId\": 1, \"nonce\": 9,\n"
+        "  \"extra\": {\"list\": [1, \"two\", {\"x\": null}], \"flag\": true},\n"
+        "  \"gasPrice\": 20000000000, \"gasLimit\": \"0x5208\", \"input\": \"0x\",\n"
+        "  \"to\": \"0x3535353535353535353535353535353535353535\", \"value\": 1000000000000000000 }\n";
+    TEST_CHECK(tx_json_parse_text(aliases, &tx, &arena) == 0);
+    TEST_CHECK(tx.data_len == 0);
+    TEST_CHECK(eth_tx_hash(&tx, &hash) == 0);
+    TEST_CHECK_HEX(hash.data, 32, "daf5a779ae972f972197303d7b574746c7ef83eadac0f2791ad23db92e4c8e53");
+
+    /* EIP-1559 with calldata, a full-width value and an access list */
+    static const char dynamic_fee[] =
+        "{\"type\":\"0x2\",\"chainId\":\"0x89\",\"nonce\":\"0x0\",\"gas\":\"0x30d40\","
+        "\"maxFeePerGas\":\"0x2540be400\",\"maxPriorityFeePerGas\":\"0x3b9aca00\","
+        "\"to\":\"0xA0b86991c6218b36c1d19D4a2e9Eb0cE3606eB48\","
+        "\"value\":\"0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff\","
+        "\"data\":\"0xa9059cbb0000\","
+        "\"accessList\":[{\"address\":\"0x1111111111111111111111111111111111111111\","
+        "\"storageKeys\":[\"0x2222222222222222222222222222222222222222222222222222222222222222\"]}]}";
+    TEST_CHECK(tx_json_parse_text(dynamic_fee, &tx, &arena) == 0);
+    TEST_CHECK(tx.tx_type == ETH_EIP1559_TX && tx.chain_id == 137 && tx.gas_limit == 200000);
+    eth_u256_set_u64(&expected, 10000000000ULL);
+    TEST_CHECK(eth_u256_cmp(&tx.max_fee, &expected) == 0);
+    eth_u256_set_u64(&expected, 1000000000);
+    TEST_CHECK(eth_u256_cmp(&tx.max_priority_fee, &expected) == 0);
+    TEST_CHECK_HEX(tx.to, 20, "a0b86991c6218b36c1d19d4a2e9eb0ce3606eb48");
+    TEST_CHECK_HEX(tx.data, tx.data_len, "a9059cbb0000");
+    uint8_t value[32];
+    eth_u256_to_bytes(&tx.value, value);
+    TEST_CHECK_HEX(value, 32, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    /* [address, [key]] as the RLP list payload */
+    TEST_CHECK_HEX(tx.access_list, tx.access_list_len,
+                   "f794" "1111111111111111111111111111111111111111"
+                   "e1a0" "2222222222222222222222222222222222222222222222222222222222222222");
+
+    /* An access list without a type makes it EIP-2930; contract creation has no "to" */
+    TEST_CHECK(tx_json_parse_text("{\"chainId\":1,\"gasPrice\":1,\"gas\":53000,\"data\":\"0x6000\",\"accessList\":[]}",
+                                  &tx, &arena) == 0);
+    TEST_CHECK(tx.tx_type == ETH_EIP2930_TX && tx.to_len == 0 && tx.access_list_len == 0 && tx.data_len == 2);
+
+    /* Malformed input and fields that do not belong to the type */
+    static const char *const rejected[] = {
+        "{\"type\":\"0x0\",\"maxFeePerGas\":\"0x1\"}",
+        "{\"type\":\"0x2\",\"gasPrice\":\"0x1\"}",
+        "{\"type\":\"0x3\"}",
+        "{\"to\":\"0x3535\"}",
+        "{\"from\":\"0xzz35353535353535353535353535353535353535\"}",
+        "{\"data\":\"0xabc\"}",
+        "{\"nonce\":\"0x10000000000000000\"}",
+        "{\"value\":\"0x1ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff\"}",
+        "{\"nonce\":-1}",
+        "{\"nonce\":\"0x1\"",
+        "{\"nonce\" \"0x1\"}",
+        "[\"nonce\"]",
+        "",
+    };
+    for (size_t i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        TEST_CHECK(tx_json_parse_text(rejected[i], &tx, &arena) != 0);
+    }
+
+    /* Calldata that does not fit the arena is an error, not a truncation */
+    static uint8_t small_memory[4];
+    eth_arena_t small;
+    TEST_CHECK(eth_arena_init(&small, small_memory, sizeof(small_memory)) == 0);
+    TEST_CHECK(eth_tx_json_parse("{\"data\":\"0xa9059cbb00\"}", 23, &tx, &small) != 0);
+
+    /* A newline-delimited stream keeps going past a bad line */
+    static const char stream[] =
+        "{\"nonce\":1,\"gasPrice\":1}\n"
+        "{\"nonce\":2,\"gasPrice\":}\n"
+        "\n"
+        "{\"nonce\":3,\"gasPrice\":1} {\"nonce\":4,\"gasPrice\":1}\n";
+    eth_tx_json_reader_t reader;
+    eth_arena_reset(&arena);
+    TEST_CHECK(eth_tx_json_reader_init(&reader, stream, sizeof(stream) - 1, &arena) == 0);
+    TEST_CHECK(eth_tx_json_next(&reader, &tx) == 0 && tx.nonce == 1);
+    TEST_CHECK(eth_tx_json_next(&reader, &tx) < 0);
+    TEST_CHECK(reader.error_offset > 26 && reader.error_offset < 52);
+    TEST_CHECK(eth_tx_json_next(&reader, &tx) == 0 && tx.nonce == 3);
+    TEST_CHECK(eth_tx_json_next(&reader, &tx) == 0 && tx.nonce == 4);
+    TEST_CHECK(eth_tx_json_next(&reader, &tx) == ETH_TX_JSON_END);
+}
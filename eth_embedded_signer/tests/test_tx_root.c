@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/tx_root.h"
+
+/* Transactions used below: transaction i is i + 1 bytes of value i */
+#define TX_ROOT_COUNT 130
+
+/* Root of the first 'count' test transactions with 'threads' threads */
+static int tx_root_of(const uint8_t *const *raw_txs, const size_t *lengths, size_t count,
+                      unsigned threads, uint8_t root[32]) {
+    size_t size = eth_tx_root_arena_size(count, threads);
+    void *memory = malloc(size ? size : 1);
+    eth_arena_t arena;
+    int result = -1;
+
+    if (memory && eth_arena_init(&arena, memory, size) == 0) {
+        result = eth_tx_root(raw_txs, lengths, count, &arena, threads, root);
+    }
+
+    free(memory);
+    return result;
+}
+
+/* Longer transactions of mixed lengths: every value is hashed, not inlined */
+static void tx_root_test_large(void) {
+    enum { TX_ROOT_LARGE = 1000 };
+    static uint8_t storage[TX_ROOT_LARGE][300];
+    static const uint8_t *raw_txs[TX_ROOT_LARGE];
+    static size_t lengths[TX_ROOT_LARGE];
+    uint8_t root[32];
+
+    for (size_t i = 0; i < TX_ROOT_LARGE; i++) {
+        lengths[i] = (i * 37) % 300 + 1;
+        for (size_t j = 0; j < lengths[i]; j++) {
+            storage[i][j] = (uint8_t)(i * 31 + j * 7);
+        }
+        raw_txs[i] = storage[i];
+    }
+
+    TEST_CHECK(tx_root_of(raw_txs, lengths, 17, 2, root) == 0);
+    TEST_CHECK_HEX(root, 32, "ccae7d46e3188baf070b22c75ae0013b29795a5bddfbe31fdfd6e3be5523f651");
+    for (unsigned threads = 1; threads <= 16; threads *= 2) {
+        TEST_CHECK(tx_root_of(raw_txs, lengths, TX_ROOT_LARGE, threads, root) == 0);
+        TEST_CHECK_HEX(root, 32, "e91238a407f7fc5ebe597200abfb5c1d59517bf2509d05cff18bfa78d1652e95");
+    }
+
+    /* The arena is left as it was, after data already in it */
+    size_t size = eth_tx_root_arena_size(TX_ROOT_LARGE, 4) + 64;
+    void *memory = malloc(size);
+    eth_arena_t arena;
+    TEST_CHECK(memory != NULL);
+    if (memory) {
+        TEST_CHECK(eth_arena_init(&arena, memory, size) == 0);
+        TEST_CHECK(eth_arena_alloc(&arena, 40, 8) != NULL);
+        size_t used = arena.used;
+        TEST_CHECK(eth_tx_root(raw_txs, lengths, TX_ROOT_LARGE, &arena, 4, root) == 0);
+        TEST_CHECK(arena.used == used);
+        TEST_CHECK_HEX(root, 32, "e91238a407f7fc5ebe597200abfb5c1d59517bf2509d05cff18bfa78d1652e95");
+
+        /* Too little room is an error, not an overflow */
+        TEST_CHECK(eth_arena_init(&arena, memory, 1024) == 0);
+        TEST_CHECK(eth_tx_root(raw_txs, lengths, TX_ROOT_LARGE, &arena, 4, root) != 0);
+        TEST_CHECK(arena.used == 0);
+        free(memory);
+    }
+}
+
+void test_tx_root(void) {
+    static uint8_t storage[TX_ROOT_COUNT][TX_ROOT_COUNT];
+    const uint8_t *raw_txs[TX_ROOT_COUNT];
+    size_t lengths[TX_ROOT_COUNT];
+    uint8_t root[32];
+
+    for (size_t i = 0; i < TX_ROOT_COUNT; i++) {
+        memset(storage[i], (int)i, i + 1);
+        raw_txs[i] = storage[i];
+        lengths[i] = i + 1;
+    }
+
+    /* Empty trie: keccak256(0x80) */
+    TEST_CHECK(tx_root_of(raw_txs, lengths, 0, 1, root) == 0);
+    TEST_CHECK_HEX(root, 32, "56e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421");
+
+    /* Short values stay inline in their parent nodes */
+    TEST_CHECK(tx_root_of(raw_txs, lengths, 3, 1, root) == 0);
+    TEST_CHECK_HEX(root, 32, "c144af7216ec5666b4cca99ed2d1cd454983d1c13c8e3ac8d7b638a6bc1c0206");
+
+    /* Keys past 0x7f (RLP 0x81 0x80 ...) sort after key 0 */
+    for (unsigned threads = 1; threads <= 4; threads++) {
+        TEST_CHECK(tx_root_of(raw_txs, lengths, TX_ROOT_COUNT, threads, root) == 0);
+        TEST_CHECK_HEX(root, 32, "457c62b18a561f2faabbcaf37d6b5c498e2fafb1efdf5871beb0cdaaa331ccc8");
+    }
+
+    tx_root_test_large();
+}
@@ -0,0 +1,120 @@
+#include <string.h>
+#include "test.h"
+#include "../include/u256.h"
+#include "../include/rlp.h"
+
+/* 2^256 - 1 in decimal */
+static const char u256_max_dec[] =
+    "115792089237316195423570985008687907853269984665640564039457584007913129639935";
+
+/* RLP encoding of a value, checked against hex and against rlp_u256_length */
+static void u256_check_rlp(const eth_u256_t *value, const char *hex) {
+    uint8_t buffer[40];
+    rlp_encoder_t encoder;
+
+    TEST_CHECK(rlp_encoder_init(&encoder, buffer, sizeof(buffer)) == 0);
+    TEST_CHECK(rlp_encode_u256(&encoder, value) == 0);
+    TEST_CHECK(rlp_get_length(&encoder) == rlp_u256_length(value));
+    TEST_CHECK_HEX(buffer, rlp_get_length(&encoder), hex);
+}
+
+void test_u256(void) {
+    eth_u256_t a, b;
+    uint8_t bytes[33];
+
+    /* Decimal and hex agree, across limb boundaries and at the top */
+    static const struct {
+        const char *dec;
+        const char *hex;
+        size_t byte_length;
+    } values[] = {
+        { "0", "0x0", 0 },
+        { "255", "0XFF", 1 },
+        { "1000000000000000000", "0x0de0b6b3a7640000", 8 },
+        { "18446744073709551615", "ffffffffffffffff", 8 },
+        { "18446744073709551616", "0x10000000000000000", 9 },
+        { "340282366920938463463374607431768211456", "0x100000000000000000000000000000000", 17 },
+        { u256_max_dec, "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", 32 },
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        TEST_CHECK(eth_u256_set_dec(&a, values[i].dec, strlen(values[i].dec)) == 0);
+        TEST_CHECK(eth_u256_set_hex(&b, values[i].hex, strlen(values[i].hex)) == 0);
+        TEST_CHECK(eth_u256_cmp(&a, &b) == 0);
+        TEST_CHECK(eth_u256_byte_length(&a) == values[i].byte_length);
+        TEST_CHECK(eth_u256_is_zero(&a) == (values[i].byte_length == 0));
+    }
+
+    /* 2^64 is the low bit of the second limb */
+    eth_u256_set_dec(&b, "18446744073709551616", 20);
+    TEST_CHECK(b.limb[0] == 0 && b.limb[1] == 1 && b.limb[2] == 0 && b.limb[3] == 0);
+
+    /* Big-endian bytes in both directions */
+    eth_u256_set_dec(&a, u256_max_dec, sizeof(u256_max_dec) - 1);
+    eth_u256_to_bytes(&a, bytes);
+    TEST_CHECK_HEX(bytes, 32, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    test_hex_bytes("0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20", bytes, 32);
+    TEST_CHECK(eth_u256_set_bytes(&a, bytes, 32) == 0);
+    TEST_CHECK(a.limb[0] == 0x191a1b1c1d1e1f20ULL && a.limb[3] == 0x0102030405060708ULL);
+    TEST_CHECK(eth_u256_set_bytes(&a, bytes + 29, 3) == 0 && a.limb[0] == 0x1e1f20 && a.limb[1] == 0);
+    TEST_CHECK(eth_u256_set_bytes(&a, bytes, 33) != 0);
+
+    /* Ordering is decided by the most significant limb that differs */
+    eth_u256_set_hex(&a, "0x10000000000000000", 19);
+    eth_u256_set_u64(&b, UINT64_MAX);
+    TEST_CHECK(eth_u256_cmp(&a, &b) == 1 && eth_u256_cmp(&b, &a) == -1);
+    eth_u256_set_hex(&b, "0x1000000000000000000000000000000000000000000000000", 51);
+    TEST_CHECK(eth_u256_cmp(&a, &b) == -1);
+
+    /* Leading zeros are fine, more than 256 bits or stray characters are not */
+    static const char padded[] = "0x0000000000000000000000000000000000000000000000000000000000000000000001";
+    TEST_CHECK(eth_u256_set_hex(&a, padded, sizeof(padded) - 1) == 0 && a.limb[0] == 1);
+    static const char *const bad_hex[] = {
+        "", "0x", "0x1g", "-1", "1 ",
+        "0x1ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+    };
+    for (size_t i = 0; i < sizeof(bad_hex) / sizeof(bad_hex[0]); i++) {
+        TEST_CHECK(eth_u256_set_hex(&a, bad_hex[i], strlen(bad_hex[i])) != 0);
+    }
+    static const char *const bad_dec[] = {
+        "", "12a", "-1", "0x10",
+        "115792089237316195423570985008687907853269984665640564039457584007913129639936",
+        "1157920892373161954235709850086879078532699846656405640394575840079131296399350",
+    };
+    for (size_t i = 0; i < sizeof(bad_dec) / sizeof(bad_dec[0]); i++) {
+        TEST_CHECK(eth_u256_set_dec(&a, bad_dec[i], strlen(bad_dec[i])) != 0);
+    }
+
+    /* RLP: minimal big-endian bytes, single bytes below 0x80 stand for themselves */
+    eth_u256_set_u64(&a, 0);
+    u256_check_rlp(&a, "80");
+    eth_u256_set_u64(&a, 0x7f);
+    u256_check_rlp(&a, "7f");
+    eth_u256_set_u64(&a, 0x80);
+    u256_check_rlp(&a, "8180");
+    eth_u256_set_hex(&a, "0x10000000000000000", 19);
+    u256_check_rlp(&a, "89010000000000000000");
+    eth_u256_set_dec(&a, u256_max_dec, sizeof(u256_max_dec) - 1);
+    u256_check_rlp(&a, "a0ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+
+    /* Same bytes as the 64-bit encoder for values that fit */
+    static const uint64_t small[] = { 0, 1, 0x7f, 0x80, 0xff, 0x100, 0xdeadbeef, UINT64_MAX };
+    for (size_t i = 0; i < sizeof(small) / sizeof(small[0]); i++) {
+        uint8_t wide[16], narrow[16];
+        rlp_encoder_t wide_encoder, narrow_encoder;
+
+        eth_u256_set_u64(&a, small[i]);
+        rlp_encoder_init(&wide_encoder, wide, sizeof(wide));
+        rlp_encoder_init(&narrow_encoder, narrow, sizeof(narrow));
+        TEST_CHECK(rlp_encode_u256(&wide_encoder, &a) == 0 && rlp_encode_uint(&narrow_encoder, small[i]) == 0);
+        TEST_CHECK(rlp_get_length(&wide_encoder) == rlp_get_length(&narrow_encoder));
+        TEST_CHECK(memcmp(wide, narrow, rlp_get_length(&narrow_encoder)) == 0);
+        TEST_CHECK(rlp_u256_length(&a) == rlp_uint_length(small[i]));
+    }
+
+    /* No room for the value is an error */
+    rlp_encoder_t full;
+    uint8_t tiny[8];
+    rlp_encoder_init(&full, tiny, sizeof(tiny));
+    eth_u256_set_hex(&a, "0x10000000000000000", 19);
+    TEST_CHECK(rlp_encode_u256(&full, &a) != 0);
+}
@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../include/verify.h"
+
+#define VERIFY_TEST_KEYS     3
+#define VERIFY_TEST_MESSAGES 24
+
+/* secp256k1 group order */
+static const char verify_order_hex[] = "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141";
+
+/* s -> n - s (big-endian, s non-zero) */
+static void verify_negate_s(eth_signature_t *signature) {
+    uint8_t order[32];
+    int borrow = 0;
+
+    test_hex_bytes(verify_order_hex, order, sizeof(order));
+    for (int i = 31; i >= 0; i--) {
+        int difference = order[i] - signature->data[32 + i] - borrow;
+        borrow = difference < 0;
+        signature->data[32 + i] = (uint8_t)(difference + (borrow ? 256 : 0));
+    }
+}
+
+/* Check a signature both ways: generic and through the set */
+static void verify_both(const eth_verifier_set_t *set, size_t key_index, const eth_public_key_t *public_key,
+                        const eth_hash_t *hash, const eth_signature_t *signature, int expected) {
+    TEST_CHECK(eth_verify(hash, signature, public_key) == expected);
+    TEST_CHECK(eth_verify_known(set, key_index, hash, signature) == expected);
+}
+
+/* The EIP-155 example: signing hash, signature and key 0x4646...46 */
+static void verify_test_published(void) {
+    eth_private_key_t key;
+    eth_public_key_t public_key;
+    eth_signature_t signature;
+    eth_hash_t hash;
+
+    memset(key.data, 0x46, sizeof(key.data));
+    TEST_CHECK(eth_private_key_to_public_key(&key, &public_key) == 0);
+    test_hex_bytes("daf5a779ae972f972197303d7b574746c7ef83eadac0f2791ad23db92e4c8e53", hash.data, 32);
+    test_hex_bytes("28ef61340bd939bc2195fe537567866003e1a15d3c71ff63e1590620aa636276"
+                   "67cbe9d8997f761aecb703304b3800ccf555c9f3dc64214b297fb1966a3b6d83",
+                   signature.data, 64);
+    TEST_CHECK(eth_verify(&hash, &signature, &public_key) == 0);
+
+    hash.data[31] ^= 1;
+    TEST_CHECK(eth_verify(&hash, &signature, &public_key) == ETH_VERIFY_MISMATCH);
+}
+
+void test_verify(void) {
+    eth_private_key_t keys[VERIFY_TEST_KEYS];
+    eth_public_key_t public_keys[VERIFY_TEST_KEYS];
+    eth_verifier_set_t set;
+    eth_arena_t arena;
+    size_t key_index = 0;
+
+    verify_test_published();
+
+    size_t size = eth_verifier_set_arena_size(VERIFY_TEST_KEYS);
+    void *memory = malloc(size);
+    TEST_CHECK(memory != NULL);
+    if (!memory) {
+        return;
+    }
+    TEST_CHECK(eth_arena_init(&arena, memory, size) == 0);
+    TEST_CHECK(eth_verifier_set_init(&set, &arena, VERIFY_TEST_KEYS) == 0);
+
+    for (size_t k = 0; k < VERIFY_TEST_KEYS; k++) {
+        memset(keys[k].data, (int)(0x21 * (k + 1)), sizeof(keys[k].data));
+        TEST_CHECK(eth_private_key_to_public_key(&keys[k], &public_keys[k]) == 0);
+        TEST_CHECK(eth_verifier_set_add(&set, &public_keys[k], &key_index) == 0 && key_index == k);
+    }
+
+    /* The set is full; tables are cache-line aligned */
+    TEST_CHECK(eth_verifier_set_add(&set, &public_keys[0], NULL) != 0);
+    TEST_CHECK(((uintptr_t)set.tables & 63) == 0);
+
+    unsigned failures = 0;
+    for (size_t i = 0; i < VERIFY_TEST_MESSAGES; i++) {
+        size_t k = i % VERIFY_TEST_KEYS;
+        eth_signature_t signature;
+        eth_hash_t hash;
+        uint8_t message[2] = { 0x76, (uint8_t)i };
+
+        TEST_CHECK(eth_keccak256(message, sizeof(message), &hash) == 0);
+        TEST_CHECK(eth_sign(&hash, &keys[k], &signature) == 0);
+        int before = test_failures;
+
+        verify_both(&set, k, &public_keys[k], &hash, &signature, 0);
+
+        /* High s verifies too */
+        verify_negate_s(&signature);
+        verify_both(&set, k, &public_keys[k], &hash, &signature, 0);
+
+        /* Another key, another message, a changed r */
+        size_t other = (k + 1) % VERIFY_TEST_KEYS;
+        verify_both(&set, other, &public_keys[other], &hash, &signature, ETH_VERIFY_MISMATCH);
+        hash.data[i % 32] ^= 0x40;
+        verify_both(&set, k, &public_keys[k], &hash, &signature, ETH_VERIFY_MISMATCH);
+        hash.data[i % 32] ^= 0x40;
+        signature.data[i % 32] ^= 0x01;
+        verify_both(&set, k, &public_keys[k], &hash, &signature, ETH_VERIFY_MISMATCH);
+
+        failures += test_failures != before;
+    }
+    TEST_CHECK(failures == 0);
+
+    /* r or s of 0 or n are not signatures */
+    eth_signature_t malformed;
+    eth_hash_t hash;
+    memset(&hash, 0x5e, sizeof(hash));
+    memset(&malformed, 0, sizeof(malformed));
+    malformed.data[31] = 1;
+    verify_both(&set, 0, &public_keys[0], &hash, &malformed, ETH_VERIFY_MISMATCH);
+    test_hex_bytes(verify_order_hex, malformed.data + 32, 32);
+    verify_both(&set, 0, &public_keys[0], &hash, &malformed, ETH_VERIFY_MISMATCH);
+
+    /* Unknown indexes and keys off the curve are errors, not mismatches */
+    TEST_CHECK(eth_verify_known(&set, VERIFY_TEST_KEYS, &hash, &malformed) < 0);
+    eth_public_key_t off_curve = public_keys[0];
+    off_curve.data[63] ^= 1;
+    TEST_CHECK(eth_verify(&hash, &malformed, &off_curve) < 0);
+    TEST_CHECK(eth_verifier_set_init(&set, &arena, 1) != 0);
+
+    free(memory);
+}
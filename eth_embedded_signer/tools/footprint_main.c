@@ -0,0 +1,31 @@
+/*
+ * Smallest program around the signing path: signs one transaction and
+ * encodes it. The footprint target links it with unused sections removed,
+ * so its map shows what eth_tx_sign and eth_tx_encode_signed take from
+ * flash and RAM on their own.
+ */
+
+#include <string.h>
+#include "../include/transaction.h"
+
+int main(void) {
+    static uint8_t encoded[256];
+    eth_transaction_t tx;
+    eth_private_key_t key;
+    size_t size;
+
+    memset(&key, 0x11, sizeof(key));
+    eth_tx_init(&tx, ETH_EIP1559_TX);
+    tx.chain_id = 1;
+    tx.gas_limit = 21000;
+    tx.to_len = 20;
+    memset(tx.to, 0x22, sizeof(tx.to));
+
+    if (eth_tx_sign(&tx, &key) != 0) {
+        return 1;
+    }
+    if (eth_tx_encode_signed(&tx, encoded, sizeof(encoded), &size) != 0) {
+        return 1;
+    }
+    return encoded[0] == 0x02 ? 0 : 1;
+}
@@ -0,0 +1,495 @@
+/*
+ * Stack and section report for the footprint target.
+ *
+ * Reads the call graphs GCC writes with -fcallgraph-info=su (one .ci file
+ * per translation unit, with every function's frame size from
+ * -fstack-usage) and the linker map of the footprint image, then prints:
+ *   - the worst-case stack depth of each root function, with its deepest path
+ *   - frame, worst-case depth and code size of every function it can reach
+ *   - the image's section sizes and largest data objects
+ * Recursion, calls through function pointers and unbounded dynamic frames
+ * make a depth a lower bound only; they are reported as such. Library
+ * functions (no call graph) are listed but not counted.
+ *
+ * Usage: footprint_report <image.map> <root[,root...]> <file.ci>...
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPORT_LINE_SIZE 4096
+#define REPORT_BUCKETS   4096
+#define REPORT_INDIRECT  "__indirect_call"
+
+/* Visit states of the depth search */
+#define REPORT_NEW     0
+#define REPORT_ACTIVE  1
+#define REPORT_DONE    2
+
+typedef struct {
+    char *title;            /* Unique key: "file:name" for static functions, "name" otherwise */
+    char *name;
+    char *file;             /* Source file, from the label */
+    long frame;             /* Frame size in bytes, -1 without a call graph (library) */
+    int dynamic;            /* Frame has an unbounded dynamic part */
+    long code;              /* Code size from the map, -1 if not found */
+    size_t *callees;
+    size_t callee_count, callee_capacity;
+    int state;
+    int unbounded;          /* Depth is a lower bound */
+    long worst;             /* Worst-case depth including this frame */
+    size_t deepest;         /* Callee on the deepest path, or SIZE_MAX */
+    int reachable;
+    size_t next;            /* Hash chain */
+} report_node_t;
+
+typedef struct {
+    char *name;             /* Input section, e.g. .text.eth_tx_sign */
+    char *object;
+    long size;
+} report_section_t;
+
+static report_node_t *nodes;
+static size_t node_count, node_capacity;
+static size_t buckets[REPORT_BUCKETS];
+
+static report_section_t *sections;
+static size_t section_count, section_capacity;
+
+/* Output sections of the image */
+static const char *const output_names[] = { ".text", ".rodata", ".data", ".bss" };
+static long output_sizes[4];
+
+static void *report_grow(void *array, size_t *capacity, size_t count, size_t size) {
+    if (count < *capacity) {
+        return array;
+    }
+    *capacity = *capacity ? *capacity * 2 : 64;
+    array = realloc(array, *capacity * size);
+    if (!array) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return array;
+}
+
+static char *report_strndup(const char *text, size_t length) {
+    char *copy = malloc(length + 1);
+    if (!copy) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+static size_t report_hash(const char *text) {
+    size_t hash = 2166136261u;
+    while (*text) {
+        hash = (hash ^ (unsigned char)*text++) * 16777619u;
+    }
+    return hash % REPORT_BUCKETS;
+}
+
+/* Node with this title, created on first mention */
+static size_t report_node(const char *title) {
+    size_t bucket = report_hash(title);
+    for (size_t i = buckets[bucket]; i != SIZE_MAX; i = nodes[i].next) {
+        if (strcmp(nodes[i].title, title) == 0) {
+            return i;
+        }
+    }
+
+    nodes = report_grow(nodes, &node_capacity, node_count, sizeof(*nodes));
+    report_node_t *node = &nodes[node_count];
+    memset(node, 0, sizeof(*node));
+    node->title = report_strndup(title, strlen(title));
+    const char *colon = strrchr(title, ':');
+    node->name = report_strndup(colon ? colon + 1 : title, strlen(colon ? colon + 1 : title));
+    node->file = report_strndup("", 0);
+    node->frame = -1;
+    node->code = -1;
+    node->state = REPORT_NEW;
+    node->deepest = SIZE_MAX;
+    node->next = buckets[bucket];
+    buckets[bucket] = node_count;
+    return node_count++;
+}
+
+/* Quoted value after key on line, copied into output; 0 if absent */
+static int report_field(const char *line, const char *key, char *output, size_t size) {
+    const char *start = strstr(line, key);
+    if (!start) {
+        return 0;
+    }
+    start += strlen(key);
+    const char *end = strchr(start, '"');
+    if (!end || (size_t)(end - start) >= size) {
+        return 0;
+    }
+    memcpy(output, start, (size_t)(end - start));
+    output[end - start] = '\0';
+    return 1;
+}
+
+/* Label: "name\nfile:line:col\nN bytes (static|dynamic|dynamic,bounded)" */
+static void report_label(report_node_t *node, const char *label) {
+    const char *file = strstr(label, "\\n");
+    if (!file) {
+        return;
+    }
+    file += 2;
+    const char *colon = strchr(file, ':');
+    if (colon) {
+        free(node->file);
+        node->file = report_strndup(file, (size_t)(colon - file));
+    }
+
+    const char *bytes = strstr(file, "\\n");
+    if (bytes) {
+        node->frame = strtol(bytes + 2, NULL, 10);
+        node->dynamic = strstr(bytes, "(dynamic)") != NULL;
+    }
+}
+
+static int report_read_graph(const char *path) {
+    FILE *input = fopen(path, "r");
+    if (!input) {
+        perror(path);
+        return 1;
+    }
+
+    char line[REPORT_LINE_SIZE], title[1024], label[1024], target[1024];
+    while (fgets(line, sizeof(line), input)) {
+        if (strncmp(line, "node:", 5) == 0 && report_field(line, "title: \"", title, sizeof(title))) {
+            size_t index = report_node(title);
+            if (!strstr(line, "shape : ellipse") && report_field(line, "label: \"", label, sizeof(label))) {
+                report_label(&nodes[index], label);
+            }
+        } else if (strncmp(line, "edge:", 5) == 0 && report_field(line, "sourcename: \"", title, sizeof(title)) &&
+                   report_field(line, "targetname: \"", target, sizeof(target))) {
+            size_t source = report_node(title);
+            size_t callee = report_node(target);
+            report_node_t *node = &nodes[source];
+            node->callees = report_grow(node->callees, &node->callee_capacity, node->callee_count,
+                                        sizeof(size_t));
+            node->callees[node->callee_count++] = callee;
+        }
+    }
+
+    fclose(input);
+    return 0;
+}
+
+static void report_add_section(const char *name, long size, const char *object) {
+    sections = report_grow(sections, &section_capacity, section_count, sizeof(*sections));
+    sections[section_count].name = report_strndup(name, strlen(name));
+    sections[section_count].object = report_strndup(object, strlen(object));
+    sections[section_count].size = size;
+    section_count++;
+}
+
+/* "0xADDRESS 0xSIZE [object]" after a section name */
+static int report_address_size(const char *text, long *size, char object[1024]) {
+    unsigned long long address, value;
+    int consumed = 0;
+    if (sscanf(text, " 0x%llx 0x%llx %n", &address, &value, &consumed) < 2) {
+        return 0;
+    }
+    *size = (long)value;
+    object[0] = '\0';
+    if (consumed > 0 && sscanf(text + consumed, "%1023s", object) != 1) {
+        object[0] = '\0';
+    }
+    return 1;
+}
+
+static int report_read_map(const char *path) {
+    FILE *input = fopen(path, "r");
+    if (!input) {
+        perror(path);
+        return 1;
+    }
+
+    char line[REPORT_LINE_SIZE], pending[1024] = "", object[1024];
+    int in_map = 0, pending_output = -1;
+    while (fgets(line, sizeof(line), input)) {
+        if (!in_map) {
+            in_map = strncmp(line, "Linker script and memory map", 28) == 0;
+            continue;
+        }
+
+        long size;
+        if (pending[0] != '\0') {
+            /* Long names put address and size on the next line */
+            if (report_address_size(line, &size, object)) {
+                report_add_section(pending, size, object);
+            }
+            pending[0] = '\0';
+            continue;
+        }
+
+        if (line[0] == '.') {
+            pending_output = -1;
+            for (int i = 0; i < 4; i++) {
+                size_t length = strlen(output_names[i]);
+                if (strncmp(line, output_names[i], length) == 0 && (line[length] == ' ' || line[length] == '\n')) {
+                    pending_output = i;
+                }
+            }
+            if (pending_output >= 0) {
+                const char *rest = line + strlen(output_names[pending_output]);
+                if (report_address_size(rest, &size, object)) {
+                    output_sizes[pending_output] = size;
+                    pending_output = -1;
+                }
+            }
+        } else if (pending_output >= 0) {
+            if (report_address_size(line, &size, object)) {
+                output_sizes[pending_output] = size;
+            }
+            pending_output = -1;
+        } else if (line[0] == ' ' && line[1] == '.') {
+            char name[1024];
+            int consumed = 0;
+            if (sscanf(line, " %1023s%n", name, &consumed) != 1) {
+                continue;
+            }
+            if (report_address_size(line + consumed, &size, object)) {
+                report_add_section(name, size, object);
+            } else {
+                snprintf(pending, sizeof(pending), "%s", name);
+            }
+        }
+    }
+
+    fclose(input);
+    return 0;
+}
+
+static const char *report_basename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    const char *backslash = strrchr(path, '\\');
+    if (backslash && (!slash || backslash > slash)) {
+        slash = backslash;
+    }
+    return slash ? slash + 1 : path;
+}
+
+/* Object built from source: transaction.c -> transaction.c.o or transaction.o */
+static int report_object_matches(const char *object, const char *source) {
+    const char *object_name = report_basename(object);
+    const char *source_name = report_basename(source);
+    size_t length = strlen(source_name);
+
+    if (strncmp(object_name, source_name, length) == 0 && strcmp(object_name + length, ".o") == 0) {
+        return 1;
+    }
+    return length > 2 && strcmp(source_name + length - 2, ".c") == 0 &&
+           strncmp(object_name, source_name, length - 2) == 0 && strcmp(object_name + length - 2, ".o") == 0;
+}
+
+/* Code size: .text.<name> plus any hot/cold/startup parts */
+static void report_code_sizes(void) {
+    static const char *const prefixes[] = { ".text.", ".text.unlikely.", ".text.hot.", ".text.startup." };
+
+    for (size_t i = 0; i < node_count; i++) {
+        report_node_t *node = &nodes[i];
+        int is_static = strcmp(node->title, node->name) != 0;
+        if (node->frame < 0) {
+            continue;
+        }
+        for (size_t s = 0; s < section_count; s++) {
+            for (size_t p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+                size_t length = strlen(prefixes[p]);
+                if (strncmp(sections[s].name, prefixes[p], length) != 0 ||
+                    strcmp(sections[s].name + length, node->name) != 0) {
+                    continue;
+                }
+                if (is_static && !report_object_matches(sections[s].object, node->file)) {
+                    continue;
+                }
+                node->code = (node->code < 0 ? 0 : node->code) + sections[s].size;
+            }
+        }
+    }
+}
+
+/* Worst-case depth from node, memoized; recursion and indirect calls mark it unbounded */
+static long report_depth(size_t index) {
+    report_node_t *node = &nodes[index];
+
+    if (node->state == REPORT_DONE) {
+        return node->worst;
+    }
+    if (node->state == REPORT_ACTIVE) {
+        fprintf(stdout, "  recursion through %s: depth is a lower bound\n", node->name);
+        node->unbounded = 1;
+        return 0;
+    }
+
+    node->state = REPORT_ACTIVE;
+    node->reachable = 1;
+    long deepest = 0;
+    int unbounded = node->dynamic;
+    for (size_t i = 0; i < node->callee_count; i++) {
+        size_t callee = node->callees[i];
+        if (strcmp(nodes[callee].title, REPORT_INDIRECT) == 0) {
+            nodes[callee].reachable = 1;
+            unbounded = 1;
+            continue;
+        }
+        long depth = report_depth(callee);
+        unbounded |= nodes[callee].unbounded;
+        if (node->deepest == SIZE_MAX || depth > deepest) {
+            deepest = depth;
+            node->deepest = callee;
+        }
+    }
+
+    node->worst = (node->frame > 0 ? node->frame : 0) + deepest;
+    node->unbounded |= unbounded;
+    node->state = REPORT_DONE;
+    return node->worst;
+}
+
+static int report_by_worst(const void *a, const void *b) {
+    const report_node_t *x = &nodes[*(const size_t *)a];
+    const report_node_t *y = &nodes[*(const size_t *)b];
+    if (x->worst != y->worst) {
+        return x->worst < y->worst ? 1 : -1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+static int report_by_size(const void *a, const void *b) {
+    const report_section_t *x = *(const report_section_t *const *)a;
+    const report_section_t *y = *(const report_section_t *const *)b;
+    return x->size < y->size ? 1 : x->size > y->size ? -1 : 0;
+}
+
+static void report_roots(char *roots) {
+    printf("Worst-case stack (bytes)\n\n");
+    for (char *root = strtok(roots, ","); root; root = strtok(NULL, ",")) {
+        size_t index = report_node(root);
+        if (nodes[index].frame < 0) {
+            printf("%s: no call graph (not built with -fcallgraph-info?)\n\n", root);
+            continue;
+        }
+        long depth = report_depth(index);
+        printf("%s: %ld%s\n", root, depth, nodes[index].unbounded ? " (lower bound, see below)" : "");
+        printf("   frame  function\n");
+        for (size_t i = index; i != SIZE_MAX && nodes[i].frame >= 0; i = nodes[i].deepest) {
+            printf("  %6ld  %s\n", nodes[i].frame, nodes[i].name);
+        }
+        printf("\n");
+    }
+}
+
+static void report_functions(void) {
+    size_t *order = malloc((node_count ? node_count : 1) * sizeof(size_t));
+    size_t count = 0;
+    long code = 0;
+
+    if (!order) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < node_count; i++) {
+        if (nodes[i].reachable && nodes[i].frame >= 0) {
+            order[count++] = i;
+            code += nodes[i].code > 0 ? nodes[i].code : 0;
+        }
+    }
+    qsort(order, count, sizeof(size_t), report_by_worst);
+
+    printf("Reachable functions\n");
+    printf("   frame   worst    code  function\n");
+    for (size_t i = 0; i < count; i++) {
+        const report_node_t *node = &nodes[order[i]];
+        printf("  %6ld  %6ld  ", node->frame, node->worst);
+        if (node->code >= 0) {
+            printf("%6ld", node->code);
+        } else {
+            printf("%6s", "-");
+        }
+        printf("  %s%s%s\n", node->name, node->dynamic ? " (dynamic frame)" : "",
+               node->unbounded && !node->dynamic ? " *" : "");
+    }
+    printf("  %zu functions, %ld bytes of code\n\n", count, code);
+
+    int any = 0;
+    for (size_t i = 0; i < node_count; i++) {
+        if (nodes[i].reachable && strcmp(nodes[i].title, REPORT_INDIRECT) == 0) {
+            printf("* calls through function pointers: depth is a lower bound\n\n");
+        }
+    }
+    for (size_t i = 0; i < node_count; i++) {
+        if (nodes[i].reachable && nodes[i].frame < 0 && strcmp(nodes[i].title, REPORT_INDIRECT) != 0) {
+            printf("%s%s", any ? " " : "Library calls (not counted): ", nodes[i].name);
+            any = 1;
+        }
+    }
+    if (any) {
+        printf("\n\n");
+    }
+    free(order);
+}
+
+static void report_sections(void) {
+    printf("Image sections (bytes)\n");
+    for (int i = 0; i < 4; i++) {
+        printf("  %-8s %8ld\n", output_names[i], output_sizes[i]);
+    }
+    printf("  flash    %8ld  (.text + .rodata + .data)\n", output_sizes[0] + output_sizes[1] + output_sizes[2]);
+    printf("  RAM      %8ld  (.data + .bss, before stack)\n\n", output_sizes[2] + output_sizes[3]);
+
+    const report_section_t **data = malloc((section_count ? section_count : 1) * sizeof(*data));
+    size_t count = 0;
+    if (!data) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < section_count; i++) {
+        if (sections[i].size >= 64 && (strncmp(sections[i].name, ".rodata.", 8) == 0 ||
+                                        strncmp(sections[i].name, ".data.", 6) == 0 ||
+                                        strncmp(sections[i].name, ".bss.", 5) == 0)) {
+            data[count++] = &sections[i];
+        }
+    }
+    qsort(data, count, sizeof(*data), report_by_size);
+
+    printf("Data objects of 64 bytes or more\n");
+    for (size_t i = 0; i < count; i++) {
+        printf("  %8ld  %s (%s)\n", data[i]->size, data[i]->name, report_basename(data[i]->object));
+    }
+    free(data);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <image.map> <root[,root...]> <file.ci>...\n", argv[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < REPORT_BUCKETS; i++) {
+        buckets[i] = SIZE_MAX;
+    }
+    for (int i = 3; i < argc; i++) {
+        if (report_read_graph(argv[i]) != 0) {
+            return 1;
+        }
+    }
+    if (report_read_map(argv[1]) != 0) {
+        return 1;
+    }
+    report_code_sizes();
+
+    report_roots(argv[2]);
+    report_functions();
+    report_sections();
+    return 0;
+}
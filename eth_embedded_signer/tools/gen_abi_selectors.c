@@ -0,0 +1,169 @@
+/*
+ * Build-time generator for abi_selectors.h.
+ *
+ * Reads the signature list (tools/abi_selectors.txt), runs Keccak-256 over
+ * each signature and writes the selector macros plus the lookup tables used
+ * by abi.c, so no selector is hashed at run time.
+ *
+ * Usage: gen_abi_selectors <abi_selectors.txt> <abi_selectors.h>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include "../include/keccak.h"
+
+#define GEN_MAX_ENTRIES    256
+#define GEN_MAX_NAME       64
+#define GEN_MAX_SIGNATURE  256
+
+typedef struct {
+    char name[GEN_MAX_NAME];
+    char signature[GEN_MAX_SIGNATURE];
+    uint32_t selector;
+} gen_entry_t;
+
+static gen_entry_t entries[GEN_MAX_ENTRIES];
+static size_t entry_count;
+
+static int compare_selector(const void *a, const void *b) {
+    uint32_t x = ((const gen_entry_t *)a)->selector;
+    uint32_t y = ((const gen_entry_t *)b)->selector;
+    return (x > y) - (x < y);
+}
+
+/* Sort key for the signature index: entry positions after sorting by selector */
+static int compare_signature(const void *a, const void *b) {
+    return strcmp(entries[*(const size_t *)a].signature, entries[*(const size_t *)b].signature);
+}
+
+static int parse_line(const char *path, unsigned line_number, char *line) {
+    char *name = strtok(line, " \t\r\n");
+    if (!name || name[0] == '#') {
+        return 0;
+    }
+
+    char *signature = strtok(NULL, " \t\r\n");
+    if (!signature || strtok(NULL, " \t\r\n")) {
+        fprintf(stderr, "%s:%u: expected <NAME> <signature>\n", path, line_number);
+        return -1;
+    }
+    if (strlen(name) >= GEN_MAX_NAME || strlen(signature) >= GEN_MAX_SIGNATURE) {
+        fprintf(stderr, "%s:%u: entry too long\n", path, line_number);
+        return -1;
+    }
+    for (const char *c = name; *c; c++) {
+        if (!isupper((unsigned char)*c) && !isdigit((unsigned char)*c) && *c != '_') {
+            fprintf(stderr, "%s:%u: name must be upper case, digits and '_'\n", path, line_number);
+            return -1;
+        }
+    }
+    if (!strchr(signature, '(') || signature[strlen(signature) - 1] != ')') {
+        fprintf(stderr, "%s:%u: malformed signature '%s'\n", path, line_number, signature);
+        return -1;
+    }
+    if (entry_count == GEN_MAX_ENTRIES) {
+        fprintf(stderr, "%s:%u: too many entries\n", path, line_number);
+        return -1;
+    }
+
+    gen_entry_t *entry = &entries[entry_count++];
+    strcpy(entry->name, name);
+    strcpy(entry->signature, signature);
+
+    uint8_t digest[32];
+    eth_keccak_ctx_t ctx;
+    eth_keccak256_init(&ctx);
+    eth_keccak256_update(&ctx, (const uint8_t *)signature, strlen(signature));
+    eth_keccak256_final(&ctx, digest);
+    entry->selector = ((uint32_t)digest[0] << 24) | ((uint32_t)digest[1] << 16) |
+                      ((uint32_t)digest[2] << 8) | digest[3];
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <abi_selectors.txt> <abi_selectors.h>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *input = fopen(argv[1], "r");
+    if (!input) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    char line[512];
+    unsigned line_number = 0;
+    while (fgets(line, sizeof(line), input)) {
+        if (parse_line(argv[1], ++line_number, line) != 0) {
+            fclose(input);
+            return 1;
+        }
+    }
+    fclose(input);
+
+    /* Names and selectors must both be unique */
+    for (size_t i = 0; i < entry_count; i++) {
+        for (size_t j = i + 1; j < entry_count; j++) {
+            if (strcmp(entries[i].name, entries[j].name) == 0) {
+                fprintf(stderr, "%s: duplicate name %s\n", argv[1], entries[i].name);
+                return 1;
+            }
+            if (entries[i].selector == entries[j].selector) {
+                fprintf(stderr, "%s: selector collision between %s and %s\n",
+                        argv[1], entries[i].signature, entries[j].signature);
+                return 1;
+            }
+        }
+    }
+
+    qsort(entries, entry_count, sizeof(gen_entry_t), compare_selector);
+
+    size_t order[GEN_MAX_ENTRIES];
+    for (size_t i = 0; i < entry_count; i++) {
+        order[i] = i;
+    }
+    qsort(order, entry_count, sizeof(size_t), compare_signature);
+
+    FILE *output = fopen(argv[2], "w");
+    if (!output) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    fprintf(output, "/* Generated by tools/gen_abi_selectors.c from tools/abi_selectors.txt, do not edit */\n\n");
+    fprintf(output, "#ifndef ETH_EMBEDDED_ABI_SELECTORS_H\n#define ETH_EMBEDDED_ABI_SELECTORS_H\n\n");
+
+    for (size_t i = 0; i < entry_count; i++) {
+        fprintf(output, "#define ETH_ABI_SELECTOR_%-28s 0x%08xu  /* %s */\n",
+                entries[i].name, entries[i].selector, entries[i].signature);
+    }
+
+    fprintf(output, "\n#define ETH_ABI_SELECTOR_COUNT %zu\n", entry_count);
+
+    fprintf(output, "\n/* X(selector, signature), sorted by selector */\n");
+    fprintf(output, "#define ETH_ABI_SELECTOR_ENTRIES(X) \\\n");
+    for (size_t i = 0; i < entry_count; i++) {
+        fprintf(output, "    X(0x%08xu, \"%s\")%s\n", entries[i].selector, entries[i].signature,
+                i + 1 < entry_count ? " \\" : "");
+    }
+
+    fprintf(output, "\n/* Positions in ETH_ABI_SELECTOR_ENTRIES, sorted by signature */\n");
+    fprintf(output, "#define ETH_ABI_SIGNATURE_ORDER");
+    for (size_t i = 0; i < entry_count; i++) {
+        fprintf(output, "%s%zu", i == 0 ? " " : ", ", order[i]);
+    }
+
+    fprintf(output, "\n\n#endif /* ETH_EMBEDDED_ABI_SELECTORS_H */\n");
+
+    if (fclose(output) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
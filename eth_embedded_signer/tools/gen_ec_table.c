@@ -0,0 +1,89 @@
+/*
+ * Build-time generator for ec_gen_table.h.
+ *
+ * Computes the fixed-base table of the secp256k1 generator G with the given
+ * window width and writes it as a const array, which ec.c compiles into
+ * .rodata, so no process builds the table at startup.
+ *
+ * Usage: gen_ec_table <window bits, 1-8> <ec_gen_table.h>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/ec.h"
+
+static void write_fe(FILE *output, const eth_fe_t *a) {
+    fprintf(output, "{ { ");
+    for (int i = 0; i < 8; i++) {
+        fprintf(output, "0x%08xu%s", a->n[i], i < 7 ? ", " : "");
+    }
+    fprintf(output, " } }");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <window bits, 1-8> <ec_gen_table.h>\n", argv[0]);
+        return 1;
+    }
+
+    char *end;
+    long bits = strtol(argv[1], &end, 10);
+    if (*end != '\0' || bits < 1 || bits > 8) {
+        fprintf(stderr, "%s: window bits must be between 1 and 8\n", argv[1]);
+        return 1;
+    }
+
+    size_t size = ETH_EC_TABLE_SIZE_FOR(bits);
+    eth_ge_storage_t *table = malloc(size * sizeof(eth_ge_storage_t));
+    if (!table) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    eth_ge_t g;
+    eth_ge_set_generator(&g);
+    eth_ec_table_build_bits(table, &g, (unsigned)bits);
+
+    /* Every entry must be on the curve */
+    for (size_t i = 0; i < size; i++) {
+        eth_ge_t entry;
+        entry.x = table[i].x;
+        entry.y = table[i].y;
+        entry.infinity = 0;
+        if (!eth_ge_is_valid(&entry)) {
+            fprintf(stderr, "entry %zu is not on the curve\n", i);
+            free(table);
+            return 1;
+        }
+    }
+
+    FILE *output = fopen(argv[2], "w");
+    if (!output) {
+        perror(argv[2]);
+        free(table);
+        return 1;
+    }
+
+    fprintf(output, "/* Generated by tools/gen_ec_table.c, do not edit */\n\n");
+    fprintf(output, "#ifndef ETH_EMBEDDED_EC_GEN_TABLE_H\n#define ETH_EMBEDDED_EC_GEN_TABLE_H\n\n");
+    fprintf(output, "#define EC_GEN_TABLE_BITS %ld\n\n", bits);
+    fprintf(output, "/* j * 2^(%ld * w) * G for j = 1..%d, window w after window (%zu bytes) */\n",
+            bits, ETH_EC_TABLE_ENTRIES_FOR(bits), size * sizeof(eth_ge_storage_t));
+    fprintf(output, "static const eth_ge_storage_t ec_gen_table[%zu] = {\n", size);
+    for (size_t i = 0; i < size; i++) {
+        fprintf(output, "    { ");
+        write_fe(output, &table[i].x);
+        fprintf(output, ", ");
+        write_fe(output, &table[i].y);
+        fprintf(output, " },\n");
+    }
+    fprintf(output, "};\n\n#endif /* ETH_EMBEDDED_EC_GEN_TABLE_H */\n");
+    free(table);
+
+    if (fclose(output) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    return 0;
+}